@@ -68,9 +68,14 @@ namespace Falcor
         }
     }
 
-    CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+    bool CopyContext::ReadTextureTask::isReady() const
     {
-        return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex);
+        return mpFence->getGpuValue() + 1 >= mpFence->getCpuValue();
+    }
+
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pStagingBuffer)
+    {
+        return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex, pStagingBuffer);
     }
 
     std::vector<uint8_t> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
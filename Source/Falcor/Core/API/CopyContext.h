@@ -43,8 +43,19 @@ namespace Falcor
         {
         public:
             using SharedPtr = std::shared_ptr<ReadTextureTask>;
-            static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+            /** Record a copy of a texture subresource into a CPU-readable buffer and signal a fence once it completes.
+                \param[in] pStagingBuffer Optional readback buffer to copy into. It is used if it's large enough, otherwise a new buffer is allocated. The caller must make sure the GPU is no longer using it.
+            */
+            static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pStagingBuffer = nullptr);
             std::vector<uint8_t> getData();
+
+            /** Check if the GPU finished the copy, i.e. getData() won't block.
+            */
+            bool isReady() const;
+
+            /** Get the readback buffer the data was copied into. It can be passed to a later task once this one is ready.
+            */
+            const Buffer::SharedPtr& getStagingBuffer() const { return mpBuffer; }
         private:
             ReadTextureTask() = default;
             GpuFence::SharedPtr mpFence;
@@ -126,8 +137,9 @@ namespace Falcor
         std::vector<uint8_t> readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
 
         /** Read texture data Asynchronously
+            \param[in] pStagingBuffer Optional readback buffer to reuse, see ReadTextureTask::create()
         */
-        ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
+        ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pStagingBuffer = nullptr);
 
         /** Get the low-level context data
         */
@@ -94,6 +94,7 @@ namespace Falcor
 
         mpLastBoundComputeVars = pVars;
         mpLowLevelData->getCommandList()->SetPipelineState(pCSO->getApiHandle());
+        mpLowLevelData->addRecordedCommand();
         mCommandsPending = true;
         return true;
     }
@@ -122,7 +122,7 @@ namespace Falcor
         return pSwapChain3;
     }
 
-    DeviceHandle createDevice(IDXGIFactory4* pFactory, D3D_FEATURE_LEVEL requestedFeatureLevel, const std::vector<UUID>& experimentalFeatures)
+    DeviceHandle createDevice(IDXGIFactory4* pFactory, D3D_FEATURE_LEVEL requestedFeatureLevel, const std::vector<UUID>& experimentalFeatures, bool useSoftwareAdapter, bool allowSoftwareFallback)
     {
         // Feature levels to try creating devices. Listed in descending order so the highest supported level is used.
         const static D3D_FEATURE_LEVEL kFeatureLevels[] =
@@ -172,6 +172,25 @@ namespace Falcor
             return false;
         };
 
+        auto createSoftwareDevice = [&]() -> bool
+        {
+            if (FAILED(pFactory->EnumWarpAdapter(IID_PPV_ARGS(&pAdapter)))) return false;
+
+            if (requestedFeatureLevel == 0) createMaxFeatureLevel(kFeatureLevels, arraysize(kFeatureLevels));
+            else createMaxFeatureLevel(&requestedFeatureLevel, 1);
+
+            if (pDevice == nullptr) return false;
+            logInfo("Successfully created software (WARP) device with feature level: " + to_string(deviceFeatureLevel));
+            return true;
+        };
+
+        if (useSoftwareAdapter)
+        {
+            if (createSoftwareDevice()) return pDevice;
+            logFatal("Could not create a D3D12 device on the software (WARP) adapter");
+            return nullptr;
+        }
+
         uint32_t gpuDeviceId = 0;
         for (uint32_t i = 0; DXGI_ERROR_NOT_FOUND != pFactory->EnumAdapters1(i, &pAdapter); i++)
         {
@@ -197,6 +216,12 @@ namespace Falcor
             }
         }
 
+        if (allowSoftwareFallback)
+        {
+            logWarning("Could not find a GPU that supports D3D12 device. Falling back to the software (WARP) adapter.");
+            if (createSoftwareDevice()) return pDevice;
+        }
+
         logFatal("Could not find a GPU that supports D3D12 device");
         return nullptr;
     }
@@ -307,7 +332,7 @@ namespace Falcor
         d3d_call(CreateDXGIFactory2(dxgiFlags, IID_PPV_ARGS(&mpApiData->pDxgiFactory)));
 
         // Create the device
-        mApiHandle = createDevice(mpApiData->pDxgiFactory, getD3DFeatureLevel(mDesc.apiMajorVersion, mDesc.apiMinorVersion), mDesc.experimentalFeatures);
+        mApiHandle = createDevice(mpApiData->pDxgiFactory, getD3DFeatureLevel(mDesc.apiMajorVersion, mDesc.apiMinorVersion), mDesc.experimentalFeatures, mDesc.useSoftwareAdapter, isHeadless());
         if (mApiHandle == nullptr) return false;
 
         mSupportedFeatures = getSupportedFeatures(mApiHandle);
@@ -355,7 +380,9 @@ namespace Falcor
         uint64_t freq;
         d3d_call(getCommandQueueHandle(LowLevelContextData::CommandQueueType::Direct, 0)->GetTimestampFrequency(&freq));
         mGpuTimestampFrequency = 1000.0 / (double)freq;
-        return createSwapChain(mDesc.colorFormat);
+
+        // Headless devices don't have a swap-chain
+        return isHeadless() ? true : createSwapChain(mDesc.colorFormat);
     }
 
     bool Device::createSwapChain(ResourceFormat colorFormat)
@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "Core/API/GpuFence.h"
 #include "Core/API/Device.h"
+#include "Utils/Timing/CpuStallMonitor.h"
 
 namespace Falcor
 {
@@ -83,8 +84,10 @@ namespace Falcor
         uint64_t gpuVal = getGpuValue();
         if (gpuVal < syncVal)
         {
+            auto start = CpuTimer::getCurrentTimePoint();
             d3d_call(mApiHandle->SetEventOnCompletion(syncVal, mpApiData->eventHandle));
             WaitForSingleObject(mpApiData->eventHandle, INFINITE);
+            CpuStallMonitor::reportStall(CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()));
         }
     }
 
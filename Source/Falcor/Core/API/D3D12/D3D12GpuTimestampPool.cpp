@@ -0,0 +1,55 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "Core/API/GpuTimestampPool.h"
+
+namespace Falcor
+{
+    void GpuTimestampPool::apiWriteTimestamp(uint32_t query)
+    {
+        mpLowLevelData->getCommandList()->EndQuery(mpHeap.lock()->getApiHandle(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+    }
+
+    void GpuTimestampPool::apiResolve(uint32_t firstQuery, uint32_t count)
+    {
+        mpLowLevelData->getCommandList()->ResolveQueryData(mpHeap.lock()->getApiHandle(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, count, mpReadbackBuffer->getApiHandle(), sizeof(uint64_t) * firstQuery);
+    }
+
+    bool GpuTimestampPool::apiCalibrate(uint64_t& gpuTimestamp, int64_t& cpuTimeNs)
+    {
+        // The CPU timestamp is a QPC value, which is also the source of std::chrono::high_resolution_clock.
+        uint64_t cpuTimestamp = 0;
+        if (FAILED(mpLowLevelData->getCommandQueue()->GetClockCalibration(&gpuTimestamp, &cpuTimestamp))) return false;
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        const uint64_t freq = (uint64_t)frequency.QuadPart;
+        cpuTimeNs = (int64_t)((cpuTimestamp / freq) * 1000000000ull + (cpuTimestamp % freq) * 1000000000ull / freq);
+        return true;
+    }
+}
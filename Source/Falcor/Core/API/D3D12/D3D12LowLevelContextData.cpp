@@ -98,7 +98,16 @@ namespace Falcor
         d3d_call(mpList->Close());
         ID3D12CommandList* pList = mpList.GetInterfacePtr();
         assert(mpQueue);
-        mpQueue->ExecuteCommandLists(1, &pList);
+        if (gpDevice->isDiscardingGpuWork())
+        {
+            // Only record the stats. The fence is still signaled so that resources and allocators are recycled, which completes immediately on an idle queue.
+            gpDevice->recordDiscardedCommandList(mRecordedCommandCount);
+        }
+        else
+        {
+            mpQueue->ExecuteCommandLists(1, &pList);
+        }
+        mRecordedCommandCount = 0;
         mpFence->gpuSignal(mpQueue);
         mpAllocator = mpApiData->pAllocatorPool->newObject();
         d3d_call(mpAllocator->Reset());
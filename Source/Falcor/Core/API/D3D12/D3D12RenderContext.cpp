@@ -321,6 +321,7 @@ namespace Falcor
         const auto pDsState = pState->getDepthStencilState();
         pList->OMSetStencilRef(pDsState == nullptr ? 0 : pDsState->getStencilRef());
 
+        mpLowLevelData->addRecordedCommand();
         mCommandsPending = true;
         return true;
     }
@@ -413,6 +414,7 @@ namespace Falcor
         GET_COM_INTERFACE(pCmdList, ID3D12GraphicsCommandList4, pList4);
         pList4->SetPipelineState1(pRtso->getApiHandle().GetInterfacePtr());
         pList4->DispatchRays(&raytraceDesc);
+        mpLowLevelData->addRecordedCommand();
     }
 
     void RenderContext::blit(ShaderResourceView::SharedPtr pSrc, RenderTargetView::SharedPtr pDst, const uint4& srcRect, const uint4& dstRect, Sampler::Filter filter)
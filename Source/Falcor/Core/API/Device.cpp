@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "Device.h"
+#include "Utils/Timing/CpuStallMonitor.h"
 
 namespace Falcor
 {
@@ -47,6 +48,24 @@ namespace Falcor
         return gpDevice;
     }
 
+    Device::SharedPtr Device::createHeadless(uint32_t width, uint32_t height, const Device::Desc& desc)
+    {
+        if (gpDevice)
+        {
+            logError("Falcor only supports a single device");
+            return nullptr;
+        }
+        if (width == 0 || height == 0)
+        {
+            logError("Can't create a headless device with an empty back-buffer");
+            return nullptr;
+        }
+        gpDevice = SharedPtr(new Device(nullptr, desc));
+        gpDevice->mHeadlessSize = uint2(width, height);
+        if (gpDevice->init() == false) { gpDevice = nullptr; }
+        return gpDevice;
+    }
+
     bool Device::init()
     {
         const uint32_t kDirectQueueIndex = (uint32_t)LowLevelContextData::CommandQueueType::Direct;
@@ -81,7 +100,8 @@ namespace Falcor
         // TODO: Do we need to flush here or should RenderContext::create() bind the descriptor heaps automatically without flush? See #749.
 
         // Update the FBOs
-        if (updateDefaultFBO(mpWindow->getClientAreaSize().x, mpWindow->getClientAreaSize().y, mDesc.colorFormat, mDesc.depthFormat) == false)
+        uint2 backBufferSize = mpWindow ? mpWindow->getClientAreaSize() : mHeadlessSize;
+        if (updateDefaultFBO(backBufferSize.x, backBufferSize.y, mDesc.colorFormat, mDesc.depthFormat) == false)
         {
             return false;
         }
@@ -105,13 +125,21 @@ namespace Falcor
     bool Device::updateDefaultFBO(uint32_t width, uint32_t height, ResourceFormat colorFormat, ResourceFormat depthFormat)
     {
         ResourceHandle apiHandles[kSwapChainBuffersCount] = {};
-        getApiFboData(width, height, colorFormat, depthFormat, apiHandles, mCurrentBackBufferIndex);
+        if (mpWindow && getApiFboData(width, height, colorFormat, depthFormat, apiHandles, mCurrentBackBufferIndex) == false) return false;
 
         for (uint32_t i = 0; i < kSwapChainBuffersCount; i++)
         {
-            // Create a texture object
-            auto pColorTex = Texture::SharedPtr(new Texture(width, height, 1, 1, 1, 1, colorFormat, Texture::Type::Texture2D, Texture::BindFlags::RenderTarget));
-            pColorTex->mApiHandle = apiHandles[i];
+            // Create a texture object. Headless devices render into offscreen textures in place of the swap-chain buffers.
+            Texture::SharedPtr pColorTex;
+            if (mpWindow)
+            {
+                pColorTex = Texture::SharedPtr(new Texture(width, height, 1, 1, 1, 1, colorFormat, Texture::Type::Texture2D, Texture::BindFlags::RenderTarget));
+                pColorTex->mApiHandle = apiHandles[i];
+            }
+            else
+            {
+                pColorTex = Texture::create2D(width, height, colorFormat, 1, 1, nullptr, Texture::BindFlags::RenderTarget | Texture::BindFlags::ShaderResource);
+            }
             // Create the FBO if it's required
             if (mpSwapChainFbos[i] == nullptr) mpSwapChainFbos[i] = Fbo::create();
             mpSwapChainFbos[i]->attachColorTarget(pColorTex, 0);
@@ -167,6 +195,14 @@ namespace Falcor
         mpGpuDescPool->executeDeferredReleases();
     }
 
+    void Device::recordDiscardedCommandList(uint32_t commandCount)
+    {
+        mDiscardedStats.commandListCount++;
+        mDiscardedStats.commandCount += commandCount;
+        mTotalDiscardedStats.commandListCount++;
+        mTotalDiscardedStats.commandCount += commandCount;
+    }
+
     void Device::toggleVSync(bool enable)
     {
         mDesc.enableVsync = enable;
@@ -174,8 +210,13 @@ namespace Falcor
 
     void Device::cleanup()
     {
-        toggleFullScreen(false);
+        CpuStallMonitor::ExpectedScope expectedStall;
+        if (mpWindow) toggleFullScreen(false);
         mpRenderContext->flush(true);
+        if (isDiscardingGpuWork())
+        {
+            logInfo("Discarded " + std::to_string(mTotalDiscardedStats.commandListCount) + " command lists with " + std::to_string(mTotalDiscardedStats.commandCount) + " draws/dispatches without submitting them to the GPU.");
+        }
         // Release all the bound resources. Need to do that before deleting the RenderContext
         for (uint32_t i = 0; i < arraysize(mCmdQueues); i++) mCmdQueues[i].clear();
         for (uint32_t i = 0; i < kSwapChainBuffersCount; i++) mpSwapChainFbos[i].reset();
@@ -194,17 +235,39 @@ namespace Falcor
 
     void Device::present()
     {
-        mpRenderContext->resourceBarrier(mpSwapChainFbos[mCurrentBackBufferIndex]->getColorTexture(0).get(), Resource::State::Present);
-        mpRenderContext->flush();
-        apiPresent();
+        if (mpWindow)
+        {
+            mpRenderContext->resourceBarrier(mpSwapChainFbos[mCurrentBackBufferIndex]->getColorTexture(0).get(), Resource::State::Present);
+            mpRenderContext->flush();
+            apiPresent();
+        }
+        else
+        {
+            // Nothing to present. Submit the frame and rotate the offscreen back-buffers so frame pacing matches the windowed path.
+            // Note that unless GPU work is discarded, the frame time includes the GPU execution, which runs on the CPU when using WARP.
+            mpRenderContext->flush();
+            mCurrentBackBufferIndex = (mCurrentBackBufferIndex + 1) % kSwapChainBuffersCount;
+        }
+        if (isDiscardingGpuWork())
+        {
+            mLastFrameDiscardedStats = mDiscardedStats;
+            mDiscardedStats = {};
+        }
         mpFrameFence->gpuSignal(mpRenderContext->getLowLevelData()->getCommandQueue());
-        if (mpFrameFence->getCpuValue() >= kSwapChainBuffersCount) mpFrameFence->syncCpu(mpFrameFence->getCpuValue() - kSwapChainBuffersCount);
+        if (mpFrameFence->getCpuValue() >= kSwapChainBuffersCount && !isDiscardingGpuWork())
+        {
+            // Limit the number of frames in flight. Waiting here only means we're GPU bound.
+            CpuStallMonitor::ExpectedScope expectedStall;
+            mpFrameFence->syncCpu(mpFrameFence->getCpuValue() - kSwapChainBuffersCount);
+        }
         executeDeferredReleases();
+        CpuStallMonitor::endFrame();
         mFrameID++;
     }
 
     void Device::flushAndSync()
     {
+        CpuStallMonitor::ExpectedScope expectedStall;
         mpRenderContext->flush(true);
         mpFrameFence->gpuSignal(mpRenderContext->getLowLevelData()->getCommandQueue());
         executeDeferredReleases();
@@ -214,6 +277,7 @@ namespace Falcor
     {
         assert(width > 0 && height > 0);
 
+        CpuStallMonitor::ExpectedScope expectedStall;
         mpRenderContext->flush(true);
 
         // Store the FBO parameters
@@ -248,12 +312,12 @@ namespace Falcor
 
         // Delete all the FBOs
         releaseFboData();
-        apiResizeSwapChain(width, height, colorFormat);
+        if (mpWindow) apiResizeSwapChain(width, height, colorFormat);
         updateDefaultFBO(width, height, colorFormat, depthFormat);
 
 #ifdef FALCOR_D3D12
-        // Restore FBO resource states
-        for (uint32_t i = 0; i < kSwapChainBuffersCount; i++)
+        // Restore FBO resource states. Headless back-buffers are new textures and already track their own state.
+        for (uint32_t i = 0; i < kSwapChainBuffersCount && mpWindow; i++)
         {
             assert(mpSwapChainFbos[i]->getColorTexture(0)->isStateGlobal());
             mpSwapChainFbos[i]->getColorTexture(0)->setGlobalState(fboColorStates[i]);
@@ -278,7 +342,7 @@ namespace Falcor
         auto deviceDesc = m.class_<Device::Desc>("DeviceDesc");
 #define desc_field(f_) rwField(#f_, &Device::Desc::f_)
         deviceDesc.desc_field(colorFormat).desc_field(depthFormat).desc_field(apiMajorVersion).desc_field(apiMinorVersion);
-        deviceDesc.desc_field(enableVsync).desc_field(enableDebugLayer).desc_field(cmdQueues);
+        deviceDesc.desc_field(enableVsync).desc_field(enableDebugLayer).desc_field(useSoftwareAdapter).desc_field(discardGpuWork).desc_field(cmdQueues);
 #undef desc_field
     }
 }
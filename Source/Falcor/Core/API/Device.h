@@ -62,6 +62,8 @@ namespace Falcor
             uint32_t apiMinorVersion = 0;                                   ///< Requested API minor version. If specified, device creation will fail if not supported. Otherwise, the highest supported version will be automatically selected.
             bool enableVsync = false;                                       ///< Controls vertical-sync
             bool enableDebugLayer = DEFAULT_ENABLE_DEBUG_LAYER;             ///< Enable the debug layer. The default for release build is false, for debug build it's true.
+            bool useSoftwareAdapter = false;                                ///< Create the device on the software (WARP) adapter instead of a GPU. Headless devices fall back to it when no GPU is found.
+            bool discardGpuWork = false;                                    ///< Headless D3D12 devices only. Close command lists without submitting them, so frame times only measure the CPU side. GPU results and readbacks are undefined.
 
             static_assert((uint32_t)LowLevelContextData::CommandQueueType::Direct == 2, "Default initialization of cmdQueues assumes that Direct queue index is 2");
             std::array<uint32_t, kQueueTypeCount> cmdQueues = { 0, 0, 1 };  ///< Command queues to create. If no direct-queues are created, mpRenderContext will not be initialized
@@ -80,6 +82,11 @@ namespace Falcor
             Raytracing = 0x4                              // On D3D12, DirectX Raytracing is supported. It is up to the user to not use raytracing functions when not supported.
         };
 
+        /** Maximum number of frames the CPU can record ahead of the GPU. present() blocks until the GPU has finished the frame that many frames back.
+            Per-frame resources (upload heap, deferred releases) are recycled at the same rate.
+        */
+        static constexpr uint32_t kMaxFramesInFlight = 3;
+
         /** Create a new device.
             \param[in] pWindow a previously-created window object
             \param[in] desc Device configuration descriptor.
@@ -87,6 +94,16 @@ namespace Falcor
         */
         static SharedPtr create(Window::SharedPtr& pWindow, const Desc& desc);
 
+        /** Create a new device without a window.
+            There is no swap-chain. The default FBOs are backed by offscreen textures and present() only advances the frame.
+            If no GPU supports D3D12, the device is created on the software (WARP) adapter.
+            \param[in] width Width of the offscreen back-buffers.
+            \param[in] height Height of the offscreen back-buffers.
+            \param[in] desc Device configuration descriptor.
+            \return nullptr if the function failed, otherwise a new device object
+        */
+        static SharedPtr createHeadless(uint32_t width, uint32_t height, const Desc& desc);
+
         /** Acts as the destructor for Device. Some resources use gpDevice in their cleanup.
             Cleaning up the SharedPtr directly would clear gpDevice before calling destructors.
         */
@@ -100,6 +117,28 @@ namespace Falcor
         */
         bool isWindowOccluded() const;
 
+        /** Check if the device was created without a window
+        */
+        bool isHeadless() const { return mpWindow == nullptr; }
+
+        /** Check if command lists are discarded instead of submitted. See Desc::discardGpuWork.
+        */
+        bool isDiscardingGpuWork() const { return isHeadless() && mDesc.discardGpuWork; }
+
+        struct SubmissionStats
+        {
+            uint64_t commandListCount = 0;  ///< Number of command lists.
+            uint64_t commandCount = 0;      ///< Number of draws, dispatches and ray dispatches recorded in them.
+        };
+
+        /** Get the stats of the command lists discarded during the last frame. Only valid if isDiscardingGpuWork() is true.
+        */
+        const SubmissionStats& getDiscardedSubmissionStats() const { return mLastFrameDiscardedStats; }
+
+        /** Record a command list that was closed without being submitted. Called by LowLevelContextData::flush().
+        */
+        void recordDiscardedCommandList(uint32_t commandCount);
+
         /** Get the FBO object associated with the swap-chain.
             This can change each frame, depending on the API used
         */
@@ -166,7 +205,7 @@ namespace Falcor
         uint32_t  getDeviceVendorID() const;
 #endif
     private:
-        static constexpr uint32_t kSwapChainBuffersCount = 3;
+        static constexpr uint32_t kSwapChainBuffersCount = kMaxFramesInFlight;
         struct ResourceRelease
         {
             size_t frameID;
@@ -174,7 +213,7 @@ namespace Falcor
         };
         std::queue<ResourceRelease> mDeferredReleases;
 
-        uint32_t mCurrentBackBufferIndex;
+        uint32_t mCurrentBackBufferIndex = 0;
         Fbo::SharedPtr mpSwapChainFbos[kSwapChainBuffersCount];
 
         Device(Window::SharedPtr pWindow, const Desc& desc) : mpWindow(pWindow), mDesc(desc) {}
@@ -192,6 +231,10 @@ namespace Falcor
         GpuFence::SharedPtr mpFrameFence;
 
         Window::SharedPtr mpWindow;
+        uint2 mHeadlessSize = uint2(0);
+        SubmissionStats mDiscardedStats;                // Current frame
+        SubmissionStats mLastFrameDiscardedStats;
+        SubmissionStats mTotalDiscardedStats;
         DeviceApiData* mpApiData;
         RenderContext::SharedPtr mpRenderContext;
         size_t mFrameID = 0;
@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "GpuTimestampPool.h"
+#include "Device.h"
+#include "RenderContext.h"
+
+namespace Falcor
+{
+    GpuTimestampPool::SharedPtr GpuTimestampPool::create(uint32_t maxTimestampsPerFrame, uint32_t frameCount)
+    {
+        return SharedPtr(new GpuTimestampPool(maxTimestampsPerFrame, frameCount));
+    }
+
+    GpuTimestampPool::GpuTimestampPool(uint32_t maxTimestampsPerFrame, uint32_t frameCount)
+        : mMaxTimestampsPerFrame(maxTimestampsPerFrame)
+        , mFrameCount(frameCount)
+    {
+        assert(gpDevice);
+        if (maxTimestampsPerFrame == 0) throw std::exception("Can't create GPU timestamp pool, the number of timestamps per frame must be non-zero.");
+        if (frameCount < 2) throw std::exception("Can't create GPU timestamp pool, at least two frames in flight are required.");
+
+        // The pool owns the whole heap, which lets each frame use a contiguous range of queries that can be resolved with a single command.
+        const uint32_t queryCount = maxTimestampsPerFrame * frameCount;
+        mpHeap = gpDevice->createQueryHeap(QueryHeap::Type::Timestamp, queryCount);
+        mpReadbackBuffer = Buffer::create(sizeof(uint64_t) * queryCount, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        mpFence = GpuFence::create();
+        mpLowLevelData = gpDevice->getRenderContext()->getLowLevelData();
+        mFrameData.resize(frameCount);
+        mResults.reserve(maxTimestampsPerFrame);
+    }
+
+    GpuTimestampPool::~GpuTimestampPool() = default;
+
+    uint32_t GpuTimestampPool::writeTimestamp()
+    {
+        FrameData& frame = mFrameData[mCurrentFrame];
+        if (frame.timestampCount >= mMaxTimestampsPerFrame)
+        {
+            if (!mOverflowReported)
+            {
+                logWarning("GpuTimestampPool::writeTimestamp() - Out of timestamp queries for the current frame (" + std::to_string(mMaxTimestampsPerFrame) + "). Ignoring further timestamps.");
+                mOverflowReported = true;
+            }
+            return kInvalidIndex;
+        }
+
+        uint32_t index = frame.timestampCount++;
+        apiWriteTimestamp(mCurrentFrame * mMaxTimestampsPerFrame + index);
+        return index;
+    }
+
+    void GpuTimestampPool::endFrame()
+    {
+        FrameData& frame = mFrameData[mCurrentFrame];
+        if (frame.timestampCount > 0)
+        {
+            apiResolve(mCurrentFrame * mMaxTimestampsPerFrame, frame.timestampCount);
+
+            // Submit the resolve so the fence covers it. Waiting on the fence is deferred until the region is reused.
+            gpDevice->getRenderContext()->flush(false);
+            frame.fenceValue = mpFence->gpuSignal(mpLowLevelData->getCommandQueue());
+        }
+
+        mCurrentFrame = (mCurrentFrame + 1) % mFrameCount;
+        readback(mCurrentFrame);
+    }
+
+    void GpuTimestampPool::readback(uint32_t frameIndex)
+    {
+        FrameData& frame = mFrameData[frameIndex];
+        mResults.clear();
+        mResolvedFrame = kInvalidIndex;
+
+        if (frame.timestampCount > 0)
+        {
+            // The resolve was submitted (frameCount - 1) frames ago, so this normally returns immediately.
+            mpFence->syncCpu(frame.fenceValue);
+
+            const uint64_t* pData = reinterpret_cast<const uint64_t*>(mpReadbackBuffer->map(Buffer::MapType::Read));
+            const uint64_t* pFrameData = pData + frameIndex * mMaxTimestampsPerFrame;
+            mResults.assign(pFrameData, pFrameData + frame.timestampCount);
+            mpReadbackBuffer->unmap();
+
+            mResolvedFrame = frameIndex;
+            mCalibration.valid = apiCalibrate(mCalibration.gpuTimestamp, mCalibration.cpuTimeNs);
+        }
+
+        frame.timestampCount = 0;
+        frame.fenceValue = 0;
+    }
+
+    double GpuTimestampPool::getElapsedTime(uint32_t start, uint32_t end) const
+    {
+        if (start >= mResults.size() || end >= mResults.size()) return 0;
+        double range = (double)mResults[end] - (double)mResults[start];
+        return range * gpDevice->getGpuTimestampFrequency();
+    }
+
+    bool GpuTimestampPool::getCpuTime(uint32_t index, int64_t& cpuTimeNs) const
+    {
+        if (index >= mResults.size() || !mCalibration.valid) return false;
+        double deltaMS = ((double)mResults[index] - (double)mCalibration.gpuTimestamp) * gpDevice->getGpuTimestampFrequency();
+        cpuTimeNs = mCalibration.cpuTimeNs + (int64_t)(deltaMS * 1.0e6);
+        return true;
+    }
+}
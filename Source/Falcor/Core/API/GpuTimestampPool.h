@@ -0,0 +1,128 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/LowLevelContextData.h"
+#include "Core/API/QueryHeap.h"
+#include "Core/API/Buffer.h"
+#include "Core/API/GpuFence.h"
+
+namespace Falcor
+{
+    /** Frame-level pool of GPU timestamp queries.
+        The query heap is split into one region per frame in flight. All timestamps written during a frame are resolved
+        with a single command into the matching region of a ring readback buffer when the frame ends.
+        Results are read back when a region is about to be reused, i.e. with a latency of (frameCount - 1) frames, so reading them never stalls the GPU.
+    */
+    class dlldecl GpuTimestampPool
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GpuTimestampPool>;
+
+        static const uint32_t kInvalidIndex = 0xffffffff;
+        static const uint32_t kDefaultMaxTimestampsPerFrame = 8192;
+        static const uint32_t kDefaultFrameCount = 3;
+
+        /** Create a new timestamp pool.
+            \param[in] maxTimestampsPerFrame Maximum number of timestamps that can be written per frame.
+            \param[in] frameCount Number of frames in flight. Must be at least 2.
+            \return New object, or throws an exception if creation failed.
+        */
+        static SharedPtr create(uint32_t maxTimestampsPerFrame = kDefaultMaxTimestampsPerFrame, uint32_t frameCount = kDefaultFrameCount);
+
+        ~GpuTimestampPool();
+
+        /** Write a timestamp into the current frame's region.
+            \return Index of the timestamp within the frame, or kInvalidIndex if the frame's region is full.
+        */
+        uint32_t writeTimestamp();
+
+        /** Resolve all timestamps of the current frame and advance to the next frame.
+            The results of the frame that previously used the next region are read back and become available through getElapsedTime().
+        */
+        void endFrame();
+
+        /** Get the index of the frame region timestamps are currently written to.
+        */
+        uint32_t getCurrentFrameIndex() const { return mCurrentFrame; }
+
+        /** Get the index of the frame region whose results are currently available, or kInvalidIndex if no frame has been resolved yet.
+        */
+        uint32_t getResolvedFrameIndex() const { return mResolvedFrame; }
+
+        /** Get the number of frames in flight.
+        */
+        uint32_t getFrameCount() const { return mFrameCount; }
+
+        /** Get the elapsed time in milliseconds between two timestamps of the resolved frame.
+            \param[in] start Index of the first timestamp, as returned by writeTimestamp().
+            \param[in] end Index of the second timestamp, as returned by writeTimestamp().
+            \return Elapsed time in ms, or zero if the timestamps are not available.
+        */
+        double getElapsedTime(uint32_t start, uint32_t end) const;
+
+        /** Convert a timestamp of the resolved frame to the CPU clock used by CpuTimer.
+            The GPU and CPU clocks are calibrated against each other whenever a frame is read back.
+            \param[in] index Index of the timestamp, as returned by writeTimestamp().
+            \param[out] cpuTimeNs The timestamp in nanoseconds since the CpuTimer::TimePoint epoch.
+            \return True if the timestamp is available and the clocks could be calibrated.
+        */
+        bool getCpuTime(uint32_t index, int64_t& cpuTimeNs) const;
+
+    private:
+        GpuTimestampPool(uint32_t maxTimestampsPerFrame, uint32_t frameCount);
+        void apiWriteTimestamp(uint32_t query);
+        void apiResolve(uint32_t firstQuery, uint32_t count);
+        bool apiCalibrate(uint64_t& gpuTimestamp, int64_t& cpuTimeNs);
+        void readback(uint32_t frame);
+
+        struct FrameData
+        {
+            uint32_t timestampCount = 0;
+            uint64_t fenceValue = 0;
+        };
+
+        std::weak_ptr<QueryHeap> mpHeap;
+        Buffer::SharedPtr mpReadbackBuffer;
+        GpuFence::SharedPtr mpFence;
+        LowLevelContextData::SharedPtr mpLowLevelData;
+
+        uint32_t mMaxTimestampsPerFrame;
+        uint32_t mFrameCount;
+        uint32_t mCurrentFrame = 0;
+        uint32_t mResolvedFrame = kInvalidIndex;
+        std::vector<FrameData> mFrameData;
+        std::vector<uint64_t> mResults;     ///< Timestamps of the resolved frame.
+        struct
+        {
+            bool valid = false;
+            uint64_t gpuTimestamp = 0;
+            int64_t cpuTimeNs = 0;
+        } mCalibration;
+        bool mOverflowReported = false;
+    };
+}
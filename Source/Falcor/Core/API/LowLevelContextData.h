@@ -57,6 +57,11 @@ namespace Falcor
 
         void flush();
 
+        /** Count a draw, dispatch or ray dispatch recorded into the current command list.
+            The count is only used for the submission stats of devices that discard GPU work (see Device::Desc::discardGpuWork).
+        */
+        void addRecordedCommand() { mRecordedCommandCount++; }
+
         const CommandListHandle& getCommandList() const { return mpList; }
         const CommandQueueHandle& getCommandQueue() const { return mpQueue; }
         const CommandAllocatorHandle& getCommandAllocator() const { return mpAllocator; }
@@ -76,5 +81,6 @@ namespace Falcor
         CommandQueueHandle mpQueue; // Can be nullptr
         CommandAllocatorHandle mpAllocator;
         GpuFence::SharedPtr mpFence;
+        uint32_t mRecordedCommandCount = 0;
     };
 }
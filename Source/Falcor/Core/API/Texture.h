@@ -212,6 +212,7 @@ namespace Falcor
         UnorderedAccessView::SharedPtr getUAV(uint32_t mipLevel, uint32_t firstArraySlice = 0, uint32_t arraySize = kMaxPossible);
 
         /** Capture the texture to an image file.
+            This waits for the GPU to finish the copy. Use AsyncTextureCapture to capture without stalling the renderer.
             \param[in] mipLevel Requested mip-level
             \param[in] arraySlice Requested array-slice
             \param[in] filename Name of the file to save.
@@ -33,6 +33,7 @@ namespace Falcor
 {
     class Clock;
     class FrameRate;
+    class AsyncTextureCapture;
 
     /** Sample configuration
     */
@@ -45,6 +46,7 @@ namespace Falcor
         float timeScale = 1.0f;                  ///< A scaling factor for the time elapsed between frames
         bool pauseTime = false;                  ///< Control whether or not to start the clock when the sample start running
         bool showUI = true;                      ///< Show the UI
+        bool headless = false;                   ///< Run without a window or swap-chain. Frames render offscreen until exit() is called. The window size sets the back-buffer size.
     };
 
     class IFramework
@@ -56,7 +58,7 @@ namespace Falcor
         /** Get the current FBO*/
         virtual std::shared_ptr<Fbo> getTargetFbo() = 0;
 
-        /** Get the window*/
+        /** Get the window. Returns nullptr when running headless*/
         virtual Window* getWindow() = 0;
 
         /** Get the global Clock object
@@ -86,6 +88,10 @@ namespace Falcor
         */
         virtual std::string captureScreen(const std::string explicitFilename = "", const std::string explicitOutputDirectory = "") = 0;
 
+        /** Get the service used to write textures to image files without stalling the renderer.
+        */
+        virtual AsyncTextureCapture* getTextureCapture() = 0;
+
         /* Shutdown the app
         */
         virtual void shutdown() = 0;
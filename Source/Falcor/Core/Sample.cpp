@@ -33,6 +33,7 @@
 #include <sstream>
 #include <fstream>
 #include "Utils/Threading.h"
+#include "Utils/Timing/CpuStallMonitor.h"
 #include "dear_imgui/imgui.h"
 
 namespace Falcor
@@ -46,9 +47,18 @@ namespace Falcor
     void Sample::handleWindowSizeChange()
     {
         if (!gpDevice) return;
-        // Tell the device to resize the swap chain
-        auto winSize = mpWindow->getClientAreaSize();
-        auto pBackBufferFBO = gpDevice->resizeSwapChain(winSize.x, winSize.y);
+        Fbo::SharedPtr pBackBufferFBO;
+        if (mpWindow)
+        {
+            // Tell the device to resize the swap chain
+            auto winSize = mpWindow->getClientAreaSize();
+            pBackBufferFBO = gpDevice->resizeSwapChain(winSize.x, winSize.y);
+        }
+        else
+        {
+            // Headless. The offscreen back-buffers were already resized by resizeSwapChain().
+            pBackBufferFBO = gpDevice->getSwapChainFbo();
+        }
         auto width = pBackBufferFBO->getWidth();
         auto height = pBackBufferFBO->getHeight();
 
@@ -166,12 +176,14 @@ namespace Falcor
     {
         mpRenderer.reset();
         if (mVideoCapture.pVideoCapture) endVideoCapture();
+        mpTextureCapture.reset(); // Waits for the pending captures to be written
 
         Clock::shutdown();
         Threading::shutdown();
         Scripting::shutdown();
         RenderPassLibrary::instance().shutdown();
         TextRenderer::shutdown();
+        Profiler::shutdown();
         mpGui.reset();
         mpTargetFBO.reset();
         mpPixelZoom.reset();
@@ -248,19 +260,22 @@ namespace Falcor
         mVsyncOn = config.deviceDesc.enableVsync;
 
         // Create the window
-        mpWindow = Window::create(config.windowDesc, this);
-        if (mpWindow == nullptr)
+        if (!config.headless)
         {
-            logError("Failed to create device and window");
-            return;
+            mpWindow = Window::create(config.windowDesc, this);
+            if (mpWindow == nullptr)
+            {
+                logError("Failed to create device and window");
+                return;
+            }
         }
 
-        // Show the progress bar (unless window is minimized)
+        // Show the progress bar (unless window is minimized or we're headless)
         ProgressBar::SharedPtr pBar;
-        if (config.windowDesc.mode != Window::WindowMode::Minimized) pBar = ProgressBar::show("Initializing Falcor");
+        if (mpWindow && config.windowDesc.mode != Window::WindowMode::Minimized) pBar = ProgressBar::show("Initializing Falcor");
 
-        Device::Desc d = config.deviceDesc;
-        gpDevice = Device::create(mpWindow, config.deviceDesc);
+        if (config.headless) gpDevice = Device::createHeadless(config.windowDesc.width, config.windowDesc.height, config.deviceDesc);
+        else gpDevice = Device::create(mpWindow, config.deviceDesc);
         if (gpDevice == nullptr)
         {
             logError("Failed to create device");
@@ -276,10 +291,11 @@ namespace Falcor
         // Init the UI
         initUI();
         mpPixelZoom = PixelZoom::create(mpTargetFBO.get());
+        mpTextureCapture = AsyncTextureCapture::create();
 
 #ifdef _WIN32
         // Set the icon
-        setWindowIcon("Framework\\Nvidia.ico", mpWindow->getApiHandle());
+        if (mpWindow) setWindowIcon("Framework\\Nvidia.ico", mpWindow->getApiHandle());
 
         if (argc == 0 || argv == nullptr)
         {
@@ -296,13 +312,26 @@ namespace Falcor
         pBar = nullptr;
 
         mFrameRate.reset();
-        mpWindow->msgLoop();
+        if (mpWindow) mpWindow->msgLoop();
+        else
+        {
+            // No window events to pump. Mimic msgLoop() by sending the initial size change, then render until someone asks to exit.
+            handleWindowSizeChange();
+            while (!mExitHeadless) renderFrame();
+        }
 
         mpRenderer->onShutdown();
         if (gpDevice) gpDevice->flushAndSync();
         mpRenderer = nullptr;
     }
 
+    void Sample::requestExit(int32_t exitCode)
+    {
+        // Without a window there's no message loop to receive the quit message
+        if (mpWindow) postQuitMessage(exitCode);
+        else shutdown();
+    }
+
     void screenSizeUI(Gui::Widgets& widget, uint2 screenDims)
     {
         static const uint2 resolutions[] =
@@ -396,7 +425,7 @@ namespace Falcor
             controlsGroup.tooltip("Freeze the renderer and keep displaying the last rendered frame. The renderer will keep accepting mouse/keyboard/GUI messages. Changes in the UI will not be reflected in the displayed image until the renderer is unfrozen");
 
             controlsGroup.separator();
-            screenSizeUI(controlsGroup, mpWindow->getClientAreaSize());
+            if (mpWindow) screenSizeUI(controlsGroup, mpWindow->getClientAreaSize());
             controlsGroup.separator();
 
             mCaptureScreen = controlsGroup.button("Screen Capture");
@@ -435,6 +464,7 @@ namespace Falcor
                 if(gProfileEnabled)
                 {
                     profilerWindow.text(Profiler::getEventsString().c_str());
+                    profilerWindow.text(CpuStallMonitor::getMsg().c_str());
                     Profiler::startEvent("renderUI");
                     profilerWindow.release();
                 }
@@ -450,7 +480,7 @@ namespace Falcor
         if (gpDevice && gpDevice->isWindowOccluded()) return;
 
         // Check clock exit condition
-        if (mClock.shouldExit()) postQuitMessage(0);
+        if (mClock.shouldExit()) requestExit(0);
 
         mClock.tick();
         mFrameRate.newFrame();
@@ -488,6 +518,7 @@ namespace Falcor
             // Capture video frame after UI is rendered
             if (captureVideoUI) captureVideoFrame();
             if (mCaptureScreen) captureScreen();
+            mpTextureCapture->poll();
 
             {
                 PROFILE("present", Profiler::Flags::Internal);
@@ -510,7 +541,7 @@ namespace Falcor
         {
             Texture::SharedPtr pTexture;
             pTexture = gpDevice->getSwapChainFbo()->getColorTexture(0);
-            pTexture->captureToFile(0, 0, pngFile);
+            mpTextureCapture->capture(getRenderContext(), pTexture.get(), 0, 0, pngFile);
         }
         else
         {
@@ -532,7 +563,13 @@ namespace Falcor
 
     void Sample::resizeSwapChain(uint32_t width, uint32_t height)
     {
-        mpWindow->resize(width, height);
+        if (mpWindow) mpWindow->resize(width, height);
+        else if (gpDevice)
+        {
+            // There's no window to send a resize event, so resize the offscreen back-buffers directly
+            gpDevice->resizeSwapChain(width, height);
+            handleWindowSizeChange();
+        }
     }
 
     bool Sample::isKeyPressed(const KeyboardEvent::Key& key)
@@ -568,7 +605,6 @@ namespace Falcor
         if (!mVideoCapture.pVideoCapture) return false;
 
         assert(mVideoCapture.pVideoCapture);
-        mVideoCapture.pFrame.resize(desc.width*desc.height * 4);
         mVideoCapture.fixedTimeDelta = 1 / (double)desc.fps;
 
         if (mVideoCapture.pUI->useTimeRange())
@@ -586,6 +622,10 @@ namespace Falcor
     {
         if (mVideoCapture.pVideoCapture)
         {
+            {
+                CpuStallMonitor::ExpectedScope expectedStall;
+                encodePendingVideoFrames(true);
+            }
             mVideoCapture.pVideoCapture->endCapture();
             mShowUI = true;
         }
@@ -596,7 +636,9 @@ namespace Falcor
     {
         if (mVideoCapture.pVideoCapture)
         {
-            mVideoCapture.pVideoCapture->appendFrame(getRenderContext()->readTextureSubresource(gpDevice->getSwapChainFbo()->getColorTexture(0).get(), 0).data());
+            // Read the frame back asynchronously and encode it once the GPU is done with it, so recording doesn't stall the pipeline
+            mVideoCapture.pendingFrames.push_back(getRenderContext()->asyncReadTextureSubresource(gpDevice->getSwapChainFbo()->getColorTexture(0).get(), 0));
+            encodePendingVideoFrames(false);
 
             if (mVideoCapture.pUI->useTimeRange())
             {
@@ -614,11 +656,27 @@ namespace Falcor
         }
     }
 
+    void Sample::encodePendingVideoFrames(bool flush)
+    {
+        auto& pending = mVideoCapture.pendingFrames;
+        while (pending.size() && (flush || pending.front()->isReady() || pending.size() > Device::kMaxFramesInFlight))
+        {
+            mVideoCapture.pVideoCapture->appendFrame(pending.front()->getData().data());
+            pending.pop_front();
+        }
+    }
+
     SampleConfig Sample::getConfig()
     {
         SampleConfig c;
         c.deviceDesc = gpDevice->getDesc();
-        c.windowDesc = mpWindow->getDesc();
+        if (mpWindow) c.windowDesc = mpWindow->getDesc();
+        else
+        {
+            c.windowDesc.width = mpTargetFBO->getWidth();
+            c.windowDesc.height = mpTargetFBO->getHeight();
+        }
+        c.headless = mpWindow == nullptr;
         c.showMessageBoxOnError = Logger::isBoxShownOnError();
         c.timeScale = (float)mClock.getTimeScale();
         c.pauseTime = mClock.isPaused();
@@ -649,15 +707,15 @@ namespace Falcor
         auto sampleDesc = m.regClass(SampleConfig);
 #define field(f_) rwField(#f_, &SampleConfig::f_)
         sampleDesc.field(windowDesc).field(deviceDesc).field(showMessageBoxOnError).field(timeScale);
-        sampleDesc.field(pauseTime).field(showUI);
+        sampleDesc.field(pauseTime).field(showUI).field(headless);
 #undef field
-        auto exit = [](int32_t errorCode) { postQuitMessage(errorCode); };
+        auto exit = [this](int32_t errorCode) { requestExit(errorCode); };
         m.func_("exit", exit, "errorCode"_a = 0);
 
         auto renderFrame = [this]() {ProgressBar::close(); this->renderFrame(); };
         m.func_("renderFrame", renderFrame);
 
-        auto setWindowPos = [this](int32_t x, int32_t y) {getWindow()->setWindowPos(x, y); };
+        auto setWindowPos = [this](int32_t x, int32_t y) { if (mpWindow) mpWindow->setWindowPos(x, y); };
         m.func_("setWindowPos", setWindowPos, "x"_a, "y"_a);
 
         auto resize = [this](uint32_t width, uint32_t height) {resizeSwapChain(width, height); };
@@ -30,12 +30,14 @@
 #include "API/Device.h"
 #include "Renderer.h"
 #include "Utils/ArgList.h"
+#include "Utils/Image/AsyncTextureCapture.h"
 #include "Utils/Timing/FrameRate.h"
 #include "Utils/UI/Gui.h"
 #include "Utils/UI/TextRenderer.h"
 #include "Utils/UI/PixelZoom.h"
 #include "Utils/Video/VideoEncoderUI.h"
 #include <set>
+#include <deque>
 #include <optional>
 
 namespace Falcor
@@ -83,7 +85,8 @@ namespace Falcor
         void pauseRenderer(bool pause) override { mRendererPaused = pause; }
         bool isRendererPaused() override { return mRendererPaused; }
         std::string captureScreen(const std::string explicitFilename = "", const std::string explicitOutputDirectory = "") override;
-        void shutdown() override { if (mpWindow) { mpWindow->shutdown(); } }
+        AsyncTextureCapture* getTextureCapture() override { return mpTextureCapture.get(); }
+        void shutdown() override { if (mpWindow) { mpWindow->shutdown(); } else { mExitHeadless = true; } }
         SampleConfig getConfig() override;
         void renderGlobalUI(Gui* pGui) override;
         std::string getKeyboardShortcutsStr() override;
@@ -113,9 +116,11 @@ namespace Falcor
         bool startVideoCapture();
         void endVideoCapture();
         void captureVideoFrame();
+        void encodePendingVideoFrames(bool flush);
         void renderUI();
 
         void runInternal(const SampleConfig& config, uint32_t argc, char** argv);
+        void requestExit(int32_t exitCode);
 
         void startScripting();
         void registerScriptBindings(ScriptBindings::Module& m);
@@ -124,6 +129,7 @@ namespace Falcor
         bool mVsyncOn = false;
         bool mShowUI = true;
         bool mCaptureScreen = false;
+        bool mExitHeadless = false;
         FrameRate mFrameRate;
         Clock mClock;
 
@@ -133,7 +139,7 @@ namespace Falcor
         {
             VideoEncoderUI::UniquePtr pUI;
             VideoEncoder::UniquePtr pVideoCapture;
-            std::vector<uint8_t> pFrame;
+            std::deque<CopyContext::ReadTextureTask::SharedPtr> pendingFrames;   ///< Frames read back but not yet encoded
             double fixedTimeDelta = 0;
             double currentTime = 0;
             bool displayUI = false;
@@ -141,6 +147,7 @@ namespace Falcor
 
         std::set<KeyboardEvent::Key> mPressedKeys;
         PixelZoom::SharedPtr mpPixelZoom;
+        AsyncTextureCapture::SharedPtr mpTextureCapture;    ///< Writes screenshots and frame captures in the background
 
         Sample(IRenderer::UniquePtr& pRenderer) : mpRenderer(std::move(pRenderer)) {}
         Sample(const Sample&) = delete;
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "LightBVH.h"
+#include <unordered_set>
 
 namespace
 {
@@ -84,6 +85,159 @@ namespace Falcor
         mIsCpuDataValid = false;
     }
 
+    void LightBVH::refitCPU(const std::vector<LightCollection::TriangleRange>& triangleRanges)
+    {
+        PROFILE("LightBVH::refitCPU()");
+
+        assert(mIsValid);
+
+        // Make sure the CPU copy of the nodes is current. This only reads back data if refit() was used since the last build.
+        syncDataToCPU();
+        const auto& triangles = mpLightCollection->getMeshLightTriangles();
+        uint8_t* const pNodes = static_cast<uint8_t*>(mAlignedAllocator.getStartPointer());
+
+        // Collect the nodes on the paths from the root to the leaves holding the changed triangles.
+        std::vector<NodeLocation> dirtyNodes;
+        std::unordered_set<uint32_t> visited;
+        for (const auto& range : triangleRanges)
+        {
+            for (uint32_t triangleIdx = range.offset; triangleIdx < range.offset + range.count; triangleIdx++)
+            {
+                assert(triangleIdx < mTriangleBitmasks.size());
+                const uint64_t bitmask = mTriangleBitmasks[triangleIdx];
+                if (bitmask == std::numeric_limits<uint64_t>::max()) continue; // Triangle was culled from the BVH.
+
+                NodeLocation location;
+                while (true)
+                {
+                    if (visited.insert(location.byteOffset).second) dirtyNodes.push_back(location);
+                    if (*reinterpret_cast<const NodeType*>(pNodes + location.byteOffset) == NodeType::Leaf) break;
+
+                    const InternalNode* pNode = reinterpret_cast<const InternalNode*>(pNodes + location.byteOffset);
+                    const bool right = (bitmask >> location.depth) & 1ull;
+                    location = NodeLocation(right ? pNode->rightNodeOffset : pNode->leftNodeOffset, location.depth + 1);
+                }
+            }
+        }
+        if (dirtyNodes.empty()) return;
+
+        // Helper to fetch the data of a child node, which can be either an internal or a leaf node.
+        struct ChildData
+        {
+            float3 aabbMin;
+            float3 aabbMax;
+            float3 coneDirection;
+            float cosConeAngle;
+        };
+        auto getChildData = [pNodes](uint32_t offset)
+        {
+            if (*reinterpret_cast<const NodeType*>(pNodes + offset) == NodeType::Internal)
+            {
+                const InternalNode* pNode = reinterpret_cast<const InternalNode*>(pNodes + offset);
+                return ChildData{ pNode->aabbMin, pNode->aabbMax, pNode->coneDirection, pNode->cosConeAngle };
+            }
+            const LeafNode* pNode = reinterpret_cast<const LeafNode*>(pNodes + offset);
+            return ChildData{ pNode->aabbMin, pNode->aabbMax, pNode->coneDirection, pNode->cosConeAngle };
+        };
+
+        // Update the nodes bottom-up. Children are always deeper than their parent, so sorting by decreasing depth is sufficient.
+        // This mirrors updateLeafNodes() and updateInternalNodes() in LightBVHRefit.cs.slang.
+        std::sort(dirtyNodes.begin(), dirtyNodes.end(), [](const NodeLocation& a, const NodeLocation& b) { return a.depth > b.depth; });
+        for (const NodeLocation& location : dirtyNodes)
+        {
+            if (*reinterpret_cast<const NodeType*>(pNodes + location.byteOffset) == NodeType::Leaf)
+            {
+                LeafNode* pNode = reinterpret_cast<LeafNode*>(pNodes + location.byteOffset);
+                BBox bounds;
+                float3 normalsSum = float3(0.f);
+                for (uint32_t i = 0; i < pNode->triangleCount; i++)
+                {
+                    const auto& tri = triangles[pNode->triangleIndices[i]];
+                    for (uint32_t j = 0; j < 3; j++) bounds |= tri.vtx[j].pos;
+                    normalsSum += tri.normal;
+                }
+                pNode->aabbMin = bounds.minPoint;
+                pNode->aabbMax = bounds.maxPoint;
+
+                const float coneDirectionLength = glm::length(normalsSum);
+                pNode->coneDirection = coneDirectionLength >= FLT_MIN ? normalsSum / coneDirectionLength : float3(0.f);
+                pNode->cosConeAngle = kInvalidCosConeAngle;
+                if (coneDirectionLength >= FLT_MIN)
+                {
+                    pNode->cosConeAngle = 1.f;
+                    for (uint32_t i = 0; i < pNode->triangleCount; i++)
+                    {
+                        pNode->cosConeAngle = std::min(pNode->cosConeAngle, glm::dot(pNode->coneDirection, triangles[pNode->triangleIndices[i]].normal));
+                    }
+                }
+            }
+            else
+            {
+                InternalNode* pNode = reinterpret_cast<InternalNode*>(pNodes + location.byteOffset);
+                const ChildData left = getChildData(pNode->leftNodeOffset);
+                const ChildData right = getChildData(pNode->rightNodeOffset);
+
+                pNode->aabbMin = glm::min(left.aabbMin, right.aabbMin);
+                pNode->aabbMax = glm::max(left.aabbMax, right.aabbMax);
+
+                const float3 coneDirectionSum = left.coneDirection + right.coneDirection;
+                const float coneDirectionLength = glm::length(coneDirectionSum);
+                pNode->coneDirection = coneDirectionLength >= FLT_MIN ? coneDirectionSum / coneDirectionLength : float3(0.f);
+                pNode->cosConeAngle = kInvalidCosConeAngle;
+
+                if (coneDirectionLength >= FLT_MIN && left.cosConeAngle != kInvalidCosConeAngle && right.cosConeAngle != kInvalidCosConeAngle)
+                {
+                    // Rotate (cosDiffAngle, sinDiffAngle) counterclockwise by each child's cone spread angle.
+                    auto sinFromCos = [](float cosAngle) { return std::sqrt(std::max(0.f, 1.f - cosAngle * cosAngle)); };
+                    const float cosLeftDiffAngle = glm::dot(pNode->coneDirection, left.coneDirection);
+                    const float cosRightDiffAngle = glm::dot(pNode->coneDirection, right.coneDirection);
+                    const float sinLeftDiffAngle = sinFromCos(cosLeftDiffAngle);
+                    const float sinRightDiffAngle = sinFromCos(cosRightDiffAngle);
+                    const float sinLeftConeAngle = sinFromCos(left.cosConeAngle);
+                    const float sinRightConeAngle = sinFromCos(right.cosConeAngle);
+
+                    const float sinLeftTotalAngle = sinLeftConeAngle * cosLeftDiffAngle + sinLeftDiffAngle * left.cosConeAngle;
+                    const float sinRightTotalAngle = sinRightConeAngle * cosRightDiffAngle + sinRightDiffAngle * right.cosConeAngle;
+
+                    // If either sum of angles is greater than pi, the cone would represent the whole sphere and is left invalid.
+                    if (sinLeftTotalAngle > 0.f && sinRightTotalAngle > 0.f)
+                    {
+                        const float cosLeftTotalAngle = left.cosConeAngle * cosLeftDiffAngle - sinLeftConeAngle * sinLeftDiffAngle;
+                        const float cosRightTotalAngle = right.cosConeAngle * cosRightDiffAngle - sinRightConeAngle * sinRightDiffAngle;
+                        pNode->cosConeAngle = std::min(cosLeftTotalAngle, cosRightTotalAngle);
+                    }
+                }
+            }
+        }
+
+        // Upload the updated nodes. Nodes that are close in memory are uploaded together to reduce the number of copies.
+        const uint32_t kMaxUploadGap = 256;
+        std::sort(dirtyNodes.begin(), dirtyNodes.end(), [](const NodeLocation& a, const NodeLocation& b) { return a.byteOffset < b.byteOffset; });
+        auto getNodeEnd = [pNodes](uint32_t offset)
+        {
+            if (*reinterpret_cast<const NodeType*>(pNodes + offset) == NodeType::Internal) return offset + (uint32_t)sizeof(InternalNode);
+            const LeafNode* pNode = reinterpret_cast<const LeafNode*>(pNodes + offset);
+            return offset + (uint32_t)(sizeof(LeafNode) + (pNode->triangleCount - 1) * sizeof(uint32_t));
+        };
+
+        uint32_t uploadBegin = dirtyNodes[0].byteOffset;
+        uint32_t uploadEnd = getNodeEnd(uploadBegin);
+        for (size_t i = 1; i <= dirtyNodes.size(); i++)
+        {
+            if (i < dirtyNodes.size() && dirtyNodes[i].byteOffset <= uploadEnd + kMaxUploadGap)
+            {
+                uploadEnd = std::max(uploadEnd, getNodeEnd(dirtyNodes[i].byteOffset));
+                continue;
+            }
+            mpBVHNodesBuffer->setBlob(pNodes + uploadBegin, uploadBegin, uploadEnd - uploadBegin);
+            if (i < dirtyNodes.size())
+            {
+                uploadBegin = dirtyNodes[i].byteOffset;
+                uploadEnd = getNodeEnd(uploadBegin);
+            }
+        }
+    }
+
     LightBVH::NodeType LightBVH::getNodeType(const uint32_t nodeOffset) const
     {
         assert(isValid());
@@ -175,6 +329,7 @@ namespace Falcor
         // Reset all CPU data.
         mAlignedAllocator.reset();
         mNodeOffsets.clear();
+        mTriangleBitmasks.clear();
         mPerDepthRefitEntryInfo.clear();
         mMaxTriangleCountPerLeaf = 0u;
         mBVHStats = BVHStats();
@@ -345,6 +500,7 @@ namespace Falcor
         mpBVHNodesBuffer->setBlob(mAlignedAllocator.getStartPointer(), 0, bvhByteSize);
         assert(mpTriangleBitmasksBuffer->getSize() >= triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
         mpTriangleBitmasksBuffer->setBlob(triangleBitmasks.data(), 0, triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
+        mTriangleBitmasks = triangleBitmasks;
 
         mIsCpuDataValid = true;
     }
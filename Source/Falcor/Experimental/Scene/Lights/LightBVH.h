@@ -136,6 +136,15 @@ namespace Falcor
         */
         void refit(RenderContext* pRenderContext);
 
+        /** Refit the BVH nodes above the given triangles on the CPU, without changing the hierarchy.
+            Only the leaf nodes holding the triangles and their ancestors are updated. These are found by following
+            the triangle bitmasks from the root. Only the updated nodes are uploaded to the GPU.
+            This is cheaper than refit() when few lights have changed, but it reads back the changed triangles from the light collection,
+            which waits for the GPU unless LightCollection::prepareSyncCPUData() was called well ahead of time.
+            \param[in] triangleRanges Ranges of triangles that have changed, see LightCollection::getUpdatedTriangleRanges().
+        */
+        void refitCPU(const std::vector<LightCollection::TriangleRange>& triangleRanges);
+
         /** Return the type of the specified node.
             \return the type of the specified node.
         */
@@ -151,6 +160,11 @@ namespace Falcor
         */
         const LeafNode* getLeafNode(const uint32_t nodeOffset) const;
 
+        /** Return the per-triangle bitmasks retracing the traversal from the root to the leaf holding each triangle: 0=left child, 1=right child.
+            Triangles that were culled from the BVH have all bits set.
+        */
+        const std::vector<uint64_t>& getTriangleBitmasks() const { return mTriangleBitmasks; }
+
         /** Perform a depth-first traversal of the BVH and run a function on each node.
             \param[in] evalNode Function called on each node; see TraversalEvalFunction for more details.
             \param[in] rootNodeByteOffset The byte offset of the node to start traversing.
@@ -232,6 +246,7 @@ namespace Falcor
         // CPU resources
         mutable AlignedAllocator              mAlignedAllocator;        ///< Utility class for the CPU-side node buffer.
         std::vector<uint32_t>                 mNodeOffsets;
+        std::vector<uint64_t>                 mTriangleBitmasks;        ///< CPU copy of the triangle bitmasks, used for finding the nodes to refit in refitCPU().
         std::vector<RefitEntryInfo>           mPerDepthRefitEntryInfo;  ///< Array containing for each level the number of internal nodes as well as the corresponding offset in mpNodeOffsetsBuffer; the very last entry contains the same data, but for all leaf nodes instead.
         uint32_t                              mMaxTriangleCountPerLeaf = 0u; ///< After the BVH is built, this contains the maximum light count per leaf node.
         BVHStats                              mBVHStats;
@@ -28,6 +28,10 @@
 #include "stdafx.h"
 #include "LightBVHBuilder.h"
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace
 {
@@ -37,6 +41,65 @@ namespace
     // The limitation comes from the need to store the traversal path to each node in a bit mask.
     const uint32_t kMaxBVHDepth = 64;
 
+    // Minimum number of triangles in a node for binning them on multiple threads.
+    const uint32_t kMinParallelBinningCount = 32768;
+
+    // Minimum number of triangles in a node for building its two subtrees on separate threads.
+    const uint32_t kMinParallelSubtreeCount = 2048;
+
+    /** Fills bins with the triangles in the range [begin,end).
+        Large ranges are binned in parallel. First the bin ID of each triangle is computed in parallel,
+        then each thread accumulates the triangles of the bins it owns in triangle order. Every bin thus sees
+        the same sequence of operations as in the serial loop and the result is bitwise identical.
+        \param[in] getBinId Function returning the bin ID for a triangle index.
+        \param[in] accumulate Function adding a triangle index to a bin, called as accumulate(binId, triangleIndex).
+    */
+    template<typename ThreadPool, typename GetBinId, typename Accumulate>
+    void fillBins(uint32_t begin, uint32_t end, uint32_t binCount, ThreadPool* pThreadPool, uint32_t threadCount, const GetBinId& getBinId, const Accumulate& accumulate)
+    {
+        const uint32_t count = end - begin;
+        if (!pThreadPool || threadCount <= 1 || count < kMinParallelBinningCount)
+        {
+            for (uint32_t i = begin; i < end; ++i) accumulate(getBinId(i), i);
+            return;
+        }
+
+        std::vector<uint32_t> binIds(count);
+        pThreadPool->parallelFor(threadCount, [&](uint32_t threadIndex, uint32_t threadCount)
+        {
+            const uint32_t chunkBegin = (uint32_t)((uint64_t)count * threadIndex / threadCount);
+            const uint32_t chunkEnd = (uint32_t)((uint64_t)count * (threadIndex + 1) / threadCount);
+            for (uint32_t i = chunkBegin; i < chunkEnd; ++i) binIds[i] = getBinId(begin + i);
+        });
+
+        pThreadPool->parallelFor(std::min(threadCount, binCount), [&](uint32_t threadIndex, uint32_t threadCount)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t binId = binIds[i];
+                if (binId % threadCount == threadIndex) accumulate(binId, begin + i);
+            }
+        });
+    }
+
+    /** Returns the byte offset of a node, checking that it fits in the 32-bit offsets stored in the nodes.
+    */
+    uint32_t getNodeOffset(const AlignedAllocator& allocator, void* pNode)
+    {
+        const size_t offset = allocator.offsetOf(pNode);
+        if (offset > std::numeric_limits<uint32_t>::max())
+        {
+            logFatal("Our node offset is going to overflow!");
+        }
+        return static_cast<uint32_t>(offset);
+    }
+
+    template<typename T>
+    T* getNode(AlignedAllocator& allocator, uint32_t offset)
+    {
+        return reinterpret_cast<T*>(static_cast<uint8_t*>(allocator.getStartPointer()) + offset);
+    }
+
     inline float safeACos(float v)
     {
         return std::acos(glm::clamp(v, -1.0f, 1.0f));
@@ -207,6 +270,109 @@ namespace
 
 namespace Falcor
 {
+    /** Fixed set of worker threads used for the parallel build.
+        The threads are created once per build, so parallel tasks only pay for queueing rather than thread creation.
+        A thread waiting in parallelFor() runs queued tasks itself, which lets tasks nest without deadlocking.
+    */
+    class LightBVHBuilder::ThreadPool
+    {
+    public:
+        ThreadPool(uint32_t workerCount)
+        {
+            mWorkers.reserve(workerCount);
+            for (uint32_t i = 0; i < workerCount; i++) mWorkers.emplace_back([this]() { workerLoop(); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStop = true;
+            }
+            mCondition.notify_all();
+            for (auto& t : mWorkers) t.join();
+        }
+
+        /** Runs func(taskIndex, taskCount) for all task indices and waits for all to finish.
+            Task 0 runs on the calling thread, the others are queued for the workers. Profiler zones in the tasks are nested under the caller's current event.
+        */
+        template<typename Func>
+        void parallelFor(uint32_t taskCount, const Func& func)
+        {
+            std::atomic<uint32_t> pendingCount = taskCount - 1;
+            const Profiler::EventData* pParentEvent = Profiler::getCurrentEvent();
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (uint32_t i = 1; i < taskCount; i++)
+                {
+                    mTasks.push_back({ [&func, i, taskCount, pParentEvent]()
+                    {
+                        Profiler::setThreadParent(pParentEvent);
+                        func(i, taskCount);
+                        Profiler::setThreadParent(nullptr);
+                    }, &pendingCount });
+                }
+            }
+            mCondition.notify_all();
+
+            func(0u, taskCount);
+
+            // Help with the queued tasks until all of ours have finished.
+            while (pendingCount.load(std::memory_order_acquire) != 0)
+            {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mCondition.wait(lock, [&]() { return pendingCount.load(std::memory_order_acquire) == 0 || !mTasks.empty(); });
+                    if (mTasks.empty()) break;
+                    task = std::move(mTasks.front());
+                    mTasks.pop_front();
+                }
+                runTask(task);
+            }
+        }
+
+    private:
+        struct Task
+        {
+            std::function<void()> func;
+            std::atomic<uint32_t>* pPendingCount = nullptr;
+        };
+
+        void workerLoop()
+        {
+            while (true)
+            {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mCondition.wait(lock, [this]() { return mStop || !mTasks.empty(); });
+                    if (mTasks.empty()) return;
+                    task = std::move(mTasks.front());
+                    mTasks.pop_front();
+                }
+                runTask(task);
+            }
+        }
+
+        void runTask(Task& task)
+        {
+            task.func();
+            if (task.pPendingCount->fetch_sub(1, std::memory_order_release) == 1)
+            {
+                // Notify under the lock so that a thread that has just checked the count in parallelFor() cannot miss the wake-up.
+                std::lock_guard<std::mutex> lock(mMutex);
+                mCondition.notify_all();
+            }
+        }
+
+        std::vector<std::thread> mWorkers;
+        std::deque<Task> mTasks;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mStop = false;
+    };
+
     LightBVHBuilder::SharedPtr LightBVHBuilder::create(const Options& options)
     {
         return SharedPtr(new LightBVHBuilder(options));
@@ -226,7 +392,9 @@ namespace Falcor
 
         // Compute list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mAlignedAllocator);
+        std::vector<TriangleSortData> trianglesData;
+        std::vector<uint64_t> triangleBitmasks;
+        BuildingData data(bvh.mAlignedAllocator, trianglesData, triangleBitmasks);
         data.trianglesData.reserve(triangles.size());
 
         for (size_t i = 0; i < triangles.size(); i++)
@@ -256,7 +424,14 @@ namespace Falcor
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
         data.triangleBitmasks.resize(triangles.size(), invalidBitmask);
 
-        // Build the tree.
+        // Build the tree. The worker threads are created once per build and shared by all parallel tasks.
+        data.threadCount = mOptions.useParallelBuild ? std::max(1u, Threading::getLogicalThreadCount()) : 1u;
+        std::unique_ptr<ThreadPool> pThreadPool;
+        if (data.threadCount > 1 && data.trianglesData.size() >= kMinParallelSubtreeCount)
+        {
+            pThreadPool = std::make_unique<ThreadPool>(data.threadCount - 1);
+            data.pThreadPool = pThreadPool.get();
+        }
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
         buildInternal(mOptions, splitFunc, 0ull, 0u, Range(0u, static_cast<uint32_t>(data.trianglesData.size())), data);
 
@@ -293,6 +468,12 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        if (options.allowRefitting)
+        {
+            optionsChanged |= widget.var("Max triangle count for CPU refit", options.maxCPURefitTriangleCount);
+            widget.tooltip("Refit on the CPU if at most this many triangles changed. The CPU refit stalls until the changed triangles are read back from the GPU, so it only pays off when lights rarely move. Set to 0 to always refit on the GPU.", true);
+        }
+        optionsChanged |= widget.checkbox("Parallel build", options.useParallelBuild);
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u);
         optionsChanged |= widget.dropdown("Split heuristic", kSplitHeuristicList, (uint32_t&)options.splitHeuristicSelection);
 
@@ -330,8 +511,9 @@ namespace Falcor
     {
     }
 
-    void* LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
     {
+        PROFILE_ZONE("LightBVHBuilder::buildInternal");
         assert(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
@@ -370,20 +552,50 @@ namespace Falcor
                 logFatal("BVH depth of " + std::to_string(depth + 1u) + " reached; maximum of " + std::to_string(kMaxBVHDepth) + " allowed.");
             }
 
-            uint32_t currentByteOffset = static_cast<uint32_t>(data.alignedAllocator.offsetOf(pNode));
-            void* pLeft = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1u, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            void* pRight = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1u, Range(splitResult.triangleIndex, triangleRange.end), data);
+            // The allocator may grow while building the subtrees, so refer to the node by offset from here on.
+            const uint32_t currentByteOffset = getNodeOffset(data.alignedAllocator, pNode);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            uint32_t leftOffset, rightOffset;
+
+            if (data.pThreadPool && data.threadCount > 1 && triangleRange.length() >= kMinParallelSubtreeCount)
+            {
+                // Build the two subtrees concurrently on the thread pool, each into its own allocator.
+                // The subtrees operate on disjoint ranges of trianglesData and disjoint sets of triangles in triangleBitmasks.
+                AlignedAllocator leftAllocator, rightAllocator;
+                for (AlignedAllocator* pAllocator : { &leftAllocator, &rightAllocator })
+                {
+                    pAllocator->setMinimumAlignment(data.alignedAllocator.getMinimumAlignment());
+                    pAllocator->setCacheLineSize(data.alignedAllocator.getCacheLineSize());
+                }
+
+                BuildingData leftData(leftAllocator, data.trianglesData, data.triangleBitmasks);
+                BuildingData rightData(rightAllocator, data.trianglesData, data.triangleBitmasks);
+                leftData.threadCount = data.threadCount / 2;
+                rightData.threadCount = data.threadCount - leftData.threadCount;
+                leftData.pThreadPool = rightData.pThreadPool = data.pThreadPool;
+
+                data.pThreadPool->parallelFor(2u, [&](uint32_t taskIndex, uint32_t)
+                {
+                    if (taskIndex == 0) buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1u, leftRange, leftData);
+                    else buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1u, rightRange, rightData);
+                });
 
-            if (data.alignedAllocator.offsetOf(pLeft) > std::numeric_limits<uint32_t>::max() ||
-                data.alignedAllocator.offsetOf(pRight) > std::numeric_limits<uint32_t>::max())
+                // Append the subtrees in the same order as the serial build allocates them, which reproduces its memory layout exactly.
+                leftOffset = copySubtree(leftAllocator, 0u, data.alignedAllocator);
+                rightOffset = copySubtree(rightAllocator, 0u, data.alignedAllocator);
+            }
+            else
             {
-                logFatal("Our node offset is going to overflow!");
+                leftOffset = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1u, leftRange, data);
+                rightOffset = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1u, rightRange, data);
             }
 
-            pNode->leftNodeOffset  = static_cast<uint32_t>(data.alignedAllocator.offsetOf(pLeft));
-            pNode->rightNodeOffset = static_cast<uint32_t>(data.alignedAllocator.offsetOf(pRight));
+            pNode = getNode<LightBVH::InternalNode>(data.alignedAllocator, currentByteOffset);
+            pNode->leftNodeOffset  = leftOffset;
+            pNode->rightNodeOffset = rightOffset;
 
-            return pNode;
+            return currentByteOffset;
         }
         else // No split => create leaf node
         {
@@ -411,7 +623,33 @@ namespace Falcor
             pNode->coneDirection = computeLightingCone(triangleRange, data, cosTheta);
             pNode->cosConeAngle = cosTheta;
 
-            return pNode;
+            return getNodeOffset(data.alignedAllocator, pNode);
+        }
+    }
+
+    uint32_t LightBVHBuilder::copySubtree(const AlignedAllocator& src, uint32_t srcOffset, AlignedAllocator& dst)
+    {
+        const uint8_t* pSrc = static_cast<const uint8_t*>(src.getStartPointer()) + srcOffset;
+
+        if (*reinterpret_cast<const LightBVH::NodeType*>(pSrc) == LightBVH::NodeType::Internal)
+        {
+            const LightBVH::InternalNode* pSrcNode = reinterpret_cast<const LightBVH::InternalNode*>(pSrc);
+            const uint32_t dstOffset = getNodeOffset(dst, dst.allocate<LightBVH::InternalNode>(*pSrcNode));
+            const uint32_t leftOffset = copySubtree(src, pSrcNode->leftNodeOffset, dst);
+            const uint32_t rightOffset = copySubtree(src, pSrcNode->rightNodeOffset, dst);
+
+            LightBVH::InternalNode* pDstNode = getNode<LightBVH::InternalNode>(dst, dstOffset);
+            pDstNode->leftNodeOffset = leftOffset;
+            pDstNode->rightNodeOffset = rightOffset;
+            return dstOffset;
+        }
+        else
+        {
+            const LightBVH::LeafNode* pSrcNode = reinterpret_cast<const LightBVH::LeafNode*>(pSrc);
+            const size_t allocSize = sizeof(LightBVH::LeafNode) + (pSrcNode->triangleCount - 1) * sizeof(uint32_t);
+            LightBVH::LeafNode* pDstNode = dst.allocateSized<LightBVH::LeafNode>(allocSize);
+            std::memcpy(pDstNode, pSrcNode, allocSize);
+            return getNodeOffset(dst, pDstNode);
         }
     }
 
@@ -501,6 +739,7 @@ namespace Falcor
 
     LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const BBox& nodeBounds, const Options& parameters)
     {
+        PROFILE_ZONE("LightBVHBuilder::computeSplitWithBinnedSAH");
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         assert(!overallBestSplit.second.isValid());
 
@@ -544,11 +783,9 @@ namespace Falcor
             for (Bin& bin : bins) bin = Bin();
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            fillBins(triangleRange.begin, triangleRange.end, parameters.binCount, data.pThreadPool, data.threadCount,
+                [&](uint32_t i) { return getBinId(data.trianglesData[i]); },
+                [&](uint32_t binId, uint32_t i) { bins[binId] |= data.trianglesData[i]; });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -656,6 +893,7 @@ namespace Falcor
 
     LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const BBox& nodeBounds, const Options& parameters)
     {
+        PROFILE_ZONE("LightBVHBuilder::computeSplitWithBinnedSAOH");
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         assert(!overallBestSplit.second.isValid());
 
@@ -714,11 +952,9 @@ namespace Falcor
             for (Bin& bin : bins) bin = Bin();
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            fillBins(triangleRange.begin, triangleRange.end, parameters.binCount, data.pThreadPool, data.threadCount,
+                [&](uint32_t i) { return getBinId(data.trianglesData[i]); },
+                [&](uint32_t binId, uint32_t i) { bins[binId] |= data.trianglesData[i]; });
 
             // Compute the lighting cones for each bin.
             // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
@@ -729,12 +965,14 @@ namespace Falcor
                 bin.cosConeAngle = glm::length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
                 bin.coneDirection = glm::normalize(bin.coneDirection);
             }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
-            }
+            fillBins(triangleRange.begin, triangleRange.end, parameters.binCount, data.pThreadPool, data.threadCount,
+                [&](uint32_t i) { return getBinId(data.trianglesData[i]); },
+                [&](uint32_t binId, uint32_t i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    Bin& bin = bins[binId];
+                    bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
+                });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -875,8 +1113,10 @@ namespace Falcor
         options.field(useLeafCreationCost);
         options.field(createLeavesASAP);
         options.field(allowRefitting);
+        options.field(maxCPURefitTriangleCount);
         options.field(usePreintegration);
         options.field(useLightingCones);
+        options.field(useParallelBuild);
 #undef field
     }
 }
@@ -72,8 +72,10 @@ namespace Falcor
             bool           useLeafCreationCost = true;                           ///< Set to true to avoid splitting when the cost is higher than the cost of creating a leaf node. Only used when 'createLeavesASAP' is disabled.
             bool           createLeavesASAP = true;                              ///< Rather than creating a leaf only once splitting stops, create it as soon as we can.
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
+            uint32_t       maxCPURefitTriangleCount = 0u;                        ///< When refitting, update only the nodes above the changed triangles on the CPU if at most this many triangles changed. Otherwise all nodes are refit on the GPU. The CPU refit waits for the changed triangles to be read back, so only enable it for scenes where lights rarely move. Set to 0 to always refit on the GPU.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           useParallelBuild = true;                              ///< Build the BVH using multiple threads. The result is identical to the single-threaded build.
         };
 
         /** Creates a new object.
@@ -123,14 +125,21 @@ namespace Falcor
             uint32_t triangleIndex = kInvalidIndex;     ///< Index into global triangle list.
         };
 
+        /** Pool of worker threads used by the parallel build. Defined in LightBVHBuilder.cpp.
+        */
+        class ThreadPool;
+
         struct BuildingData
         {
             AlignedAllocator& alignedAllocator;                                 ///< Allocator used for allocating the BVH nodes.
-            std::vector<TriangleSortData> trianglesData;                        ///< Compact list of triangles to include in build.
-            std::vector<uint64_t> triangleBitmasks;                             ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
+            std::vector<TriangleSortData>& trianglesData;                       ///< Compact list of triangles to include in build.
+            std::vector<uint64_t>& triangleBitmasks;                            ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
             float currentNodeFlux = 0.f;                                        ///< Used by computeSAOHSplit() as the leaf creation cost.
+            uint32_t threadCount = 1;                                           ///< Number of threads available for building the current subtree.
+            ThreadPool* pThreadPool = nullptr;                                  ///< Worker threads shared by the whole build, or nullptr for a single-threaded build.
 
-            BuildingData(AlignedAllocator& _allocator) : alignedAllocator(_allocator) {}
+            BuildingData(AlignedAllocator& _allocator, std::vector<TriangleSortData>& _trianglesData, std::vector<uint64_t>& _triangleBitmasks)
+                : alignedAllocator(_allocator), trianglesData(_trianglesData), triangleBitmasks(_triangleBitmasks) {}
         };
 
         /** Compute the split according to a specified heuristic.
@@ -148,14 +157,24 @@ namespace Falcor
         bool renderOptions(Gui::Widgets& widget, Options& options) const;
 
         /** Recursive BVH build.
+            If data.threadCount > 1, large subtrees are built concurrently into separate allocators and then copied back in depth-first order.
             \param[in] splitHeuristic The splitting heuristic to be used.
             \param[in] bitmask Bit pattern retracing the tree traversal to reach the node to be built: 0=left child, 1=right child.
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
-            \return pointer to the allocated node.
+            \return Byte offset of the allocated node.
+        */
+        static uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+
+        /** Recursively copy a subtree from one allocator to another.
+            The nodes are allocated in the same depth-first order as in buildInternal(), so the memory layout is the same as if the subtree had been built directly into the destination.
+            \param[in] src Allocator holding the subtree.
+            \param[in] srcOffset Byte offset of the subtree root in src.
+            \param[in,out] dst Allocator to append the subtree to.
+            \return Byte offset of the subtree root in dst.
         */
-        static void* buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        static uint32_t copySubtree(const AlignedAllocator& src, uint32_t srcOffset, AlignedAllocator& dst);
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodesCurrentByteOffset Current offset to the start of the next free node (= size of current node data).
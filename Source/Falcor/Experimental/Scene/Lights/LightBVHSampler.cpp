@@ -72,7 +72,13 @@ namespace Falcor
         }
         else if (needsRefit)
         {
-            mpBVH->refit(pRenderContext);
+            // Refit only the nodes above the changed triangles on the CPU if few lights changed, otherwise refit all nodes on the GPU.
+            const auto& updatedRanges = mpScene->getLightCollection(pRenderContext)->getUpdatedTriangleRanges();
+            uint64_t updatedTriangleCount = 0;
+            for (const auto& range : updatedRanges) updatedTriangleCount += range.count;
+
+            if (updatedTriangleCount > mOptions.buildOptions.maxCPURefitTriangleCount) mpBVH->refit(pRenderContext);
+            else if (updatedTriangleCount > 0) mpBVH->refitCPU(updatedRanges);
             samplerChanged = true;
         }
 
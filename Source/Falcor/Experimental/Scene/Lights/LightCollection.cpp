@@ -42,6 +42,29 @@ namespace Falcor
         const char kBuildTriangleListFile[] = "Experimental/Scene/Lights/BuildTriangleList.cs.slang";
         const char kUpdateTriangleVerticesFile[] = "Experimental/Scene/Lights/UpdateTriangleVertices.cs.slang";
         const char kFinalizeIntegrationFile[] = "Experimental/Scene/Lights/FinalizeIntegration.cs.slang";
+
+        /** Sorts a list of triangle ranges and merges overlapping and adjacent ranges.
+        */
+        void mergeTriangleRanges(std::vector<LightCollection::TriangleRange>& ranges)
+        {
+            if (ranges.empty()) return;
+            std::sort(ranges.begin(), ranges.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+
+            size_t last = 0;
+            for (size_t i = 1; i < ranges.size(); i++)
+            {
+                if (ranges[i].offset <= ranges[last].offset + ranges[last].count)
+                {
+                    const uint32_t end = std::max(ranges[last].offset + ranges[last].count, ranges[i].offset + ranges[i].count);
+                    ranges[last].count = end - ranges[last].offset;
+                }
+                else
+                {
+                    ranges[++last] = ranges[i];
+                }
+            }
+            ranges.resize(last + 1);
+        }
     }
 
     LightCollection::SharedPtr LightCollection::create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene)
@@ -59,6 +82,7 @@ namespace Falcor
             pUpdateStatus->lightsUpdateInfo.clear();
             pUpdateStatus->lightsUpdateInfo.reserve(mMeshLights.size());
         }
+        mUpdatedTriangleRanges.clear();
 
         // Update transform matrices and check for updates.
         // TODO: Move per-mesh instance update flags into Scene. Return just a list of mesh lights that have changed.
@@ -250,6 +274,7 @@ namespace Falcor
             mMeshLightStats = MeshLightStats();
 
             mCPUInvalidData = CPUOutOfDateFlags::None;
+            mCPUInvalidTriangleRanges.clear();
             mStagingBufferValid = true;
             mStatsValid = true;
         }
@@ -264,6 +289,7 @@ namespace Falcor
             integrateEmissive(pRenderContext);
 
             mCPUInvalidData = CPUOutOfDateFlags::All;
+            mCPUInvalidTriangleRanges.assign(1, { 0, mTriangleCount });
             mStagingBufferValid = false;
             mStatsValid = false;
 
@@ -482,6 +508,15 @@ namespace Falcor
         // Run compute pass to update all triangles.
         mpTrianglePositionUpdater->execute(pRenderContext, mTriangleCount, 1u, 1u);
 
+        // Only the triangles of the updated lights have changed, so only those need to be read back.
+        for (uint32_t lightIdx : updatedLights)
+        {
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            if (meshLight.triangleCount > 0) mUpdatedTriangleRanges.push_back({ meshLight.triangleOffset, meshLight.triangleCount });
+        }
+        mergeTriangleRanges(mUpdatedTriangleRanges);
+
+        mCPUInvalidTriangleRanges.insert(mCPUInvalidTriangleRanges.end(), mUpdatedTriangleRanges.begin(), mUpdatedTriangleRanges.end());
         mCPUInvalidData |= (CPUOutOfDateFlags::Positions | CPUOutOfDateFlags::TriangleData);
         mStagingBufferValid = false;
     }
@@ -532,6 +567,7 @@ namespace Falcor
             mpStagingBuffer = Buffer::create(stagingSize, Resource::BindFlags::None, Buffer::CpuAccess::Read);
             mpStagingBuffer->setName("LightCollection_StagingBuffer");
             mCPUInvalidData = CPUOutOfDateFlags::All;
+            mCPUInvalidTriangleRanges.assign(1, { 0, mTriangleCount });
         }
 
         // Schedule the copy operations for data that is invalid.
@@ -543,9 +579,22 @@ namespace Falcor
         bool copyTexCoords = (mCPUInvalidData & CPUOutOfDateFlags::TexCoords) == CPUOutOfDateFlags::TexCoords;
         bool copyTriangleData = (mCPUInvalidData & CPUOutOfDateFlags::TriangleData) == CPUOutOfDateFlags::TriangleData;
 
-        if (copyPositions) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), 0, mpMeshLightsVertexPos.get(), 0, mpMeshLightsVertexPos->getSize());
-        if (copyTexCoords) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), mpMeshLightsVertexPos->getSize(), mpMeshLightsTexCoords.get(), 0, mpMeshLightsTexCoords->getSize());
-        if (copyTriangleData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), mpMeshLightsVertexPos->getSize() + mpMeshLightsTexCoords->getSize(), mpTriangleData.get(), 0, mpTriangleData->getSize());
+        // Only the out-of-date triangle ranges are copied. The staging buffer has the same layout as the source buffers, so untouched ranges keep their previous contents.
+        mergeTriangleRanges(mCPUInvalidTriangleRanges);
+        const uint64_t texCoordsOffset = mpMeshLightsVertexPos->getSize();
+        const uint64_t triangleDataOffset = texCoordsOffset + mpMeshLightsTexCoords->getSize();
+
+        for (const auto& range : mCPUInvalidTriangleRanges)
+        {
+            assert(range.offset + range.count <= mTriangleCount);
+            const uint64_t posOffset = range.offset * 3ull * sizeof(float3), posSize = range.count * 3ull * sizeof(float3);
+            const uint64_t texCrdOffset = range.offset * 3ull * sizeof(float2), texCrdSize = range.count * 3ull * sizeof(float2);
+            const uint64_t triOffset = range.offset * (uint64_t)sizeof(EmissiveTriangle), triSize = range.count * (uint64_t)sizeof(EmissiveTriangle);
+
+            if (copyPositions) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), posOffset, mpMeshLightsVertexPos.get(), posOffset, posSize);
+            if (copyTexCoords) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), texCoordsOffset + texCrdOffset, mpMeshLightsTexCoords.get(), texCrdOffset, texCrdSize);
+            if (copyTriangleData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), triangleDataOffset + triOffset, mpTriangleData.get(), triOffset, triSize);
+        }
 
         // Submit command list and insert signal.
         pRenderContext->flush(false);
@@ -586,35 +635,39 @@ namespace Falcor
         const bool updateTriangleData = (mCPUInvalidData & CPUOutOfDateFlags::TriangleData) == CPUOutOfDateFlags::TriangleData;
 
         assert(mMeshLightTriangles.size() == (size_t)mTriangleCount);
-        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
+        for (const auto& range : mCPUInvalidTriangleRanges)
         {
-            auto& tri = mMeshLightTriangles[triIdx];
-
-            // Store triangle data.
-            if (updateTriangleData)
+            for (uint32_t triIdx = range.offset; triIdx < range.offset + range.count; triIdx++)
             {
-                tri.lightIdx = triangleData[triIdx].lightIdx;
-                tri.normal = triangleData[triIdx].normal;
-                tri.area = triangleData[triIdx].area;
-                tri.averageRadiance = triangleData[triIdx].averageRadiance;
-                tri.luminousFlux = triangleData[triIdx].flux;
-            }
+                auto& tri = mMeshLightTriangles[triIdx];
 
-            // Store texcoords.
-            if (updateTexCoords)
-            {
-                for (uint32_t j = 0; j < 3; j++) tri.vtx[j].uv = vertexTexCrd[triIdx * 3 + j];
-            }
+                // Store triangle data.
+                if (updateTriangleData)
+                {
+                    tri.lightIdx = triangleData[triIdx].lightIdx;
+                    tri.normal = triangleData[triIdx].normal;
+                    tri.area = triangleData[triIdx].area;
+                    tri.averageRadiance = triangleData[triIdx].averageRadiance;
+                    tri.luminousFlux = triangleData[triIdx].flux;
+                }
 
-            // Store positions.
-            if (updatePositions)
-            {
-                for (uint32_t j = 0; j < 3; j++) tri.vtx[j].pos = vertexPos[triIdx * 3 + j];
+                // Store texcoords.
+                if (updateTexCoords)
+                {
+                    for (uint32_t j = 0; j < 3; j++) tri.vtx[j].uv = vertexTexCrd[triIdx * 3 + j];
+                }
+
+                // Store positions.
+                if (updatePositions)
+                {
+                    for (uint32_t j = 0; j < 3; j++) tri.vtx[j].pos = vertexPos[triIdx * 3 + j];
+                }
             }
         }
 
         mpStagingBuffer->unmap();
 
         mCPUInvalidData = CPUOutOfDateFlags::None;
+        mCPUInvalidTriangleRanges.clear();
     }
 }
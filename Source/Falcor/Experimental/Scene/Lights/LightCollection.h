@@ -59,6 +59,14 @@ namespace Falcor
             std::vector<UpdateFlags> lightsUpdateInfo;
         };
 
+        /** Range of triangles in the global list of mesh light triangles.
+        */
+        struct TriangleRange
+        {
+            uint32_t offset = 0;    ///< Index of the first triangle.
+            uint32_t count = 0;     ///< Number of triangles.
+        };
+
         struct MeshLightStats
         {
             // Stats before pre-processing (input data).
@@ -163,6 +171,11 @@ namespace Falcor
         */
         void prepareSyncCPUData(RenderContext* pRenderContext) const { copyDataToStagingBuffer(pRenderContext); }
 
+        /** Returns the ranges of triangles that were updated by the last call to update().
+            The ranges are sorted and non-overlapping. The list is empty if nothing changed.
+        */
+        const std::vector<TriangleRange>& getUpdatedTriangleRanges() const { return mUpdatedTriangleRanges; }
+
         // Internal update flags. This only public for enum_class_operators() to work.
         enum class CPUOutOfDateFlags : uint32_t
         {
@@ -228,7 +241,10 @@ namespace Falcor
         ComputePass::SharedPtr                  mpTrianglePositionUpdater;
         ComputePass::SharedPtr                  mpFinalizeIntegration;
 
+        std::vector<TriangleRange>              mUpdatedTriangleRanges; ///< Triangles updated by the last call to update().
+
         mutable CPUOutOfDateFlags               mCPUInvalidData = CPUOutOfDateFlags::None;  ///< Flags indicating which CPU data is valid.
+        mutable std::vector<TriangleRange>      mCPUInvalidTriangleRanges;                  ///< Triangles whose CPU data is out of date. Only these are copied to the staging buffer and read back.
         mutable bool                            mStagingBufferValid = true;                 ///< Flag to indicate if the contents of the staging buffer is up-to-date.
     };
 
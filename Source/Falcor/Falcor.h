@@ -111,13 +111,18 @@
 #include "Scene/Camera/Camera.h"
 #include "Scene/Camera/CameraController.h"
 #include "Scene/Lights/Light.h"
+#include "Scene/Lights/LightClusterBinning.h"
+#include "Scene/Lights/LightClusters.h"
 #include "Scene/Lights/LightProbe.h"
+#include "Scene/Lights/ShadowCasterCache.h"
 #include "Scene/Material/Material.h"
 #include "Scene/Animation/Animation.h"
 #include "Scene/Animation/AnimationController.h"
 #include "Scene/Importers/AssimpImporter.h"
 #include "Scene/Importers/PythonImporter.h"
 #include "Scene/ParticleSystem/ParticleSystem.h"
+#include "Scene/Culling/HoleTiles.h"
+#include "Scene/Culling/OcclusionCulling.h"
 
 // Utils
 #include "Utils/Math/AABB.h"
@@ -130,6 +135,7 @@
 #include "Utils/Algorithm/DirectedGraph.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
 #include "Utils/Algorithm/ParallelReduction.h"
+#include "Utils/Image/AsyncTextureCapture.h"
 #include "Utils/Image/Bitmap.h"
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/FalcorMath.h"
@@ -140,9 +146,12 @@
 #include "Utils/SampleGenerators/HaltonSamplePattern.h"
 #include "Utils/SampleGenerators/StratifiedSamplePattern.h"
 #include "Utils/SampleGenerators/CPUSampleGenerator.h"
+#include "Utils/Color/LuminanceHistogram.h"
+#include "Utils/ShadingRate/ShadingRate.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Scripting/Console.h"
 #include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/CpuStallMonitor.h"
 #include "Utils/Timing/Clock.h"
 #include "Utils/Timing/FrameRate.h"
 #include "Utils/Timing/Profiler.h"
@@ -209,6 +209,15 @@ namespace Falcor
         togglePersistentViewMatrix(true);
     }
 
+    void Camera::setRightEyeMatrices(const glm::mat4& view, const glm::mat4& proj)
+    {
+        mRightEye.viewMat = view;
+        mRightEye.projMat = proj;
+        mRightEye.viewProjMat = proj * view;
+        mRightEye.invViewProj = glm::inverse(mRightEye.viewProjMat);
+        mRightEye.valid = true;
+    }
+
     void Camera::togglePersistentProjectionMatrix(bool persistent)
     {
         mEnablePersistentProjMat = persistent;
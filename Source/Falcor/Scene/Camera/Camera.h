@@ -232,6 +232,26 @@ namespace Falcor
         */
         void setRightEyeMatrices(const glm::mat4& view, const glm::mat4& proj);
 
+        /** Check if right eye matrices were set, i.e. the camera is used for stereo rendering.
+        */
+        bool hasRightEye() const { return mRightEye.valid; }
+
+        /** Get the right eye view matrix.
+        */
+        const glm::mat4& getRightEyeViewMatrix() const { return mRightEye.viewMat; }
+
+        /** Get the right eye projection matrix.
+        */
+        const glm::mat4& getRightEyeProjMatrix() const { return mRightEye.projMat; }
+
+        /** Get the right eye view-projection matrix.
+        */
+        const glm::mat4& getRightEyeViewProjMatrix() const { return mRightEye.viewProjMat; }
+
+        /** Get the inverse of the right eye view-projection matrix.
+        */
+        const glm::mat4& getRightEyeInvViewProjMatrix() const { return mRightEye.invViewProj; }
+
         /** Render the UI
         */
         void renderUI(Gui* pGui, const char* uiGroup = nullptr);
@@ -282,6 +302,15 @@ namespace Falcor
             float3 sign;    ///< Camera frustum plane position
         } mutable mFrustumPlanes[6];
 
+        struct
+        {
+            glm::mat4 viewMat;
+            glm::mat4 projMat;
+            glm::mat4 viewProjMat;
+            glm::mat4 invViewProj;
+            bool valid = false;
+        } mRightEye;
+
         struct
         {
             CPUSampleGenerator::SharedPtr pGenerator;
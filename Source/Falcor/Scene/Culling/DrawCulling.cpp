@@ -0,0 +1,48 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "DrawCulling.h"
+
+namespace Falcor
+{
+    Buffer::SharedPtr createInstanceBoundsBuffer(const Scene* pScene)
+    {
+        assert(pScene);
+        const uint32_t instanceCount = pScene->getMeshInstanceCount();
+        std::vector<float4> bounds(instanceCount * 2);
+        for (uint32_t i = 0; i < instanceCount; i++)
+        {
+            uint32_t meshID = pScene->getMeshInstance(i).meshID;
+            const BoundingBox& bb = pScene->getMeshBounds(meshID);
+            bool alwaysVisible = pScene->hasDynamicData(meshID);
+            bounds[i * 2] = float4(bb.center, alwaysVisible ? 1.f : 0.f);
+            bounds[i * 2 + 1] = float4(bb.extent, 0.f);
+        }
+        return Buffer::createStructured(sizeof(float4), instanceCount * 2, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, bounds.data());
+    }
+}
@@ -0,0 +1,154 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "HiZReference.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        std::array<float4, 8> getClipSpaceCorners(const BoundingBox& box, const glm::mat4& viewProj)
+        {
+            std::array<float4, 8> corners;
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                float3 s((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : -1.f);
+                corners[i] = viewProj * float4(box.center + s * box.extent, 1.f);
+            }
+            return corners;
+        }
+
+        uint32_t ceilLog2(uint32_t n)
+        {
+            uint32_t log = 0;
+            while ((1u << log) < n) log++;
+            return log;
+        }
+    }
+
+    HiZReference::HiZReference(const std::vector<float>& depth, uint32_t width, uint32_t height)
+        : mScreenDim(width, height)
+    {
+        assert(depth.size() == (size_t)width * height);
+
+        // Level 0 is the depth buffer padded to a power-of-two size.
+        Level level0;
+        level0.dim = uint2(1u << ceilLog2(width), 1u << ceilLog2(height));
+        level0.data.resize((size_t)level0.dim.x * level0.dim.y, 0.f);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            std::copy_n(depth.data() + (size_t)y * width, width, level0.data.data() + (size_t)y * level0.dim.x);
+        }
+        mLevels.push_back(std::move(level0));
+
+        while (mLevels.back().dim.x > 1 || mLevels.back().dim.y > 1)
+        {
+            const Level& src = mLevels.back();
+            Level dst;
+            dst.dim = glm::max(src.dim / 2u, uint2(1));
+            dst.data.resize((size_t)dst.dim.x * dst.dim.y);
+            for (uint32_t y = 0; y < dst.dim.y; y++)
+            {
+                for (uint32_t x = 0; x < dst.dim.x; x++)
+                {
+                    uint32_t x0 = std::min(x * 2, src.dim.x - 1), x1 = std::min(x * 2 + 1, src.dim.x - 1);
+                    uint32_t y0 = std::min(y * 2, src.dim.y - 1), y1 = std::min(y * 2 + 1, src.dim.y - 1);
+                    auto load = [&](uint32_t sx, uint32_t sy) { return src.data[(size_t)sy * src.dim.x + sx]; };
+                    dst.data[(size_t)y * dst.dim.x + x] = std::max(std::max(load(x0, y0), load(x1, y0)), std::max(load(x0, y1), load(x1, y1)));
+                }
+            }
+            mLevels.push_back(std::move(dst));
+        }
+    }
+
+    float HiZReference::getTexel(uint32_t level, uint32_t x, uint32_t y) const
+    {
+        const Level& l = mLevels[level];
+        assert(x < l.dim.x && y < l.dim.y);
+        return l.data[(size_t)y * l.dim.x + x];
+    }
+
+    float HiZReference::getMaxInRect(int2 rectMin, int2 rectMax) const
+    {
+        uint2 size = uint2(rectMax - rectMin) + 1u;
+        uint32_t level = std::min(ceilLog2(std::max(size.x, size.y)), getMipCount() - 1);
+
+        uint2 texelMin = uint2(rectMin) >> level;
+        uint2 texelMax = uint2(rectMax) >> level;
+        return std::max(std::max(getTexel(level, texelMin.x, texelMin.y), getTexel(level, texelMax.x, texelMin.y)),
+                        std::max(getTexel(level, texelMin.x, texelMax.y), getTexel(level, texelMax.x, texelMax.y)));
+    }
+
+    bool HiZReference::isOccluded(const BoundingBox& box, const glm::mat4& viewProj) const
+    {
+        int2 pixelMin, pixelMax;
+        float minZ;
+        if (!getScreenRect(box, viewProj, mScreenDim, pixelMin, pixelMax, minZ)) return false;
+
+        return minZ > getMaxInRect(pixelMin, pixelMax);
+    }
+
+    bool HiZReference::isInFrustum(const BoundingBox& box, const glm::mat4& viewProj)
+    {
+        uint32_t outsideAll = 0x3f;
+        for (const float4& c : getClipSpaceCorners(box, viewProj))
+        {
+            uint32_t outside = 0;
+            if (c.x < -c.w) outside |= 0x1;
+            if (c.x > c.w) outside |= 0x2;
+            if (c.y < -c.w) outside |= 0x4;
+            if (c.y > c.w) outside |= 0x8;
+            if (c.z < 0.f) outside |= 0x10;
+            if (c.z > c.w) outside |= 0x20;
+            outsideAll &= outside;
+        }
+        return outsideAll == 0;
+    }
+
+    bool HiZReference::getScreenRect(const BoundingBox& box, const glm::mat4& viewProj, uint2 screenDim, int2& pixelMin, int2& pixelMax, float& minZ)
+    {
+        float2 ndcMin(1.f), ndcMax(-1.f);
+        minZ = 1.f;
+        for (const float4& c : getClipSpaceCorners(box, viewProj))
+        {
+            if (c.w <= 0.f) return false;
+            float3 ndc = float3(c) / c.w;
+            ndcMin = glm::min(ndcMin, float2(ndc));
+            ndcMax = glm::max(ndcMax, float2(ndc));
+            minZ = std::min(minZ, ndc.z);
+        }
+        if (minZ <= 0.f) return false;
+
+        float2 uvMin = float2(ndcMin.x, -ndcMax.y) * 0.5f + 0.5f;
+        float2 uvMax = float2(ndcMax.x, -ndcMin.y) * 0.5f + 0.5f;
+        int2 screenMax = int2(screenDim) - 1;
+        pixelMin = glm::clamp(int2(glm::floor(uvMin * float2(screenDim))), int2(0), screenMax);
+        pixelMax = glm::clamp(int2(glm::floor(uvMax * float2(screenDim))), int2(0), screenMax);
+        return true;
+    }
+}
@@ -0,0 +1,98 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/AABB.h"
+
+namespace Falcor
+{
+    /** CPU implementation of the Hi-Z pyramid and the bounding box tests used for occlusion culling.
+        It mirrors HiZBuild.cs.slang and HiZTest.slang and serves as the reference for unit tests.
+    */
+    class dlldecl HiZReference
+    {
+    public:
+        /** Build the pyramid from a depth buffer.
+            \param[in] depth Depth values in row-major order, with standard depth (0 = near, 1 = far).
+            \param[in] width Width of the depth buffer in pixels.
+            \param[in] height Height of the depth buffer in pixels.
+        */
+        HiZReference(const std::vector<float>& depth, uint32_t width, uint32_t height);
+
+        /** Get the number of levels in the pyramid.
+        */
+        uint32_t getMipCount() const { return (uint32_t)mLevels.size(); }
+
+        /** Get the size of a level in texels.
+        */
+        uint2 getMipDim(uint32_t level) const { return mLevels[level].dim; }
+
+        /** Get the depth stored in a texel. Texels outside the depth buffer hold zero.
+        */
+        float getTexel(uint32_t level, uint32_t x, uint32_t y) const;
+
+        /** Get the maximum value over a texel rectangle of level 0, using the same lookup as loadMaxInRect() in HiZTest.slang.
+            The result can include texels outside the rectangle.
+            \param[in] rectMin Top-left texel of the rectangle.
+            \param[in] rectMax Bottom-right texel of the rectangle.
+        */
+        float getMaxInRect(int2 rectMin, int2 rectMax) const;
+
+        /** Test if a box is hidden behind the depth buffer.
+            \param[in] box Bounding box in world space.
+            \param[in] viewProj View-projection matrix the depth buffer was rendered with.
+            \return True if the box is guaranteed to be occluded. Boxes crossing the near plane are never occluded.
+        */
+        bool isOccluded(const BoundingBox& box, const glm::mat4& viewProj) const;
+
+        /** Test if a box intersects the view frustum.
+            \return False if all corners of the box are outside one of the clip planes.
+        */
+        static bool isInFrustum(const BoundingBox& box, const glm::mat4& viewProj);
+
+        /** Compute the pixel rectangle covered by a box.
+            \param[in] box Bounding box in world space.
+            \param[in] viewProj View-projection matrix.
+            \param[in] screenDim Screen size in pixels.
+            \param[out] pixelMin Top-left pixel of the rectangle, clamped to the screen.
+            \param[out] pixelMax Bottom-right pixel of the rectangle, clamped to the screen.
+            \param[out] minZ Nearest depth of the box.
+            \return False if the box crosses the near plane. The outputs are undefined in that case.
+        */
+        static bool getScreenRect(const BoundingBox& box, const glm::mat4& viewProj, uint2 screenDim, int2& pixelMin, int2& pixelMax, float& minZ);
+
+    private:
+        struct Level
+        {
+            uint2 dim;
+            std::vector<float> data;
+        };
+
+        uint2 mScreenDim;
+        std::vector<Level> mLevels;
+    };
+}
@@ -0,0 +1,216 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "HoleTiles.h"
+#include "DrawCulling.h"
+#include "HoleTilesData.slang"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kClassifyShaderFile[] = "Scene/Culling/HoleTilesClassify.cs.slang";
+        const char kCullShaderFile[] = "Scene/Culling/HoleTilesCull.cs.slang";
+        const char kTileVsFile[] = "Scene/Culling/HoleTiles.vs.slang";
+        const char kHiZShaderFile[] = "Scene/Culling/HiZBuild.cs.slang";
+
+        const uint32_t kDrawArgsSize = sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+
+        uint32_t nextPowerOf2(uint32_t a)
+        {
+            uint32_t p = 1;
+            while (p < a) p <<= 1;
+            return p;
+        }
+    }
+
+    HoleTiles::SharedPtr HoleTiles::create(const Scene::SharedPtr& pScene)
+    {
+        if (!pScene) throw std::exception("HoleTiles requires a scene");
+        return SharedPtr(new HoleTiles(pScene));
+    }
+
+    FullScreenPass::SharedPtr HoleTiles::createTilePass(const std::string& psFile, const Program::DefineList& defines)
+    {
+        Program::Desc d;
+        d.addShaderLibrary(kTileVsFile).vsEntry("main");
+        d.addShaderLibrary(psFile).psEntry("main");
+        return FullScreenPass::create(d, defines);
+    }
+
+    HoleTiles::HoleTiles(const Scene::SharedPtr& pScene)
+        : mpScene(pScene)
+    {
+        mpClassifyPass = ComputePass::create(kClassifyShaderFile, "classify");
+        mpDownsamplePass = ComputePass::create(kHiZShaderFile, "downsample");
+        mpCullPass = ComputePass::create(kCullShaderFile, "cull", mpScene->getSceneDefines());
+        mpCullPass["gScene"] = mpScene->getParameterBlock();
+
+        // Depth-only pass writing the far plane in the hole tiles.
+        Program::Desc d;
+        d.addShaderLibrary(kTileVsFile).vsEntry("main");
+        mpDepthPass = FullScreenPass::create(d);
+        auto dsDesc = DepthStencilState::Desc().setDepthEnabled(true).setDepthFunc(DepthStencilState::Func::Always).setDepthWriteMask(true);
+        mpDepthPass->getState()->setDepthStencilState(DepthStencilState::create(dsDesc));
+
+        const uint32_t argsInit[kHoleTilesArgsSize / 4] = { 0, 1, 1, 4, 0, 0, 0, 0 };
+        mpArgsInit = Buffer::create(kHoleTilesArgsSize, Resource::BindFlags::None, Buffer::CpuAccess::None, argsInit);
+        mpArgs = Buffer::create(kHoleTilesArgsSize, Resource::BindFlags::UnorderedAccess | Resource::BindFlags::IndirectArg);
+
+        mpInstanceBounds = createInstanceBoundsBuffer(mpScene.get());
+        mpCounters = Buffer::create(kHoleTilesCounterCount * sizeof(uint32_t), Resource::BindFlags::UnorderedAccess | Resource::BindFlags::IndirectArg);
+
+        const Scene::DrawList& drawList = mpScene->getDrawList();
+        const Scene::DrawArgs* srcArgs[] = { &drawList.counterClockwise, &drawList.clockwise };
+        Scene::DrawArgs* dstArgs[] = { &mDrawList.counterClockwise, &mDrawList.clockwise };
+        for (uint32_t list = 0; list < 2; list++)
+        {
+            const uint32_t count = srcArgs[list]->count;
+            if (count == 0) continue;
+            mpDrawArgs[list] = Buffer::create(count * kDrawArgsSize, Resource::BindFlags::UnorderedAccess | Resource::BindFlags::IndirectArg);
+            *dstArgs[list] = { mpDrawArgs[list], count, mpCounters, (kHoleTilesDrawCount + list) * (uint32_t)sizeof(uint32_t) };
+        }
+    }
+
+    void HoleTiles::createTileResources(uint2 screenDim)
+    {
+        mScreenDim = screenDim;
+        mTileDim = (screenDim + kHoleTileSize - 1u) / kHoleTileSize;
+
+        // The pyramid is padded to a power-of-two size like the Hi-Z pyramid, see HiZTest.slang. The padding holds no holes.
+        mpTileCounts = Texture::create2D(nextPowerOf2(mTileDim.x), nextPowerOf2(mTileDim.y), ResourceFormat::R32Float, 1, Texture::kMaxPossible, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+        mpTileCounts->setName("HoleTiles::TileCounts");
+        mpTileList = Buffer::create(mTileDim.x * mTileDim.y * sizeof(uint32_t), Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+    }
+
+    void HoleTiles::classify(RenderContext* pRenderContext, const Texture::SharedPtr& pHoleMask)
+    {
+        PROFILE("classifyHoleTiles");
+
+        assert(pHoleMask);
+        const uint2 screenDim(pHoleMask->getWidth(), pHoleMask->getHeight());
+        if (!mpTileCounts || mScreenDim != screenDim)
+        {
+            createTileResources(screenDim);
+            pRenderContext->clearUAV(mpTileCounts->getUAV(0).get(), float4(0.f));
+        }
+
+        pRenderContext->copyResource(mpArgs.get(), mpArgsInit.get());
+
+        auto var = mpClassifyPass->getRootVar();
+        var["gHoleMask"] = pHoleMask;
+        var["gTileCounts"].setUav(mpTileCounts->getUAV(0));
+        var["gTileList"] = mpTileList;
+        var["gArgs"] = mpArgs;
+        var["CB"]["gScreenDim"] = screenDim;
+        mpClassifyPass->execute(pRenderContext, mTileDim.x * kHoleTileSize, mTileDim.y * kHoleTileSize);
+
+        // Reduce each level into the next.
+        uint2 dstDim(mpTileCounts->getWidth(), mpTileCounts->getHeight());
+        auto downsampleVar = mpDownsamplePass->getRootVar();
+        for (uint32_t level = 1; level < mpTileCounts->getMipCount(); level++)
+        {
+            uint2 srcDim = dstDim;
+            dstDim = glm::max(srcDim / 2u, uint2(1));
+            downsampleVar["gSrc"].setSrv(mpTileCounts->getSRV(level - 1, 1));
+            downsampleVar["gDst"].setUav(mpTileCounts->getUAV(level));
+            downsampleVar["CB"]["gSrcDim"] = srcDim;
+            downsampleVar["CB"]["gDstDim"] = dstDim;
+            mpDownsamplePass->execute(pRenderContext, dstDim.x, dstDim.y);
+        }
+    }
+
+    void HoleTiles::setShaderData(const ShaderVar& var) const
+    {
+        var["gHoleTileList"] = mpTileList;
+        var["HoleTilesCB"]["gHoleTilesScreenDim"] = mScreenDim;
+    }
+
+    void HoleTiles::restrictDepthToTiles(RenderContext* pRenderContext, const Fbo::SharedPtr& pFbo)
+    {
+        PROFILE("restrictDepthToHoleTiles");
+
+        assert(pFbo && pFbo->getDepthStencilTexture());
+        pRenderContext->clearDsv(pFbo->getDepthStencilView().get(), 0.f, 0, true, false);
+        drawTiles(pRenderContext, mpDepthPass, pFbo);
+    }
+
+    const Scene::DrawList& HoleTiles::cullDraws(RenderContext* pRenderContext, const glm::mat4& viewProj)
+    {
+        PROFILE("cullHoleTileDraws");
+
+        if (!mpTileCounts)
+        {
+            logWarning("HoleTiles::cullDraws() called before classify(). Returning the full draw list.");
+            return mpScene->getDrawList();
+        }
+
+        pRenderContext->clearUAV(mpCounters->getUAV().get(), uint4(0));
+
+        auto var = mpCullPass->getRootVar();
+        var["gInstanceBounds"] = mpInstanceBounds;
+        var["gTileCounts"] = mpTileCounts;
+        var["gCounters"] = mpCounters;
+        var["CB"]["gViewProj"] = viewProj;
+        var["CB"]["gScreenDim"] = mScreenDim;
+        var["CB"]["gTileMipCount"] = mpTileCounts->getMipCount();
+
+        const Scene::DrawList& drawList = mpScene->getDrawList();
+        const Scene::DrawArgs* srcArgs[] = { &drawList.counterClockwise, &drawList.clockwise };
+        for (uint32_t list = 0; list < 2; list++)
+        {
+            if (srcArgs[list]->count == 0) continue;
+            var["gSrcArgs"] = srcArgs[list]->pBuffer;
+            var["gDstArgs"] = mpDrawArgs[list];
+            var["CB"]["gDrawCount"] = srcArgs[list]->count;
+            var["CB"]["gListIndex"] = list;
+            mpCullPass->execute(pRenderContext, srcArgs[list]->count, 1);
+        }
+
+        return mDrawList;
+    }
+
+    void HoleTiles::drawTiles(RenderContext* pRenderContext, const FullScreenPass::SharedPtr& pPass, const Fbo::SharedPtr& pFbo)
+    {
+        assert(pPass && pFbo);
+        assert(pFbo->getWidth() == mScreenDim.x && pFbo->getHeight() == mScreenDim.y);
+
+        setShaderData(pPass->getRootVar());
+        pPass->getState()->setFbo(pFbo);
+        pRenderContext->drawIndirect(pPass->getState().get(), pPass->getVars().get(), 1, mpArgs.get(), kHoleTilesDrawArgsOffset, nullptr, 0);
+    }
+
+    void HoleTiles::dispatchTiles(RenderContext* pRenderContext, const ComputePass::SharedPtr& pPass)
+    {
+        assert(pPass);
+        assert(pPass->getThreadGroupSize() == uint3(kHoleTileSize, kHoleTileSize, 1));
+
+        setShaderData(pPass->getRootVar());
+        pPass->executeIndirect(pRenderContext, mpArgs.get(), kHoleTilesDispatchArgsOffset);
+    }
+}
@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/Scene.h"
+#include "RenderGraph/BasePasses/ComputePass.h"
+#include "RenderGraph/BasePasses/FullScreenPass.h"
+
+namespace Falcor
+{
+    /** Screen tile classification for filling holes, e.g. disocclusions after reprojection, by re-rasterizing the scene.
+        The work of the hole-filling passes scales with the area of the holes instead of the screen size.
+
+        Usage per frame:
+        1. classify() counts the holes in each tile of kHoleTileSize x kHoleTileSize pixels and builds a list of the tiles with holes.
+        2. restrictDepthToTiles() prepares the depth buffer so that only pixels in hole tiles pass the depth test.
+           This replaces a scissor rectangle per tile, which would need one draw per tile and a CPU readback of the tile list.
+        3. cullDraws() selects the draws whose screen-space bounds overlap hole tiles. Render the returned draw list
+           into the FBO prepared in step 2, e.g. with Scene::render().
+        4. drawTiles() or dispatchTiles() run the lighting only over the hole tiles using indirect arguments.
+
+        All steps are GPU-driven. Shaders access the tile list through Scene/Culling/HoleTiles.slang.
+    */
+    class dlldecl HoleTiles
+    {
+    public:
+        using SharedPtr = std::shared_ptr<HoleTiles>;
+
+        /** Create a new object.
+            \param[in] pScene The scene to re-rasterize.
+            \return New object, or throws an exception on error.
+        */
+        static SharedPtr create(const Scene::SharedPtr& pScene);
+
+        /** Create a pass drawing one quad per hole tile with drawTiles().
+            \param[in] psFile Pixel shader filename. The pixel shader must be named "main()" and can be shared with a FullScreenPass.
+            \param[in] defines Optional list of macro definitions to set into the program.
+            \return A new object, or throws an exception if creation failed.
+        */
+        static FullScreenPass::SharedPtr createTilePass(const std::string& psFile, const Program::DefineList& defines = Program::DefineList());
+
+        /** Classify the tiles of a hole mask.
+            \param[in] pRenderContext Render context.
+            \param[in] pHoleMask Hole mask. Pixels where the first channel is non-zero are holes.
+        */
+        void classify(RenderContext* pRenderContext, const Texture::SharedPtr& pHoleMask);
+
+        /** Bind the hole tile list to a program importing Scene/Culling/HoleTiles.slang.
+        */
+        void setShaderData(const ShaderVar& var) const;
+
+        /** Clear a depth buffer to the near plane outside the hole tiles and to the far plane inside them.
+            Afterwards, only geometry rendered into hole tiles passes a less-than depth test.
+            \param[in] pRenderContext Render context.
+            \param[in] pFbo FBO with the depth buffer to clear. Must be the size of the classified hole mask.
+        */
+        void restrictDepthToTiles(RenderContext* pRenderContext, const Fbo::SharedPtr& pFbo);
+
+        /** Select the draws of the scene that overlap hole tiles.
+            \param[in] pRenderContext Render context.
+            \param[in] viewProj View-projection matrix used for rendering.
+            \return Draw list with the draws that overlap hole tiles. The counts are stored on the GPU.
+        */
+        const Scene::DrawList& cullDraws(RenderContext* pRenderContext, const glm::mat4& viewProj);
+
+        /** Draw one quad per hole tile.
+            \param[in] pRenderContext Render context.
+            \param[in] pPass Pass created with createTilePass().
+            \param[in] pFbo Target FBO. Must be the size of the classified hole mask.
+        */
+        void drawTiles(RenderContext* pRenderContext, const FullScreenPass::SharedPtr& pPass, const Fbo::SharedPtr& pFbo);
+
+        /** Dispatch one thread group per hole tile. See HoleTiles.slang for how the kernel finds its tile.
+            \param[in] pRenderContext Render context.
+            \param[in] pPass Compute pass with a thread group size of kHoleTileSize x kHoleTileSize.
+        */
+        void dispatchTiles(RenderContext* pRenderContext, const ComputePass::SharedPtr& pPass);
+
+        /** Get the size of the tile grid.
+        */
+        uint2 getTileDim() const { return mTileDim; }
+
+        /** Get the indirect argument buffer. See HoleTilesData.slang for the layout.
+        */
+        const Buffer::SharedPtr& getArgsBuffer() const { return mpArgs; }
+
+        /** Get the tile pyramid. Level 0 holds the number of holes in each tile, the other levels the maximum of the tiles they cover.
+        */
+        const Texture::SharedPtr& getTileCountTexture() const { return mpTileCounts; }
+
+    private:
+        HoleTiles(const Scene::SharedPtr& pScene);
+        void createTileResources(uint2 screenDim);
+
+        Scene::SharedPtr mpScene;
+
+        ComputePass::SharedPtr mpClassifyPass;
+        ComputePass::SharedPtr mpDownsamplePass;
+        ComputePass::SharedPtr mpCullPass;
+        FullScreenPass::SharedPtr mpDepthPass;
+
+        uint2 mScreenDim = {};
+        uint2 mTileDim = {};
+        Texture::SharedPtr mpTileCounts;        ///< Tile pyramid.
+        Buffer::SharedPtr mpTileList;           ///< Hole tiles, packed as x | (y << 16).
+        Buffer::SharedPtr mpArgs;               ///< Indirect arguments, see HoleTilesData.slang.
+        Buffer::SharedPtr mpArgsInit;           ///< Initial contents of the indirect arguments.
+
+        Buffer::SharedPtr mpInstanceBounds;     ///< Local-space bounds per mesh instance.
+        Buffer::SharedPtr mpCounters;           ///< Draw counts, see HoleTilesData.slang.
+        std::array<Buffer::SharedPtr, 2> mpDrawArgs;
+        Scene::DrawList mDrawList;
+    };
+}
@@ -0,0 +1,272 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "OcclusionCulling.h"
+#include "DrawCulling.h"
+#include "OcclusionCullingData.slang"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kCullShaderFile[] = "Scene/Culling/OcclusionCulling.cs.slang";
+        const char kHiZShaderFile[] = "Scene/Culling/HiZBuild.cs.slang";
+
+        const uint32_t kDrawArgsSize = sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+
+        uint32_t nextPowerOf2(uint32_t a)
+        {
+            uint32_t p = 1;
+            while (p < a) p <<= 1;
+            return p;
+        }
+    }
+
+    OcclusionCulling::SharedPtr OcclusionCulling::create(const Scene::SharedPtr& pScene)
+    {
+        if (!pScene) throw std::exception("OcclusionCulling requires a scene");
+        return SharedPtr(new OcclusionCulling(pScene));
+    }
+
+    OcclusionCulling::OcclusionCulling(const Scene::SharedPtr& pScene)
+        : mpScene(pScene)
+    {
+        Program::DefineList defines = mpScene->getSceneDefines();
+        mpCullPhase1Pass = ComputePass::create(kCullShaderFile, "cullPhase1", defines);
+        mpCullPhase2Pass = ComputePass::create(kCullShaderFile, "cullPhase2", defines);
+        mpCopyDepthPass = ComputePass::create(kHiZShaderFile, "copyDepth");
+        mpDownsamplePass = ComputePass::create(kHiZShaderFile, "downsample");
+
+        mpCullPhase1Pass["gScene"] = mpScene->getParameterBlock();
+        mpCullPhase2Pass["gScene"] = mpScene->getParameterBlock();
+
+        createBuffers();
+        mpReadbackFence = GpuFence::create();
+    }
+
+    void OcclusionCulling::createBuffers()
+    {
+        mpInstanceBounds = createInstanceBoundsBuffer(mpScene.get());
+
+        mpCounters = Buffer::create(kOcclusionCullingCounterCount * sizeof(uint32_t), Resource::BindFlags::UnorderedAccess | Resource::BindFlags::IndirectArg);
+
+        const Scene::DrawList& drawList = mpScene->getDrawList();
+        const Scene::DrawArgs* srcArgs[] = { &drawList.counterClockwise, &drawList.clockwise };
+        Scene::DrawArgs* phase1Args[] = { &mPhase1DrawList.counterClockwise, &mPhase1DrawList.clockwise };
+        Scene::DrawArgs* phase2Args[] = { &mPhase2DrawList.counterClockwise, &mPhase2DrawList.clockwise };
+
+        for (uint32_t list = 0; list < 2; list++)
+        {
+            const uint32_t count = srcArgs[list]->count;
+            if (count == 0) continue;
+
+            auto& buffers = mListBuffers[list];
+            buffers.pPhase1Args = Buffer::create(count * kDrawArgsSize, Resource::BindFlags::UnorderedAccess | Resource::BindFlags::IndirectArg);
+            buffers.pPhase2Args = Buffer::create(count * kDrawArgsSize, Resource::BindFlags::UnorderedAccess | Resource::BindFlags::IndirectArg);
+            buffers.pRejected = Buffer::create(count * sizeof(uint32_t), Resource::BindFlags::UnorderedAccess);
+
+            *phase1Args[list] = { buffers.pPhase1Args, count, mpCounters, (kOcclusionCullingPhase1DrawCount + list) * (uint32_t)sizeof(uint32_t) };
+            *phase2Args[list] = { buffers.pPhase2Args, count, mpCounters, (kOcclusionCullingPhase2DrawCount + list) * (uint32_t)sizeof(uint32_t) };
+        }
+
+        for (auto& readback : mReadbacks)
+        {
+            readback.pBuffer = Buffer::create(kOcclusionCullingCounterCount * sizeof(uint32_t), Resource::BindFlags::None, Buffer::CpuAccess::Read);
+        }
+    }
+
+    void OcclusionCulling::setHiZVars(const ShaderVar& var, const OcclusionCulling& source)
+    {
+        var["gHiZ"] = source.mHiZ.pTexture;
+        var["CB"]["gHiZViewProj"] = source.mHiZ.viewProj;
+        var["CB"]["gHiZScreenDim"] = source.mHiZ.screenDim;
+        var["CB"]["gHiZMipCount"] = source.mHiZ.pTexture ? source.mHiZ.pTexture->getMipCount() : 0u;
+    }
+
+    void OcclusionCulling::cullPhase1(RenderContext* pRenderContext, const glm::mat4& viewProj, const OcclusionCulling* pHiZSource)
+    {
+        PROFILE("occlusionCullPhase1");
+
+        readStats(pRenderContext);
+
+        const OcclusionCulling& source = pHiZSource ? *pHiZSource : *this;
+        pRenderContext->clearUAV(mpCounters->getUAV().get(), uint4(0));
+
+        auto var = mpCullPhase1Pass->getRootVar();
+        var["gInstanceBounds"] = mpInstanceBounds;
+        var["gCounters"] = mpCounters;
+        var["CB"]["gViewProj"] = viewProj;
+        var["CB"]["gUseHiZ"] = source.mHiZ.valid ? 1u : 0u;
+        setHiZVars(var, source);
+
+        const Scene::DrawList& drawList = mpScene->getDrawList();
+        const Scene::DrawArgs* srcArgs[] = { &drawList.counterClockwise, &drawList.clockwise };
+        for (uint32_t list = 0; list < 2; list++)
+        {
+            if (srcArgs[list]->count == 0) continue;
+            var["gSrcArgs"] = srcArgs[list]->pBuffer;
+            var["gDstArgs"] = mListBuffers[list].pPhase1Args;
+            var["gRejected"] = mListBuffers[list].pRejected;
+            var["CB"]["gDrawCount"] = srcArgs[list]->count;
+            var["CB"]["gListIndex"] = list;
+            mpCullPhase1Pass->execute(pRenderContext, srcArgs[list]->count, 1);
+        }
+
+        mStats.drawCount = drawList.counterClockwise.count + drawList.clockwise.count;
+    }
+
+    void OcclusionCulling::buildHiZ(RenderContext* pRenderContext, const Texture::SharedPtr& pDepth, const glm::mat4& viewProj)
+    {
+        PROFILE("buildHiZ");
+
+        assert(pDepth);
+        const uint2 screenDim(pDepth->getWidth(), pDepth->getHeight());
+        if (!mHiZ.pTexture || mHiZ.screenDim != screenDim)
+        {
+            mHiZ.pTexture = Texture::create2D(nextPowerOf2(screenDim.x), nextPowerOf2(screenDim.y), ResourceFormat::R32Float, 1, Texture::kMaxPossible, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+            mHiZ.pTexture->setName("OcclusionCulling::HiZ");
+        }
+        mHiZ.screenDim = screenDim;
+        mHiZ.viewProj = viewProj;
+
+        // Copy the depth buffer into level 0.
+        uint2 dstDim(mHiZ.pTexture->getWidth(), mHiZ.pTexture->getHeight());
+        auto copyVar = mpCopyDepthPass->getRootVar();
+        copyVar["gSrc"] = pDepth;
+        copyVar["gDst"].setUav(mHiZ.pTexture->getUAV(0));
+        copyVar["CB"]["gSrcDim"] = screenDim;
+        copyVar["CB"]["gDstDim"] = dstDim;
+        mpCopyDepthPass->execute(pRenderContext, dstDim.x, dstDim.y);
+
+        // Reduce each level into the next.
+        auto downsampleVar = mpDownsamplePass->getRootVar();
+        for (uint32_t level = 1; level < mHiZ.pTexture->getMipCount(); level++)
+        {
+            uint2 srcDim = dstDim;
+            dstDim = glm::max(srcDim / 2u, uint2(1));
+            downsampleVar["gSrc"].setSrv(mHiZ.pTexture->getSRV(level - 1, 1));
+            downsampleVar["gDst"].setUav(mHiZ.pTexture->getUAV(level));
+            downsampleVar["CB"]["gSrcDim"] = srcDim;
+            downsampleVar["CB"]["gDstDim"] = dstDim;
+            mpDownsamplePass->execute(pRenderContext, dstDim.x, dstDim.y);
+        }
+
+        mHiZ.valid = true;
+    }
+
+    void OcclusionCulling::cullPhase2(RenderContext* pRenderContext)
+    {
+        PROFILE("occlusionCullPhase2");
+
+        if (!mHiZ.valid)
+        {
+            logWarning("OcclusionCulling::cullPhase2() called without a Hi-Z pyramid. Call buildHiZ() first.");
+            return;
+        }
+
+        auto var = mpCullPhase2Pass->getRootVar();
+        var["gInstanceBounds"] = mpInstanceBounds;
+        var["gCounters"] = mpCounters;
+        setHiZVars(var, *this);
+
+        const Scene::DrawList& drawList = mpScene->getDrawList();
+        const Scene::DrawArgs* srcArgs[] = { &drawList.counterClockwise, &drawList.clockwise };
+        for (uint32_t list = 0; list < 2; list++)
+        {
+            if (srcArgs[list]->count == 0) continue;
+            pRenderContext->uavBarrier(mListBuffers[list].pRejected.get());
+            var["gSrcArgs"] = srcArgs[list]->pBuffer;
+            var["gDstArgs"] = mListBuffers[list].pPhase2Args;
+            var["gRejected"] = mListBuffers[list].pRejected;
+            var["CB"]["gDrawCount"] = srcArgs[list]->count;
+            var["CB"]["gListIndex"] = list;
+            mpCullPhase2Pass->execute(pRenderContext, srcArgs[list]->count, 1);
+        }
+
+        // Queue the counters for readback. If all buffers are still in flight, this frame's stats are dropped.
+        for (auto& readback : mReadbacks)
+        {
+            if (readback.pending) continue;
+            pRenderContext->copyResource(readback.pBuffer.get(), mpCounters.get());
+            readback.pending = true;
+            readback.signaled = false;
+            break;
+        }
+    }
+
+    void OcclusionCulling::readStats(RenderContext* pRenderContext)
+    {
+        // The signal is queued after all submitted work, which includes the copies recorded in earlier frames.
+        bool hasUnsignaled = std::any_of(mReadbacks.begin(), mReadbacks.end(), [](const Readback& r) { return r.pending && !r.signaled; });
+        if (hasUnsignaled)
+        {
+            uint64_t value = mpReadbackFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+            for (auto& readback : mReadbacks)
+            {
+                if (readback.pending && !readback.signaled)
+                {
+                    readback.fenceValue = value;
+                    readback.signaled = true;
+                }
+            }
+        }
+
+        // Read the most recent completed copy and release all completed ones.
+        const uint64_t gpuValue = mpReadbackFence->getGpuValue();
+        bool hasLatest = false;
+        uint64_t latestValue = 0;
+        for (auto& readback : mReadbacks)
+        {
+            if (!readback.pending || !readback.signaled || readback.fenceValue > gpuValue) continue;
+            if (!hasLatest || readback.fenceValue >= latestValue)
+            {
+                const uint32_t* pCounters = reinterpret_cast<const uint32_t*>(readback.pBuffer->map(Buffer::MapType::Read));
+                mStats.frustumCulled = pCounters[kOcclusionCullingFrustumCulled];
+                mStats.phase1Draws = pCounters[kOcclusionCullingPhase1DrawCount] + pCounters[kOcclusionCullingPhase1DrawCount + 1];
+                mStats.phase2Draws = pCounters[kOcclusionCullingPhase2DrawCount] + pCounters[kOcclusionCullingPhase2DrawCount + 1];
+                uint32_t rejected = pCounters[kOcclusionCullingRejectedCount] + pCounters[kOcclusionCullingRejectedCount + 1];
+                mStats.occlusionCulled = rejected - mStats.phase2Draws;
+                readback.pBuffer->unmap();
+                latestValue = readback.fenceValue;
+                hasLatest = true;
+            }
+            readback.pending = false;
+        }
+    }
+
+    void OcclusionCulling::renderUI(Gui::Widgets& widget)
+    {
+        std::string msg;
+        msg += "Draws: " + std::to_string(mStats.drawCount) + "\n";
+        msg += "Frustum culled: " + std::to_string(mStats.frustumCulled) + "\n";
+        msg += "Occlusion culled: " + std::to_string(mStats.occlusionCulled) + "\n";
+        msg += "Phase 1 draws: " + std::to_string(mStats.phase1Draws) + "\n";
+        msg += "Phase 2 draws: " + std::to_string(mStats.phase2Draws);
+        widget.text(msg);
+    }
+}
@@ -0,0 +1,163 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/Scene.h"
+#include "RenderGraph/BasePasses/ComputePass.h"
+
+namespace Falcor
+{
+    /** GPU-driven two-phase occlusion culling of the scene's mesh instances using a hierarchical depth (Hi-Z) pyramid.
+
+        Usage per frame (and per eye in stereo rendering):
+        1. cullPhase1() tests all mesh instances against the frustum and the Hi-Z pyramid from the previous frame.
+           If another culler is passed as the Hi-Z source, its pyramid is used instead, e.g. the right eye can reuse the left eye's depth.
+        2. Render getPhase1DrawList() into the depth buffer.
+        3. buildHiZ() builds the pyramid from that depth buffer.
+        4. cullPhase2() re-tests the instances rejected in phase 1 against the new pyramid.
+        5. Render getPhase2DrawList() into the same depth buffer. Passes after the depth pass render both lists.
+        6. buildHiZ() again from the complete depth buffer. This pyramid is tested against by the next frame's phase 1.
+
+        The draw lists hold compacted indirect arguments with a GPU count, so no CPU readback is needed.
+        The pyramid is kept for the next frame. Call invalidateHiZ() on camera cuts to avoid a frame of heavy phase 2 work.
+    */
+    class dlldecl OcclusionCulling
+    {
+    public:
+        using SharedPtr = std::shared_ptr<OcclusionCulling>;
+
+        /** Culling statistics. They are read back without stalling and lag the GPU by a few frames.
+        */
+        struct Stats
+        {
+            uint32_t drawCount = 0;         ///< Number of draws tested.
+            uint32_t frustumCulled = 0;     ///< Draws outside the view frustum.
+            uint32_t phase1Draws = 0;       ///< Draws that passed phase 1.
+            uint32_t phase2Draws = 0;       ///< Draws rejected in phase 1 that were found to be visible in phase 2.
+            uint32_t occlusionCulled = 0;   ///< Draws rejected in both phases.
+        };
+
+        /** Create a new object.
+            \param[in] pScene The scene to cull.
+            \return New object, or throws an exception on error.
+        */
+        static SharedPtr create(const Scene::SharedPtr& pScene);
+
+        /** Run phase 1 of the culling.
+            \param[in] pRenderContext Render context.
+            \param[in] viewProj View-projection matrix used for rendering.
+            \param[in] pHiZSource Culler whose Hi-Z pyramid to test against. If nullptr, this culler's own pyramid is used.
+        */
+        void cullPhase1(RenderContext* pRenderContext, const glm::mat4& viewProj, const OcclusionCulling* pHiZSource = nullptr);
+
+        /** Build the Hi-Z pyramid.
+            \param[in] pRenderContext Render context.
+            \param[in] pDepth Depth buffer containing the phase 1 draws, or all draws at the end of the frame. Must be bindable as a shader resource.
+            \param[in] viewProj View-projection matrix the depth buffer was rendered with.
+        */
+        void buildHiZ(RenderContext* pRenderContext, const Texture::SharedPtr& pDepth, const glm::mat4& viewProj);
+
+        /** Run phase 2 of the culling. Requires a pyramid built by buildHiZ() in the same frame.
+        */
+        void cullPhase2(RenderContext* pRenderContext);
+
+        /** Get the draws that passed phase 1.
+        */
+        const Scene::DrawList& getPhase1DrawList() const { return mPhase1DrawList; }
+
+        /** Get the draws that passed phase 2.
+        */
+        const Scene::DrawList& getPhase2DrawList() const { return mPhase2DrawList; }
+
+        /** Get the Hi-Z pyramid, or nullptr if none has been built.
+        */
+        const Texture::SharedPtr& getHiZTexture() const { return mHiZ.pTexture; }
+
+        /** Discard the Hi-Z pyramid. The next phase 1 only does frustum culling.
+        */
+        void invalidateHiZ() { mHiZ.valid = false; }
+
+        /** Get the latest statistics that have been read back.
+        */
+        const Stats& getStats() const { return mStats; }
+
+        /** Render the statistics in the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        OcclusionCulling(const Scene::SharedPtr& pScene);
+        void createBuffers();
+        void setHiZVars(const ShaderVar& var, const OcclusionCulling& source);
+        void readStats(RenderContext* pRenderContext);
+
+        Scene::SharedPtr mpScene;
+
+        ComputePass::SharedPtr mpCullPhase1Pass;
+        ComputePass::SharedPtr mpCullPhase2Pass;
+        ComputePass::SharedPtr mpCopyDepthPass;
+        ComputePass::SharedPtr mpDownsamplePass;
+
+        Buffer::SharedPtr mpInstanceBounds;     ///< Local-space bounds per mesh instance.
+        Buffer::SharedPtr mpCounters;           ///< Counters, see OcclusionCullingData.slang.
+
+        /** Buffers for one of the scene's draw lists (counter-clockwise or clockwise).
+        */
+        struct ListBuffers
+        {
+            Buffer::SharedPtr pPhase1Args;
+            Buffer::SharedPtr pPhase2Args;
+            Buffer::SharedPtr pRejected;
+        };
+        std::array<ListBuffers, 2> mListBuffers;
+
+        Scene::DrawList mPhase1DrawList;
+        Scene::DrawList mPhase2DrawList;
+
+        struct
+        {
+            Texture::SharedPtr pTexture;
+            uint2 screenDim = {};
+            glm::mat4 viewProj;
+            bool valid = false;
+        } mHiZ;
+
+        /** Ring of readback buffers for the statistics.
+            A buffer is read once the fence shows that the frame that wrote it has completed.
+        */
+        struct Readback
+        {
+            Buffer::SharedPtr pBuffer;
+            uint64_t fenceValue = 0;    ///< Fence value to wait for. Only valid if `signaled` is set.
+            bool signaled = false;      ///< Whether a fence signal has been queued after the copy.
+            bool pending = false;       ///< Whether the buffer holds a copy that has not been read.
+        };
+        std::array<Readback, Device::kMaxFramesInFlight + 1> mReadbacks;
+        GpuFence::SharedPtr mpReadbackFence;
+        Stats mStats;
+    };
+}
@@ -530,6 +530,7 @@ namespace Falcor
 
         bool createMeshes(ImporterData& data)
         {
+            PROFILE_ZONE("AssimpImporter::createMeshes");
             const aiScene* pScene = data.pScene;
             for (uint32_t i = 0; i < pScene->mNumMeshes; i++)
             {
@@ -676,6 +677,7 @@ namespace Falcor
 
         bool createSceneGraph(ImporterData& data)
         {
+            PROFILE_ZONE("AssimpImporter::createSceneGraph");
             createBoneList(data);
             aiNode* pRoot = data.pScene->mRootNode;
             assert(isBone(data, pRoot->mName.C_Str()) == false);
@@ -909,6 +911,7 @@ namespace Falcor
 
         bool createAllMaterials(ImporterData& data, const std::string& modelFolder, ImportMode importMode)
         {
+            PROFILE_ZONE("AssimpImporter::createAllMaterials");
             bool useSrgb = !is_set(data.builder.getFlags(), SceneBuilder::Flags::AssumeLinearSpaceTextures);
 
             for (uint32_t i = 0; i < data.pScene->mNumMaterials; i++)
@@ -0,0 +1,228 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "LightClusterBinning.h"
+
+namespace Falcor
+{
+    const float LightClusterBinning::kDefaultMinIntensity = 0.01f;
+
+    namespace
+    {
+        bool sphereIntersectsBox(const float3& center, float radius, const BoundingBox& box)
+        {
+            float3 d = center - glm::clamp(center, box.getMinPos(), box.getMaxPos());
+            return glm::dot(d, d) <= radius * radius;
+        }
+
+        uint32_t clampTile(float t, uint32_t dim)
+        {
+            return (uint32_t)glm::clamp(t, 0.f, float(dim - 1));
+        }
+    }
+
+    LightClusterBinning::LightClusterBinning(uint3 gridDim)
+    {
+        setGridDim(gridDim);
+    }
+
+    void LightClusterBinning::setGridDim(uint3 gridDim)
+    {
+        assert(gridDim.x > 0 && gridDim.y > 0 && gridDim.z > 0);
+        if (gridDim == mGrid.dim) return;
+        mGrid.dim = gridDim;
+        mDirty = true;
+    }
+
+    void LightClusterBinning::setView(const float4x4& viewMat, const float4x4& projMat, uint2 screenDim, float nearZ, float farZ)
+    {
+        assert(nearZ > 0.f && farZ > nearZ);
+        assert(projMat[0][0] > 0.f && projMat[1][1] > 0.f);
+
+        // The cluster bounds are in view space, so only the projection and the depth range invalidate them.
+        if (projMat != mProjMat || nearZ != mGrid.nearZ || farZ != mGrid.farZ) mDirty = true;
+        mViewMat = viewMat;
+        mProjMat = projMat;
+
+        const float4x4 invView = glm::inverse(viewMat);
+        mGrid.cameraPosW = float3(invView[3]);
+        mGrid.cameraDirW = -glm::normalize(float3(invView[2]));
+        mGrid.nearZ = nearZ;
+        mGrid.farZ = farZ;
+        mGrid.tileScale = float2(mGrid.dim.x, mGrid.dim.y) / float2(screenDim);
+        mGrid.sliceScale = float(mGrid.dim.z) / std::log(farZ / nearZ);
+    }
+
+    void LightClusterBinning::updateClusterBounds()
+    {
+        const uint3 dim = mGrid.dim;
+        mClusterBounds.resize((size_t)dim.x * dim.y * dim.z);
+
+        // For a perspective projection, x / depth and y / depth are affine in NDC. This also holds for off-center projections.
+        auto viewPos = [this](float ndcX, float ndcY, float depth)
+        {
+            return float3(depth * (ndcX + mProjMat[2][0]) / mProjMat[0][0], depth * (ndcY + mProjMat[2][1]) / mProjMat[1][1], -depth);
+        };
+
+        for (uint32_t z = 0; z < dim.z; z++)
+        {
+            // Points nearer than the first slice are assigned to it, so it extends to the eye.
+            const float depth0 = z == 0 ? 0.f : getLightClusterSliceDepth(z, mGrid);
+            const float depth1 = getLightClusterSliceDepth(z + 1, mGrid);
+            for (uint32_t y = 0; y < dim.y; y++)
+            {
+                const float ndcY0 = 1.f - 2.f * float(y + 1) / float(dim.y);
+                const float ndcY1 = 1.f - 2.f * float(y) / float(dim.y);
+                for (uint32_t x = 0; x < dim.x; x++)
+                {
+                    const float ndcX0 = 2.f * float(x) / float(dim.x) - 1.f;
+                    const float ndcX1 = 2.f * float(x + 1) / float(dim.x) - 1.f;
+
+                    float3 minPos = viewPos(ndcX0, ndcY0, depth0);
+                    float3 maxPos = minPos;
+                    for (uint32_t i = 1; i < 8; i++)
+                    {
+                        float3 p = viewPos(i & 1 ? ndcX1 : ndcX0, i & 2 ? ndcY1 : ndcY0, i & 4 ? depth1 : depth0);
+                        minPos = glm::min(minPos, p);
+                        maxPos = glm::max(maxPos, p);
+                    }
+                    mClusterBounds[getLightClusterIndex(uint3(x, y, z), mGrid)] = BoundingBox::fromMinMax(minPos, maxPos);
+                }
+            }
+        }
+        mDirty = false;
+    }
+
+    void LightClusterBinning::bin(const std::vector<LightData>& lights, float minIntensity)
+    {
+        if (mDirty) updateClusterBounds();
+
+        const uint3 dim = mGrid.dim;
+        std::vector<uint32_t> globalLights;
+        mAssignments.clear();
+
+        for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+        {
+            float3 centerW;
+            float radius;
+            if (!getLightBoundingSphere(lights[i], minIntensity, centerW, radius))
+            {
+                globalLights.push_back(i);
+                continue;
+            }
+            if (radius <= 0.f) continue;
+
+            const float3 centerV = float3(mViewMat * float4(centerW, 1.f));
+            const float depthMin = -centerV.z - radius;
+            const float depthMax = -centerV.z + radius;
+            if (depthMax <= 0.f || depthMin >= mGrid.farZ) continue;
+
+            // Find the tiles covered by the light's view-space bounding box. If the box reaches behind the eye, its projection is unbounded.
+            uint32_t tileMinX = 0, tileMaxX = dim.x - 1;
+            uint32_t tileMinY = 0, tileMaxY = dim.y - 1;
+            if (depthMin > 0.f)
+            {
+                const float x0 = centerV.x - radius, x1 = centerV.x + radius;
+                const float y0 = centerV.y - radius, y1 = centerV.y + radius;
+                const float ndcMinX = std::min(x0 / depthMin, x0 / depthMax) * mProjMat[0][0] - mProjMat[2][0];
+                const float ndcMaxX = std::max(x1 / depthMin, x1 / depthMax) * mProjMat[0][0] - mProjMat[2][0];
+                const float ndcMinY = std::min(y0 / depthMin, y0 / depthMax) * mProjMat[1][1] - mProjMat[2][1];
+                const float ndcMaxY = std::max(y1 / depthMin, y1 / depthMax) * mProjMat[1][1] - mProjMat[2][1];
+                if (ndcMaxX < -1.f || ndcMinX > 1.f || ndcMaxY < -1.f || ndcMinY > 1.f) continue;
+
+                tileMinX = clampTile((ndcMinX * 0.5f + 0.5f) * dim.x, dim.x);
+                tileMaxX = clampTile((ndcMaxX * 0.5f + 0.5f) * dim.x, dim.x);
+                tileMinY = clampTile((0.5f - ndcMaxY * 0.5f) * dim.y, dim.y);
+                tileMaxY = clampTile((0.5f - ndcMinY * 0.5f) * dim.y, dim.y);
+            }
+
+            const uint32_t sliceMin = getLightClusterSlice(depthMin, mGrid);
+            const uint32_t sliceMax = getLightClusterSlice(depthMax, mGrid);
+            for (uint32_t z = sliceMin; z <= sliceMax; z++)
+            {
+                for (uint32_t y = tileMinY; y <= tileMaxY; y++)
+                {
+                    for (uint32_t x = tileMinX; x <= tileMaxX; x++)
+                    {
+                        const uint32_t cluster = getLightClusterIndex(uint3(x, y, z), mGrid);
+                        if (sphereIntersectsBox(centerV, radius, mClusterBounds[cluster])) mAssignments.push_back(uint2(cluster, i));
+                    }
+                }
+            }
+        }
+
+        // Compact the assignments with a counting sort by cluster. Lights stay in ascending order within each cluster.
+        mClusterRanges.assign(mClusterBounds.size(), uint2(0));
+        for (const auto& a : mAssignments) mClusterRanges[a.x].y++;
+
+        uint32_t offset = (uint32_t)globalLights.size();
+        for (auto& range : mClusterRanges)
+        {
+            range.x = offset;
+            offset += range.y;
+            range.y = 0;
+        }
+
+        mLightIndices.resize(offset);
+        std::copy(globalLights.begin(), globalLights.end(), mLightIndices.begin());
+        for (const auto& a : mAssignments)
+        {
+            uint2& range = mClusterRanges[a.x];
+            mLightIndices[range.x + range.y++] = a.y;
+        }
+        mGrid.globalLightCount = (uint32_t)globalLights.size();
+    }
+
+    bool LightClusterBinning::getLightBoundingSphere(const LightData& light, float minIntensity, float3& centerW, float& radius)
+    {
+        if (light.type != (uint32_t)LightType::Point || minIntensity <= 0.f) return false;
+
+        // The intensity of a point light falls off with the squared distance.
+        const float maxIntensity = std::max(light.intensity.x, std::max(light.intensity.y, light.intensity.z));
+        const float range = maxIntensity > 0.f ? std::sqrt(maxIntensity / minIntensity) : 0.f;
+        centerW = light.posW;
+        radius = range;
+
+        // Bound the intersection of the spot light's cone with the range sphere.
+        if (light.openingAngle < float(M_PI) * 0.5f)
+        {
+            const float cosAngle = std::cos(light.openingAngle);
+            if (light.openingAngle > float(M_PI) * 0.25f)
+            {
+                centerW = light.posW + light.dirW * (range * cosAngle);
+                radius = range * std::sin(light.openingAngle);
+            }
+            else
+            {
+                radius = range / (2.f * cosAngle);
+                centerW = light.posW + light.dirW * radius;
+            }
+        }
+        return true;
+    }
+}
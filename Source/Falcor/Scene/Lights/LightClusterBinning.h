@@ -0,0 +1,116 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "LightData.slang"
+#include "LightClustersData.slang"
+#include "Utils/Math/AABB.h"
+
+namespace Falcor
+{
+    /** Assigns lights to the clusters of a froxel grid on the CPU.
+        Point and spot lights are bounded by a sphere and added to the list of every froxel the sphere overlaps.
+        Their range is where the light's intensity falls below a cut-off. Lights without a finite range, i.e.
+        directional and area lights, are global and affect all clusters.
+        The class holds no GPU resources, see LightClusters for uploading the lists.
+
+        The result is a compact light index list. The global lights come first, followed by the lights of each cluster.
+        The cluster ranges hold the offset and count of each cluster's lights in the index list, indexed by getLightClusterIndex().
+
+        Usage per frame (and per eye in stereo rendering):
+        1. setView() with the eye's matrices. Froxel bounds are only recomputed when the projection changes.
+        2. bin() the lights.
+        3. Read the lists with getClusterRanges() and getLightIndices().
+    */
+    class dlldecl LightClusterBinning
+    {
+    public:
+        static const float kDefaultMinIntensity;
+
+        /** Constructor.
+            \param[in] gridDim Number of tiles in x and y and number of depth slices.
+        */
+        LightClusterBinning(uint3 gridDim = uint3(16, 9, 24));
+
+        /** Set the number of tiles and depth slices.
+        */
+        void setGridDim(uint3 gridDim);
+
+        /** Set the view the grid is built for.
+            \param[in] viewMat View matrix of the eye.
+            \param[in] projMat Perspective projection matrix of the eye. Off-center projections as used for stereo are supported.
+            \param[in] screenDim Screen size in pixels.
+            \param[in] nearZ View depth of the start of the first slice.
+            \param[in] farZ View depth of the end of the last slice.
+        */
+        void setView(const float4x4& viewMat, const float4x4& projMat, uint2 screenDim, float nearZ, float farZ);
+
+        /** Assign lights to clusters.
+            \param[in] lights Lights to bin. The light indices in the output lists refer to this array.
+            \param[in] minIntensity Intensity below which point and spot lights are assumed not to contribute.
+        */
+        void bin(const std::vector<LightData>& lights, float minIntensity = kDefaultMinIntensity);
+
+        /** Get the grid parameters to upload to the GPU.
+        */
+        const LightClusterGrid& getGrid() const { return mGrid; }
+
+        /** Get the offset and count of each cluster's lights in the light index list.
+        */
+        const std::vector<uint2>& getClusterRanges() const { return mClusterRanges; }
+
+        /** Get the light index list.
+        */
+        const std::vector<uint32_t>& getLightIndices() const { return mLightIndices; }
+
+        /** Get the view-space bounds of a cluster.
+        */
+        const BoundingBox& getClusterBounds(uint3 cluster) const { return mClusterBounds[getLightClusterIndex(cluster, mGrid)]; }
+
+        /** Get the world-space bounding sphere of a light.
+            \param[in] light Light data.
+            \param[in] minIntensity Intensity below which the light is assumed not to contribute.
+            \param[out] centerW Center of the bounding sphere.
+            \param[out] radius Radius of the bounding sphere. Zero if the light does not contribute anywhere.
+            \return False if the light has no finite range and affects all clusters.
+        */
+        static bool getLightBoundingSphere(const LightData& light, float minIntensity, float3& centerW, float& radius);
+
+    private:
+        void updateClusterBounds();
+
+        LightClusterGrid mGrid;
+        float4x4 mViewMat;
+        float4x4 mProjMat;
+        bool mDirty = true;                         ///< Set when the cluster bounds have to be recomputed.
+
+        std::vector<BoundingBox> mClusterBounds;    ///< View-space bounds of each cluster.
+        std::vector<uint2> mClusterRanges;
+        std::vector<uint32_t> mLightIndices;
+        std::vector<uint2> mAssignments;            ///< Scratch list of (cluster, light) pairs.
+    };
+}
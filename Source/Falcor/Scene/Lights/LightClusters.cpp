@@ -0,0 +1,116 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "LightClusters.h"
+#include "Scene/Camera/Camera.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Upload a list into a structured buffer, reallocating it if it is too small.
+        */
+        template<typename T>
+        void uploadList(Buffer::SharedPtr& pBuffer, const std::vector<T>& list, const std::string& name)
+        {
+            const uint32_t count = std::max((uint32_t)list.size(), 1u);
+            if (!pBuffer || pBuffer->getElementCount() < count)
+            {
+                // Grow with some headroom so that the buffer is not reallocated every time a light moves.
+                pBuffer = Buffer::createStructured(sizeof(T), count + count / 2, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+                pBuffer->setName(name);
+            }
+            if (!list.empty()) pBuffer->setBlob(list.data(), 0, list.size() * sizeof(T));
+        }
+    }
+
+    LightClusters::SharedPtr LightClusters::create(uint3 gridDim)
+    {
+        return SharedPtr(new LightClusters(gridDim));
+    }
+
+    LightClusters::LightClusters(uint3 gridDim)
+        : mBinning(gridDim)
+    {
+    }
+
+    void LightClusters::build(const Scene* pScene, const Camera* pCamera, uint32_t eye, uint2 screenDim)
+    {
+        PROFILE("buildLightClusters");
+
+        assert(pScene && pCamera && eye < 2);
+        assert(eye == 0 || pCamera->hasRightEye());
+
+        const float4x4& viewMat = eye == 0 ? pCamera->getViewMatrix() : pCamera->getRightEyeViewMatrix();
+        const float4x4& projMat = eye == 0 ? pCamera->getProjMatrix() : pCamera->getRightEyeProjMatrix();
+        const float farZ = pCamera->getFarPlane();
+        const float nearZ = std::min(std::max(pCamera->getNearPlane(), mMinSliceDepth), 0.5f * farZ);
+        mBinning.setView(viewMat, projMat, screenDim, nearZ, farZ);
+
+        mLights.resize(pScene->getLightCount());
+        for (uint32_t i = 0; i < pScene->getLightCount(); i++) mLights[i] = pScene->getLight(i)->getData();
+        mBinning.bin(mLights, mMinIntensity);
+
+        uploadList(mpClusterRanges, mBinning.getClusterRanges(), "LightClusters::ClusterRanges");
+        uploadList(mpLightIndices, mBinning.getLightIndices(), "LightClusters::LightIndices");
+    }
+
+    void LightClusters::setShaderData(const ShaderVar& var) const
+    {
+        if (!mpClusterRanges)
+        {
+            logWarning("LightClusters::setShaderData() called before build(). Ignoring.");
+            return;
+        }
+        var["LightClustersCB"]["gLightClusterGrid"].setBlob(mBinning.getGrid());
+        var["gLightClusterRanges"] = mpClusterRanges;
+        var["gLightClusterIndices"] = mpLightIndices;
+    }
+
+    void LightClusters::renderUI(Gui::Widgets& widget)
+    {
+        uint3 dim = mBinning.getGrid().dim;
+        if (widget.var("Grid size", dim, 1u, 64u)) mBinning.setGridDim(dim);
+        widget.tooltip("Number of tiles in x and y and number of depth slices.", true);
+        widget.var("Min slice depth", mMinSliceDepth, 0.01f, 100.f, 0.01f);
+        widget.tooltip("View depth at which the exponential depth slicing starts. Nearer points all fall into the first slice.", true);
+        widget.var("Min intensity", mMinIntensity, 0.0001f, 1.f, 0.0001f);
+        widget.tooltip("Intensity below which point and spot lights are culled. Lower values increase the light range and the cost of the lighting.", true);
+
+        const auto& ranges = mBinning.getClusterRanges();
+        uint32_t maxCount = 0;
+        for (const auto& range : ranges) maxCount = std::max(maxCount, range.y);
+        const uint32_t globalCount = mBinning.getGrid().globalLightCount;
+        const uint32_t clusterEntries = (uint32_t)mBinning.getLightIndices().size() - globalCount;
+        std::ostringstream oss;
+        oss << "Global lights: " << globalCount << "\n"
+            << "Avg lights per cluster: " << (ranges.empty() ? 0.f : float(clusterEntries) / ranges.size()) << "\n"
+            << "Max lights per cluster: " << maxCount;
+        widget.text(oss.str());
+    }
+}
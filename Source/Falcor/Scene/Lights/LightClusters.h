@@ -0,0 +1,96 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "LightClusterBinning.h"
+#include "Scene/Scene.h"
+
+namespace Falcor
+{
+    class Camera;
+
+    /** Clustered light culling for passes shading with the analytic lights of a scene.
+        The lights are binned into a froxel grid on the CPU with LightClusterBinning and the compact per-cluster
+        light lists are uploaded to the GPU. Shaders look up the lights affecting a point with Scene/Lights/LightClusters.slang
+        and only loop over those, instead of looping over all lights of the scene.
+
+        Usage per frame (and per eye in stereo rendering, with one object per eye):
+        1. build() the clusters for the eye's view.
+        2. Bind them with setShaderData() to the passes that do the lighting.
+    */
+    class dlldecl LightClusters
+    {
+    public:
+        using SharedPtr = std::shared_ptr<LightClusters>;
+
+        /** Create a new object.
+            \param[in] gridDim Number of tiles in x and y and number of depth slices.
+            \return New object, or throws an exception on error.
+        */
+        static SharedPtr create(uint3 gridDim = uint3(16, 9, 24));
+
+        /** Bin the scene's lights for one eye of a camera and upload the lists.
+            \param[in] pScene Scene whose lights are binned.
+            \param[in] pCamera Camera.
+            \param[in] eye 0 for the camera's own view, 1 for the right eye of a stereo camera, see Camera::setRightEyeMatrices().
+            \param[in] screenDim Screen size in pixels.
+        */
+        void build(const Scene* pScene, const Camera* pCamera, uint32_t eye, uint2 screenDim);
+
+        /** Bind the clusters to a program importing Scene/Lights/LightClusters.slang.
+        */
+        void setShaderData(const ShaderVar& var) const;
+
+        /** Set the intensity below which point and spot lights are assumed not to contribute.
+            Lower values give the lights a larger range and increase the number of lights per cluster.
+        */
+        void setMinIntensity(float minIntensity) { mMinIntensity = minIntensity; }
+
+        /** Get the intensity below which point and spot lights are assumed not to contribute.
+        */
+        float getMinIntensity() const { return mMinIntensity; }
+
+        /** Get the CPU binning, e.g. for inspecting the lists.
+        */
+        const LightClusterBinning& getBinning() const { return mBinning; }
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        LightClusters(uint3 gridDim);
+
+        LightClusterBinning mBinning;
+        float mMinIntensity = LightClusterBinning::kDefaultMinIntensity;
+        float mMinSliceDepth = 0.5f;        ///< View depth at which the depth slicing starts. Avoids wasting slices close to the eye.
+        std::vector<LightData> mLights;     ///< Scratch list of the scene's light data.
+
+        Buffer::SharedPtr mpClusterRanges;
+        Buffer::SharedPtr mpLightIndices;
+    };
+}
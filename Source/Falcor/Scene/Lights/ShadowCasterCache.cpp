@@ -0,0 +1,104 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ShadowCasterCache.h"
+
+namespace Falcor
+{
+    ShadowCasterCache::ShadowCasterCache(uint32_t staticFrameCount, float lightDirThreshold)
+        : mStaticFrameCount(staticFrameCount)
+        , mLightDirThreshold(lightDirThreshold)
+    {
+    }
+
+    ShadowCasterCache::Update ShadowCasterCache::update(const float3& lightDir, const std::vector<BoundingBox>& casterBounds, const std::vector<bool>& alwaysDynamic)
+    {
+        assert(alwaysDynamic.empty() || alwaysDynamic.size() == casterBounds.size());
+        mAppendedCasters.clear();
+        bool rebuild = !mValid;
+        bool listsChanged = rebuild;
+
+        // Start a new set of casters as static. Casters that move are demoted in the following frames.
+        if (casterBounds.size() != mCasters.size())
+        {
+            mCasters.assign(casterBounds.size(), {});
+            for (size_t i = 0; i < casterBounds.size(); i++) mCasters[i].bounds = casterBounds[i];
+            rebuild = listsChanged = true;
+        }
+
+        const float3 dir = glm::normalize(lightDir);
+        if (glm::dot(dir, mLightDir) < mLightDirThreshold)
+        {
+            mLightDir = dir;
+            rebuild = true;
+        }
+
+        for (uint32_t i = 0; i < (uint32_t)mCasters.size(); i++)
+        {
+            Caster& caster = mCasters[i];
+            const BoundingBox& bounds = casterBounds[i];
+            const bool moved = caster.bounds.center != bounds.center || caster.bounds.extent != bounds.extent;
+            caster.bounds = bounds;
+
+            if (moved || (!alwaysDynamic.empty() && alwaysDynamic[i]))
+            {
+                caster.unchangedFrames = 0;
+                if (caster.isStatic)
+                {
+                    // The caster's old footprint is baked into the cached map
+                    caster.isStatic = false;
+                    rebuild = listsChanged = true;
+                }
+            }
+            else if (!caster.isStatic && ++caster.unchangedFrames >= mStaticFrameCount)
+            {
+                caster.isStatic = true;
+                mAppendedCasters.push_back(i);
+                listsChanged = true;
+            }
+        }
+
+        if (listsChanged)
+        {
+            mStaticCasters.clear();
+            mDynamicCasters.clear();
+            for (uint32_t i = 0; i < (uint32_t)mCasters.size(); i++)
+            {
+                (mCasters[i].isStatic ? mStaticCasters : mDynamicCasters).push_back(i);
+            }
+        }
+
+        mValid = true;
+        if (rebuild)
+        {
+            mAppendedCasters.clear();
+            return Update::Rebuild;
+        }
+        return mAppendedCasters.empty() ? Update::None : Update::Append;
+    }
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/AABB.h"
+
+namespace Falcor
+{
+    /** Tracks which shadow casters of a static light can be served from a cached shadow map.
+        Casters are split into static casters, rendered once into a cached depth map, and dynamic casters, rendered
+        every frame on top of a copy of the cached map. A caster becomes dynamic as soon as its bounds change, and
+        static again after its bounds stayed unchanged for a number of frames.
+        The class holds no GPU resources. The caller renders the caster lists it returns.
+
+        Usage per frame:
+        1. update() with the light direction and the world-space bounds of all casters.
+        2. On Update::Rebuild, clear the cached map and render getStaticCasters() into it.
+           On Update::Append, render getAppendedCasters() into the cached map. Adding casters to a depth map never needs a clear.
+        3. Copy the cached map to the output and render getDynamicCasters() into it.
+    */
+    class dlldecl ShadowCasterCache
+    {
+    public:
+        static const uint32_t kDefaultStaticFrameCount = 30;
+
+        enum class Update
+        {
+            None,       ///< The cached map is up to date.
+            Append,     ///< Casters became static. Render getAppendedCasters() into the cached map.
+            Rebuild,    ///< The cached map is invalid. Clear it and render getStaticCasters().
+        };
+
+        /** Constructor.
+            \param[in] staticFrameCount Number of consecutive frames a dynamic caster's bounds must stay unchanged before it becomes static.
+            \param[in] lightDirThreshold Cosine of the angle the light direction can deviate from the cached direction before the cache is rebuilt.
+        */
+        ShadowCasterCache(uint32_t staticFrameCount = kDefaultStaticFrameCount, float lightDirThreshold = 0.99995f);
+
+        /** Update the caster classification.
+            \param[in] lightDir Light direction in world space.
+            \param[in] casterBounds World-space bounds of all casters. A change in the number of casters rebuilds the cache.
+            \param[in] alwaysDynamic Optional flags of casters that are never cached, e.g. skinned meshes that can move without changing their bounds.
+            \return How the cached map needs to be updated.
+        */
+        Update update(const float3& lightDir, const std::vector<BoundingBox>& casterBounds, const std::vector<bool>& alwaysDynamic = {});
+
+        /** Force a rebuild on the next update(), e.g. after the cached map was resized.
+        */
+        void invalidate() { mValid = false; }
+
+        /** Check if a caster is currently static.
+        */
+        bool isStatic(uint32_t caster) const { return mCasters[caster].isStatic; }
+
+        /** Get the static casters. The list changes only when update() returns something other than Update::None.
+        */
+        const std::vector<uint32_t>& getStaticCasters() const { return mStaticCasters; }
+
+        /** Get the dynamic casters. The list changes only when update() returns something other than Update::None.
+        */
+        const std::vector<uint32_t>& getDynamicCasters() const { return mDynamicCasters; }
+
+        /** Get the casters that became static in the last update(). Only valid if it returned Update::Append.
+        */
+        const std::vector<uint32_t>& getAppendedCasters() const { return mAppendedCasters; }
+
+    private:
+        struct Caster
+        {
+            BoundingBox bounds;
+            uint32_t unchangedFrames = 0;
+            bool isStatic = true;
+        };
+
+        uint32_t mStaticFrameCount;
+        float mLightDirThreshold;
+
+        bool mValid = false;
+        float3 mLightDir = float3(0.f);
+        std::vector<Caster> mCasters;
+        std::vector<uint32_t> mStaticCasters;
+        std::vector<uint32_t> mDynamicCasters;
+        std::vector<uint32_t> mAppendedCasters;
+    };
+}
@@ -333,6 +333,37 @@ namespace Falcor
         return true;
     }
 
+    size_t Material::getHash() const
+    {
+        // Must be kept in sync with operator==.
+        size_t hash = 0;
+        auto combine = [&hash](size_t h) { hash ^= h + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2); };
+        // Add 0.f so that -0.f and +0.f hash the same, as they compare equal.
+        auto hashFloats = [&combine](const float* pData, size_t count) { for (size_t i = 0; i < count; i++) combine(std::hash<float>()(pData[i] + 0.f)); };
+
+#define hash_field(_a) hashFloats(reinterpret_cast<const float*>(&mData._a), sizeof(mData._a) / sizeof(float))
+        hash_field(baseColor);
+        hash_field(specular);
+        hash_field(emissive);
+        hash_field(emissiveFactor);
+        hash_field(alphaThreshold);
+        hash_field(IoR);
+        hash_field(specularTransmission);
+        hash_field(volumeAbsorption);
+#undef hash_field
+        combine(std::hash<uint32_t>()(mData.flags));
+
+#define hash_texture(_a) combine(std::hash<const Texture*>()(mResources._a.get()))
+        hash_texture(baseColor);
+        hash_texture(specular);
+        hash_texture(emissive);
+        hash_texture(normalMap);
+        hash_texture(occlusionMap);
+#undef hash_texture
+        combine(std::hash<const Sampler*>()(mResources.samplerState.get()));
+        return hash;
+    }
+
     void Material::markUpdates(UpdateFlags updates)
     {
         mUpdates |= updates;
@@ -260,6 +260,11 @@ namespace Falcor
         */
         bool operator==(const Material& other) const;
 
+        /** Returns a hash of the material properties and the identities of the bound textures and sampler.
+            Materials that compare equal with operator== are guaranteed to have the same hash. The name is not included.
+        */
+        size_t getHash() const;
+
         /** Bind a sampler to the material
         */
         void setSampler(Sampler::SharedPtr pSampler);
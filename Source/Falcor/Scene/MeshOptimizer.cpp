@@ -0,0 +1,375 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "MeshOptimizer.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // Parameters of the vertex cache optimization. See "Linear-Speed Vertex Cache Optimisation", Tom Forsyth, 2006.
+        const uint32_t kForsythCacheSize = 32;
+        const float kCacheDecayPower = 1.5f;
+        const float kLastTriScore = 0.75f;
+        const float kValenceBoostScale = 2.0f;
+        const float kValenceBoostPower = 0.5f;
+
+        float computeVertexScore(int32_t cachePosition, uint32_t remainingValence)
+        {
+            // Vertices without remaining triangles don't contribute.
+            if (remainingValence == 0) return -1.f;
+
+            float score = 0.f;
+            if (cachePosition >= 0)
+            {
+                // The vertices of the last triangle get a fixed score so that we don't favor any particular one of them.
+                if (cachePosition < 3) score = kLastTriScore;
+                else
+                {
+                    const float scaler = 1.f / (kForsythCacheSize - 3);
+                    score = std::pow(1.f - (cachePosition - 3) * scaler, kCacheDecayPower);
+                }
+            }
+
+            // Boost vertices with few remaining triangles to get rid of lone triangles early.
+            score += kValenceBoostScale * std::pow((float)remainingValence, -kValenceBoostPower);
+            return score;
+        }
+
+        size_t hashBytes(const uint8_t* pData, size_t size)
+        {
+            // FNV-1a
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= pData[i];
+                hash *= 1099511628211ull;
+            }
+            return (size_t)hash;
+        }
+
+        void computeMeshletBounds(MeshletDesc& meshlet, const uint32_t* pIndices, const float3* pPositions)
+        {
+            const uint32_t* pMeshletIndices = pIndices + meshlet.indexOffset;
+            const uint32_t indexCount = meshlet.triangleCount * 3;
+
+            // Bounding sphere centered at the bounding box center.
+            float3 boxMin(FLT_MAX);
+            float3 boxMax(-FLT_MAX);
+            for (uint32_t i = 0; i < indexCount; i++)
+            {
+                boxMin = glm::min(boxMin, pPositions[pMeshletIndices[i]]);
+                boxMax = glm::max(boxMax, pPositions[pMeshletIndices[i]]);
+            }
+            meshlet.center = (boxMin + boxMax) * 0.5f;
+            meshlet.radius = 0.f;
+            for (uint32_t i = 0; i < indexCount; i++)
+            {
+                meshlet.radius = std::max(meshlet.radius, glm::length(pPositions[pMeshletIndices[i]] - meshlet.center));
+            }
+
+            // Normal cone around the average triangle normal. Degenerate triangles are ignored.
+            std::vector<float3> normals;
+            normals.reserve(meshlet.triangleCount);
+            float3 axis(0.f);
+            for (uint32_t i = 0; i < indexCount; i += 3)
+            {
+                const float3& p0 = pPositions[pMeshletIndices[i + 0]];
+                const float3& p1 = pPositions[pMeshletIndices[i + 1]];
+                const float3& p2 = pPositions[pMeshletIndices[i + 2]];
+                float3 n = glm::cross(p1 - p0, p2 - p0);
+                float len = glm::length(n);
+                if (len == 0.f) continue;
+                normals.push_back(n / len);
+                axis += normals.back();
+            }
+
+            float axisLength = glm::length(axis);
+            meshlet.coneAxis = axisLength > 0.f ? axis / axisLength : float3(0.f, 0.f, 1.f);
+            meshlet.coneCutoff = 1.f;
+            if (axisLength == 0.f) return;
+
+            float minDot = 1.f;
+            for (const auto& n : normals) minDot = std::min(minDot, glm::dot(n, meshlet.coneAxis));
+
+            // Wide cones are practically never culled, so we disable culling for them. Otherwise store the sine of the cone spread angle.
+            if (minDot > 0.1f) meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+        }
+    }
+
+    MeshOptimizer::Stats MeshOptimizer::computeStats(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        Stats stats;
+        stats.triangleCount = indexCount / 3;
+        stats.vertexCount = vertexCount;
+
+        // A vertex is in the FIFO cache if fewer than cacheSize vertices were transformed since it was transformed.
+        std::vector<uint64_t> timestamps(vertexCount, 0);
+        uint64_t time = cacheSize + 1;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t v = pIndices[i];
+            assert(v < vertexCount);
+            if (time - timestamps[v] > cacheSize)
+            {
+                timestamps[v] = time++;
+                stats.transformedVertexCount++;
+            }
+        }
+        return stats;
+    }
+
+    uint32_t MeshOptimizer::weldVertices(const void* pVertices, uint32_t vertexCount, size_t vertexStride, std::vector<uint32_t>& remap)
+    {
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(pVertices);
+        std::unordered_multimap<size_t, uint32_t> uniqueVertices;
+        uniqueVertices.reserve(vertexCount);
+
+        remap.resize(vertexCount);
+        uint32_t uniqueCount = 0;
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            const uint8_t* pVertex = pData + i * vertexStride;
+            const size_t hash = hashBytes(pVertex, vertexStride);
+
+            remap[i] = kInvalidIndex;
+            auto range = uniqueVertices.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (std::memcmp(pData + it->second * vertexStride, pVertex, vertexStride) == 0)
+                {
+                    remap[i] = remap[it->second];
+                    break;
+                }
+            }
+
+            if (remap[i] == kInvalidIndex)
+            {
+                remap[i] = uniqueCount++;
+                uniqueVertices.emplace(hash, i);
+            }
+        }
+        return uniqueCount;
+    }
+
+    void MeshOptimizer::optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount)
+    {
+        assert(indexCount % 3 == 0);
+        assert(indexCount / 3 <= UINT32_MAX);
+        const uint32_t triangleCount = (uint32_t)(indexCount / 3);
+        if (triangleCount == 0) return;
+
+        // Build the vertex to triangle adjacency. Each vertex keeps its not yet emitted triangles at the front of its list.
+        std::vector<uint32_t> remainingValence(vertexCount, 0);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            assert(pIndices[i] < vertexCount);
+            remainingValence[pIndices[i]]++;
+        }
+
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + remainingValence[v];
+
+        std::vector<uint32_t> adjacency(indexCount);
+        {
+            std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                for (uint32_t j = 0; j < 3; j++) adjacency[fill[pIndices[t * 3 + j]]++] = t;
+            }
+        }
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) vertexScore[v] = computeVertexScore(-1, remainingValence[v]);
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        uint32_t bestTriangle = kInvalidIndex;
+        float bestScore = -1.f;
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            triangleScore[t] = vertexScore[pIndices[t * 3]] + vertexScore[pIndices[t * 3 + 1]] + vertexScore[pIndices[t * 3 + 2]];
+            if (triangleScore[t] > bestScore)
+            {
+                bestScore = triangleScore[t];
+                bestTriangle = t;
+            }
+        }
+
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+        std::vector<uint32_t> cache, newCache;
+        cache.reserve(kForsythCacheSize + 3);
+        newCache.reserve(kForsythCacheSize + 3);
+        uint32_t cursor = 0;
+
+        for (uint32_t i = 0; i < triangleCount; i++)
+        {
+            // If no triangle touches the cache, continue with the next triangle in input order.
+            if (bestTriangle == kInvalidIndex)
+            {
+                while (emitted[cursor]) cursor++;
+                bestTriangle = cursor;
+            }
+
+            const uint32_t t = bestTriangle;
+            const uint32_t* tri = pIndices + t * 3;
+            emitted[t] = true;
+
+            // Emit the triangle and remove it from the adjacency of its vertices.
+            newCache.clear();
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                const uint32_t v = tri[j];
+                output.push_back(v);
+
+                uint32_t* pAdj = adjacency.data() + adjacencyOffset[v];
+                uint32_t* pEnd = pAdj + remainingValence[v];
+                uint32_t* pIt = std::find(pAdj, pEnd, t);
+                if (pIt != pEnd)
+                {
+                    std::swap(*pIt, *(pEnd - 1));
+                    remainingValence[v]--;
+                }
+                if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+            }
+
+            // The triangle's vertices move to the front of the LRU cache.
+            for (uint32_t v : cache)
+            {
+                if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+            }
+
+            // Update the scores of the vertices in the cache, including those that just got evicted.
+            for (uint32_t j = 0; j < (uint32_t)newCache.size(); j++)
+            {
+                const uint32_t v = newCache[j];
+                cachePosition[v] = j < kForsythCacheSize ? (int32_t)j : -1;
+                vertexScore[v] = computeVertexScore(cachePosition[v], remainingValence[v]);
+            }
+            if (newCache.size() > kForsythCacheSize) newCache.resize(kForsythCacheSize);
+            std::swap(cache, newCache);
+
+            // Update the triangle scores and find the next best triangle among those touching the cache.
+            bestTriangle = kInvalidIndex;
+            bestScore = -1.f;
+            for (uint32_t v : cache)
+            {
+                for (uint32_t k = 0; k < remainingValence[v]; k++)
+                {
+                    const uint32_t adjTri = adjacency[adjacencyOffset[v] + k];
+                    const uint32_t* adjIndices = pIndices + adjTri * 3;
+                    triangleScore[adjTri] = vertexScore[adjIndices[0]] + vertexScore[adjIndices[1]] + vertexScore[adjIndices[2]];
+                    if (triangleScore[adjTri] > bestScore)
+                    {
+                        bestScore = triangleScore[adjTri];
+                        bestTriangle = adjTri;
+                    }
+                }
+            }
+        }
+
+        std::copy(output.begin(), output.end(), pIndices);
+    }
+
+    uint32_t MeshOptimizer::optimizeVertexFetch(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, std::vector<uint32_t>& remap)
+    {
+        remap.assign(vertexCount, kInvalidIndex);
+        uint32_t nextVertex = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            const uint32_t v = pIndices[i];
+            assert(v < vertexCount);
+            if (remap[v] == kInvalidIndex) remap[v] = nextVertex++;
+        }
+        return nextVertex;
+    }
+
+    void MeshOptimizer::remapIndices(uint32_t* pIndices, size_t indexCount, const std::vector<uint32_t>& remap)
+    {
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            assert(pIndices[i] < remap.size() && remap[pIndices[i]] != kInvalidIndex);
+            pIndices[i] = remap[pIndices[i]];
+        }
+    }
+
+    std::vector<MeshletDesc> MeshOptimizer::buildMeshlets(const uint32_t* pIndices, size_t indexCount, const float3* pPositions, uint32_t maxVertices, uint32_t maxTriangles)
+    {
+        assert(indexCount % 3 == 0);
+        assert(maxVertices >= 3 && maxTriangles >= 1);
+
+        std::vector<MeshletDesc> meshlets;
+        if (indexCount == 0) return meshlets;
+
+        // For each vertex, the index of the last meshlet that referenced it.
+        const uint32_t maxIndex = *std::max_element(pIndices, pIndices + indexCount);
+        std::vector<uint32_t> lastMeshlet(maxIndex + 1, kInvalidIndex);
+
+        MeshletDesc meshlet = {};
+        uint32_t meshletIndex = 0;
+
+        auto countNewVertices = [&](const uint32_t* tri)
+        {
+            uint32_t count = 0;
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                // Count each vertex once, even if the triangle is degenerate.
+                bool duplicate = (j > 0 && tri[j] == tri[0]) || (j > 1 && tri[j] == tri[1]);
+                if (!duplicate && lastMeshlet[tri[j]] != meshletIndex) count++;
+            }
+            return count;
+        };
+
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            const uint32_t* tri = pIndices + i;
+            uint32_t newVertices = countNewVertices(tri);
+
+            if (meshlet.triangleCount > 0 && (meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles))
+            {
+                computeMeshletBounds(meshlet, pIndices, pPositions);
+                meshlets.push_back(meshlet);
+
+                meshlet = {};
+                meshlet.indexOffset = (uint32_t)i;
+                meshletIndex++;
+                newVertices = countNewVertices(tri);
+            }
+
+            for (uint32_t j = 0; j < 3; j++) lastMeshlet[tri[j]] = meshletIndex;
+            meshlet.vertexCount += newVertices;
+            meshlet.triangleCount++;
+        }
+
+        computeMeshletBounds(meshlet, pIndices, pPositions);
+        meshlets.push_back(meshlet);
+        return meshlets;
+    }
+}
@@ -0,0 +1,151 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SceneTypes.slang"
+
+namespace Falcor
+{
+    /** Utility functions for optimizing indexed triangle meshes for rasterization.
+        All functions operate on triangle lists. Index buffers are modified in place and vertex reorderings are returned as remap tables,
+        so that the caller can apply them to any vertex format.
+    */
+    class dlldecl MeshOptimizer
+    {
+    public:
+        static constexpr uint32_t kInvalidIndex = -1;
+        static constexpr uint32_t kDefaultCacheSize = 16;           ///< FIFO cache size used for the statistics. Matches the typical post-transform cache of current GPUs.
+        static constexpr uint32_t kDefaultMeshletMaxVertices = 64;
+        static constexpr uint32_t kDefaultMeshletMaxTriangles = 124;
+
+        /** Post-transform vertex cache statistics.
+        */
+        struct Stats
+        {
+            uint64_t triangleCount = 0;             ///< Number of triangles.
+            uint64_t vertexCount = 0;               ///< Number of vertices in the vertex buffer.
+            uint64_t transformedVertexCount = 0;    ///< Number of vertex shader invocations with a simulated FIFO cache.
+
+            /** Average cache miss ratio: transformed vertices per triangle. Ranges from 0.5 (ideal) to 3.
+            */
+            float getACMR() const { return triangleCount ? (float)transformedVertexCount / triangleCount : 0.f; }
+
+            /** Average transform to vertex ratio: transformed vertices per vertex. 1 is ideal.
+            */
+            float getATVR() const { return vertexCount ? (float)transformedVertexCount / vertexCount : 0.f; }
+
+            Stats& operator+=(const Stats& other)
+            {
+                triangleCount += other.triangleCount;
+                vertexCount += other.vertexCount;
+                transformedVertexCount += other.transformedVertexCount;
+                return *this;
+            }
+        };
+
+        /** Simulate a FIFO post-transform vertex cache.
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices.
+            \param[in] vertexCount Number of vertices.
+            \param[in] cacheSize Number of entries in the simulated cache.
+            \return The cache statistics.
+        */
+        static Stats computeStats(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Find vertices with identical data.
+            The vertices are compared bitwise, so the vertex type must not contain padding.
+            \param[in] pVertices Vertex data.
+            \param[in] vertexCount Number of vertices.
+            \param[in] vertexStride Size of a vertex in bytes.
+            \param[out] remap For each vertex, the index of the welded vertex. Welded vertices are numbered in order of first occurrence.
+            \return The number of unique vertices.
+        */
+        static uint32_t weldVertices(const void* pVertices, uint32_t vertexCount, size_t vertexStride, std::vector<uint32_t>& remap);
+
+        /** Reorder triangles to improve post-transform vertex cache efficiency.
+            Uses Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" algorithm, which is independent of the exact cache size.
+            \param[in,out] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices. Must be a multiple of 3.
+            \param[in] vertexCount Number of vertices.
+        */
+        static void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount);
+
+        /** Compute a vertex order for fetch locality. Vertices are numbered in the order they are first referenced by the index buffer.
+            Unreferenced vertices are dropped and mapped to kInvalidIndex. Call this after optimizeVertexCache().
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices.
+            \param[in] vertexCount Number of vertices.
+            \param[out] remap For each vertex, the new index.
+            \return The number of referenced vertices.
+        */
+        static uint32_t optimizeVertexFetch(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, std::vector<uint32_t>& remap);
+
+        /** Apply a remap table to an index buffer.
+        */
+        static void remapIndices(uint32_t* pIndices, size_t indexCount, const std::vector<uint32_t>& remap);
+
+        /** Apply a remap table to a vertex buffer. If several vertices map to the same index, the first one is kept.
+            \param[in] vertices Vertex data.
+            \param[in] remap Remap table from weldVertices() or optimizeVertexFetch().
+            \param[in] newVertexCount Number of vertices after remapping.
+            \return The remapped vertex data.
+        */
+        template<typename T>
+        static std::vector<T> remapVertices(const std::vector<T>& vertices, const std::vector<uint32_t>& remap, uint32_t newVertexCount)
+        {
+            assert(vertices.size() == remap.size());
+            std::vector<T> result;
+            result.reserve(newVertexCount);
+            std::vector<uint32_t> sourceIndex(newVertexCount, kInvalidIndex);
+            for (uint32_t i = 0; i < (uint32_t)remap.size(); i++)
+            {
+                if (remap[i] != kInvalidIndex && sourceIndex[remap[i]] == kInvalidIndex) sourceIndex[remap[i]] = i;
+            }
+            for (uint32_t i : sourceIndex) result.push_back(vertices[i]);
+            return result;
+        }
+
+        /** Split a mesh into meshlets with a bounded number of vertices and triangles.
+            Meshlets are formed from consecutive triangles, so they map to contiguous ranges in the index buffer. Call this after optimizeVertexCache().
+            Each meshlet has a bounding sphere and a normal cone for backface culling, see MeshletDesc.
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices.
+            \param[in] pPositions Vertex positions.
+            \param[in] maxVertices Maximum number of unique vertices per meshlet.
+            \param[in] maxTriangles Maximum number of triangles per meshlet.
+            \return List of meshlets, with index offsets relative to pIndices.
+        */
+        static std::vector<MeshletDesc> buildMeshlets(const uint32_t* pIndices, size_t indexCount, const float3* pPositions, uint32_t maxVertices = kDefaultMeshletMaxVertices, uint32_t maxTriangles = kDefaultMeshletMaxTriangles);
+    };
+
+    inline std::string to_string(const MeshOptimizer::Stats& stats)
+    {
+        std::string s = "ACMR " + std::to_string(stats.getACMR()) + ", ATVR " + std::to_string(stats.getATVR());
+        s += " (" + std::to_string(stats.triangleCount) + " triangles, " + std::to_string(stats.vertexCount) + " vertices)";
+        return s;
+    }
+}
@@ -122,6 +122,7 @@ namespace Falcor
         Shader::DefineList defines;
         defines.add("MATERIAL_COUNT", std::to_string(mMaterials.size()));
         defines.add(HitInfo::getDefines(this));
+        defines.add("SCENE_COMPACT_VERTICES", mpCompactVao ? "1" : "0");
         return defines;
     }
 
@@ -136,25 +137,32 @@ namespace Falcor
     }
 
     void Scene::render(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, RenderFlags flags)
+    {
+        render(pContext, pState, pVars, mDrawList, flags);
+    }
+
+    void Scene::render(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const DrawList& drawList, RenderFlags flags)
     {
         PROFILE("renderScene");
 
-        pState->setVao(mpVao);
+        pState->setVao(mpCompactVao ? mpCompactVao : mpVao);
         pVars->setParameterBlock("gScene", mpSceneBlock);
 
         bool overrideRS = !is_set(flags, RenderFlags::UserRasterizerState);
         auto pCurrentRS = pState->getRasterizerState();
 
-        if (mDrawCounterClockwiseMeshes.count)
+        const auto& ccw = drawList.counterClockwise;
+        if (ccw.count)
         {
             if (overrideRS) pState->setRasterizerState(nullptr);
-            pContext->drawIndexedIndirect(pState, pVars, mDrawCounterClockwiseMeshes.count, mDrawCounterClockwiseMeshes.pBuffer.get(), 0, nullptr, 0);
+            pContext->drawIndexedIndirect(pState, pVars, ccw.count, ccw.pBuffer.get(), 0, ccw.pCountBuffer.get(), ccw.countOffset);
         }
 
-        if (mDrawClockwiseMeshes.count)
+        const auto& cw = drawList.clockwise;
+        if (cw.count)
         {
             if (overrideRS) pState->setRasterizerState(mpFrontClockwiseRS);
-            pContext->drawIndexedIndirect(pState, pVars, mDrawClockwiseMeshes.count, mDrawClockwiseMeshes.pBuffer.get(), 0, nullptr, 0);
+            pContext->drawIndexedIndirect(pState, pVars, cw.count, cw.pBuffer.get(), 0, cw.pCountBuffer.get(), cw.countOffset);
         }
 
         if (overrideRS) pState->setRasterizerState(pCurrentRS);
@@ -264,6 +272,12 @@ namespace Falcor
         }
     }
 
+    BoundingBox Scene::getMeshInstanceBounds(uint32_t instanceID) const
+    {
+        const auto& inst = mMeshInstanceData[instanceID];
+        return mMeshBBs[inst.meshID].transform(mpAnimationController->getGlobalMatrices()[inst.globalMatrixID]);
+    }
+
     void Scene::updateMeshInstanceFlags()
     {
         for (auto& inst : mMeshInstanceData)
@@ -370,6 +384,7 @@ namespace Falcor
 
     Scene::UpdateFlags Scene::updateCamera(bool forceUpdate)
     {
+        PROFILE_ZONE("Scene::updateCamera");
         UpdateFlags flags = UpdateFlags::None;
         mCamera.enabled(forceUpdate) ? mCamera.update(mpAnimationController.get(), forceUpdate) : mpCamCtrl->update();
         auto cameraChanges = mCamera.pObject->beginFrame();
@@ -384,6 +399,7 @@ namespace Falcor
 
     Scene::UpdateFlags Scene::updateLights(bool forceUpdate)
     {
+        PROFILE_ZONE("Scene::updateLights");
         UpdateFlags flags = UpdateFlags::None;
 
         for (size_t i = 0; i < mLights.size(); i++)
@@ -408,6 +424,7 @@ namespace Falcor
 
     Scene::UpdateFlags Scene::updateMaterials(bool forceUpdate)
     {
+        PROFILE_ZONE("Scene::updateMaterials");
         UpdateFlags flags = UpdateFlags::None;
 
         // Early out if no materials have changed
@@ -448,7 +465,6 @@ namespace Falcor
         mUpdates |= updateCamera(false);
         mUpdates |= updateLights(false);
         mUpdates |= updateMaterials(false);
-        pContext->flush();
         if (is_set(mUpdates, UpdateFlags::MeshesMoved))
         {
             mTlasCache.clear();
@@ -677,23 +693,60 @@ namespace Falcor
             (doesTransformFlip(transform)) ? drawClockwiseMeshes.push_back(draw) : drawCounterClockwiseMeshes.push_back(draw);
         }
 
-        // Create the draw-indirect buffer
+        // Create the draw-indirect buffers. They are also bound as shader resources so that culling passes can read them.
+        const Resource::BindFlags bindFlags = Resource::BindFlags::IndirectArg | Resource::BindFlags::ShaderResource;
         if (drawCounterClockwiseMeshes.size())
         {
-            mDrawCounterClockwiseMeshes.pBuffer = Buffer::create(sizeof(drawCounterClockwiseMeshes[0]) * drawCounterClockwiseMeshes.size(), Resource::BindFlags::IndirectArg, Buffer::CpuAccess::None, drawCounterClockwiseMeshes.data());
-            mDrawCounterClockwiseMeshes.count = (uint32_t)drawCounterClockwiseMeshes.size();
+            mDrawList.counterClockwise.pBuffer = Buffer::create(sizeof(drawCounterClockwiseMeshes[0]) * drawCounterClockwiseMeshes.size(), bindFlags, Buffer::CpuAccess::None, drawCounterClockwiseMeshes.data());
+            mDrawList.counterClockwise.count = (uint32_t)drawCounterClockwiseMeshes.size();
         }
 
         if (drawClockwiseMeshes.size())
         {
-            mDrawClockwiseMeshes.pBuffer = Buffer::create(sizeof(drawClockwiseMeshes[0]) * drawClockwiseMeshes.size(), Resource::BindFlags::IndirectArg, Buffer::CpuAccess::None, drawClockwiseMeshes.data());
-            mDrawClockwiseMeshes.count = (uint32_t)drawClockwiseMeshes.size();
+            mDrawList.clockwise.pBuffer = Buffer::create(sizeof(drawClockwiseMeshes[0]) * drawClockwiseMeshes.size(), bindFlags, Buffer::CpuAccess::None, drawClockwiseMeshes.data());
+            mDrawList.clockwise.count = (uint32_t)drawClockwiseMeshes.size();
         }
 
         size_t drawCount = drawClockwiseMeshes.size() + drawCounterClockwiseMeshes.size();
         assert(drawCount <= UINT32_MAX);
     }
 
+    Scene::DrawList Scene::createInstanceDrawList(const std::vector<uint32_t>& instanceIDs) const
+    {
+        std::vector<D3D12_DRAW_INDEXED_ARGUMENTS> drawClockwiseMeshes, drawCounterClockwiseMeshes;
+
+        for (uint32_t instanceID : instanceIDs)
+        {
+            const auto& instance = mMeshInstanceData[instanceID];
+            const auto& mesh = mMeshDesc[instance.meshID];
+
+            D3D12_DRAW_INDEXED_ARGUMENTS draw;
+            draw.IndexCountPerInstance = mesh.indexCount;
+            draw.InstanceCount = 1;
+            draw.StartIndexLocation = mesh.ibOffset;
+            draw.BaseVertexLocation = mesh.vbOffset;
+            draw.StartInstanceLocation = instanceID;
+
+            (instance.flags & MeshInstanceFlags::Flipped) ? drawClockwiseMeshes.push_back(draw) : drawCounterClockwiseMeshes.push_back(draw);
+        }
+
+        DrawList drawList;
+        const Resource::BindFlags bindFlags = Resource::BindFlags::IndirectArg | Resource::BindFlags::ShaderResource;
+        if (drawCounterClockwiseMeshes.size())
+        {
+            drawList.counterClockwise.pBuffer = Buffer::create(sizeof(drawCounterClockwiseMeshes[0]) * drawCounterClockwiseMeshes.size(), bindFlags, Buffer::CpuAccess::None, drawCounterClockwiseMeshes.data());
+            drawList.counterClockwise.count = (uint32_t)drawCounterClockwiseMeshes.size();
+        }
+
+        if (drawClockwiseMeshes.size())
+        {
+            drawList.clockwise.pBuffer = Buffer::create(sizeof(drawClockwiseMeshes[0]) * drawClockwiseMeshes.size(), bindFlags, Buffer::CpuAccess::None, drawClockwiseMeshes.data());
+            drawList.clockwise.count = (uint32_t)drawClockwiseMeshes.size();
+        }
+
+        return drawList;
+    }
+
     void Scene::sortMeshes()
     {
         // We first sort meshes into groups with the same transform.
@@ -196,6 +196,11 @@ namespace Falcor
         */
         const MeshDesc& getMesh(uint32_t meshID) const { return mMeshDesc[meshID]; }
 
+        /** Get the meshlets of a mesh. The list is empty unless the scene was built with SceneBuilder::Flags::GenerateMeshlets.
+            The index offsets are relative to the start of the mesh's indices.
+        */
+        const std::vector<MeshletDesc>& getMeshlets(uint32_t meshID) const { return mMeshlets[meshID]; }
+
         /** Get the number of mesh instances
         */
         uint32_t getMeshInstanceCount() const { return (uint32_t)mMeshInstanceData.size(); }
@@ -224,6 +229,15 @@ namespace Falcor
         */
         const BoundingBox& getMeshBounds(uint32_t meshID) const { return mMeshBBs[meshID]; }
 
+        /** Get the world-space bounds of a mesh instance with its current transform.
+            Instances of meshes with dynamic data can move outside these bounds, see hasDynamicData().
+        */
+        BoundingBox getMeshInstanceBounds(uint32_t instanceID) const;
+
+        /** Check if a mesh has dynamic (skinned) vertex data. Its vertices can move outside the bounds returned by getMeshBounds().
+        */
+        bool hasDynamicData(uint32_t meshID) const { return mMeshHasDynamicData[meshID]; }
+
         /** Get the number of lights in the scene
         */
         uint32_t getLightCount() const { return (uint32_t)mLights.size(); }
@@ -275,10 +289,47 @@ namespace Falcor
         */
         UpdateFlags getUpdates() const { return mUpdates; }
 
+        /** Indirect draw arguments for a set of mesh instances.
+            The buffer holds D3D12_DRAW_INDEXED_ARGUMENTS entries. The StartInstanceLocation of each entry is the mesh instance ID.
+            If pCountBuffer is set, the number of draws is read from it on the GPU and `count` is the maximum number of draws.
+        */
+        struct DrawArgs
+        {
+            Buffer::SharedPtr pBuffer;
+            uint32_t count = 0;
+            Buffer::SharedPtr pCountBuffer;
+            uint32_t countOffset = 0;
+        };
+
+        /** The draws of the scene, split by triangle winding order.
+        */
+        struct DrawList
+        {
+            DrawArgs counterClockwise;  ///< Mesh instances with a transform that preserves the winding order.
+            DrawArgs clockwise;         ///< Mesh instances with a transform that flips the winding order.
+        };
+
+        /** Get the draw list covering all mesh instances in the scene.
+            Culling passes can use it as input to generate a reduced draw list.
+        */
+        const DrawList& getDrawList() const { return mDrawList; }
+
+        /** Create a draw list for a subset of the mesh instances, e.g. to render static and dynamic geometry separately.
+            The draw arguments are uploaded to new buffers, so keep the list around instead of creating it every frame.
+            \param[in] instanceIDs Mesh instances to draw.
+            \return Draw list that can be passed to render().
+        */
+        DrawList createInstanceDrawList(const std::vector<uint32_t>& instanceIDs) const;
+
         /** Render the scene using the rasterizer
         */
         void render(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, RenderFlags flags = RenderFlags::None);
 
+        /** Render a subset of the scene using the rasterizer
+            \param[in] drawList Draw list to render. Usually generated by a culling pass from the list returned by getDrawList().
+        */
+        void render(RenderContext* pContext, GraphicsState* pState, GraphicsVars* pVars, const DrawList& drawList, RenderFlags flags = RenderFlags::None);
+
         /** Render the scene using raytracing
         */
         void raytrace(RenderContext* pContext, RtProgram* pProgram, const std::shared_ptr<RtProgramVars>& pVars, uint3 dispatchDims);
@@ -295,6 +346,11 @@ namespace Falcor
         */
         const Vao::SharedPtr& getVao() const { return mpVao; }
 
+        /** Get the scene's compact VAO used for rasterization, or nullptr if the scene was built without SceneBuilder::Flags::UseCompactVertices.
+            It shares the index, previous position and draw ID buffers with getVao() and replaces the vertex data with CompactVertexData.
+        */
+        const Vao::SharedPtr& getCompactVao() const { return mpCompactVao; }
+
         /** Set an environment map.
             \param[in] pEnvMap Texture to use as environment map. Can be nullptr.
         */
@@ -440,11 +496,8 @@ namespace Falcor
 
         // Scene Geometry
         Vao::SharedPtr mpVao;
-        struct DrawArgs
-        {
-            Buffer::SharedPtr pBuffer;
-            uint32_t count = 0;
-        } mDrawClockwiseMeshes, mDrawCounterClockwiseMeshes;
+        Vao::SharedPtr mpCompactVao;    ///< Optional VAO with quantized vertex data for rasterization.
+        DrawList mDrawList;
 
         static const uint32_t kInvalidNode = -1;
 
@@ -480,6 +533,7 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mMeshIdToInstanceIds;    ///< Mapping of what instances belong to which mesh
         BoundingBox mSceneBB;                                       ///< Bounding boxes of the entire scene
         std::vector<bool> mMeshHasDynamicData;                      ///< Whether a Mesh has dynamic data, meaning it is skinned
+        std::vector<std::vector<MeshletDesc>> mMeshlets;            ///< Meshlets for each mesh. Only generated with SceneBuilder::Flags::GenerateMeshlets
         GeometryStats mGeometryStats;                               ///< Geometry statistics for the scene.
 
         // Resources
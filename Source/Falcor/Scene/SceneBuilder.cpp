@@ -92,6 +92,17 @@ namespace Falcor
             }
         };
 
+        /** Vertex representation used by the optimization stage. Vertices are welded bitwise, so there must be no padding.
+        */
+        struct OptimizerVertex
+        {
+            OptimizerVertex(const StaticVertexData& s) : staticData(s) {}
+            PackedStaticVertexData staticData;
+            uint4 boneID = uint4(0);
+            float4 boneWeight = float4(0);
+        };
+        static_assert(sizeof(OptimizerVertex) == sizeof(PackedStaticVertexData) + sizeof(uint4) + sizeof(float4), "OptimizerVertex must not contain padding");
+
         void validateTangentSpace(const float3 bitangents[], uint32_t vertexCount)
         {
             auto isValid = [](const float3& bitangent)
@@ -177,10 +188,8 @@ namespace Falcor
         spec.staticVertexOffset = (uint32_t)mBuffersData.staticData.size();
         spec.dynamicVertexOffset = (uint32_t)mBuffersData.dynamicData.size();
         spec.indexOffset = (uint32_t)mBuffersData.indices.size();
-        spec.indexCount = mesh.indexCount;
-        spec.vertexCount = mesh.vertexCount;
         spec.topology = mesh.topology;
-        spec.materialId = addMaterial(mesh.pMaterial, is_set(mFlags, Flags::RemoveDuplicateMaterials));
+        spec.materialId = addMaterial(mesh.pMaterial);
 
         // Error checking
         auto throw_on_missing_element = [&](const std::string& element)
@@ -195,7 +204,7 @@ namespace Falcor
 
         // Initialize the static data
         if (mesh.indexCount == 0 || !mesh.pIndices) throw_on_missing_element("indices");
-        mBuffersData.indices.insert(mBuffersData.indices.end(), mesh.pIndices, mesh.pIndices + mesh.indexCount);
+        std::vector<uint32_t> indices(mesh.pIndices, mesh.pIndices + mesh.indexCount);
 
         if (mesh.vertexCount == 0) throw_on_missing_element("vertices");
         if (mesh.pPositions == nullptr) throw_on_missing_element("positions");
@@ -221,6 +230,8 @@ namespace Falcor
             validateTangentSpace(mesh.pBitangents, mesh.vertexCount);
         }
 
+        std::vector<OptimizerVertex> vertices;
+        vertices.reserve(mesh.vertexCount);
         for (uint32_t v = 0; v < mesh.vertexCount; v++)
         {
             StaticVertexData s;
@@ -228,13 +239,60 @@ namespace Falcor
             s.normal = mesh.pNormals ? mesh.pNormals[v] : float3(0, 0, 0);
             s.texCrd = mesh.pTexCrd ? mesh.pTexCrd[v] : float2(0, 0);
             s.bitangent = bitangents.size() ? bitangents[v] : mesh.pBitangents[v];
-            mBuffersData.staticData.push_back(PackedStaticVertexData(s));
+            vertices.push_back(OptimizerVertex(s));
 
             if (mesh.pBoneWeights)
+            {
+                vertices.back().boneWeight = mesh.pBoneWeights[v];
+                vertices.back().boneID = mesh.pBoneIDs[v];
+            }
+        }
+
+        // Optional mesh optimization stage
+        const bool optimize = is_set(mFlags, Flags::WeldVertices) || is_set(mFlags, Flags::OptimizeMeshes) || is_set(mFlags, Flags::GenerateMeshlets);
+        if (optimize && mesh.topology == Vao::Topology::TriangleList)
+        {
+            mVertexCacheStatsBefore += MeshOptimizer::computeStats(indices.data(), indices.size(), (uint32_t)vertices.size());
+
+            std::vector<uint32_t> remap;
+            if (is_set(mFlags, Flags::WeldVertices))
+            {
+                uint32_t weldedCount = MeshOptimizer::weldVertices(vertices.data(), (uint32_t)vertices.size(), sizeof(OptimizerVertex), remap);
+                MeshOptimizer::remapIndices(indices.data(), indices.size(), remap);
+                vertices = MeshOptimizer::remapVertices(vertices, remap, weldedCount);
+            }
+
+            if (is_set(mFlags, Flags::OptimizeMeshes))
+            {
+                MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), (uint32_t)vertices.size());
+                uint32_t referencedCount = MeshOptimizer::optimizeVertexFetch(indices.data(), indices.size(), (uint32_t)vertices.size(), remap);
+                MeshOptimizer::remapIndices(indices.data(), indices.size(), remap);
+                vertices = MeshOptimizer::remapVertices(vertices, remap, referencedCount);
+            }
+
+            if (is_set(mFlags, Flags::GenerateMeshlets))
+            {
+                std::vector<float3> positions(vertices.size());
+                for (size_t v = 0; v < vertices.size(); v++) positions[v] = vertices[v].staticData.position;
+                spec.meshlets = MeshOptimizer::buildMeshlets(indices.data(), indices.size(), positions.data());
+            }
+
+            mVertexCacheStatsAfter += MeshOptimizer::computeStats(indices.data(), indices.size(), (uint32_t)vertices.size());
+        }
+
+        assert(indices.size() <= UINT32_MAX && vertices.size() <= UINT32_MAX);
+        spec.indexCount = (uint32_t)indices.size();
+        spec.vertexCount = (uint32_t)vertices.size();
+        mBuffersData.indices.insert(mBuffersData.indices.end(), indices.begin(), indices.end());
+        for (const auto& v : vertices)
+        {
+            mBuffersData.staticData.push_back(v.staticData);
+
+            if (spec.hasDynamicData)
             {
                 DynamicVertexData d;
-                d.boneWeight = mesh.pBoneWeights[v];
-                d.boneID = mesh.pBoneIDs[v];
+                d.boneWeight = v.boneWeight;
+                d.boneID = v.boneID;
                 d.staticIndex = (uint32_t)mBuffersData.staticData.size() - 1;
                 mBuffersData.dynamicData.push_back(d);
             }
@@ -246,25 +304,30 @@ namespace Falcor
         return (uint32_t)mMeshes.size() - 1;
     }
 
-    uint32_t SceneBuilder::addMaterial(const Material::SharedPtr& pMaterial, bool removeDuplicate)
+    uint32_t SceneBuilder::addMaterial(const Material::SharedPtr& pMaterial)
     {
         assert(pMaterial);
 
         // Reuse previously added materials
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialToId.find(pMaterial.get()); it != mMaterialToId.end())
         {
-            return (uint32_t)std::distance(mMaterials.begin(), it);
+            return it->second;
         }
 
+        // Materials may have been edited through the scene since they were indexed (e.g. by a scene script run by the PythonImporter)
+        if (mMaterialIndexStale) updateMaterialIndex();
+
         // Try to find previously added material with equal properties (duplicate)
-        if (auto it = std::find_if(mMaterials.begin(), mMaterials.end(), [&pMaterial] (const auto& m) { return *m == *pMaterial; }); it != mMaterials.end())
+        const size_t hash = pMaterial->getHash();
+        auto& ids = mMaterialHashToIds[hash];
+        if (auto it = std::find_if(ids.begin(), ids.end(), [&](uint32_t id) { return *mMaterials[id] == *pMaterial; }); it != ids.end())
         {
-            const auto& equalMaterial = *it;
+            const auto& equalMaterial = mMaterials[*it];
 
             // ASSIMP sometimes creates internal copies of a material: Always de-duplicate if name and properties are equal.
-            if (removeDuplicate || pMaterial->getName() == equalMaterial->getName())
+            if (is_set(mFlags, Flags::RemoveDuplicateMaterials) || pMaterial->getName() == equalMaterial->getName())
             {
-                return (uint32_t)std::distance(mMaterials.begin(), it);
+                return *it;
             }
             else
             {
@@ -275,7 +338,30 @@ namespace Falcor
         mDirty = true;
         mMaterials.push_back(pMaterial);
         assert(mMaterials.size() <= UINT32_MAX);
-        return (uint32_t)mMaterials.size() - 1;
+        const uint32_t materialID = (uint32_t)mMaterials.size() - 1;
+        mMaterialHashes.push_back(hash);
+        mMaterialToId[pMaterial.get()] = materialID;
+        ids.push_back(materialID);
+        return materialID;
+    }
+
+    void SceneBuilder::updateMaterialIndex()
+    {
+        // Only re-index the materials whose hash changed. The ID lists are kept sorted so that the lowest ID wins, as with a linear search.
+        for (uint32_t id = 0; id < (uint32_t)mMaterials.size(); id++)
+        {
+            const size_t hash = mMaterials[id]->getHash();
+            if (hash == mMaterialHashes[id]) continue;
+
+            auto& oldIds = mMaterialHashToIds[mMaterialHashes[id]];
+            oldIds.erase(std::find(oldIds.begin(), oldIds.end(), id));
+            if (oldIds.empty()) mMaterialHashToIds.erase(mMaterialHashes[id]);
+
+            auto& newIds = mMaterialHashToIds[hash];
+            newIds.insert(std::lower_bound(newIds.begin(), newIds.end(), id), id);
+            mMaterialHashes[id] = hash;
+        }
+        mMaterialIndexStale = false;
     }
 
     void SceneBuilder::setCamera(const Camera::SharedPtr& pCamera, uint32_t nodeID)
@@ -346,6 +432,73 @@ namespace Falcor
         return pVao;
     }
 
+    Vao::SharedPtr SceneBuilder::createCompactVao(Scene* pScene, const Vao::SharedPtr& pVao)
+    {
+        // Skinning only updates the full-precision buffer, so the compact copy would go stale.
+        for (const auto& mesh : mMeshes)
+        {
+            if (mesh.hasDynamicData)
+            {
+                logWarning("SceneBuilder::Flags::UseCompactVertices is not supported for scenes with skinned meshes. Ignoring the flag.");
+                return nullptr;
+            }
+        }
+
+        std::vector<CompactVertexData> compactData(mBuffersData.staticData.size());
+        for (uint32_t meshID = 0; meshID < mMeshes.size(); meshID++)
+        {
+            const auto& mesh = mMeshes[meshID];
+            const auto first = mBuffersData.staticData.begin() + mesh.staticVertexOffset;
+            const auto last = first + mesh.vertexCount;
+
+            // Positions are quantized relative to the mesh bounds.
+            float3 minPos(FLT_MAX);
+            float3 maxPos(-FLT_MAX);
+            for (auto it = first; it != last; it++)
+            {
+                minPos = glm::min(minPos, it->position);
+                maxPos = glm::max(maxPos, it->position);
+            }
+
+            auto& meshDesc = pScene->mMeshDesc[meshID];
+            meshDesc.positionOffset = minPos;
+            meshDesc.positionScale = (maxPos - minPos) / 65535.f;
+
+            // Snap the full-precision positions to the quantized ones. The ray tracing path, the previous positions and the
+            // mesh bounds are all built from the full-precision data, so this keeps them consistent with the rasterized geometry.
+            for (auto it = first; it != last; it++)
+            {
+                auto& compact = compactData[it - mBuffersData.staticData.begin()];
+                compact.pack(it->unpack(), meshDesc.positionOffset, meshDesc.positionScale);
+                it->position = compact.unpack(meshDesc.positionOffset, meshDesc.positionScale).position;
+            }
+        }
+
+        size_t compactVbSize = sizeof(CompactVertexData) * compactData.size();
+        assert(compactVbSize <= UINT32_MAX);
+        Buffer::SharedPtr pCompactBuffer = Buffer::create((uint32_t)compactVbSize, ResourceBindFlags::Vertex, Buffer::CpuAccess::None, compactData.data());
+
+        // The compact VAO shares the index, previous position and draw ID buffers with the full-precision VAO.
+        Vao::BufferVec pVBs(Scene::kVertexBufferCount);
+        pVBs[Scene::kStaticDataBufferIndex] = pCompactBuffer;
+        pVBs[Scene::kPrevVertexBufferIndex] = pVao->getVertexBuffer(Scene::kPrevVertexBufferIndex);
+        pVBs[Scene::kDrawIdBufferIndex] = pVao->getVertexBuffer(Scene::kDrawIdBufferIndex);
+
+        VertexLayout::SharedPtr pLayout = VertexLayout::create();
+
+        VertexBufferLayout::SharedPtr pCompactLayout = VertexBufferLayout::create();
+        pCompactLayout->addElement(VERTEX_COMPACT_NAME, 0, ResourceFormat::RGBA32Uint, 1, VERTEX_COMPACT_LOC);
+        pLayout->addBufferLayout(Scene::kStaticDataBufferIndex, pCompactLayout);
+
+        const auto& pFullLayout = pVao->getVertexLayout();
+        pLayout->addBufferLayout(Scene::kPrevVertexBufferIndex, pFullLayout->getBufferLayout(Scene::kPrevVertexBufferIndex));
+        pLayout->addBufferLayout(Scene::kDrawIdBufferIndex, pFullLayout->getBufferLayout(Scene::kDrawIdBufferIndex));
+
+        logInfo("Compact vertex buffer: " + std::to_string(compactVbSize / 1024) + " KB (full-precision buffer: " + std::to_string(sizeof(PackedStaticVertexData) * compactData.size() / 1024) + " KB)");
+
+        return Vao::create(pVao->getPrimitiveTopology(), pLayout, pVBs, pVao->getIndexBuffer(), pVao->getIndexBufferFormat());
+    }
+
     void SceneBuilder::createGlobalMatricesBuffer(Scene* pScene)
     {
         pScene->mSceneGraph.resize(mSceneGraph.size());
@@ -363,6 +516,7 @@ namespace Falcor
         auto& instanceData = pScene->mMeshInstanceData;
         meshData.resize(mMeshes.size());
         pScene->mMeshHasDynamicData.resize(mMeshes.size());
+        pScene->mMeshlets.resize(mMeshes.size());
 
         size_t drawCount = 0;
         for (uint32_t meshID = 0; meshID < mMeshes.size(); meshID++)
@@ -374,6 +528,7 @@ namespace Falcor
             meshData[meshID].ibOffset = mesh.indexOffset;
             meshData[meshID].vertexCount = mesh.vertexCount;
             meshData[meshID].indexCount = mesh.indexCount;
+            pScene->mMeshlets[meshID] = mesh.meshlets;
 
             drawCount += mesh.instances.size();
 
@@ -426,15 +581,24 @@ namespace Falcor
         mpScene->mpEnvMap = mpEnvMap;
         mpScene->mFilename = mFilename;
 
+        if (mVertexCacheStatsBefore.triangleCount > 0)
+        {
+            logInfo("Mesh optimization vertex cache statistics:\n  Before: " + to_string(mVertexCacheStatsBefore) + "\n  After:  " + to_string(mVertexCacheStatsAfter));
+        }
+
         createGlobalMatricesBuffer(mpScene.get());
         uint32_t drawCount = createMeshData(mpScene.get());
         assert(drawCount <= UINT16_MAX);
         mpScene->mpVao = createVao(drawCount);
+        if (is_set(mFlags, Flags::UseCompactVertices)) mpScene->mpCompactVao = createCompactVao(mpScene.get(), mpScene->mpVao);
         calculateMeshBoundingBoxes(mpScene.get());
         createAnimationController(mpScene.get());
         mpScene->finalize();
         mDirty = false;
 
+        // The scene shares the material objects and allows editing them.
+        mMaterialIndexStale = true;
+
         return mpScene;
     }
 
@@ -491,6 +655,10 @@ namespace Falcor
         buildFlags.regEnumVal(SceneBuilder::Flags::BuffersAsShaderResource);
         buildFlags.regEnumVal(SceneBuilder::Flags::UseSpecGlossMaterials);
         buildFlags.regEnumVal(SceneBuilder::Flags::UseMetalRoughMaterials);
+        buildFlags.regEnumVal(SceneBuilder::Flags::WeldVertices);
+        buildFlags.regEnumVal(SceneBuilder::Flags::OptimizeMeshes);
+        buildFlags.regEnumVal(SceneBuilder::Flags::GenerateMeshlets);
+        buildFlags.regEnumVal(SceneBuilder::Flags::UseCompactVertices);
         buildFlags.addBinaryOperators();
     }
 }
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Scene.h"
+#include "MeshOptimizer.h"
 #include "VertexAttrib.slangh"
 
 namespace Falcor
@@ -48,6 +49,10 @@ namespace Falcor
             BuffersAsShaderResource     = 0x10,   ///< Generate the VBs and IB with the shader-resource-view bind flag
             UseSpecGlossMaterials       = 0x20,   ///< Set materials to use Spec-Gloss shading model. Otherwise default is Spec-Gloss for OBJ, Metal-Rough for everything else
             UseMetalRoughMaterials      = 0x40,   ///< Set materials to use Metal-Rough shading model. Otherwise default is Spec-Gloss for OBJ, Metal-Rough for everything else
+            WeldVertices                = 0x80,   ///< Merge vertices with identical attributes. Only applies to triangle lists
+            OptimizeMeshes              = 0x100,  ///< Reorder triangles for post-transform vertex cache efficiency and vertices for fetch locality. Only applies to triangle lists
+            GenerateMeshlets            = 0x200,  ///< Split meshes into meshlets with bounding spheres and normal cones for fine-grained culling. See Scene::getMeshlets(). Only applies to triangle lists
+            UseCompactVertices          = 0x400,  ///< Rasterize from a 16B quantized vertex buffer (see CompactVertexData) instead of the 32B full-precision one. The full-precision buffer is kept for ray tracing, with its positions snapped to the quantized ones so both paths see the same geometry. Ignored for scenes with skinned meshes
 
             Default = None
         };
@@ -127,6 +132,18 @@ namespace Falcor
         */
         uint32_t addMesh(const Mesh& mesh);
 
+        /** Add a material. If the material was added before, or if it's a duplicate of a previously added material, the ID of the existing material is returned.
+            Duplicates are detected using Material::getHash() and verified with Material::operator==, so the cost per call doesn't depend on the number of materials.
+            Duplicates with a different name are only removed if Flags::RemoveDuplicateMaterials is set.
+            \param pMaterial The material. Can't be nullptr
+            \return The material ID
+        */
+        uint32_t addMaterial(const Material::SharedPtr& pMaterial);
+
+        /** Get the number of added materials
+        */
+        size_t getMaterialCount() const { return mMaterials.size(); }
+
         /** Add a light source
             \param pLight The light object. Can't be nullptr
             \param nodeID The node ID of the light.
@@ -193,6 +210,7 @@ namespace Falcor
             bool hasDynamicData = false;
             std::vector<uint32_t> instances; // Node IDs
             std::vector<Animation::SharedPtr> animations;
+            std::vector<MeshletDesc> meshlets;
         };
 
         // Geometry data
@@ -214,7 +232,10 @@ namespace Falcor
 
         MeshList mMeshes;
         std::vector<Material::SharedPtr> mMaterials;
+        std::vector<size_t> mMaterialHashes;                                    // Hash of each material at the time it was indexed
         std::unordered_map<const Material*, uint32_t> mMaterialToId;
+        std::unordered_map<size_t, std::vector<uint32_t>> mMaterialHashToIds;   // Material hash to the IDs of all materials with that hash, in ascending order
+        bool mMaterialIndexStale = false;                                       // Set when the materials were handed out and may have been modified since they were indexed
 
         Scene::AnimatedObject<Camera> mCamera;
         std::vector<Scene::AnimatedObject<Light>> mLights;
@@ -222,8 +243,12 @@ namespace Falcor
         Texture::SharedPtr mpEnvMap;
         float mCameraSpeed = 1.0f;
 
-        uint32_t addMaterial(const Material::SharedPtr& pMaterial, bool removeDuplicate);
+        MeshOptimizer::Stats mVertexCacheStatsBefore;   // Accumulated vertex cache statistics of the meshes before optimization
+        MeshOptimizer::Stats mVertexCacheStatsAfter;    // Accumulated vertex cache statistics of the meshes after optimization
+
+        void updateMaterialIndex();
         Vao::SharedPtr createVao(uint16_t drawCount);
+        Vao::SharedPtr createCompactVao(Scene* pScene, const Vao::SharedPtr& pVao);
 
         uint32_t createMeshData(Scene* pScene);
         void createGlobalMatricesBuffer(Scene* pScene);
@@ -245,6 +270,10 @@ namespace Falcor
             t2s(BuffersAsShaderResource);
             t2s(UseSpecGlossMaterials);
             t2s(UseMetalRoughMaterials);
+            t2s(WeldVertices);
+            t2s(OptimizeMeshes);
+            t2s(GenerateMeshlets);
+            t2s(UseCompactVertices);
         default:
             should_not_get_here();
             return "";
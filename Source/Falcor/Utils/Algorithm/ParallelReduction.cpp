@@ -64,6 +64,9 @@ namespace Falcor
         }
         mpFirstIterProg = FullScreenPass::create(psFilename, defines);
         mpFirstIterProg->addDefine("_FIRST_ITERATION");
+        mpFirstIterPairProg = FullScreenPass::create(psFilename, defines);
+        mpFirstIterPairProg->addDefine("_FIRST_ITERATION");
+        mpFirstIterPairProg->addDefine("_SECOND_INPUT");
         mpRestIterProg = FullScreenPass::create(psFilename, defines);
 
         // Calculate the number of reduction passes
@@ -97,8 +100,19 @@ namespace Falcor
      }
 
     float4 ParallelReduction::reduce(RenderContext* pRenderCtx, Texture::SharedPtr pInput)
+    {
+        return reduce(pRenderCtx, pInput, nullptr);
+    }
+
+    float4 ParallelReduction::reduce(RenderContext* pRenderCtx, Texture::SharedPtr pInput, const Texture::SharedPtr& pSecondInput)
     {
         FullScreenPass::SharedPtr pPass = mpFirstIterProg;
+        if (pSecondInput)
+        {
+            assert(pSecondInput->getWidth() == pInput->getWidth() && pSecondInput->getHeight() == pInput->getHeight() && pSecondInput->getSampleCount() == pInput->getSampleCount());
+            pPass = mpFirstIterPairProg;
+            pPass["gSecondInputTex"] = pSecondInput;
+        }
 
         for(size_t i = 0; i < mpTmpResultFbo.size(); i++)
         {
@@ -53,9 +53,17 @@ namespace Falcor
 
         float4 reduce(RenderContext* pRenderCtx, Texture::SharedPtr pInput);
 
+        /** Reduce two textures into a single result, e.g. the depth buffers of both eyes in stereo rendering.
+            This is cheaper than two separate reductions since only the first iteration reads both inputs, and only one result is read back.
+            \param[in] pInput First input texture.
+            \param[in] pSecondInput Second input texture. Must have the same dimensions and sample count as pInput.
+        */
+        float4 reduce(RenderContext* pRenderCtx, Texture::SharedPtr pInput, const Texture::SharedPtr& pSecondInput);
+
     private:
         ParallelReduction(Type reductionType, uint32_t readbackLatency, uint32_t width, uint32_t height, uint32_t sampleCount);
         FullScreenPass::SharedPtr mpFirstIterProg;
+        FullScreenPass::SharedPtr mpFirstIterPairProg;
         FullScreenPass::SharedPtr mpRestIterProg;
 
         struct ResultData
@@ -65,6 +65,9 @@ namespace Falcor
             mCacheLineSize = cacheLineSize;
         }
 
+        int getMinimumAlignment() const { return mMinAlignment; }
+        int getCacheLineSize() const { return mCacheLineSize; }
+
         /** Allocates an object of given type and executes its constructor.
             \param[in] args Arguments to pass to the constructor.
             \return pointer to allocated object.
@@ -0,0 +1,114 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "LuminanceHistogram.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "Utils/Color/LuminanceHistogram.cs.slang";
+    }
+
+    LuminanceHistogram::SharedPtr LuminanceHistogram::create()
+    {
+        return SharedPtr(new LuminanceHistogram());
+    }
+
+    LuminanceHistogram::LuminanceHistogram()
+    {
+        mpBuildPass = ComputePass::create(kShaderFile, "buildHistogram");
+        mpExposurePass = ComputePass::create(kShaderFile, "computeExposure");
+
+        mpHistogram = Buffer::create(kLuminanceHistogramBinCount * sizeof(uint32_t), Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+        mpHistogram->setName("LuminanceHistogram::Histogram");
+        mpExposure = Buffer::createStructured(sizeof(LuminanceHistogramExposure), 1, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
+        mpExposure->setName("LuminanceHistogram::Exposure");
+    }
+
+    void LuminanceHistogram::setParams(const LuminanceHistogramParams& params)
+    {
+        if (params.minLogLuminance != mParams.minLogLuminance || params.maxLogLuminance != mParams.maxLogLuminance) mDirty = true;
+        mParams = params;
+    }
+
+    void LuminanceHistogram::reset(RenderContext* pRenderContext)
+    {
+        pRenderContext->clearUAV(mpHistogram->getUAV().get(), uint4(0));
+        pRenderContext->clearUAV(mpExposure->getUAV().get(), uint4(0));
+        mDirty = false;
+    }
+
+    void LuminanceHistogram::accumulate(RenderContext* pRenderContext, const Texture::SharedPtr& pColor)
+    {
+        PROFILE("LuminanceHistogram::accumulate");
+
+        assert(pColor);
+        if (mDirty) reset(pRenderContext);
+
+        const uint2 frameDim(pColor->getWidth(), pColor->getHeight());
+        auto var = mpBuildPass->getRootVar();
+        var["LuminanceHistogramCB"]["gParams"].setBlob(mParams);
+        var["LuminanceHistogramCB"]["gFrameDim"] = frameDim;
+        var["gColor"] = pColor;
+        var["gHistogram"] = mpHistogram;
+        mpBuildPass->execute(pRenderContext, frameDim.x, frameDim.y);
+    }
+
+    void LuminanceHistogram::updateExposure(RenderContext* pRenderContext, float deltaTime)
+    {
+        PROFILE("LuminanceHistogram::updateExposure");
+
+        if (mDirty) reset(pRenderContext);
+
+        auto var = mpExposurePass->getRootVar();
+        var["LuminanceHistogramCB"]["gParams"].setBlob(mParams);
+        var["LuminanceHistogramCB"]["gDeltaTime"] = deltaTime;
+        var["gHistogram"] = mpHistogram;
+        var["gExposure"] = mpExposure;
+        mpExposurePass->execute(pRenderContext, kLuminanceHistogramBinCount, 1);
+    }
+
+    void LuminanceHistogram::renderUI(Gui::Widgets& widget)
+    {
+        LuminanceHistogramParams params = mParams;
+        widget.var("Min log luminance", params.minLogLuminance, -32.f, params.maxLogLuminance - 1.f, 0.5f);
+        widget.tooltip("Lower edge of the histogram in log2 luminance.", true);
+        widget.var("Max log luminance", params.maxLogLuminance, params.minLogLuminance + 1.f, 32.f, 0.5f);
+        widget.tooltip("Upper edge of the histogram in log2 luminance.", true);
+        widget.var("Low percentile", params.lowPercentile, 0.f, params.highPercentile, 0.01f);
+        widget.tooltip("Fraction of the darkest pixels that is ignored by the exposure.", true);
+        widget.var("High percentile", params.highPercentile, params.lowPercentile, 1.f, 0.01f);
+        widget.tooltip("Fraction of the pixels up to which the exposure is computed. The brightest pixels above it are ignored.", true);
+        widget.var("Adaptation speed up", params.speedUp, 0.f, 100.f, 0.1f);
+        widget.tooltip("Adaptation speed when the image gets brighter, in 1/s. Zero freezes the exposure.", true);
+        widget.var("Adaptation speed down", params.speedDown, 0.f, 100.f, 0.1f);
+        widget.tooltip("Adaptation speed when the image gets darker, in 1/s. Zero freezes the exposure.", true);
+        setParams(params);
+    }
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "LuminanceHistogramParams.slang"
+#include "RenderGraph/BasePasses/ComputePass.h"
+
+namespace Falcor
+{
+    /** Histogram-based auto-exposure.
+
+        The luminance of an image is binned in log2 space in a single compute pass. The exposure is computed from the
+        average log luminance between two percentiles of the histogram, which ignores small very dark or very bright
+        regions, and adapts exponentially over time towards it.
+
+        Usage per frame:
+        1. accumulate() adds the pixels of one or more images to the histogram. Calling it for both eyes of a stereo
+           pair gives them a common exposure.
+        2. updateExposure() computes the exposure from the accumulated pixels and clears the histogram.
+        3. Bind getExposureBuffer() as a StructuredBuffer<LuminanceHistogramExposure> to the passes applying the exposure.
+    */
+    class dlldecl LuminanceHistogram
+    {
+    public:
+        using SharedPtr = std::shared_ptr<LuminanceHistogram>;
+
+        /** Create a new object.
+            \return New object, or throws an exception on error.
+        */
+        static SharedPtr create();
+
+        /** Set the histogram and adaptation parameters. Changing the luminance range invalidates the current histogram.
+        */
+        void setParams(const LuminanceHistogramParams& params);
+
+        /** Get the histogram and adaptation parameters.
+        */
+        const LuminanceHistogramParams& getParams() const { return mParams; }
+
+        /** Add the pixels of an image to the histogram.
+            \param[in] pRenderContext Render context.
+            \param[in] pColor Linear HDR image.
+        */
+        void accumulate(RenderContext* pRenderContext, const Texture::SharedPtr& pColor);
+
+        /** Compute the exposure from the accumulated pixels and clear the histogram. Does nothing if no pixels were accumulated.
+            \param[in] pRenderContext Render context.
+            \param[in] deltaTime Time since the last update in seconds.
+        */
+        void updateExposure(RenderContext* pRenderContext, float deltaTime);
+
+        /** Clear the histogram and drop the adaptation state. The next update sets the exposure without adaptation.
+        */
+        void reset(RenderContext* pRenderContext);
+
+        /** Get the histogram buffer holding kLuminanceHistogramBinCount uint counters.
+        */
+        const Buffer::SharedPtr& getHistogramBuffer() const { return mpHistogram; }
+
+        /** Get the buffer holding a single LuminanceHistogramExposure element.
+        */
+        const Buffer::SharedPtr& getExposureBuffer() const { return mpExposure; }
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        LuminanceHistogram();
+
+        ComputePass::SharedPtr mpBuildPass;
+        ComputePass::SharedPtr mpExposurePass;
+        Buffer::SharedPtr mpHistogram;
+        Buffer::SharedPtr mpExposure;
+
+        LuminanceHistogramParams mParams;
+        bool mDirty = true;     ///< Set when the buffers have to be cleared before use.
+    };
+}
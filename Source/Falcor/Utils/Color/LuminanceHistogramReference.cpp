@@ -0,0 +1,62 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "LuminanceHistogramReference.h"
+
+namespace Falcor
+{
+    void LuminanceHistogramReference::accumulate(const std::vector<float3>& color)
+    {
+        for (const float3& c : color) mBins[getLuminanceHistogramBin(getHistogramLuminance(c), mParams)]++;
+    }
+
+    void LuminanceHistogramReference::updateExposure(float deltaTime)
+    {
+        uint32_t totalCount = 0;
+        for (uint32_t count : mBins) totalCount += count;
+
+        float weightSum = 0.f;
+        float logLuminanceSum = 0.f;
+        uint32_t firstPixel = 0;
+        for (uint32_t i = 0; i < kLuminanceHistogramBinCount; i++)
+        {
+            const float w = getLuminanceHistogramBinWeight(firstPixel, mBins[i], totalCount, mParams);
+            weightSum += w;
+            logLuminanceSum += w * getLuminanceHistogramBinCenter(i, mParams);
+            firstPixel += mBins[i];
+        }
+
+        if (totalCount > 0 && weightSum > 0.f)
+        {
+            mExposure.targetLogLuminance = logLuminanceSum / weightSum;
+            mExposure.adaptedLogLuminance = mExposure.valid != 0 ? adaptLogLuminance(mExposure.adaptedLogLuminance, mExposure.targetLogLuminance, deltaTime, mParams) : mExposure.targetLogLuminance;
+            mExposure.valid = 1;
+        }
+        std::fill(mBins.begin(), mBins.end(), 0);
+    }
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "LuminanceHistogramParams.slang"
+
+namespace Falcor
+{
+    /** CPU implementation of the histogram and exposure computation in LuminanceHistogram.cs.slang.
+        It serves as the reference for unit tests.
+    */
+    class dlldecl LuminanceHistogramReference
+    {
+    public:
+        LuminanceHistogramReference(const LuminanceHistogramParams& params) : mParams(params), mBins(kLuminanceHistogramBinCount, 0) {}
+
+        /** Add pixels to the histogram.
+            \param[in] color Linear HDR colors.
+        */
+        void accumulate(const std::vector<float3>& color);
+
+        /** Compute the exposure from the accumulated pixels and clear the histogram. Does nothing if no pixels were accumulated.
+            \param[in] deltaTime Time since the last update in seconds.
+        */
+        void updateExposure(float deltaTime);
+
+        /** Get the pixel count per bin accumulated since the last update.
+        */
+        const std::vector<uint32_t>& getBins() const { return mBins; }
+
+        /** Get the exposure state.
+        */
+        const LuminanceHistogramExposure& getExposure() const { return mExposure; }
+
+    private:
+        LuminanceHistogramParams mParams;
+        std::vector<uint32_t> mBins;
+        LuminanceHistogramExposure mExposure = {};
+    };
+}
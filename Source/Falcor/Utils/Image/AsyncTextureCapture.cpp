@@ -0,0 +1,215 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "AsyncTextureCapture.h"
+#include "Utils/Timing/CpuStallMonitor.h"
+
+namespace Falcor
+{
+    AsyncTextureCapture::SharedPtr AsyncTextureCapture::create(uint32_t encoderThreadCount, uint32_t maxPendingReadbacks, uint32_t maxQueuedImages)
+    {
+        return SharedPtr(new AsyncTextureCapture(encoderThreadCount, maxPendingReadbacks, maxQueuedImages));
+    }
+
+    AsyncTextureCapture::AsyncTextureCapture(uint32_t encoderThreadCount, uint32_t maxPendingReadbacks, uint32_t maxQueuedImages)
+        : mMaxPendingReadbacks(std::max(maxPendingReadbacks, 1u))
+        , mMaxQueuedImages(std::max(maxQueuedImages, 1u))
+    {
+        if (encoderThreadCount == 0) encoderThreadCount = std::max(Threading::getLogicalThreadCount() / 2, 1u);
+        for (uint32_t i = 0; i < encoderThreadCount; i++)
+        {
+            mEncoderThreads.push_back(std::thread(&AsyncTextureCapture::encoderThread, this));
+        }
+    }
+
+    AsyncTextureCapture::~AsyncTextureCapture()
+    {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mQueueChanged.notify_all();
+        for (auto& t : mEncoderThreads) t.join();
+    }
+
+    void AsyncTextureCapture::capture(RenderContext* pContext, Texture* pTexture, uint32_t mipLevel, uint32_t arraySlice, const std::string& filename, Bitmap::FileFormat format, Bitmap::ExportFlags exportFlags)
+    {
+        PROFILE("AsyncTextureCapture::capture");
+        assert(pContext && pTexture && pTexture->getType() == Texture::Type::Texture2D);
+
+        // Bound the number of readbacks in flight. This only waits when captures are issued faster than the GPU completes them.
+        while (mPendingReadbacks.size() >= mMaxPendingReadbacks)
+        {
+            mForcedWaitCount++;
+            completeReadback();
+        }
+
+        Readback readback;
+        Image& image = readback.image;
+        image.filename = filename;
+        image.width = pTexture->getWidth(mipLevel);
+        image.height = pTexture->getHeight(mipLevel);
+        image.format = format;
+        image.exportFlags = exportFlags;
+        image.resourceFormat = pTexture->getFormat();
+
+        // Bitmap can't save float formats with less than 3 channels, so those are blitted to RGBA32Float first
+        const Texture* pSrc = pTexture;
+        uint32_t subresource = pTexture->getSubresourceIndex(arraySlice, mipLevel);
+        if (getFormatType(image.resourceFormat) == FormatType::Float && getFormatChannelCount(image.resourceFormat) < 3)
+        {
+            readback.pConversionTexture = acquireConversionTexture(image.width, image.height);
+            pContext->blit(pTexture->getSRV(mipLevel, 1, arraySlice, 1), readback.pConversionTexture->getRTV(0, 0, 1));
+            pSrc = readback.pConversionTexture.get();
+            subresource = 0;
+            image.resourceFormat = ResourceFormat::RGBA32Float;
+        }
+
+        // The staging buffer is only a hint. If the copy needs a larger one (row pitch alignment) the task allocates it and we keep ours.
+        Buffer::SharedPtr pStaging = acquireStagingBuffer(size_t(image.width) * image.height * getFormatBytesPerBlock(image.resourceFormat));
+        readback.pTask = pContext->asyncReadTextureSubresource(pSrc, subresource, pStaging);
+        if (pStaging && readback.pTask->getStagingBuffer() != pStaging) mFreeStagingBuffers.push_back(pStaging);
+
+        mPendingReadbacks.push_back(std::move(readback));
+        mCapturedCount++;
+    }
+
+    void AsyncTextureCapture::poll()
+    {
+        while (!mPendingReadbacks.empty() && mPendingReadbacks.front().pTask->isReady())
+        {
+            completeReadback();
+        }
+    }
+
+    void AsyncTextureCapture::flush()
+    {
+        {
+            // Flushing is an explicit request to wait
+            CpuStallMonitor::ExpectedScope expectedStall;
+            while (!mPendingReadbacks.empty()) completeReadback();
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mQueueChanged.wait(lock, [this]() { return mQueuedImages.empty() && mActiveEncoders == 0; });
+    }
+
+    AsyncTextureCapture::Stats AsyncTextureCapture::getStats() const
+    {
+        Stats s;
+        s.capturedCount = mCapturedCount;
+        s.forcedWaitCount = mForcedWaitCount;
+        s.pendingReadbacks = (uint32_t)mPendingReadbacks.size();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        s.writtenCount = mWrittenCount;
+        s.queuedImages = (uint32_t)mQueuedImages.size() + mActiveEncoders;
+        return s;
+    }
+
+    void AsyncTextureCapture::completeReadback()
+    {
+        assert(!mPendingReadbacks.empty());
+        Readback readback = std::move(mPendingReadbacks.front());
+        mPendingReadbacks.pop_front();
+
+        readback.image.data = readback.pTask->getData();
+
+        // The copy is done, recycle the resources it used
+        if (mFreeStagingBuffers.size() < mMaxPendingReadbacks) mFreeStagingBuffers.push_back(readback.pTask->getStagingBuffer());
+        if (readback.pConversionTexture && mFreeConversionTextures.size() < mMaxPendingReadbacks) mFreeConversionTextures.push_back(readback.pConversionTexture);
+
+        queueImage(std::move(readback.image));
+    }
+
+    void AsyncTextureCapture::queueImage(Image&& image)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mQueueChanged.wait(lock, [this]() { return mQueuedImages.size() < mMaxQueuedImages; });
+            mQueuedImages.push_back(std::move(image));
+        }
+        mQueueChanged.notify_all();
+    }
+
+    void AsyncTextureCapture::encoderThread()
+    {
+        while (true)
+        {
+            Image image;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mQueueChanged.wait(lock, [this]() { return mTerminate || !mQueuedImages.empty(); });
+                if (mQueuedImages.empty()) return;
+                image = std::move(mQueuedImages.front());
+                mQueuedImages.pop_front();
+                mActiveEncoders++;
+            }
+            mQueueChanged.notify_all();
+
+            Bitmap::saveImage(image.filename, image.width, image.height, image.format, image.exportFlags, image.resourceFormat, true, image.data.data());
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mActiveEncoders--;
+                mWrittenCount++;
+            }
+            mQueueChanged.notify_all();
+        }
+    }
+
+    Buffer::SharedPtr AsyncTextureCapture::acquireStagingBuffer(size_t minSize)
+    {
+        // Pick the smallest free buffer that might fit
+        auto best = mFreeStagingBuffers.end();
+        for (auto it = mFreeStagingBuffers.begin(); it != mFreeStagingBuffers.end(); it++)
+        {
+            if ((*it)->getSize() >= minSize && (best == mFreeStagingBuffers.end() || (*it)->getSize() < (*best)->getSize())) best = it;
+        }
+        if (best == mFreeStagingBuffers.end()) return nullptr;
+
+        Buffer::SharedPtr pBuffer = *best;
+        mFreeStagingBuffers.erase(best);
+        return pBuffer;
+    }
+
+    Texture::SharedPtr AsyncTextureCapture::acquireConversionTexture(uint32_t width, uint32_t height)
+    {
+        for (auto it = mFreeConversionTextures.begin(); it != mFreeConversionTextures.end(); it++)
+        {
+            if ((*it)->getWidth() == width && (*it)->getHeight() == height)
+            {
+                Texture::SharedPtr pTexture = *it;
+                mFreeConversionTextures.erase(it);
+                return pTexture;
+            }
+        }
+        return Texture::create2D(width, height, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource);
+    }
+}
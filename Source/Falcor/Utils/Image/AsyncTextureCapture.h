@@ -0,0 +1,140 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/CopyContext.h"
+#include "Core/API/Texture.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Falcor
+{
+    class RenderContext;
+
+    /** Captures textures to image files without blocking the renderer.
+        capture() records a copy into a pooled readback buffer and returns immediately. The copy is tracked by a fence and poll() hands
+        completed readbacks to a pool of encoder threads, which write the PNG/EXR/PFM files. Readback buffers and the RGBA32Float
+        textures used to convert low channel-count float formats are recycled, so capturing every frame doesn't allocate.
+        When more than maxPendingReadbacks copies are in flight the oldest one is waited on, and when the encoders fall behind by more
+        than maxQueuedImages images the render thread blocks until they catch up. Both bound the memory used by long capture runs.
+    */
+    class dlldecl AsyncTextureCapture
+    {
+    public:
+        using SharedPtr = std::shared_ptr<AsyncTextureCapture>;
+
+        struct Stats
+        {
+            uint64_t capturedCount = 0;         ///< Number of capture() requests.
+            uint64_t writtenCount = 0;          ///< Number of image files written.
+            uint64_t forcedWaitCount = 0;       ///< Number of readbacks waited on because too many were in flight.
+            uint32_t pendingReadbacks = 0;      ///< Readbacks the GPU hasn't finished yet.
+            uint32_t queuedImages = 0;          ///< Images read back but not written yet.
+        };
+
+        /** Create a capture service.
+            \param[in] encoderThreadCount Number of encoder threads. 0 selects half the logical cores.
+            \param[in] maxPendingReadbacks Number of readbacks that can be in flight before capture() waits for the oldest one.
+            \param[in] maxQueuedImages Number of images that can wait for an encoder before the render thread blocks.
+        */
+        static SharedPtr create(uint32_t encoderThreadCount = 0, uint32_t maxPendingReadbacks = kDefaultMaxPendingReadbacks, uint32_t maxQueuedImages = kDefaultMaxQueuedImages);
+        ~AsyncTextureCapture();
+
+        /** Capture a 2D texture subresource to an image file. The file is written asynchronously, call flush() to wait for it.
+            \param[in] pContext Render context to record the copy on.
+            \param[in] pTexture The texture to capture.
+            \param[in] mipLevel Requested mip-level.
+            \param[in] arraySlice Requested array-slice.
+            \param[in] filename Name of the file to save.
+            \param[in] format Destination image file format (e.g., PNG, PFM, etc.)
+            \param[in] exportFlags Save flags, see Bitmap::ExportFlags
+        */
+        void capture(RenderContext* pContext, Texture* pTexture, uint32_t mipLevel, uint32_t arraySlice, const std::string& filename, Bitmap::FileFormat format = Bitmap::FileFormat::PngFile, Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None);
+
+        /** Hand all readbacks the GPU has finished to the encoders. Doesn't wait for the GPU. Call once a frame.
+        */
+        void poll();
+
+        /** Wait until all pending captures are written to disk.
+        */
+        void flush();
+
+        /** Get the capture statistics.
+        */
+        Stats getStats() const;
+
+        static const uint32_t kDefaultMaxPendingReadbacks = 16;
+        static const uint32_t kDefaultMaxQueuedImages = 32;
+    private:
+        AsyncTextureCapture(uint32_t encoderThreadCount, uint32_t maxPendingReadbacks, uint32_t maxQueuedImages);
+
+        struct Image
+        {
+            std::string filename;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            Bitmap::FileFormat format = Bitmap::FileFormat::PngFile;
+            Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None;
+            ResourceFormat resourceFormat = ResourceFormat::Unknown;
+            std::vector<uint8_t> data;
+        };
+
+        struct Readback
+        {
+            CopyContext::ReadTextureTask::SharedPtr pTask;
+            Texture::SharedPtr pConversionTexture;      ///< RGBA32Float copy of the source, if a conversion was needed
+            Image image;                                ///< Image description, data is filled once the readback completes
+        };
+
+        void completeReadback();
+        void queueImage(Image&& image);
+        void encoderThread();
+        Buffer::SharedPtr acquireStagingBuffer(size_t minSize);
+        Texture::SharedPtr acquireConversionTexture(uint32_t width, uint32_t height);
+
+        uint32_t mMaxPendingReadbacks;
+        uint32_t mMaxQueuedImages;
+
+        // Render thread state
+        std::deque<Readback> mPendingReadbacks;
+        std::vector<Buffer::SharedPtr> mFreeStagingBuffers;
+        std::vector<Texture::SharedPtr> mFreeConversionTextures;
+        uint64_t mCapturedCount = 0;
+        uint64_t mForcedWaitCount = 0;
+
+        // Encoder state, guarded by mMutex
+        mutable std::mutex mMutex;
+        std::condition_variable mQueueChanged;
+        std::deque<Image> mQueuedImages;
+        uint32_t mActiveEncoders = 0;
+        uint64_t mWrittenCount = 0;
+        bool mTerminate = false;
+        std::vector<std::thread> mEncoderThreads;
+    };
+}
@@ -0,0 +1,151 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ShadingRate.h"
+#include "Scene/Camera/Camera.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "Utils/ShadingRate/ShadingRate.cs.slang";
+
+        const Gui::DropdownList kRateList =
+        {
+            { kShadingRate1x1, "1x1" },
+            { kShadingRate2x2, "2x2" },
+            { kShadingRate2x4, "2x4" },
+            { kShadingRate4x2, "4x2" },
+            { kShadingRate4x4, "4x4" },
+        };
+    }
+
+    ShadingRate::SharedPtr ShadingRate::create()
+    {
+        return SharedPtr(new ShadingRate());
+    }
+
+    ShadingRate::ShadingRate()
+    {
+        mpBuildPass = ComputePass::create(kShaderFile, "build");
+        mpResolvePass = ComputePass::create(kShaderFile, "resolve");
+
+        const float defaultZ = 1.f;
+        mpDefaultLinearZ = Texture::create2D(1, 1, ResourceFormat::R32Float, 1, 1, &defaultZ, Resource::BindFlags::ShaderResource);
+    }
+
+    void ShadingRate::setFoveaFromCamera(const Camera* pCamera)
+    {
+        assert(pCamera);
+        float3 dir = glm::normalize(pCamera->getTarget() - pCamera->getPosition());
+        float4 p = pCamera->getViewProjMatrix() * float4(pCamera->getPosition() + dir, 1.f);
+        float2 ndc = float2(p) / p.w;
+        mParams.foveaCenter = glm::clamp(float2(ndc.x, -ndc.y) * 0.5f + 0.5f, float2(0.f), float2(1.f));
+    }
+
+    void ShadingRate::build(RenderContext* pRenderContext, uint2 screenDim, const Texture::SharedPtr& pLinearZ)
+    {
+        PROFILE("buildShadingRate");
+
+        const uint2 tileDim = (screenDim + kShadingRateTileSize - 1u) / kShadingRateTileSize;
+        if (!mpRateImage || mpRateImage->getWidth() != tileDim.x || mpRateImage->getHeight() != tileDim.y)
+        {
+            mpRateImage = Texture::create2D(tileDim.x, tileDim.y, ResourceFormat::R8Uint, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+            mpRateImage->setName("ShadingRate::RateImage");
+        }
+        mParams.screenDim = screenDim;
+
+        if (!mEnabled)
+        {
+            pRenderContext->clearUAV(mpRateImage->getUAV().get(), uint4(kShadingRate1x1));
+            return;
+        }
+
+        ShadingRateParams params = mParams;
+        params.useDiscontinuity = params.useDiscontinuity && pLinearZ != nullptr;
+
+        auto var = mpBuildPass->getRootVar();
+        var["ShadingRateCB"]["gShadingRateParams"].setBlob(params);
+        var["gLinearZ"] = pLinearZ ? pLinearZ : mpDefaultLinearZ;
+        var["gRateImage"] = mpRateImage;
+        mpBuildPass->execute(pRenderContext, tileDim.x * kShadingRateTileSize, tileDim.y * kShadingRateTileSize);
+    }
+
+    void ShadingRate::setShaderData(const ShaderVar& var) const
+    {
+        var["ShadingRateCB"]["gShadingRateParams"].setBlob(mParams);
+        var["gShadingRateImage"] = mpRateImage;
+    }
+
+    void ShadingRate::resolve(RenderContext* pRenderContext, const Texture::SharedPtr& pColor, const Texture::SharedPtr& pTileMask)
+    {
+        PROFILE("resolveShadingRate");
+
+        assert(pColor);
+        if (!mEnabled) return;
+        if (!mpRateImage)
+        {
+            logWarning("ShadingRate::resolve() called before build(). Ignoring.");
+            return;
+        }
+
+        const bool useTileMask = pTileMask != nullptr;
+        if (useTileMask != mResolveTileMask)
+        {
+            if (useTileMask) mpResolvePass->addDefine("USE_TILE_MASK", "", true);
+            else mpResolvePass->removeDefine("USE_TILE_MASK", true);
+            mResolveTileMask = useTileMask;
+        }
+
+        auto var = mpResolvePass->getRootVar();
+        setShaderData(var);
+        var["gColor"] = pColor;
+        if (useTileMask) var["gTileMask"] = pTileMask;
+        mpResolvePass->execute(pRenderContext, mParams.screenDim.x, mParams.screenDim.y);
+    }
+
+    void ShadingRate::renderUI(Gui::Widgets& widget)
+    {
+        widget.checkbox("Enabled", mEnabled);
+        if (!mEnabled) return;
+
+        widget.dropdown("Coarsest rate", kRateList, mParams.coarsestRate);
+        widget.checkbox("Foveation", mParams.useFoveation);
+        if (mParams.useFoveation)
+        {
+            widget.var("Fovea center", mParams.foveaCenter, 0.f, 1.f, 0.01f);
+            widget.var("Inner radius", mParams.foveaInnerRadius, 0.f, 2.f, 0.01f);
+            widget.var("Outer radius", mParams.foveaOuterRadius, mParams.foveaInnerRadius, 2.f, 0.01f);
+        }
+        widget.checkbox("Depth discontinuities", mParams.useDiscontinuity);
+        if (mParams.useDiscontinuity)
+        {
+            widget.var("Discontinuity threshold", mParams.discontinuityThreshold, 0.f, 1.f, 0.005f);
+        }
+    }
+}
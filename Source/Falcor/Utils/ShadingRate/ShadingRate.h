@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ShadingRateParams.slang"
+#include "RenderGraph/BasePasses/ComputePass.h"
+
+namespace Falcor
+{
+    class Camera;
+
+    /** Variable-rate shading in software.
+
+        A rate image holds one shading rate per tile of kShadingRateTileSize x kShadingRateTileSize pixels. The rate is
+        selected by the distance to the fovea center (foveated rendering) and refined in tiles with depth discontinuities.
+        Passes opt in by only shading the anchor pixel of each block, see Utils/ShadingRate/ShadingRate.slang.
+
+        Usage per frame (and per eye in stereo rendering):
+        1. Optionally set the fovea center with setFoveaFromCamera() or setParams().
+        2. build() computes the rate image.
+        3. Bind it with setShaderData() to the passes that shade at reduced rate and run them.
+        4. resolve() fills the pixels those passes skipped.
+
+        The rate encoding matches D3D12_SHADING_RATE, so the rate image can also drive hardware variable-rate shading.
+    */
+    class dlldecl ShadingRate
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ShadingRate>;
+
+        /** Create a new object.
+            \return New object, or throws an exception on error.
+        */
+        static SharedPtr create();
+
+        /** Set the rate selection parameters. The screen size is set by build().
+        */
+        void setParams(const ShadingRateParams& params) { mParams = params; }
+
+        /** Get the rate selection parameters.
+        */
+        const ShadingRateParams& getParams() const { return mParams; }
+
+        /** Enable or disable reduced-rate shading. When disabled, build() sets all tiles to full rate and resolve() does nothing.
+        */
+        void setEnabled(bool enabled) { mEnabled = enabled; }
+
+        /** Check if reduced-rate shading is enabled.
+        */
+        bool isEnabled() const { return mEnabled; }
+
+        /** Place the fovea center where the camera's view direction hits the screen.
+            With the asymmetric projections of a stereo camera, this is not the center of the screen.
+        */
+        void setFoveaFromCamera(const Camera* pCamera);
+
+        /** Build the rate image.
+            \param[in] pRenderContext Render context.
+            \param[in] screenDim Screen size in pixels.
+            \param[in] pLinearZ Linear depth, used to find depth discontinuities. If nullptr, the rate is only selected by foveation.
+        */
+        void build(RenderContext* pRenderContext, uint2 screenDim, const Texture::SharedPtr& pLinearZ = nullptr);
+
+        /** Bind the rate image to a program importing Utils/ShadingRate/ShadingRate.slang.
+        */
+        void setShaderData(const ShaderVar& var) const;
+
+        /** Fill the pixels of an image that were skipped by a pass shading at reduced rate.
+            \param[in] pRenderContext Render context.
+            \param[in] pColor Image to resolve in place. Must be bindable as an unordered access view.
+            \param[in] pTileMask Optional mask with one texel per tile of the rate image. Only the tiles where the first channel is non-zero are resolved,
+                       the other pixels are left as is. This allows passes that only re-render some tiles, see HoleTiles. If nullptr, all tiles are resolved.
+        */
+        void resolve(RenderContext* pRenderContext, const Texture::SharedPtr& pColor, const Texture::SharedPtr& pTileMask = nullptr);
+
+        /** Get the rate image, or nullptr if none has been built.
+        */
+        const Texture::SharedPtr& getRateImage() const { return mpRateImage; }
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+    private:
+        ShadingRate();
+
+        ComputePass::SharedPtr mpBuildPass;
+        ComputePass::SharedPtr mpResolvePass;
+        Texture::SharedPtr mpRateImage;
+        Texture::SharedPtr mpDefaultLinearZ;    ///< Bound when no depth is given.
+
+        ShadingRateParams mParams;
+        bool mEnabled = true;
+        bool mResolveTileMask = false;          ///< True if the resolve program is compiled with a tile mask.
+    };
+}
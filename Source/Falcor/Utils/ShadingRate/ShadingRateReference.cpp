@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ShadingRateReference.h"
+
+namespace Falcor
+{
+    ShadingRateReference::ShadingRateReference(const ShadingRateParams& params, const std::vector<float>& linearZ)
+        : mParams(params)
+    {
+        const uint2 screenDim = params.screenDim;
+        assert(linearZ.empty() || linearZ.size() == (size_t)screenDim.x * screenDim.y);
+
+        mTileDim = (screenDim + kShadingRateTileSize - 1u) / kShadingRateTileSize;
+        std::vector<float> maxDiscontinuity((size_t)mTileDim.x * mTileDim.y, 0.f);
+        if (!linearZ.empty())
+        {
+            auto z = [&](uint32_t x, uint32_t y) { return linearZ[(size_t)y * screenDim.x + x]; };
+            for (uint32_t y = 0; y < screenDim.y; y++)
+            {
+                for (uint32_t x = 0; x < screenDim.x; x++)
+                {
+                    float d = getDepthDiscontinuity(z(x, y), z(std::min(x + 1, screenDim.x - 1), y), z(x, std::min(y + 1, screenDim.y - 1)));
+                    float& tileMax = maxDiscontinuity[(size_t)(y / kShadingRateTileSize) * mTileDim.x + x / kShadingRateTileSize];
+                    tileMax = std::max(tileMax, d);
+                }
+            }
+        }
+        else
+        {
+            mParams.useDiscontinuity = false;
+        }
+
+        mRates.resize((size_t)mTileDim.x * mTileDim.y);
+        for (uint32_t y = 0; y < mTileDim.y; y++)
+        {
+            for (uint32_t x = 0; x < mTileDim.x; x++)
+            {
+                size_t i = (size_t)y * mTileDim.x + x;
+                mRates[i] = selectShadingRate(uint2(x, y), maxDiscontinuity[i], mParams);
+            }
+        }
+    }
+
+    uint32_t ShadingRateReference::getTileRate(uint32_t x, uint32_t y) const
+    {
+        assert(x < mTileDim.x && y < mTileDim.y);
+        return mRates[(size_t)y * mTileDim.x + x];
+    }
+
+    uint32_t ShadingRateReference::getAnchorCount() const
+    {
+        uint32_t count = 0;
+        for (uint32_t y = 0; y < mParams.screenDim.y; y++)
+        {
+            for (uint32_t x = 0; x < mParams.screenDim.x; x++)
+            {
+                if (isAnchor(uint2(x, y))) count++;
+            }
+        }
+        return count;
+    }
+
+    void ShadingRateReference::resolve(std::vector<float4>& color, const std::vector<float>& tileMask) const
+    {
+        const uint2 screenDim = mParams.screenDim;
+        assert(color.size() == (size_t)screenDim.x * screenDim.y);
+        assert(tileMask.empty() || tileMask.size() == (size_t)mTileDim.x * mTileDim.y);
+
+        for (uint32_t y = 0; y < screenDim.y; y++)
+        {
+            for (uint32_t x = 0; x < screenDim.x; x++)
+            {
+                const uint2 pixel(x, y);
+                if (!tileMask.empty() && tileMask[(y / kShadingRateTileSize) * mTileDim.x + x / kShadingRateTileSize] == 0.f) continue;
+
+                const uint2 blockSize = getShadingRateBlockSize(getRate(pixel));
+                const uint2 anchor = pixel - pixel % blockSize;
+                if (anchor == pixel) continue;
+
+                const float2 f = float2(pixel - anchor) / float2(blockSize);
+                const float weights[4] = { (1.f - f.x) * (1.f - f.y), f.x * (1.f - f.y), (1.f - f.x) * f.y, f.x * f.y };
+                const uint2 offsets[4] = { uint2(0, 0), uint2(blockSize.x, 0), uint2(0, blockSize.y), blockSize };
+
+                float4 sum(0.f);
+                float weightSum = 0.f;
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    const uint2 q = anchor + offsets[i];
+                    if (weights[i] == 0.f || q.x >= screenDim.x || q.y >= screenDim.y || !isAnchor(q)) continue;
+                    sum += weights[i] * color[(size_t)q.y * screenDim.x + q.x];
+                    weightSum += weights[i];
+                }
+                color[(size_t)y * screenDim.x + x] = sum / weightSum;
+            }
+        }
+    }
+}
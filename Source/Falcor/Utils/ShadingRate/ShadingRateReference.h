@@ -0,0 +1,76 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ShadingRateParams.slang"
+
+namespace Falcor
+{
+    /** CPU implementation of the rate image build and resolve in ShadingRate.cs.slang.
+        It serves as the reference for unit tests and for experimenting with rate selection offline.
+    */
+    class dlldecl ShadingRateReference
+    {
+    public:
+        /** Build the rate image.
+            \param[in] params Selection parameters, including the screen size.
+            \param[in] linearZ Linear depth in row-major order. If empty, depth discontinuities are ignored.
+        */
+        ShadingRateReference(const ShadingRateParams& params, const std::vector<float>& linearZ = {});
+
+        /** Get the size of the rate image in tiles.
+        */
+        uint2 getTileDim() const { return mTileDim; }
+
+        /** Get the rate of a tile.
+        */
+        uint32_t getTileRate(uint32_t x, uint32_t y) const;
+
+        /** Get the rate of a pixel.
+        */
+        uint32_t getRate(uint2 pixel) const { return getTileRate(pixel.x / kShadingRateTileSize, pixel.y / kShadingRateTileSize); }
+
+        /** Returns true if the pixel is shaded at its rate.
+        */
+        bool isAnchor(uint2 pixel) const { return getShadingRateAnchor(pixel, getRate(pixel)) == pixel; }
+
+        /** Get the number of pixels that are shaded.
+        */
+        uint32_t getAnchorCount() const;
+
+        /** Fill the pixels that are not anchors.
+            \param[in,out] color Image in row-major order. Only the anchors are read.
+            \param[in] tileMask Optional mask with one value per tile in row-major order. Only the tiles where the mask is non-zero are resolved.
+        */
+        void resolve(std::vector<float4>& color, const std::vector<float>& tileMask = {}) const;
+
+    private:
+        ShadingRateParams mParams;
+        uint2 mTileDim;
+        std::vector<uint32_t> mRates;
+    };
+}
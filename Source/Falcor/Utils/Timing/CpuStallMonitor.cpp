@@ -0,0 +1,141 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "CpuStallMonitor.h"
+#include "Profiler.h"
+#include <mutex>
+#include <unordered_set>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::mutex sMutex;
+        CpuStallMonitor::Stats sFrameStats;
+        CpuStallMonitor::Stats sLastFrameStats;
+        CpuStallMonitor::Stats sTotalStats;
+        std::unordered_set<std::string> sReportedLocations;
+        bool sLoggingEnabled = true;
+
+        thread_local uint32_t tlExpectedDepth = 0;
+
+        std::string getStallLocation()
+        {
+            if (!gProfileEnabled) return "unknown location, enable profiling to find it";
+
+            const Profiler::EventData* pEvent = Profiler::getCurrentEvent();
+            if (!pEvent) return "outside of any profiler event";
+
+            // Event names are the path of zone names separated by '#'
+            std::string name = pEvent->name;
+            std::replace(name.begin(), name.end(), '#', '/');
+            if (!name.empty() && name.front() == '/') name.erase(0, 1);
+            return name;
+        }
+
+        void accumulate(CpuStallMonitor::Stats& stats, double waitMS, bool expected)
+        {
+            stats.stallCount++;
+            stats.stallTimeMS += waitMS;
+            if (!expected)
+            {
+                stats.unexpectedCount++;
+                stats.unexpectedTimeMS += waitMS;
+            }
+        }
+    }
+
+    CpuStallMonitor::ExpectedScope::ExpectedScope()
+    {
+        tlExpectedDepth++;
+    }
+
+    CpuStallMonitor::ExpectedScope::~ExpectedScope()
+    {
+        assert(tlExpectedDepth > 0);
+        tlExpectedDepth--;
+    }
+
+    void CpuStallMonitor::reportStall(double waitMS)
+    {
+        bool expected = tlExpectedDepth > 0;
+        std::string location;
+        bool firstAtLocation = false;
+
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            accumulate(sFrameStats, waitMS, expected);
+            accumulate(sTotalStats, waitMS, expected);
+            if (!expected && sLoggingEnabled)
+            {
+                location = getStallLocation();
+                firstAtLocation = sReportedLocations.insert(location).second;
+            }
+        }
+
+        if (firstAtLocation)
+        {
+            logWarning("CPU stalled for " + std::to_string(waitMS) + " ms waiting for the GPU (" + location + "). Further stalls at this location are only counted.");
+        }
+    }
+
+    void CpuStallMonitor::endFrame()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sLastFrameStats = sFrameStats;
+        sFrameStats = {};
+    }
+
+    CpuStallMonitor::Stats CpuStallMonitor::getLastFrameStats()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sLastFrameStats;
+    }
+
+    CpuStallMonitor::Stats CpuStallMonitor::getTotalStats()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sTotalStats;
+    }
+
+    std::string CpuStallMonitor::getMsg()
+    {
+        Stats frame = getLastFrameStats();
+        Stats total = getTotalStats();
+        char msg[256];
+        snprintf(msg, arraysize(msg), "CPU waits on GPU: %u (%.2f ms) this frame, %u unexpected (%.2f ms). Unexpected since start: %u\n",
+            frame.stallCount, frame.stallTimeMS, frame.unexpectedCount, frame.unexpectedTimeMS, total.unexpectedCount);
+        return msg;
+    }
+
+    void CpuStallMonitor::setLoggingEnabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sLoggingEnabled = enabled;
+    }
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+
+namespace Falcor
+{
+    /** Tracks the time the CPU spends blocked waiting for the GPU.
+        GpuFence::syncCpu() reports every wait that actually blocks. Waits that are part of frame pacing or loading are marked with an
+        ExpectedScope and are only counted. Any other wait stalls the CPU/GPU pipeline. It is counted as unexpected and logged once per
+        profiler event it occurred in, so enable profiling to see where the stall comes from.
+    */
+    class dlldecl CpuStallMonitor
+    {
+    public:
+        struct Stats
+        {
+            uint32_t stallCount = 0;            ///< Number of waits that blocked the CPU.
+            double stallTimeMS = 0.0;           ///< Total time the CPU was blocked.
+            uint32_t unexpectedCount = 0;       ///< Number of blocking waits outside an ExpectedScope.
+            double unexpectedTimeMS = 0.0;      ///< Time spent in blocking waits outside an ExpectedScope.
+        };
+
+        /** Marks a scope in which the CPU is expected to wait for the GPU, e.g. frame-latency throttling or a flush at load time.
+            Scopes are per-thread and can be nested.
+        */
+        class dlldecl ExpectedScope
+        {
+        public:
+            ExpectedScope();
+            ~ExpectedScope();
+            ExpectedScope(const ExpectedScope&) = delete;
+            ExpectedScope& operator=(const ExpectedScope&) = delete;
+        };
+
+        /** Report a wait that blocked the calling thread. This is called by GpuFence.
+            \param[in] waitMS Time the CPU was blocked.
+        */
+        static void reportStall(double waitMS);
+
+        /** Finish the current frame. This is called by Device::present().
+        */
+        static void endFrame();
+
+        /** Get the stats of the last completed frame.
+        */
+        static Stats getLastFrameStats();
+
+        /** Get the stats accumulated since the application started.
+        */
+        static Stats getTotalStats();
+
+        /** Get a string with the stats of the last frame.
+        */
+        static std::string getMsg();
+
+        /** Enable or disable logging of unexpected stalls. Stalls are counted either way.
+        */
+        static void setLoggingEnabled(bool enabled);
+    };
+}
@@ -0,0 +1,247 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "FrameTimeStatistics.h"
+#include <fstream>
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/prettywriter.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kFileMagic[8] = { 'F', 'A', 'L', 'C', 'O', 'R', 'F', 'T' };
+        const uint32_t kFileVersion = 1;
+        const std::streamoff kFrameCountOffset = sizeof(kFileMagic) + sizeof(kFileVersion);
+        const std::streamoff kFrameTimesOffset = kFrameCountOffset + sizeof(uint64_t);
+
+        // Histograms store microseconds. Frame times are tracked up to an hour, pass times up to 10 seconds at lower precision to keep them small.
+        const uint64_t kMaxFrameTimeUS = 3600ull * 1000 * 1000;
+        const uint64_t kMaxPassTimeUS = 10ull * 1000 * 1000;
+        const uint32_t kFrameTimeDigits = 3;
+        const uint32_t kPassTimeDigits = 2;
+        const size_t kMaxStutterFramesInSummary = 256;
+
+        uint64_t toMicroseconds(double ms)
+        {
+            return ms > 0 ? (uint64_t)std::llround(ms * 1000.0) : 0;
+        }
+
+        std::string getPassName(const std::string& eventName)
+        {
+            // Profiler event names are of the form "#parent#child".
+            size_t start = eventName.find_first_not_of('#');
+            if (start == std::string::npos) return eventName;
+            std::string name = eventName.substr(start);
+            std::replace(name.begin(), name.end(), '#', '/');
+            return name;
+        }
+
+        template<typename Writer>
+        void writeDistribution(Writer& writer, const char* key, const FrameTimeStatistics::Distribution& d)
+        {
+            writer.Key(key);
+            writer.StartObject();
+            writer.Key("count"); writer.Uint64(d.count);
+            writer.Key("min"); writer.Double(d.minMS);
+            writer.Key("max"); writer.Double(d.maxMS);
+            writer.Key("mean"); writer.Double(d.meanMS);
+            writer.Key("stdDev"); writer.Double(d.stdDevMS);
+            writer.Key("p50"); writer.Double(d.p50MS);
+            writer.Key("p90"); writer.Double(d.p90MS);
+            writer.Key("p95"); writer.Double(d.p95MS);
+            writer.Key("p99"); writer.Double(d.p99MS);
+            writer.Key("p99.9"); writer.Double(d.p999MS);
+            writer.EndObject();
+        }
+    }
+
+    FrameTimeStatistics::FrameTimeStatistics(const Options& options)
+        : mOptions(options)
+        , mFrameTimeHistogram(kMaxFrameTimeUS, kFrameTimeDigits)
+        , mJitterHistogram(kMaxFrameTimeUS, kFrameTimeDigits)
+    {
+    }
+
+    void FrameTimeStatistics::reset()
+    {
+        mFrameTimes.clear();
+        mFrameTimeHistogram.reset();
+        mJitterHistogram.reset();
+        mPasses.clear();
+        mPassLookup.clear();
+    }
+
+    void FrameTimeStatistics::addFrame(double frameTimeMS)
+    {
+        if (!mFrameTimes.empty())
+        {
+            mJitterHistogram.record(toMicroseconds(std::abs(frameTimeMS - (double)mFrameTimes.back())));
+        }
+        mFrameTimes.push_back((float)frameTimeMS);
+        mFrameTimeHistogram.record(toMicroseconds(frameTimeMS));
+    }
+
+    FrameTimeStatistics::PassStatistics& FrameTimeStatistics::getPassStatistics(const Profiler::EventData* pEvent)
+    {
+        // The profiler may reuse the address of a cleared event, so the cached entry is validated by name.
+        auto cached = mPassLookup.find(pEvent);
+        if (cached != mPassLookup.end() && cached->second->first == pEvent->name) return cached->second->second;
+
+        auto it = mPasses.find(pEvent->name);
+        if (it == mPasses.end())
+        {
+            PassStatistics stats = { HdrHistogram(kMaxPassTimeUS, kPassTimeDigits), HdrHistogram(kMaxPassTimeUS, kPassTimeDigits) };
+            it = mPasses.emplace(pEvent->name, std::move(stats)).first;
+        }
+        mPassLookup[pEvent] = it;
+        return it->second;
+    }
+
+    void FrameTimeStatistics::addProfilerSamples()
+    {
+        if (!gProfileEnabled) return;
+
+        for (const auto& sample : Profiler::getLastFrameSamples())
+        {
+            PassStatistics& stats = getPassStatistics(sample.pEvent);
+            if (sample.cpuTimeMS >= 0) stats.cpu.record(toMicroseconds(sample.cpuTimeMS));
+            if (sample.gpuTimeMS >= 0) stats.gpu.record(toMicroseconds(sample.gpuTimeMS));
+        }
+    }
+
+    FrameTimeStatistics::Distribution FrameTimeStatistics::getDistribution(const HdrHistogram& histogram)
+    {
+        Distribution d;
+        d.count = histogram.getTotalCount();
+        d.minMS = histogram.getMin() * 1e-3;
+        d.maxMS = histogram.getMax() * 1e-3;
+        d.meanMS = histogram.getMean() * 1e-3;
+        d.stdDevMS = histogram.getStdDev() * 1e-3;
+        d.p50MS = histogram.getValueAtPercentile(50.0) * 1e-3;
+        d.p90MS = histogram.getValueAtPercentile(90.0) * 1e-3;
+        d.p95MS = histogram.getValueAtPercentile(95.0) * 1e-3;
+        d.p99MS = histogram.getValueAtPercentile(99.0) * 1e-3;
+        d.p999MS = histogram.getValueAtPercentile(99.9) * 1e-3;
+        return d;
+    }
+
+    FrameTimeStatistics::Summary FrameTimeStatistics::getSummary() const
+    {
+        Summary summary;
+        summary.frameTime = getDistribution(mFrameTimeHistogram);
+        summary.jitter = getDistribution(mJitterHistogram);
+        summary.stutterThresholdMS = mOptions.stutterFactor * summary.frameTime.p50MS;
+        summary.stutterCount = getStutterFrames().size();
+        return summary;
+    }
+
+    std::vector<uint64_t> FrameTimeStatistics::getStutterFrames() const
+    {
+        std::vector<uint64_t> frames;
+        const double threshold = mOptions.stutterFactor * mFrameTimeHistogram.getValueAtPercentile(50.0) * 1e-3;
+        for (size_t i = 0; i < mFrameTimes.size(); i++)
+        {
+            if (mFrameTimes[i] > threshold) frames.push_back(i);
+        }
+        return frames;
+    }
+
+    bool FrameTimeStatistics::writeFrameTimes(const std::string& filename) const
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.good()) return false;
+        return appendFrameTimes(file, 0);
+    }
+
+    bool FrameTimeStatistics::appendFrameTimes(std::ostream& file, uint64_t firstFrame) const
+    {
+        const uint64_t frameCount = mFrameTimes.size();
+        if (firstFrame > frameCount) return false;
+
+        if (firstFrame == 0)
+        {
+            file.seekp(0);
+            file.write(kFileMagic, sizeof(kFileMagic));
+            file.write(reinterpret_cast<const char*>(&kFileVersion), sizeof(kFileVersion));
+            const uint64_t emptyCount = 0;
+            file.write(reinterpret_cast<const char*>(&emptyCount), sizeof(emptyCount));
+        }
+
+        // Write the frames before the count, so an interrupted write leaves the previous count valid.
+        file.seekp(kFrameTimesOffset + std::streamoff(firstFrame * sizeof(float)));
+        file.write(reinterpret_cast<const char*>(mFrameTimes.data() + firstFrame), (frameCount - firstFrame) * sizeof(float));
+        file.flush();
+        file.seekp(kFrameCountOffset);
+        file.write(reinterpret_cast<const char*>(&frameCount), sizeof(frameCount));
+        file.flush();
+        return file.good();
+    }
+
+    bool FrameTimeStatistics::writeSummary(const std::string& filename) const
+    {
+        std::ofstream file(filename, std::ios::trunc);
+        if (!file.good()) return false;
+
+        const Summary summary = getSummary();
+        const std::vector<uint64_t> stutterFrames = getStutterFrames();
+
+        rapidjson::OStreamWrapper osw(file);
+        rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(osw);
+        writer.StartObject();
+        writer.Key("frameCount"); writer.Uint64(getFrameCount());
+        writeDistribution(writer, "frameTimeMS", summary.frameTime);
+        writeDistribution(writer, "jitterMS", summary.jitter);
+
+        writer.Key("stutter");
+        writer.StartObject();
+        writer.Key("factor"); writer.Double(mOptions.stutterFactor);
+        writer.Key("thresholdMS"); writer.Double(summary.stutterThresholdMS);
+        writer.Key("count"); writer.Uint64(summary.stutterCount);
+        writer.Key("frames");
+        writer.StartArray();
+        for (size_t i = 0; i < std::min(stutterFrames.size(), kMaxStutterFramesInSummary); i++) writer.Uint64(stutterFrames[i]);
+        writer.EndArray();
+        writer.EndObject();
+
+        writer.Key("passes");
+        writer.StartObject();
+        for (const auto& pass : mPasses)
+        {
+            writer.Key(getPassName(pass.first).c_str());
+            writer.StartObject();
+            if (pass.second.cpu.getTotalCount()) writeDistribution(writer, "cpuMS", getDistribution(pass.second.cpu));
+            if (pass.second.gpu.getTotalCount()) writeDistribution(writer, "gpuMS", getDistribution(pass.second.gpu));
+            writer.EndObject();
+        }
+        writer.EndObject();
+
+        writer.EndObject();
+        return file.good();
+    }
+}
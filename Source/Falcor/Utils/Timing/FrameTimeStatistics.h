@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <iosfwd>
+#include <map>
+#include <unordered_map>
+#include "HdrHistogram.h"
+#include "Profiler.h"
+
+namespace Falcor
+{
+    /** Streaming frame time statistics.
+        Frame times are accumulated in HDR histograms (microsecond resolution) for percentiles, together with frame pacing jitter
+        (the absolute difference between consecutive frame times) and stutter detection (frames taking longer than a multiple of the median).
+        Profiler event times can be joined in to get a per-pass breakdown.
+        The raw frame times are buffered in memory and only written to disk on request, so capturing doesn't perturb the measured frame times.
+        Long captures can append them to disk in batches with appendFrameTimes().
+    */
+    class dlldecl FrameTimeStatistics
+    {
+    public:
+        struct Options
+        {
+            double stutterFactor = 2.0;     ///< Frames taking longer than stutterFactor times the median frame time are counted as stutter.
+        };
+
+        struct Distribution
+        {
+            uint64_t count = 0;
+            double minMS = 0;
+            double maxMS = 0;
+            double meanMS = 0;
+            double stdDevMS = 0;
+            double p50MS = 0;
+            double p90MS = 0;
+            double p95MS = 0;
+            double p99MS = 0;
+            double p999MS = 0;
+        };
+
+        struct Summary
+        {
+            Distribution frameTime;
+            Distribution jitter;
+            double stutterThresholdMS = 0;
+            uint64_t stutterCount = 0;
+        };
+
+        FrameTimeStatistics(const Options& options = Options());
+
+        /** Remove all recorded frames.
+        */
+        void reset();
+
+        /** Record the time of a frame.
+            \param[in] frameTimeMS Frame time in milliseconds.
+        */
+        void addFrame(double frameTimeMS);
+
+        /** Record the per-event times of the most recently completed frame from the Profiler. Does nothing if profiling is disabled.
+        */
+        void addProfilerSamples();
+
+        /** Get the number of recorded frames.
+        */
+        uint64_t getFrameCount() const { return mFrameTimes.size(); }
+
+        /** Compute the summary of all recorded frames.
+        */
+        Summary getSummary() const;
+
+        /** Get the indices of the frames that were detected as stutter.
+        */
+        std::vector<uint64_t> getStutterFrames() const;
+
+        /** Write the recorded frame times to a binary file.
+            The file starts with the 8 characters "FALCORFT", followed by the format version and the frame count as uint32 and uint64,
+            followed by the frame times in milliseconds as float32.
+            \return True if the file was written.
+        */
+        bool writeFrameTimes(const std::string& filename) const;
+
+        /** Append frame times to a binary file in the format of writeFrameTimes().
+            The frames from firstFrame on are written, then the frame count in the header is updated, so the file stays valid if the application exits between calls.
+            \param[in] file Binary file stream opened for writing. A new file is started if firstFrame is zero.
+            \param[in] firstFrame Index of the first frame to write, usually the number of frames written by the previous call.
+            \return True if the file was written.
+        */
+        bool appendFrameTimes(std::ostream& file, uint64_t firstFrame) const;
+
+        /** Write the summary, including the per-pass breakdown, to a JSON file.
+            \return True if the file was written.
+        */
+        bool writeSummary(const std::string& filename) const;
+
+    private:
+        struct PassStatistics
+        {
+            HdrHistogram cpu;
+            HdrHistogram gpu;
+        };
+
+        static Distribution getDistribution(const HdrHistogram& histogram);
+        PassStatistics& getPassStatistics(const Profiler::EventData* pEvent);
+
+        Options mOptions;
+        std::vector<float> mFrameTimes;
+        HdrHistogram mFrameTimeHistogram;
+        HdrHistogram mJitterHistogram;
+        std::map<std::string, PassStatistics> mPasses;      ///< Keyed by the hierarchical profiler event name.
+        std::unordered_map<const Profiler::EventData*, std::map<std::string, PassStatistics>::iterator> mPassLookup;
+    };
+}
@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "HdrHistogram.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        uint32_t bitScanReverse64(uint64_t a)
+        {
+            return (a >> 32) ? 32 + bitScanReverse(uint32_t(a >> 32)) : bitScanReverse(uint32_t(a));
+        }
+    }
+
+    HdrHistogram::HdrHistogram(uint64_t highestTrackableValue, uint32_t significantDigits)
+        : mHighestTrackableValue(std::max<uint64_t>(highestTrackableValue, 2))
+    {
+        significantDigits = std::clamp(significantDigits, 1u, 5u);
+
+        // Each power-of-two bucket is split into linear sub-buckets, enough to resolve the requested number of decimal digits.
+        uint64_t largestValueWithSingleUnitResolution = 2;
+        for (uint32_t i = 0; i < significantDigits; i++) largestValueWithSingleUnitResolution *= 10;
+        uint32_t subBucketCountMagnitude = bitScanReverse64(largestValueWithSingleUnitResolution - 1) + 1;
+        mSubBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+        mSubBucketHalfCount = 1u << mSubBucketHalfCountMagnitude;
+        mSubBucketMask = (2ull << mSubBucketHalfCountMagnitude) - 1;
+
+        uint32_t bucketCount = getBucketIndex(mHighestTrackableValue) + 1;
+        mCounts.resize((size_t)(bucketCount + 1) * mSubBucketHalfCount);
+    }
+
+    uint32_t HdrHistogram::getBucketIndex(uint64_t value) const
+    {
+        // Values smaller than the sub-bucket count all land in bucket 0.
+        return bitScanReverse64(value | mSubBucketMask) - mSubBucketHalfCountMagnitude;
+    }
+
+    uint32_t HdrHistogram::getCountsIndex(uint64_t value) const
+    {
+        uint32_t bucketIndex = getBucketIndex(value);
+        uint32_t subBucketIndex = (uint32_t)(value >> bucketIndex);
+        return ((bucketIndex + 1) << mSubBucketHalfCountMagnitude) + subBucketIndex - mSubBucketHalfCount;
+    }
+
+    uint64_t HdrHistogram::getValueFromIndex(uint32_t index) const
+    {
+        int32_t bucketIndex = (int32_t)(index >> mSubBucketHalfCountMagnitude) - 1;
+        uint32_t subBucketIndex = (index & (mSubBucketHalfCount - 1)) + mSubBucketHalfCount;
+        if (bucketIndex < 0)
+        {
+            subBucketIndex -= mSubBucketHalfCount;
+            bucketIndex = 0;
+        }
+        return (uint64_t)subBucketIndex << bucketIndex;
+    }
+
+    uint64_t HdrHistogram::getEquivalentRange(uint64_t value) const
+    {
+        return 1ull << getBucketIndex(std::min(value, mHighestTrackableValue));
+    }
+
+    void HdrHistogram::record(uint64_t value, uint64_t count)
+    {
+        value = std::min(value, mHighestTrackableValue);
+        mCounts[getCountsIndex(value)] += count;
+        mTotalCount += count;
+        mMin = std::min(mMin, value);
+        mMax = std::max(mMax, value);
+        mSum += (double)value * count;
+        mSumSquares += (double)value * (double)value * count;
+    }
+
+    void HdrHistogram::reset()
+    {
+        std::fill(mCounts.begin(), mCounts.end(), 0);
+        mTotalCount = 0;
+        mMin = ~0ull;
+        mMax = 0;
+        mSum = 0;
+        mSumSquares = 0;
+    }
+
+    void HdrHistogram::add(const HdrHistogram& other)
+    {
+        assert(mCounts.size() == other.mCounts.size() && mSubBucketHalfCount == other.mSubBucketHalfCount);
+        for (size_t i = 0; i < mCounts.size(); i++) mCounts[i] += other.mCounts[i];
+        mTotalCount += other.mTotalCount;
+        mMin = std::min(mMin, other.mMin);
+        mMax = std::max(mMax, other.mMax);
+        mSum += other.mSum;
+        mSumSquares += other.mSumSquares;
+    }
+
+    uint64_t HdrHistogram::getValueAtPercentile(double percentile) const
+    {
+        if (mTotalCount == 0) return 0;
+
+        percentile = std::clamp(percentile, 0.0, 100.0);
+        uint64_t countAtPercentile = std::max<uint64_t>((uint64_t)std::ceil(percentile / 100.0 * mTotalCount), 1);
+
+        uint64_t cumulativeCount = 0;
+        for (uint32_t i = 0; i < (uint32_t)mCounts.size(); i++)
+        {
+            cumulativeCount += mCounts[i];
+            if (cumulativeCount >= countAtPercentile)
+            {
+                uint64_t value = getValueFromIndex(i);
+                uint64_t highestEquivalentValue = value + getEquivalentRange(value) - 1;
+                return std::clamp(highestEquivalentValue, getMin(), mMax);
+            }
+        }
+        return mMax;
+    }
+
+    uint64_t HdrHistogram::getCountAbove(uint64_t value) const
+    {
+        if (value >= mMax) return 0;
+
+        uint64_t count = 0;
+        for (uint32_t i = getCountsIndex(std::min(value, mHighestTrackableValue)) + 1; i < (uint32_t)mCounts.size(); i++)
+        {
+            count += mCounts[i];
+        }
+        return count;
+    }
+
+    double HdrHistogram::getMean() const
+    {
+        return mTotalCount ? mSum / mTotalCount : 0.0;
+    }
+
+    double HdrHistogram::getStdDev() const
+    {
+        if (mTotalCount == 0) return 0.0;
+        double mean = getMean();
+        return std::sqrt(std::max(mSumSquares / mTotalCount - mean * mean, 0.0));
+    }
+}
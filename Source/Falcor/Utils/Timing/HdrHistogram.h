@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <vector>
+
+namespace Falcor
+{
+    /** High dynamic range histogram.
+        Records positive integer values with a fixed number of significant decimal digits over a range of many orders of magnitude,
+        using log-linear buckets (see http://hdrhistogram.org). Recording is O(1) and the memory footprint is independent of the number of samples.
+    */
+    class dlldecl HdrHistogram
+    {
+    public:
+        /** Create a histogram.
+            \param[in] highestTrackableValue Largest value that can be recorded. Larger values are clamped.
+            \param[in] significantDigits Number of significant decimal digits kept, in the range [1, 5].
+        */
+        HdrHistogram(uint64_t highestTrackableValue = 3600ull * 1000 * 1000 * 1000, uint32_t significantDigits = 3);
+
+        /** Record a value.
+            \param[in] value The value. Values above the highest trackable value are clamped.
+            \param[in] count Number of times to record the value.
+        */
+        void record(uint64_t value, uint64_t count = 1);
+
+        /** Remove all recorded values.
+        */
+        void reset();
+
+        /** Add all values recorded in another histogram. The histograms must have been created with the same parameters.
+        */
+        void add(const HdrHistogram& other);
+
+        /** Get the value at a given percentile.
+            \param[in] percentile Percentile in the range [0, 100].
+            \return The highest value that is equivalent to the value at the percentile, or zero if the histogram is empty.
+        */
+        uint64_t getValueAtPercentile(double percentile) const;
+
+        /** Get the number of recorded values that are larger than a threshold, at the precision of the histogram.
+        */
+        uint64_t getCountAbove(uint64_t value) const;
+
+        uint64_t getTotalCount() const { return mTotalCount; }
+        uint64_t getMin() const { return mTotalCount ? mMin : 0; }
+        uint64_t getMax() const { return mMax; }
+        double getMean() const;
+        double getStdDev() const;
+
+        /** Get the size of the range of values that are counted as equal to the given value.
+        */
+        uint64_t getEquivalentRange(uint64_t value) const;
+
+    private:
+        uint32_t getBucketIndex(uint64_t value) const;
+        uint32_t getCountsIndex(uint64_t value) const;
+        uint64_t getValueFromIndex(uint32_t index) const;
+
+        uint64_t mHighestTrackableValue;
+        uint32_t mSubBucketHalfCountMagnitude;
+        uint32_t mSubBucketHalfCount;
+        uint64_t mSubBucketMask;
+        std::vector<uint64_t> mCounts;
+
+        uint64_t mTotalCount = 0;
+        uint64_t mMin = ~0ull;
+        uint64_t mMax = 0;
+        double mSum = 0;
+        double mSumSquares = 0;
+    };
+}
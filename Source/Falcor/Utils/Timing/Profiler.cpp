@@ -27,26 +27,214 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "Profiler.h"
-#include "Core/API/GpuTimer.h"
+#include "Core/API/GpuTimestampPool.h"
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <thread>
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/writer.h"
 #define USE_PIX
 #include "WinPixEventRuntime/Include/WinPixEventRuntime/pix3.h"
 
 namespace Falcor
 {
+    namespace
+    {
+        void updateRunningAverage(double& average, double value)
+        {
+            // With sigma = 0.98, then after 100 frames, a given value's contribution is down to ~1.7% of
+            // the running average, which seems to provide a reasonable trade-off of temporal smoothing
+            // versus setting in to a new value when something has changed.
+            const double sigma = .98;
+            if (average < 0.) average = value;
+            else average = sigma * average + (1. - sigma) * value;
+        }
+    }
+
     bool gProfileEnabled = false;
 
     std::unordered_map<std::string, Profiler::EventData*> Profiler::sProfilerEvents;
     std::vector<Profiler::EventData*> Profiler::sRegisteredEvents;
-    std::string curEventName = "";
-    uint32_t Profiler::sCurrentLevel = 0;
+    std::unordered_map<uint64_t, Profiler::EventData*> Profiler::sChildEvents;
+    std::unordered_map<std::string, Profiler::ZoneID> Profiler::sZoneIDs;
+    std::vector<std::string> Profiler::sZoneNames;
+    std::mutex Profiler::sMutex;
+    std::atomic<uint32_t> Profiler::sGeneration = 0;
+    uint32_t Profiler::sNextEventID = 0;
     uint32_t Profiler::sGpuTimerIndex = 0;
+    std::vector<Profiler::EventSample> Profiler::sLastFrameSamples;
+    GpuTimestampPool::SharedPtr Profiler::spTimestampPool;
+
+    namespace
+    {
+        const uint32_t kRootEventID = 0xffffffff;
+
+        struct EventStackEntry
+        {
+            Profiler::EventData* pEvent;
+            Profiler::ZoneID zone;
+            uint32_t level;                     // Level in the event hierarchy
+            uint32_t generation;                // Generation of pEvent. Entries from before the last clearEvents() are dropped when they end.
+            uint32_t recursionDepth;
+            CpuTimer::TimePoint start;
+            Profiler::ZoneID lastChildZone;     // Most recently entered child, which avoids the cache lookup in loops
+            Profiler::EventData* pLastChild;
+        };
+
+        // Per-thread state. The event cache mirrors Profiler::sChildEvents so that the common case needs no locking.
+        thread_local std::vector<EventStackEntry> tlEventStack;
+        thread_local std::unordered_map<uint64_t, Profiler::EventData*> tlEventCache;
+        thread_local uint32_t tlCacheGeneration = 0;
+
+        // Parent of the root events of this thread, see Profiler::setThreadParent().
+        thread_local const Profiler::EventData* tlParentEvent = nullptr;
+        thread_local uint32_t tlParentGeneration = 0;
+        thread_local uint32_t tlParentLevel = 0;
+
+        // Number of open stack entries (plus pushes in progress) on all threads. Events removed by clearEvents() are only deleted once it is zero.
+        std::atomic<uint32_t> sOpenEventCount = 0;
+        std::vector<Profiler::EventData*> sRetiredEvents;
+
+        // Per-thread cache of the zone IDs of string-named events. Zone IDs are never invalidated, so the cache needs no generation check.
+        thread_local std::unordered_map<std::string, Profiler::ZoneID> tlZoneIDs;
+
+        Profiler::ZoneID getZoneID(const std::string& name)
+        {
+            auto it = tlZoneIDs.find(name);
+            if (it != tlZoneIDs.end()) return it->second;
+
+            // First use of this name on this thread. registerZone() takes the global lock.
+            Profiler::ZoneID zone = Profiler::registerZone(name);
+            tlZoneIDs.emplace(name, zone);
+            return zone;
+        }
+
+        const uint32_t kGpuThreadIndex = 0xffffffff;
+
+        struct TraceEvent
+        {
+            const Profiler::EventData* pEvent;  // nullptr for frame markers
+            uint32_t threadIndex;
+            uint64_t frame;                     // Relative to the start of the capture
+            int64_t beginNs;
+            int64_t endNs;
+        };
+
+        // Timeline capture. Events are written to a ring buffer from any thread by claiming a slot with an atomic counter.
+        // Writers do not take a lock. Instead they register in 'activeWriters', and stopCaptureWriters() waits for them before the ring buffer is read or modified.
+        struct TraceCapture
+        {
+            std::atomic<bool> enabled = false;
+            std::atomic<uint32_t> activeWriters = 0;
+            std::vector<TraceEvent> events;
+            std::atomic<uint64_t> eventCount = 0;
+            std::atomic<uint32_t> generation = 0;   // Event generation of the captured events
+            uint64_t startFrame = 0;
+            int64_t startNs = 0;
+            int64_t lastFrameEndNs = 0;
+            uint32_t mainThreadIndex = 0;
+        } sCapture;
+
+        std::atomic<uint64_t> sFrameIndex = 0;
+        std::atomic<uint32_t> sThreadCount = 0;
+        thread_local uint32_t tlThreadIndex = kGpuThreadIndex;
+
+        uint32_t getThreadIndex()
+        {
+            if (tlThreadIndex == kGpuThreadIndex) tlThreadIndex = sThreadCount.fetch_add(1, std::memory_order_relaxed);
+            return tlThreadIndex;
+        }
+
+        int64_t getTimeNs(const CpuTimer::TimePoint& time)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        }
+
+        void recordTraceEvent(const Profiler::EventData* pEvent, uint32_t generation, uint32_t threadIndex, uint64_t frame, int64_t beginNs, int64_t endNs)
+        {
+            // Register as a writer before checking that the capture is still running, so that stopCaptureWriters() either sees us or we see the capture stopped.
+            // Events from before the last clearEvents() are not recorded, they may be deleted before the capture is exported.
+            sCapture.activeWriters.fetch_add(1);
+            if (sCapture.enabled.load() && sCapture.generation.load() == generation)
+            {
+                uint64_t slot = sCapture.eventCount.fetch_add(1, std::memory_order_relaxed) % sCapture.events.size();
+                sCapture.events[slot] = { pEvent, threadIndex, frame, beginNs, endNs };
+            }
+            sCapture.activeWriters.fetch_sub(1, std::memory_order_release);
+        }
+
+        // Stop the capture and wait for the writers that are still recording an event. Returns true if the capture was running.
+        bool stopCaptureWriters()
+        {
+            bool wasEnabled = sCapture.enabled.exchange(false);
+            while (sCapture.activeWriters.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+            return wasEnabled;
+        }
+
+        bool writeChromeTrace(const std::string& filename, std::vector<TraceEvent>& events)
+        {
+            std::ofstream ofs(filename);
+            if (!ofs.good()) return false;
+
+            std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.beginNs < b.beginNs; });
+
+            rapidjson::OStreamWrapper osw(ofs);
+            rapidjson::Writer<rapidjson::OStreamWrapper> writer(osw);
+            writer.StartObject();
+            writer.Key("displayTimeUnit");
+            writer.String("ms");
+            writer.Key("traceEvents");
+            writer.StartArray();
+
+            // Name the tracks. The GPU gets tid 0, CPU threads are offset by one.
+            auto getTid = [](uint32_t threadIndex) { return threadIndex == kGpuThreadIndex ? 0u : threadIndex + 1; };
+            auto writeThreadName = [&writer](uint32_t tid, const std::string& name)
+            {
+                writer.StartObject();
+                writer.Key("name"); writer.String("thread_name");
+                writer.Key("ph"); writer.String("M");
+                writer.Key("pid"); writer.Uint(0);
+                writer.Key("tid"); writer.Uint(tid);
+                writer.Key("args"); writer.StartObject(); writer.Key("name"); writer.String(name.c_str()); writer.EndObject();
+                writer.EndObject();
+            };
+            writeThreadName(getTid(kGpuThreadIndex), "GPU");
+            const uint32_t threadCount = sThreadCount.load();
+            for (uint32_t i = 0; i < threadCount; i++)
+            {
+                writeThreadName(getTid(i), i == sCapture.mainThreadIndex ? "Main thread" : "Thread " + std::to_string(i));
+            }
+
+            for (const TraceEvent& e : events)
+            {
+                std::string name = e.pEvent ? e.pEvent->name.substr(e.pEvent->name.find_last_of("#") + 1) : "Frame " + std::to_string(e.frame);
+                writer.StartObject();
+                writer.Key("name"); writer.String(name.c_str());
+                writer.Key("cat"); writer.String(e.threadIndex == kGpuThreadIndex ? "GPU" : "CPU");
+                writer.Key("ph"); writer.String("X");
+                writer.Key("pid"); writer.Uint(0);
+                writer.Key("tid"); writer.Uint(getTid(e.threadIndex));
+                writer.Key("ts"); writer.Double((e.beginNs - sCapture.startNs) * 1.0e-3);
+                writer.Key("dur"); writer.Double((e.endNs - e.beginNs) * 1.0e-3);
+                writer.Key("args");
+                writer.StartObject();
+                writer.Key("frame"); writer.Uint64(e.frame);
+                if (e.pEvent) { writer.Key("path"); writer.String(e.pEvent->name.c_str()); }
+                writer.EndObject();
+                writer.EndObject();
+            }
+
+            writer.EndArray();
+            writer.EndObject();
+            return ofs.good();
+        }
+    }
 
     void Profiler::initNewEvent(EventData *pEvent, const std::string& name)
     {
         pEvent->name = name;
-        sProfilerEvents[curEventName] = pEvent;
+        sProfilerEvents[name] = pEvent;
     }
 
     Profiler::EventData* Profiler::createNewEvent(const std::string& name)
@@ -58,6 +246,7 @@ namespace Falcor
 
     Profiler::EventData* Profiler::isEventRegistered(const std::string& name)
     {
+        std::lock_guard<std::mutex> lock(sMutex);
         auto event = sProfilerEvents.find(name);
         return (event == sProfilerEvents.end()) ? nullptr : event->second;
     }
@@ -65,39 +254,196 @@ namespace Falcor
     Profiler::EventData* Profiler::getEvent(const std::string& name)
     {
         auto event = isEventRegistered(name);
-        return event ? event : createNewEvent(name);
+        if (event) return event;
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        EventData* pData = createNewEvent(name);
+        pData->id = sNextEventID++;
+        return pData;
     }
 
-    void Profiler::startEvent(const std::string& name, Flags flags, bool showInMsg)
+    Profiler::ZoneID Profiler::registerZone(const std::string& name)
     {
-        if (gProfileEnabled && is_set(flags, Flags::Internal))
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto it = sZoneIDs.find(name);
+        if (it != sZoneIDs.end()) return it->second;
+
+        ZoneID zone = (ZoneID)sZoneNames.size();
+        sZoneNames.push_back(name);
+        sZoneIDs[name] = zone;
+        return zone;
+    }
+
+    Profiler::EventData* Profiler::getChildEvent(const EventData* pParent, ZoneID zone)
+    {
+        const uint64_t key = (uint64_t(pParent ? pParent->id : kRootEventID) << 32) | zone;
+
+        const uint32_t generation = sGeneration.load(std::memory_order_acquire);
+        if (tlCacheGeneration != generation)
+        {
+            tlEventCache.clear();
+            tlCacheGeneration = generation;
+        }
+
+        auto cached = tlEventCache.find(key);
+        if (cached != tlEventCache.end()) return cached->second;
+
+        // First use of this event on this thread. The hierarchical name is only built when the event is created.
+        std::lock_guard<std::mutex> lock(sMutex);
+        EventData*& pData = sChildEvents[key];
+        if (!pData)
+        {
+            pData = createNewEvent((pParent ? pParent->name : std::string()) + "#" + sZoneNames[zone]);
+            pData->id = sNextEventID++;
+        }
+        tlEventCache[key] = pData;
+        return pData;
+    }
+
+    void Profiler::registerEvent(EventData* pData, uint32_t level, uint32_t generation)
+    {
+        // endFrame() advances the frame under the lock, so the check and the registration can't straddle a frame boundary.
+        // clearEvents() also runs under the lock, so an event it removed is never registered again.
+        std::lock_guard<std::mutex> lock(sMutex);
+        const uint64_t frame = sFrameIndex.load();
+        if (pData->registeredFrame.load() == frame || sGeneration.load() != generation) return;
+        pData->registeredFrame = frame;
+        pData->level = level;
+        pData->showInMsg = true;
+        sRegisteredEvents.push_back(pData);
+    }
+
+    Profiler::EventData* Profiler::pushEvent(ZoneID zone)
+    {
+        auto& stack = tlEventStack;
+        if (!stack.empty() && stack.back().zone == zone)
+        {
+            stack.back().recursionDepth++;
+            return nullptr;
+        }
+
+        // Count the entry before looking up the event. Once clearEvents() has advanced the generation, a thread that isn't counted can't hold a removed event.
+        sOpenEventCount.fetch_add(1);
+        const uint32_t generation = sGeneration.load();
+
+        EventData* pData = nullptr;
+        uint32_t level = 0;
+        if (stack.empty())
+        {
+            const EventData* pParent = tlParentGeneration == generation ? tlParentEvent : nullptr;
+            pData = getChildEvent(pParent, zone);
+            level = pParent ? tlParentLevel + 1 : 0;
+        }
+        else
         {
-            curEventName = curEventName + "#" + name;
-            EventData* pData = getEvent(curEventName);
-            pData->triggered++;
-            if (pData->triggered > 1)
+            EventStackEntry& parent = stack.back();
+            if (parent.lastChildZone != zone || tlCacheGeneration != generation)
             {
-                logWarning("Profiler event `" + name + "` was triggered while it is already running. Nesting profiler events with the same name is disallowed and you should probably fix that. Ignoring the new call");
-                return;
+                parent.pLastChild = getChildEvent(parent.pEvent, zone);
+                parent.lastChildZone = zone;
+            }
+            pData = parent.pLastChild;
+            level = parent.level + 1;
+        }
+
+        if (pData->registeredFrame.load() != sFrameIndex.load()) registerEvent(pData, level, generation);
+        stack.push_back({ pData, zone, level, generation, 0, CpuTimer::getCurrentTimePoint(), kInvalidZone, nullptr });
+        return pData;
+    }
+
+    Profiler::EventData* Profiler::popEvent(ZoneID zone)
+    {
+        auto& stack = tlEventStack;
+        if (stack.empty() || stack.back().zone != zone)
+        {
+            std::string name;
+            {
+                std::lock_guard<std::mutex> lock(sMutex);
+                name = sZoneNames[zone];
             }
+            logWarning("Profiler event `" + name + "` was ended without a matching start on this thread. Ignoring call.");
+            return nullptr;
+        }
 
-            pData->showInMsg = showInMsg;
-            pData->level = sCurrentLevel;
-            pData->cpuStart = CpuTimer::getCurrentTimePoint();
-            EventData::FrameData& frame = pData->frameData[sGpuTimerIndex];
-            if (frame.currentTimer >= frame.pTimers.size())
+        EventStackEntry& entry = stack.back();
+        if (entry.recursionDepth > 0)
+        {
+            entry.recursionDepth--;
+            return nullptr;
+        }
+
+        auto end = CpuTimer::getCurrentTimePoint();
+        const EventStackEntry popped = entry;
+        stack.pop_back();
+
+        // The event is still allocated since this entry is counted, but if it was removed by clearEvents() the time is dropped.
+        EventData* pData = popped.generation == sGeneration.load() ? popped.pEvent : nullptr;
+        if (pData)
+        {
+            // endFrame() advances the frame before it takes the totals. If the time was added after that, the frame read here is the new one,
+            // and the event is registered again so that the time is reported in the next frame.
+            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - popped.start);
+            pData->cpuTotalNs.fetch_add((uint64_t)duration.count());
+            if (pData->registeredFrame.load() != sFrameIndex.load()) registerEvent(pData, popped.level, popped.generation);
+            if (sCapture.enabled.load(std::memory_order_acquire))
             {
-                frame.pTimers.push_back(GpuTimer::create());
+                recordTraceEvent(pData, popped.generation, getThreadIndex(), sFrameIndex.load(std::memory_order_relaxed) - sCapture.startFrame, getTimeNs(popped.start), getTimeNs(end));
             }
-            frame.pTimers[frame.currentTimer]->begin();
-            pData->callStack.push(frame.currentTimer);
-            frame.currentTimer++;
-            sCurrentLevel++;
+        }
+        sOpenEventCount.fetch_sub(1);
+        return pData;
+    }
 
-            if (!pData->registered)
+    void Profiler::setThreadParent(const EventData* pParent)
+    {
+        tlParentEvent = pParent;
+        tlParentGeneration = sGeneration.load();
+        if (pParent)
+        {
+            // The level is written under the lock when the parent is registered.
+            std::lock_guard<std::mutex> lock(sMutex);
+            tlParentLevel = pParent->level;
+        }
+    }
+
+    bool Profiler::startZone(ZoneID zone)
+    {
+        if (!gProfileEnabled) return false;
+        pushEvent(zone);
+        return true;
+    }
+
+    void Profiler::endZone(ZoneID zone)
+    {
+        popEvent(zone);
+    }
+
+    void Profiler::startEvent(const std::string& name, Flags flags, bool showInMsg)
+    {
+        if (gProfileEnabled && is_set(flags, Flags::Internal))
+        {
+            EventData* pData = pushEvent(getZoneID(name));
+            if (!pData)
             {
-                sRegisteredEvents.push_back(pData);
-                pData->registered = true;
+                logWarning("Profiler event `" + name + "` was triggered while it is already running. Nesting profiler events with the same name is disallowed and you should probably fix that. Ignoring the new call");
+            }
+            else
+            {
+                pData->showInMsg = showInMsg;
+                if (!spTimestampPool)
+                {
+                    spTimestampPool = GpuTimestampPool::create();
+                    sGpuTimerIndex = spTimestampPool->getCurrentFrameIndex();
+                }
+                EventData::FrameData& frame = pData->frameData[sGpuTimerIndex];
+                if (frame.currentTimer >= frame.timers.size())
+                {
+                    frame.timers.emplace_back();
+                }
+                frame.timers[frame.currentTimer].start = spTimestampPool->writeTimestamp();
+                frame.timers[frame.currentTimer].end = GpuTimestampPool::kInvalidIndex;
+                pData->callStack.push(frame.currentTimer);
+                frame.currentTimer++;
             }
         }
         if (is_set(flags, Flags::Pix))
@@ -110,19 +456,12 @@ namespace Falcor
     {
         if (gProfileEnabled && is_set(flags, Flags::Internal))
         {
-            assert(isEventRegistered(curEventName));
-            EventData* pData = getEvent(curEventName);
-            pData->triggered--;
-            if (pData->triggered != 0) return;
-
-            pData->cpuEnd = CpuTimer::getCurrentTimePoint();
-            pData->cpuTotal += CpuTimer::calcDuration(pData->cpuStart, pData->cpuEnd);
-
-            pData->frameData[sGpuTimerIndex].pTimers[pData->callStack.top()]->end();
-            pData->callStack.pop();
-
-            sCurrentLevel--;
-            curEventName.erase(curEventName.find_last_of("#"));
+            EventData* pData = popEvent(getZoneID(name));
+            if (pData)
+            {
+                pData->frameData[sGpuTimerIndex].timers[pData->callStack.top()].end = spTimestampPool->writeTimestamp();
+                pData->callStack.pop();
+            }
         }
         if (is_set(flags, Flags::Pix))
         {
@@ -144,26 +483,61 @@ namespace Falcor
 
     double Profiler::getGpuTime(const EventData* pData)
     {
-        double gpuTime = 0;
-        for (size_t i = 0; i < pData->frameData[1 - sGpuTimerIndex].currentTimer; i++)
+        return pData->gpuTotal;
+    }
+
+    void Profiler::resolveGpuTimes(uint64_t endedFrame)
+    {
+        // The pool has just read back the timestamps of the frame that last used the current frame index.
+        // Accumulate them for every event that was triggered in that frame and release the slot for reuse.
+        std::lock_guard<std::mutex> lock(sMutex);
+
+        // The resolved frame was recorded (frameCount - 1) frames before the one that is ending.
+        const uint64_t resolvedFrame = endedFrame + 1 - spTimestampPool->getFrameCount();
+        const bool capture = sCapture.enabled.load() && endedFrame + 1 >= spTimestampPool->getFrameCount() && resolvedFrame >= sCapture.startFrame;
+
+        for (auto& it : sProfilerEvents)
         {
-            gpuTime += pData->frameData[1 - sGpuTimerIndex].pTimers[i]->getElapsedTime();
+            EventData* pData = it.second;
+            EventData::FrameData& frame = pData->frameData[sGpuTimerIndex];
+            if (frame.currentTimer == 0) continue;
+
+            double gpuTime = 0;
+            for (size_t i = 0; i < frame.currentTimer; i++)
+            {
+                const auto& timer = frame.timers[i];
+                gpuTime += spTimestampPool->getElapsedTime(timer.start, timer.end);
+
+                int64_t beginNs, endNs;
+                if (capture && spTimestampPool->getCpuTime(timer.start, beginNs) && spTimestampPool->getCpuTime(timer.end, endNs))
+                {
+                    recordTraceEvent(pData, sGeneration.load(), kGpuThreadIndex, resolvedFrame - sCapture.startFrame, beginNs, endNs);
+                }
+            }
+            pData->gpuTotal = gpuTime;
+            sLastFrameSamples.push_back({ pData, -1.0, gpuTime });
+            updateRunningAverage(pData->gpuRunningAverageMS, gpuTime);
+            frame.currentTimer = 0;
         }
-        return gpuTime;
     }
 
     double Profiler::getCpuTime(const EventData* pData)
     {
-        return pData->cpuTotal;
+        return pData->cpuTotalNs.load(std::memory_order_relaxed) * 1.0e-6;
+    }
+
+    const Profiler::EventData* Profiler::getCurrentEvent()
+    {
+        return tlEventStack.empty() ? nullptr : tlEventStack.back().pEvent;
     }
 
     std::string Profiler::getEventsString()
     {
         std::string results("Name\t\t\t\t\tCPU time(ms)\t\t  GPU time(ms)\n");
 
+        std::lock_guard<std::mutex> lock(sMutex);
         for (EventData* pData : sRegisteredEvents)
         {
-            assert(pData->triggered == 0);
             if(pData->showInMsg == false) continue;
 
             double gpuTime = getGpuTime(pData);
@@ -175,7 +549,7 @@ namespace Falcor
             snprintf(event, 1000, "%*s%s %*.2f (%.2f) %14.2f (%.2f)\n", nameIndent, " ", pData->name.substr(pData->name.find_last_of("#") + 1).c_str(), cpuIndent, getCpuTime(pData),
                      pData->cpuRunningAverageMS, gpuTime, pData->gpuRunningAverageMS);
 #if _PROFILING_LOG == 1
-            pData->cpuMs[pData->stepNr] = (float)pData->cpuTotal;
+            pData->cpuMs[pData->stepNr] = (float)getCpuTime(pData);
             pData->gpuMs[pData->stepNr] = (float)gpuTime;
             pData->stepNr++;
             if (pData->stepNr == _PROFILING_LOG_BATCH_SIZE)
@@ -200,33 +574,45 @@ namespace Falcor
 
     void Profiler::endFrame()
     {
-        for (EventData* pData : sRegisteredEvents)
+        uint64_t frame;
         {
-            // Update CPU/GPU time running averages.
-            const double cpuTime = getCpuTime(pData);
-            const double gpuTime = getGpuTime(pData);
-            // With sigma = 0.98, then after 100 frames, a given value's contribution is down to ~1.7% of
-            // the running average, which seems to provide a reasonable trade-off of temporal smoothing
-            // versus setting in to a new value when something has changed.
-            const double sigma = .98;
-            if (pData->cpuRunningAverageMS < 0.) pData->cpuRunningAverageMS = cpuTime;
-            else pData->cpuRunningAverageMS = sigma * pData->cpuRunningAverageMS + (1. - sigma) * cpuTime;
-            if (pData->gpuRunningAverageMS < 0.) pData->gpuRunningAverageMS = gpuTime;
-            else pData->gpuRunningAverageMS = sigma * pData->gpuRunningAverageMS + (1. - sigma) * gpuTime;
+            std::lock_guard<std::mutex> lock(sMutex);
+            // Advance the frame before taking the CPU totals. Zones that end on other threads after their total was taken see the new frame and register for it.
+            frame = sFrameIndex++;
+            sLastFrameSamples.clear();
+            for (EventData* pData : sRegisteredEvents)
+            {
+                // Update CPU time running average. The GPU running average is updated once the frame's timestamps are resolved.
+                const double cpuTime = pData->cpuTotalNs.exchange(0) * 1.0e-6;
+                updateRunningAverage(pData->cpuRunningAverageMS, cpuTime);
+                sLastFrameSamples.push_back({ pData, cpuTime, -1.0 });
+                pData->showInMsg = false;
+            }
+            sRegisteredEvents.clear();
+            deleteRetiredEvents();
+        }
 
-            pData->showInMsg = false;
-            pData->cpuTotal = 0;
-            pData->triggered = 0;
-            pData->frameData[1 - sGpuTimerIndex].currentTimer = 0;
-            pData->registered = false;
+        if (sCapture.enabled)
+        {
+            // Frame markers span from the end of the previous frame to the end of this one.
+            int64_t nowNs = getTimeNs(CpuTimer::getCurrentTimePoint());
+            sCapture.mainThreadIndex = getThreadIndex();
+            recordTraceEvent(nullptr, sGeneration.load(), sCapture.mainThreadIndex, frame - sCapture.startFrame, sCapture.lastFrameEndNs, nowNs);
+            sCapture.lastFrameEndNs = nowNs;
+        }
+
+        if (spTimestampPool)
+        {
+            spTimestampPool->endFrame();
+            sGpuTimerIndex = spTimestampPool->getCurrentFrameIndex();
+            resolveGpuTimes(frame);
         }
-        sRegisteredEvents.clear();
-        sGpuTimerIndex = 1 - sGpuTimerIndex;
     }
 
 #if _PROFILING_LOG == 1
     void Profiler::flushLog()
     {
+        std::lock_guard<std::mutex> lock(sMutex);
         for (EventData* pData : sRegisteredEvents)
         {
             std::ostringstream logOss, fileOss;
@@ -243,16 +629,108 @@ namespace Falcor
     }
 #endif
 
+    void Profiler::deleteRetiredEvents()
+    {
+        // Called under the lock. Threads that start an event after this check see the new generation and never reach the retired events.
+        if (sRetiredEvents.empty() || sOpenEventCount.load() != 0) return;
+        for (EventData* pData : sRetiredEvents) delete pData;
+        sRetiredEvents.clear();
+    }
+
     void Profiler::clearEvents()
     {
-        for (EventData* pData : sRegisteredEvents)
+        std::lock_guard<std::mutex> lock(sMutex);
+        // Other threads may still have the events on their stacks. They are deleted once all stacks are empty, see deleteRetiredEvents().
+        for (auto& it : sProfilerEvents)
         {
-            delete pData;
+            sRetiredEvents.push_back(it.second);
         }
         sProfilerEvents.clear();
         sRegisteredEvents.clear();
-        sCurrentLevel = 0;
-        sGpuTimerIndex = 0;
-        curEventName = "";
+        sLastFrameSamples.clear();
+        sChildEvents.clear();
+        // Zone IDs stay valid, they are cached in static variables at the call sites.
+        const uint32_t generation = sGeneration.fetch_add(1) + 1;
+        sGpuTimerIndex = spTimestampPool ? spTimestampPool->getCurrentFrameIndex() : 0;
+        // Captured events reference the removed events.
+        bool capturing = stopCaptureWriters();
+        sCapture.eventCount = 0;
+        sCapture.generation = generation;
+        sCapture.enabled.store(capturing, std::memory_order_release);
+        deleteRetiredEvents();
+    }
+
+    void Profiler::startCapture(uint32_t capacity)
+    {
+        if (capacity == 0)
+        {
+            logWarning("Profiler::startCapture() - Capacity must be non-zero. Ignoring call.");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        stopCaptureWriters();
+        sCapture.events.assign(capacity, {});
+        sCapture.eventCount = 0;
+        sCapture.generation = sGeneration.load();
+        sCapture.startFrame = sFrameIndex;
+        sCapture.startNs = getTimeNs(CpuTimer::getCurrentTimePoint());
+        sCapture.lastFrameEndNs = sCapture.startNs;
+        sCapture.enabled.store(true, std::memory_order_release);
+        gProfileEnabled = true;
+    }
+
+    void Profiler::endCapture()
+    {
+        stopCaptureWriters();
+    }
+
+    bool Profiler::isCapturing()
+    {
+        return sCapture.enabled.load();
+    }
+
+    bool Profiler::exportCapture(const std::string& filename, uint64_t firstFrame, uint64_t frameCount)
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        if (sCapture.enabled.load())
+        {
+            logWarning("Profiler::exportCapture() - A capture is in progress. Call endCapture() before exporting.");
+            return false;
+        }
+
+        const uint64_t count = std::min<uint64_t>(sCapture.eventCount.load(), sCapture.events.size());
+        if (count < sCapture.eventCount.load())
+        {
+            logWarning("Profiler::exportCapture() - The capture ring buffer wrapped around, the oldest events were dropped.");
+        }
+
+        const uint64_t lastFrame = frameCount > std::numeric_limits<uint64_t>::max() - firstFrame ? std::numeric_limits<uint64_t>::max() : firstFrame + frameCount;
+        std::vector<TraceEvent> events;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            const TraceEvent& e = sCapture.events[i];
+            if (e.frame >= firstFrame && e.frame < lastFrame) events.push_back(e);
+        }
+
+        if (!writeChromeTrace(filename, events))
+        {
+            logError("Profiler::exportCapture() - Failed to write '" + filename + "'.");
+            return false;
+        }
+        logInfo("Profiler::exportCapture() - Wrote " + std::to_string(events.size()) + " events to '" + filename + "'.");
+        return true;
+    }
+
+    void Profiler::shutdown()
+    {
+        spTimestampPool.reset();
+    }
+
+    SCRIPT_BINDING(Profiler)
+    {
+        m.func_("startProfilerCapture", Profiler::startCapture, "capacity"_a = Profiler::kDefaultCaptureCapacity);
+        m.func_("endProfilerCapture", Profiler::endCapture);
+        m.func_("exportProfilerCapture", Profiler::exportCapture, "filename"_a, "firstFrame"_a = 0, "frameCount"_a = std::numeric_limits<uint64_t>::max());
     }
 }
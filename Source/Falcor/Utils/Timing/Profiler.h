@@ -27,20 +27,26 @@
  **************************************************************************/
 #pragma once
 #include <stack>
+#include <atomic>
+#include <mutex>
+#include <limits>
 #include <unordered_map>
 #include "CpuTimer.h"
-#include "Core/API/GpuTimer.h"
+#include "Core/API/GpuTimestampPool.h"
 
 namespace Falcor
 {
     extern dlldecl bool gProfileEnabled;
 
-    class GpuTimer;
-
     /** Container class for CPU/GPU profiling.
         This class uses the most accurately available CPU and GPU timers to profile given events. It automatically creates event hierarchies based on the order of the calls made.
-        This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
+        GPU timestamps are written into a frame-level GpuTimestampPool which resolves them once per frame. To avoid GPU stalls, the reported GPU times lag the CPU times by (GpuTimestampPool::kDefaultFrameCount - 1) frames.
         ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+        A timeline capture records the begin/end times of every event on every thread and on the GPU. It can be exported as a Chrome trace (see exportCapture()).
+        Profiler zones (see PROFILE_ZONE) are CPU-only events identified by an integer ID that is registered once per call site. They avoid all string
+        operations and can be used from any thread, which makes them suitable for tight CPU loops. Each thread keeps its own stack of open events.
+        Events started on a thread with an empty stack are root events, unless the thread was given a parent with setThreadParent(). Worker threads should
+        set the event of the thread that handed them the work, so that their zones are nested under it.
     */
     class dlldecl Profiler
     {
@@ -59,26 +65,37 @@ namespace Falcor
             Default = Internal | Pix
         };
 
+        /** Identifier of a registered profiler zone.
+        */
+        using ZoneID = uint32_t;
+        static const ZoneID kInvalidZone = 0xffffffff;
+
+        static constexpr uint32_t kDefaultCaptureCapacity = 1 << 20;
+
         struct EventData
         {
             virtual ~EventData() {}
             std::string name;
+            uint32_t id = 0;                     // Unique event ID, used as the parent key of child events
             struct FrameData
             {
-                std::vector<GpuTimer::SharedPtr> pTimers;
+                struct Timer
+                {
+                    uint32_t start = GpuTimestampPool::kInvalidIndex;
+                    uint32_t end = GpuTimestampPool::kInvalidIndex;
+                };
+                std::vector<Timer> timers;
                 size_t currentTimer = 0;
             };
-            FrameData frameData[2]; // Double-buffering, to avoid GPU flushes
-            bool showInMsg;
+            FrameData frameData[GpuTimestampPool::kDefaultFrameCount]; // One per frame in flight, to avoid GPU flushes
+            bool showInMsg = true;
             std::stack<size_t> callStack;
-            CpuTimer::TimePoint cpuStart;
-            CpuTimer::TimePoint cpuEnd;
-            double cpuTotal = 0;
+            std::atomic<uint64_t> cpuTotalNs = 0;   // Accumulated from all threads
             double cpuRunningAverageMS = -1.f;   // Negative value to signify invalid
             double gpuRunningAverageMS = -1.f;
-            uint32_t level;
-            uint32_t triggered = 0;
-            bool registered = false;
+            double gpuTotal = 0;                 // GPU time of the most recently resolved frame
+            uint32_t level = 0;
+            std::atomic<uint64_t> registeredFrame = std::numeric_limits<uint64_t>::max();    // Frame in which the event was last added to the registered events
 #if _PROFILING_LOG == 1
             int stepNr = 0;
             int filesWritten = 0;
@@ -87,6 +104,15 @@ namespace Falcor
 #endif
         };
 
+        /** Time of a single event in the most recently completed frame.
+        */
+        struct EventSample
+        {
+            const EventData* pEvent;
+            double cpuTimeMS;   // Negative if the event didn't run on the CPU in the last frame.
+            double gpuTimeMS;   // Negative if no GPU time was resolved for the event in the last frame.
+        };
+
         /** Start profiling a new event and update the events hierarchies.
             \param[in] name The event name.
         */
@@ -97,8 +123,32 @@ namespace Falcor
         */
         static void endEvent(const std::string& name, Flags flags = Flags::Default);
 
+        /** Register a profiler zone. This is thread-safe and is normally called once per call site by the PROFILE_ZONE macro.
+            \param[in] name The zone name. Registering the same name again returns the same ID.
+            \return The zone ID.
+        */
+        static ZoneID registerZone(const std::string& name);
+
+        /** Start a CPU-only profiler zone on the calling thread.
+            Unlike startEvent(), this builds no strings and records no GPU timestamps. Direct recursion into the same zone is folded into the outermost call.
+            \param[in] zone The zone ID returned by registerZone().
+            \return True if the zone was started, false if profiling is disabled.
+        */
+        static bool startZone(ZoneID zone);
+
+        /** Finish a profiler zone previously started on the calling thread with startZone().
+            \param[in] zone The zone ID.
+        */
+        static void endZone(ZoneID zone);
+
+        /** Set the parent of the events started on the calling thread while its event stack is empty.
+            Used by worker threads to nest their zones under the event of the thread that issued the work. Their times are accumulated together with that thread's.
+            \param[in] pParent The parent event, usually getCurrentEvent() of the issuing thread. It must stay open while this thread uses it. Pass nullptr to start root events again.
+        */
+        static void setThreadParent(const EventData* pParent);
+
         /** Finish profiling for the entire frame.
-            Due to the double-buffering nature of the profiler, the results returned are for the previous frame.
+            GPU timestamps of the frame are resolved in a single batch. The GPU results become available (GpuTimestampPool::kDefaultFrameCount - 1) frames later.
             \param[out] profileResults A string containing the the profiling results.
         */
         static void endFrame();
@@ -107,6 +157,11 @@ namespace Falcor
         */
         static std::string getEventsString();
 
+        /** Get the innermost event or zone open on the calling thread.
+            \return The event, or nullptr if there's none (or profiling is disabled).
+        */
+        static const EventData* getCurrentEvent();
+
         /** Create a new event and register and initialize it using \ref initNewEvent.
             \param[in] name The event name.
         */
@@ -141,17 +196,66 @@ namespace Falcor
 
         /** Clears all the events. 
             Useful if you want to start profiling a different technique with different events.
+            Events that are still open on other threads are dropped when they end. Their memory is released once no thread has an open event.
         */
         static void clearEvents();
 
+        /** Get the event times of the most recently completed frame.
+            CPU times are those of the last frame passed to endFrame(). GPU times are those resolved in that call, i.e. they lag by a few frames.
+            An event can appear twice, once with its CPU time and once with its GPU time. The event pointers are valid until clearEvents() is called.
+        */
+        static const std::vector<EventSample>& getLastFrameSamples() { return sLastFrameSamples; }
+
+        /** Start recording a timeline of all CPU and GPU events. This also enables profiling.
+            Events are stored in an in-memory ring buffer. When it is full, the oldest events are overwritten. Should be called between frames.
+            \param[in] capacity Maximum number of events kept.
+        */
+        static void startCapture(uint32_t capacity = kDefaultCaptureCapacity);
+
+        /** Stop recording the timeline. The captured events are kept until the next call to startCapture() or clearEvents().
+            Waits for other threads that are still recording an event, so the capture can be exported safely once this returns.
+        */
+        static void endCapture();
+
+        /** Check if a timeline capture is in progress.
+        */
+        static bool isCapturing();
+
+        /** Export the captured timeline as a Chrome trace JSON file, which can be opened in chrome://tracing or Perfetto.
+            The capture must have been stopped with endCapture() first.
+            GPU events are delayed by a few frames, so the last frames of a capture may not contain GPU events yet.
+            \param[in] filename The output file.
+            \param[in] firstFrame First frame to export, relative to the start of the capture.
+            \param[in] frameCount Number of frames to export.
+            \return True if the file was written.
+        */
+        static bool exportCapture(const std::string& filename, uint64_t firstFrame = 0, uint64_t frameCount = std::numeric_limits<uint64_t>::max());
+
+        /** Release the GPU resources used for timestamp queries. Must be called before the device is destroyed.
+        */
+        static void shutdown();
+
     private:
         static double getGpuTime(const EventData* pData);
         static double getCpuTime(const EventData* pData);
+        static void resolveGpuTimes(uint64_t endedFrame);
+        static EventData* getChildEvent(const EventData* pParent, ZoneID zone);
+        static void registerEvent(EventData* pData, uint32_t level, uint32_t generation);
+        static void deleteRetiredEvents();
+        static EventData* pushEvent(ZoneID zone);
+        static EventData* popEvent(ZoneID zone);
 
         static std::unordered_map<std::string, EventData*> sProfilerEvents;
         static std::vector<EventData*> sRegisteredEvents;
-        static uint32_t sCurrentLevel;
+        static std::unordered_map<uint64_t, EventData*> sChildEvents;  // Keyed by (parent ID, zone ID)
+        static std::unordered_map<std::string, ZoneID> sZoneIDs;
+        static std::vector<std::string> sZoneNames;
+        static std::mutex sMutex;
+        static std::atomic<uint32_t> sGeneration;                      // Incremented by clearEvents() to invalidate the per-thread caches
+        static uint32_t sNextEventID;
         static uint32_t sGpuTimerIndex;
+        static std::vector<EventSample> sLastFrameSamples;
+        static GpuTimestampPool::SharedPtr spTimestampPool;
     };
 
     /** Helper class for starting and ending profiling events.
@@ -173,14 +277,39 @@ namespace Falcor
         Profiler::Flags mFlags;
     };
 
+    /** Helper class for starting and ending profiler zones. Use the PROFILE_ZONE macro instead of creating instances directly.
+    */
+    class ProfilerZone
+    {
+    public:
+        /** C'tor
+        */
+        ProfilerZone(Profiler::ZoneID zone) : mZone(zone) { mActive = Profiler::startZone(zone); }
+        /** D'tor
+        */
+        ~ProfilerZone() { if (mActive) Profiler::endZone(mZone); }
+
+    private:
+        const Profiler::ZoneID mZone;
+        bool mActive;
+    };
+
 #if _PROFILING_ENABLED
 #define PROFILE_ALL_FLAGS(_name) Falcor::ProfilerEvent _profileEvent##__LINE__(_name)
 #define PROFILE_SOME_FLAGS(_name, _flags) Falcor::ProfilerEvent _profileEvent##__LINE__(_name, _flags)
 
 #define GET_PROFILE(_1, _2, NAME, ...) NAME
 #define PROFILE(...) GET_PROFILE(__VA_ARGS__, PROFILE_SOME_FLAGS, PROFILE_ALL_FLAGS)(__VA_ARGS__)
+
+#define PROFILE_CONCAT_IMPL(_a, _b) _a##_b
+#define PROFILE_CONCAT(_a, _b) PROFILE_CONCAT_IMPL(_a, _b)
+// The zone is registered once per call site, the first time it is reached.
+#define PROFILE_ZONE(_name) \
+    static const Falcor::Profiler::ZoneID PROFILE_CONCAT(_profileZoneID, __LINE__) = Falcor::Profiler::registerZone(_name); \
+    Falcor::ProfilerZone PROFILE_CONCAT(_profileZone, __LINE__)(PROFILE_CONCAT(_profileZoneID, __LINE__))
 #else
 #define PROFILE(_name)
+#define PROFILE_ZONE(_name)
 #endif
 
     enum_class_operators(Profiler::Flags);
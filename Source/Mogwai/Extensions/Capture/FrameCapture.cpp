@@ -113,6 +113,8 @@ namespace Mogwai
 
     void FrameCapture::triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID)
     {
+        // The outputs are read back and encoded in the background, so capturing frame ranges doesn't serialize the renderer
+        AsyncTextureCapture* pCapture = gpFramework->getTextureCapture();
         for (uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
             Texture* pTex = pGraph->getOutput(i)->asTexture().get();
@@ -121,7 +123,7 @@ namespace Mogwai
             auto ext = Bitmap::getFileExtFromResourceFormat(pTex->getFormat());
             filename += ext;
             auto format = Bitmap::getFormatFromFileExtension(ext);
-            pTex->captureToFile(0, 0, filename, format);
+            pCapture->capture(pCtx, pTex, 0, 0, filename, format);
         }
     }
 
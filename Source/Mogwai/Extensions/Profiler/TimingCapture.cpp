@@ -34,6 +34,15 @@ namespace Mogwai
     {
         const std::string kScriptVar = "tc";
         const std::string kCaptureFrameTime = "captureFrameTime";
+        const std::string kCaptureFrameStatistics = "captureFrameStatistics";
+
+        const uint64_t kFlushInterval = 60;     ///< Frames between writes of the binary frame times.
+        const uint64_t kSummaryInterval = 600;  ///< Frames between writes of the summary. Must be a multiple of kFlushInterval.
+
+        std::string getSummaryFilename(const std::string& filename)
+        {
+            return std::filesystem::path(filename).replace_extension(".summary.json").string();
+        }
     }
 
     MOGWAI_EXTENSION(TimingCapture);
@@ -43,6 +52,11 @@ namespace Mogwai
         return UniquePtr(new TimingCapture());
     }
 
+    TimingCapture::~TimingCapture()
+    {
+        endFrameStatistics();
+    }
+
     void TimingCapture::scriptBindings(Bindings& bindings)
     {
         auto& m = bindings.getModule();
@@ -51,6 +65,7 @@ namespace Mogwai
 
         // Members
         c.func_(kCaptureFrameTime.c_str(), &TimingCapture::captureFrameTime, "filename"_a);
+        c.func_(kCaptureFrameStatistics.c_str(), &TimingCapture::captureFrameStatistics, "filename"_a);
     }
 
     void TimingCapture::beginFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
@@ -78,13 +93,72 @@ namespace Mogwai
         }
     }
 
+    void TimingCapture::captureFrameStatistics(std::string filename)
+    {
+        endFrameStatistics();
+
+        if (!filename.empty())
+        {
+            if (doesFileExist(filename))
+            {
+                logWarning("Frame statistics in file '" + filename + "' will be overwritten.");
+            }
+
+            mStatisticsFile.open(filename, std::ofstream::binary | std::ofstream::trunc);
+            if (!mStatisticsFile.is_open())
+            {
+                logError("Failed to open file '" + filename + "' for writing. Ignoring call.");
+                return;
+            }
+            mStatisticsFilename = filename;
+            mFlushedFrameCount = 0;
+            mStatistics.reset();
+        }
+    }
+
+    void TimingCapture::endFrameStatistics()
+    {
+        if (mStatisticsFilename.empty()) return;
+
+        flushFrameStatistics(true);
+        mStatisticsFile.close();
+        mStatisticsFilename.clear();
+        mStatistics.reset();
+    }
+
+    void TimingCapture::flushFrameStatistics(bool writeSummary)
+    {
+        if (!mStatistics.appendFrameTimes(mStatisticsFile, mFlushedFrameCount))
+        {
+            logError("Failed to write frame times to '" + mStatisticsFilename + "'.");
+        }
+        mFlushedFrameCount = mStatistics.getFrameCount();
+
+        std::string summaryFilename = getSummaryFilename(mStatisticsFilename);
+        if (writeSummary && !mStatistics.writeSummary(summaryFilename))
+        {
+            logError("Failed to write frame time summary to '" + summaryFilename + "'.");
+        }
+    }
+
     void TimingCapture::recordPreviousFrameTime()
     {
-        if (!mFrameTimeFile.is_open()) return;
+        if (!mFrameTimeFile.is_open() && mStatisticsFilename.empty()) return;
 
         // The FrameRate object is updated at the start of each frame, the first valid time is available on the second frame.
         auto& frameRate = gpFramework->getFrameRate();
-        if (frameRate.getFrameCount() > 1)
+        if (frameRate.getFrameCount() <= 1) return;
+
+        if (mFrameTimeFile.is_open())
             mFrameTimeFile << frameRate.getLastFrameTime() << std::endl;
+
+        if (!mStatisticsFilename.empty())
+        {
+            mStatistics.addFrame(frameRate.getLastFrameTime() * 1000.0);
+            mStatistics.addProfilerSamples();
+
+            uint64_t frameCount = mStatistics.getFrameCount();
+            if (frameCount % kFlushInterval == 0) flushFrameStatistics(frameCount % kSummaryInterval == 0);
+        }
     }
 }
@@ -27,13 +27,14 @@
  **************************************************************************/
 #pragma once
 #include "../../Mogwai.h"
+#include "Utils/Timing/FrameTimeStatistics.h"
 
 namespace Mogwai
 {
     class TimingCapture : public Extension
     {
     public:
-        virtual ~TimingCapture() = default;
+        virtual ~TimingCapture();
         static UniquePtr create(Renderer* pRenderer);
 
         virtual void beginFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo) override;
@@ -43,10 +44,25 @@ namespace Mogwai
         TimingCapture() = default;
 
         /** Start capture frame times to file, or end capture if filename is empty.
+            Frame times are written as text, one line per frame in seconds.
         */
         void captureFrameTime(std::string filename);
+
+        /** Start capture frame time statistics to file, or end capture if filename is empty.
+            Frame times are written in binary form (see FrameTimeStatistics::appendFrameTimes()), and a JSON summary with percentiles,
+            stutter frames and the per-pass breakdown is written next to it with the extension '.summary.json'.
+            Both files are updated periodically during the capture, so they are usable even if the application doesn't exit cleanly.
+        */
+        void captureFrameStatistics(std::string filename);
+        void endFrameStatistics();
+        void flushFrameStatistics(bool writeSummary);
         void recordPreviousFrameTime();
 
-        std::ofstream   mFrameTimeFile;     ///< Frame times are appended to this file when it's open.
+        std::ofstream       mFrameTimeFile;             ///< Frame times are appended to this file when it's open.
+
+        std::string         mStatisticsFilename;        ///< Output file of the frame statistics capture, empty if not capturing.
+        std::ofstream       mStatisticsFile;            ///< Binary frame times of the frame statistics capture.
+        uint64_t            mFlushedFrameCount = 0;     ///< Number of frames written to the binary file so far.
+        FrameTimeStatistics mStatistics;                ///< Statistics of the current capture.
     };
 }
@@ -651,6 +651,18 @@ int main(int argc, char** argv)
             Logger::showBoxOnError(false);
         }
 
+        if (args.argExists("headless"))
+        {
+            config.headless = true;
+            config.suppressInput = true;
+            config.showUI = false;
+            config.showMessageBoxOnError = false;
+            Logger::showBoxOnError(false);
+
+            // Without this, frame times include the GPU work, which runs on the CPU when using the software adapter.
+            if (args.argExists("cpuonly")) config.deviceDesc.discardGpuWork = true;
+        }
+
         if (args.argExists("logfile"))
         {
             auto values = args.getValues("logfile");
@@ -93,7 +93,7 @@ namespace Mogwai
                 return kCustomIndex;
             };
 
-            uint2 currentRes = gpFramework->getWindow()->getClientAreaSize();
+            uint2 currentRes = uint2(gpFramework->getTargetFbo()->getWidth(), gpFramework->getTargetFbo()->getHeight());
             static const Gui::DropdownList dropdownList = initDropDown(resolutions, arraysize(resolutions));
             uint32_t currentVal = initDropDownVal(resolutions, arraysize(resolutions), currentRes);
             w.text("Window Size");
@@ -52,6 +52,8 @@ static void regCSM(ScriptBindings::Module& m)
     c.property("bleedReduction", &CSM::getVsmLightBleedReduction, &CSM::setVsmLightBleedReduction);
     c.property("positiveExp", &CSM::getEvsmPositiveExponent, &CSM::setEvsmPositiveExponent);
     c.property("negativeExp", &CSM::getEvsmNegativeExponent, &CSM::setEvsmNegativeExponent);
+    c.property("stereo", &CSM::getStereo, &CSM::setStereo);
+    c.property("cacheStaticCasters", &CSM::getCacheStaticCasters, &CSM::setCacheStaticCasters);
 
     auto partitionEnum = m.enum_<CSM::PartitionMode>("PartitionMode");
     partitionEnum.regEnumVal(CSM::PartitionMode::Linear);
@@ -95,7 +97,9 @@ namespace
     };
 
     const std::string kDepth = "depth";
+    const std::string kDepthRight = "depthRight";
     const std::string kVisibility = "visibility";
+    const std::string kVisibilityRight = "visibilityRight";
     const std::string kBlurPass = "GaussianBlur";
 
     const std::string kMapSize = "mapSize";
@@ -104,6 +108,8 @@ namespace
     const std::string kVisMapBitsPerChannel = "visibilityMapBitsPerChannel";
     const std::string kBlurKernelWidth = "blurWidth";
     const std::string kBlurSigma = "blurSigma";
+    const std::string kStereo = "stereo";
+    const std::string kCacheStaticCasters = "cacheStaticCasters";
 
     const std::string kDepthPassFile = "RenderPasses/CSM/DepthPass.slang";
     const std::string kShadowPassfile = "RenderPasses/CSM/ShadowPass.slang";
@@ -275,6 +281,7 @@ void CSM::createDepthPassResources()
 void CSM::createVisibilityPassResources()
 {
     mVisibilityPass.pFbo = Fbo::create();
+    mVisibilityPass.pFboRight = Fbo::create();
     mVisibilityPass.pPass = FullScreenPass::create(kVisibilityPassFile);
     mVisibilityPass.mPassDataOffset = mVisibilityPass.pPass->getVars()->getParameterBlock("PerFrameCB")->getVariableOffset("gPass");
 }
@@ -330,6 +337,9 @@ void CSM::createShadowPassResources()
     mShadowPass.pState->setProgram(mShadowPass.pProgram);
     mShadowPass.pState->setDepthStencilState(nullptr);
     mShadowPass.pState->setFbo(mShadowPass.pFbo);
+
+    mCasterCache.pStaticFbo = nullptr;
+    mCasterCache.casters.invalidate();
 }
 
 CSM::CSM()
@@ -365,6 +375,8 @@ CSM::SharedPtr CSM::create(RenderContext* pRenderContext, const Dictionary& dict
         else if (v.key() == kSdsmReadbackLatency) pCSM->setSdsmReadbackLatency(v.val());
         else if (v.key() == kBlurKernelWidth) pCSM->mBlurDict["kernelWidth"] = (uint32_t)v.val();
         else if (v.key() == kBlurSigma) pCSM->mBlurDict["sigma"] = (float)v.val();
+        else if (v.key() == kStereo) pCSM->mStereo = v.val();
+        else if (v.key() == kCacheStaticCasters) pCSM->setCacheStaticCasters(v.val());
         else logWarning("Unknown field `" + v.key() + "` in a CSM dictionary");
     }
     pCSM->createShadowPassResources();
@@ -383,6 +395,8 @@ Dictionary CSM::getScriptingDictionary()
     auto blurDict = mpBlurGraph->getPass(kBlurPass)->getScriptingDictionary();
     dict[kBlurKernelWidth] = (uint32_t)blurDict["kernelWidth"];
     dict[kBlurSigma] = (float)blurDict["sigma"];
+    dict[kStereo] = mStereo;
+    dict[kCacheStaticCasters] = mCasterCache.enabled;
     return dict;
 }
 
@@ -409,6 +423,15 @@ RenderPassReflection CSM::reflect(const CompileData& compileData)
         .format(getVisBufferFormat(mVisibilityPassData.mapBitsPerChannel, mVisibilityPassData.shouldVisualizeCascades))
         .texture2D(mVisibilityPassData.screenDim.x, mVisibilityPassData.screenDim.y);
     reflector.addInput(kDepth, "Pre-initialized scene depth buffer used for SDSM.\nIf not provided, the pass will run a depth-pass internally").flags(RenderPassReflection::Field::Flags::Optional);
+
+    if (mStereo)
+    {
+        reflector.addOutput(kVisibilityRight, "Visibility map of the right eye, computed from the same shadow map as the left eye")
+            .format(getVisBufferFormat(mVisibilityPassData.mapBitsPerChannel, mVisibilityPassData.shouldVisualizeCascades))
+            .texture2D(mVisibilityPassData.screenDim.x, mVisibilityPassData.screenDim.y)
+            .flags(RenderPassReflection::Field::Flags::Optional);
+        reflector.addInput(kDepthRight, "Depth buffer of the right eye. Used for SDSM together with the left eye depth and for the right eye visibility map").flags(RenderPassReflection::Field::Flags::Optional);
+    }
     return reflector;
 }
 
@@ -420,9 +443,24 @@ void CSM::compile(RenderContext* pContext, const CompileData& compileData)
     mpBlurGraph->markOutput(kBlurPass + ".dst");
 
     mVisibilityPass.pFbo->attachColorTarget(nullptr, 0);
+    mVisibilityPass.pFboRight->attachColorTarget(nullptr, 0);
 }
 
-void camClipSpaceToWorldSpace(const Camera* pCamera, float3 viewFrustum[8], float3& center, float& radius)
+static void calcBoundingSphere(const float3* pPoints, uint32_t count, float3& center, float& radius)
+{
+    center = float3(0, 0, 0);
+    for (uint32_t i = 0; i < count; i++) center += pPoints[i];
+    center *= (1.0f / float(count));
+
+    radius = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float d = glm::length(center - pPoints[i]);
+        radius = std::max(d, radius);
+    }
+}
+
+void camClipSpaceToWorldSpace(const glm::mat4& invViewProj, float3 viewFrustum[8], float3& center, float& radius)
 {
     float3 clipSpace[8] =
     {
@@ -436,25 +474,13 @@ void camClipSpaceToWorldSpace(const Camera* pCamera, float3 viewFrustum[8], floa
         float3(-1.0f, -1.0f, 1.0f),
     };
 
-    glm::mat4 invViewProj = pCamera->getInvViewProjMatrix();
-    center = float3(0, 0, 0);
-
     for (uint32_t i = 0; i < 8; i++)
     {
         float4 crd = invViewProj * float4(clipSpace[i], 1);
         viewFrustum[i] = float3(crd) / crd.w;
-        center += viewFrustum[i];
     }
 
-    center *= (1.0f / 8.0f);
-
-    // Calculate bounding sphere radius
-    radius = 0;
-    for (uint32_t i = 0; i < 8; i++)
-    {
-        float d = glm::length(center - viewFrustum[i]);
-        radius = std::max(d, radius);
-    }
+    calcBoundingSphere(viewFrustum, 8, center, radius);
 }
 
 forceinline float calcPssmPartitionEnd(float nearPlane, float camDepthRange, const float2& distanceRange, float linearBlend, uint32_t cascade, uint32_t cascadeCount)
@@ -477,12 +503,12 @@ forceinline float calcPssmPartitionEnd(float nearPlane, float camDepthRange, con
     return distance;
 }
 
-void getCascadeCropParams(const float3 crd[8], const glm::mat4& lightVP, float4& scale, float4& offset)
+void getCascadeCropParams(const float3* crd, uint32_t count, const glm::mat4& lightVP, float4& scale, float4& offset)
 {
     // Transform the frustum into light clip-space and calculate min-max
     float4 maxCS(-1, -1, 0, 1);
     float4 minCS(1, 1, 1, 1);
-    for (uint32_t i = 0; i < 8; i++)
+    for (uint32_t i = 0; i < count; i++)
     {
         float4 c = lightVP * float4(crd[i], 1.0f);
         c /= c.w;
@@ -501,16 +527,23 @@ void getCascadeCropParams(const float3 crd[8], const glm::mat4& lightVP, float4&
     offset.w = 0;
 }
 
-void CSM::partitionCascades(const Camera* pCamera, const float2& distanceRange)
+void CSM::partitionCascades(const Camera* pCamera, const float2& distanceRange, bool stereo)
 {
+    // In stereo the frusta of both eyes are stored back-to-back, and the shadow space covers their union
+    const uint32_t eyeCount = stereo ? 2 : 1;
     struct
     {
-        float3 crd[8];
+        float3 crd[16];
         float3 center;
         float radius;
     } camFrustum;
 
-    camClipSpaceToWorldSpace(pCamera, camFrustum.crd, camFrustum.center, camFrustum.radius);
+    camClipSpaceToWorldSpace(pCamera->getInvViewProjMatrix(), camFrustum.crd, camFrustum.center, camFrustum.radius);
+    if (stereo)
+    {
+        camClipSpaceToWorldSpace(pCamera->getRightEyeInvViewProjMatrix(), camFrustum.crd + 8, camFrustum.center, camFrustum.radius);
+        calcBoundingSphere(camFrustum.crd, 16, camFrustum.center, camFrustum.radius);
+    }
 
     // Create the global shadow space
     createShadowMatrix(mpLight.get(), camFrustum.center, camFrustum.radius, mShadowPass.fboAspectRatio, mCsmData.globalMat);
@@ -566,18 +599,23 @@ void CSM::partitionCascades(const Camera* pCamera, const float2& distanceRange)
         mCsmData.cascadeRange[c].x = ndcSpaceCascadeStart;
         mCsmData.cascadeRange[c].y = ndcSpaceCascadeEnd - ndcSpaceCascadeStart;
 
-        // Calculate the cascade frustum
-        float3 cascadeFrust[8];
-        for (uint32_t i = 0; i < 4; i++)
+        // Calculate the cascade frustum. The eyes share the near and far planes, so the cascade depth range applies to both.
+        float3 cascadeFrust[16];
+        for (uint32_t eye = 0; eye < eyeCount; eye++)
         {
-            float3 edge = camFrustum.crd[i + 4] - camFrustum.crd[i];
-            float3 start = edge * cascadeStart;
-            float3 end = edge * cascadeEnd;
-            cascadeFrust[i] = camFrustum.crd[i] + start;
-            cascadeFrust[i + 4] = camFrustum.crd[i] + end;
+            const float3* pEyeCrd = camFrustum.crd + eye * 8;
+            float3* pEyeCascade = cascadeFrust + eye * 8;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                float3 edge = pEyeCrd[i + 4] - pEyeCrd[i];
+                float3 start = edge * cascadeStart;
+                float3 end = edge * cascadeEnd;
+                pEyeCascade[i] = pEyeCrd[i] + start;
+                pEyeCascade[i + 4] = pEyeCrd[i] + end;
+            }
         }
 
-        getCascadeCropParams(cascadeFrust, mCsmData.globalMat, mCsmData.cascadeScale[c], mCsmData.cascadeOffset[c]);
+        getCascadeCropParams(cascadeFrust, eyeCount * 8, mCsmData.globalMat, mCsmData.cascadeScale[c], mCsmData.cascadeOffset[c]);
     }
 }
 
@@ -616,10 +654,85 @@ void CSM::renderScene(RenderContext* pCtx)
 
     pCB->setBlob(&mCsmData, 0, sizeof(mCsmData));
     mpLightCamera->setProjectionMatrix(mCsmData.globalMat);
+
+    // The moment maps of the VSM filters are blurred into a new color target every frame, so they can't be cached
+    if (mCasterCache.enabled && mShadowPass.pFbo->getColorTexture(0) == nullptr)
+    {
+        renderCachedCasters(pCtx);
+        return;
+    }
+
+    pCtx->clearFbo(mShadowPass.pFbo.get(), float4(0), 1, 0, FboAttachmentType::All);
     mpScene->render(pCtx, mShadowPass.pState.get(), mShadowPass.pVars.get());
     //        mpCsmSceneRenderer->renderScene(pCtx, mShadowPass.pState.get(), mShadowPass.pVars.get(), mpLightCamera.get());
 }
 
+void CSM::renderCachedCasters(RenderContext* pCtx)
+{
+    auto& cache = mCasterCache;
+    const auto& pShadowMap = mShadowPass.pFbo;
+
+    // The cached map is only valid for the shadow transforms it was rendered with, which precede cascadeRange in CsmData.
+    // While they change, e.g. when the camera moves, render all casters directly and start caching once they are stable.
+    if (std::memcmp(&cache.csmData, &mCsmData, offsetof(CsmData, cascadeRange)) != 0)
+    {
+        cache.csmData = mCsmData;
+        cache.casters.invalidate();
+        pCtx->clearFbo(pShadowMap.get(), float4(0), 1, 0, FboAttachmentType::All);
+        renderCasters(pCtx, pShadowMap, mpScene->getDrawList());
+        return;
+    }
+
+    for (uint32_t i = 0; i < (uint32_t)cache.bounds.size(); i++)
+    {
+        cache.bounds[i] = mpScene->getMeshInstanceBounds(i);
+    }
+    auto update = cache.casters.update(mCsmData.lightDir, cache.bounds, cache.alwaysDynamic);
+
+    // Without dynamic casters, the shadow map itself holds the static casters and is left untouched while nothing changes.
+    // Otherwise the static casters live in a separate map that is copied to the shadow map before rendering the dynamic casters.
+    const bool hasDynamic = !cache.casters.getDynamicCasters().empty();
+    if (hasDynamic && cache.pStaticFbo == nullptr)
+    {
+        Fbo::Desc desc;
+        desc.setDepthStencilTarget(pShadowMap->getDepthStencilTexture()->getFormat());
+        cache.pStaticFbo = Fbo::create2D(pShadowMap->getWidth(), pShadowMap->getHeight(), desc, pShadowMap->getDepthStencilTexture()->getArraySize());
+        update = ShadowCasterCache::Update::Rebuild;
+    }
+    if (hasDynamic != cache.hadDynamic) update = ShadowCasterCache::Update::Rebuild;
+    cache.hadDynamic = hasDynamic;
+
+    const auto& pTarget = hasDynamic ? cache.pStaticFbo : pShadowMap;
+    switch (update)
+    {
+    case ShadowCasterCache::Update::Rebuild:
+        pCtx->clearFbo(pTarget.get(), float4(0), 1, 0, FboAttachmentType::All);
+        renderCasters(pCtx, pTarget, mpScene->createInstanceDrawList(cache.casters.getStaticCasters()));
+        cache.dynamicDrawList = mpScene->createInstanceDrawList(cache.casters.getDynamicCasters());
+        break;
+    case ShadowCasterCache::Update::Append:
+        renderCasters(pCtx, pTarget, mpScene->createInstanceDrawList(cache.casters.getAppendedCasters()));
+        cache.dynamicDrawList = mpScene->createInstanceDrawList(cache.casters.getDynamicCasters());
+        break;
+    default:
+        break;
+    }
+
+    if (hasDynamic)
+    {
+        pCtx->copyResource(pShadowMap->getDepthStencilTexture().get(), cache.pStaticFbo->getDepthStencilTexture().get());
+        renderCasters(pCtx, pShadowMap, cache.dynamicDrawList);
+    }
+}
+
+void CSM::renderCasters(RenderContext* pCtx, const Fbo::SharedPtr& pFbo, const Scene::DrawList& drawList)
+{
+    // Keep the viewport set up by execute()
+    mShadowPass.pState->setFbo(pFbo, false);
+    mpScene->render(pCtx, mShadowPass.pState.get(), mShadowPass.pVars.get(), drawList);
+    mShadowPass.pState->setFbo(mShadowPass.pFbo, false);
+}
+
 void CSM::executeDepthPass(RenderContext* pCtx, const Camera* pCamera)
 {
     uint32_t width = (uint32_t)mShadowPass.mapSize.x;
@@ -646,7 +759,7 @@ void CSM::createVsmSampleState(uint32_t maxAnisotropy)
     mShadowPass.pVSMTrilinearSampler = Sampler::create(samplerDesc);
 }
 
-void CSM::reduceDepthSdsmMinMax(RenderContext* pRenderCtx, const Camera* pCamera, Texture::SharedPtr pDepthBuffer)
+void CSM::reduceDepthSdsmMinMax(RenderContext* pRenderCtx, const Camera* pCamera, Texture::SharedPtr pDepthBuffer, const Texture::SharedPtr& pDepthBufferRight)
 {
     if (pDepthBuffer == nullptr)
     {
@@ -656,7 +769,10 @@ void CSM::reduceDepthSdsmMinMax(RenderContext* pRenderCtx, const Camera* pCamera
     }
 
     createSdsmData(pDepthBuffer);
-    float2 distanceRange = float2(mSdsmData.minMaxReduction->reduce(pRenderCtx, pDepthBuffer));
+
+    // Reduce both eyes at once. The projections of the eyes only differ in the horizontal offset, so the left eye's depth terms linearize both.
+    const bool reduceRight = pDepthBufferRight && pDepthBufferRight->getWidth() == mSdsmData.width && pDepthBufferRight->getHeight() == mSdsmData.height && pDepthBufferRight->getSampleCount() == mSdsmData.sampleCount;
+    float2 distanceRange = float2(mSdsmData.minMaxReduction->reduce(pRenderCtx, pDepthBuffer, reduceRight ? pDepthBufferRight : nullptr));
 
     // Convert to linear
     glm::mat4 camProj = pCamera->getProjMatrix();
@@ -674,11 +790,11 @@ void CSM::reduceDepthSdsmMinMax(RenderContext* pRenderCtx, const Camera* pCamera
     }
 }
 
-float2 CSM::calcDistanceRange(RenderContext* pRenderCtx, const Camera* pCamera, const Texture::SharedPtr& pDepthBuffer)
+float2 CSM::calcDistanceRange(RenderContext* pRenderCtx, const Camera* pCamera, const Texture::SharedPtr& pDepthBuffer, const Texture::SharedPtr& pDepthBufferRight)
 {
     if (mControls.useMinMaxSdsm)
     {
-        reduceDepthSdsmMinMax(pRenderCtx, pCamera, pDepthBuffer);
+        reduceDepthSdsmMinMax(pRenderCtx, pCamera, pDepthBuffer, pDepthBufferRight);
         return mSdsmData.sdsmResult;
     }
     else
@@ -742,11 +858,13 @@ void CSM::execute(RenderContext* pContext, const RenderData& renderData)
     const auto pCamera = mpScene->getCamera().get();
     //const auto pCamera = mpCsmSceneRenderer->getScene()->getActiveCamera().get();
 
-    const float4 clearColor(0);
-    pContext->clearFbo(mShadowPass.pFbo.get(), clearColor, 1, 0, FboAttachmentType::All);
+    // In stereo, the shadow map is rendered once for both eyes
+    const bool stereo = mStereo && pCamera->hasRightEye();
+    const auto pDepthRight = stereo ? renderData[kDepthRight]->asTexture() : nullptr;
+    const auto pVisibilityRight = mStereo ? renderData[kVisibilityRight]->asTexture() : nullptr;
 
     // Calc the bounds
-    float2 distanceRange = calcDistanceRange(pContext, pCamera, pDepth);
+    float2 distanceRange = calcDistanceRange(pContext, pCamera, pDepth, pDepthRight);
 
     GraphicsState::Viewport VP;
     VP.originX = 0;
@@ -759,7 +877,7 @@ void CSM::execute(RenderContext* pContext, const RenderData& renderData)
     //Set shadow pass state
     mShadowPass.pState->setViewport(0, VP);
     /*mpCsmSceneRenderer->setDepthClamp(mControls.depthClamp);*/
-    partitionCascades(pCamera, distanceRange);
+    partitionCascades(pCamera, distanceRange, stereo);
     renderScene(pContext);
 
     if ((CsmFilter)mCsmData.filterMode == CsmFilter::Vsm || (CsmFilter)mCsmData.filterMode == CsmFilter::Evsm2 || (CsmFilter)mCsmData.filterMode == CsmFilter::Evsm4)
@@ -770,21 +888,39 @@ void CSM::execute(RenderContext* pContext, const RenderData& renderData)
         mShadowPass.pFbo->getColorTexture(0)->generateMips(pContext);
     }
 
-    // Clear visibility buffer
-    pContext->clearFbo(mVisibilityPass.pFbo.get(), float4(1, 0, 0, 0), 1, 0, FboAttachmentType::All);
+    auto visibilityVars = mVisibilityPass.pPass->getVars().getRootVar();
+    setDataIntoVars(visibilityVars, visibilityVars["PerFrameCB"]["gCsmData"]);
+    executeVisibilityPass(pContext, mVisibilityPass.pFbo, pDepth ? pDepth : mDepthPass.pState->getFbo()->getDepthStencilTexture(), pCamera->getInvViewProjMatrix());
 
-    // Update Vars
-    mVisibilityPass.pPass["gDepth"] = pDepth ? pDepth : mDepthPass.pState->getFbo()->getDepthStencilTexture();
+    if (pVisibilityRight)
+    {
+        if (mVisibilityPass.pFboRight->getColorTexture(0) != pVisibilityRight) mVisibilityPass.pFboRight->attachColorTarget(pVisibilityRight, 0);
 
+        if (stereo && pDepthRight)
+        {
+            executeVisibilityPass(pContext, mVisibilityPass.pFboRight, pDepthRight, pCamera->getRightEyeInvViewProjMatrix());
+        }
+        else
+        {
+            // Without right eye matrices or depth there is nothing to shadow
+            pContext->clearFbo(mVisibilityPass.pFboRight.get(), float4(1, 0, 0, 0), 1, 0, FboAttachmentType::All);
+        }
+    }
+}
 
-    auto visibilityVars = mVisibilityPass.pPass->getVars().getRootVar();
-    setDataIntoVars(visibilityVars, visibilityVars["PerFrameCB"]["gCsmData"]);
-    mVisibilityPassData.camInvViewProj = pCamera->getInvViewProjMatrix();
-    mVisibilityPassData.screenDim = uint2(mVisibilityPass.pFbo->getWidth(), mVisibilityPass.pFbo->getHeight());
+void CSM::executeVisibilityPass(RenderContext* pContext, const Fbo::SharedPtr& pFbo, const Texture::SharedPtr& pDepth, const glm::mat4& camInvViewProj)
+{
+    // Clear visibility buffer
+    pContext->clearFbo(pFbo.get(), float4(1, 0, 0, 0), 1, 0, FboAttachmentType::All);
+
+    // Update Vars
+    mVisibilityPass.pPass["gDepth"] = pDepth;
+    mVisibilityPassData.camInvViewProj = camInvViewProj;
+    mVisibilityPassData.screenDim = uint2(pFbo->getWidth(), pFbo->getHeight());
     mVisibilityPass.pPass["PerFrameCB"][mVisibilityPass.mPassDataOffset].setBlob(mVisibilityPassData);
 
     // Render visibility buffer
-    mVisibilityPass.pPass->execute(pContext, mVisibilityPass.pFbo);
+    mVisibilityPass.pPass->execute(pContext, pFbo);
 }
 
 void CSM::setLight(const Light::SharedConstPtr& pLight)
@@ -806,6 +942,17 @@ void CSM::setScene(RenderContext* pRenderContext, const Scene::SharedPtr& pScene
 
     setLight(mpScene && mpScene->getLightCount() ? mpScene->getLight(0) : nullptr);
 
+    // Skinned meshes can deform without changing their bounds, so they are never cached
+    const uint32_t instanceCount = mpScene ? mpScene->getMeshInstanceCount() : 0;
+    mCasterCache.bounds.resize(instanceCount);
+    mCasterCache.alwaysDynamic.resize(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        mCasterCache.alwaysDynamic[i] = mpScene->hasDynamicData(mpScene->getMeshInstance(i).meshID);
+    }
+    mCasterCache.casters.invalidate();
+    mCasterCache.dynamicDrawList = {};
+
     if (mpScene)
     {
         mDepthPass.pProgram->addDefines(mpScene->getSceneDefines());
@@ -856,6 +1003,14 @@ void CSM::renderUI(Gui::Widgets& widget)
     // Mesh culling
     if (widget.checkbox("Cull Meshes", mCullMeshes)) toggleMeshCulling(mCullMeshes);
 
+    // Stereo
+    if (widget.checkbox("Stereo", mStereo)) setStereo(mStereo);
+    widget.tooltip("Fit the cascades to both eyes of the scene camera and render the shadow map once for both eyes.\nRequires right eye matrices on the camera.", true);
+
+    // Static caster caching
+    if (widget.checkbox("Cache Static Casters", mCasterCache.enabled)) setCacheStaticCasters(mCasterCache.enabled);
+    widget.tooltip("Keep the static casters in a cached shadow map and only render the dynamic casters every frame.\nThe cache is rebuilt whenever the cascades move and is not used with the VSM filters.", true);
+
     //Filter mode
     uint32_t filterIndex = static_cast<uint32_t>(mCsmData.filterMode);
     if (widget.dropdown("Filter Mode", kFilterList, filterIndex))
@@ -76,6 +76,8 @@ public:
     void setVsmLightBleedReduction(float reduction) { mCsmData.lightBleedingReduction = glm::clamp(reduction, 0.f, 1.0f); }
     void setEvsmPositiveExponent(float exp) { mCsmData.evsmExponents.x = glm::clamp(exp, 0.f, 5.54f); }
     void setEvsmNegativeExponent(float exp) { mCsmData.evsmExponents.y = glm::clamp(exp, 0.f, 5.54f); }
+    void setStereo(bool enabled) { mStereo = enabled; mPassChangedCB(); }
+    void setCacheStaticCasters(bool enabled) { mCasterCache.enabled = enabled; mCasterCache.casters.invalidate(); }
     uint32_t getCascadeCount() { return mCsmData.cascadeCount; }
     const uint2& getMapSize() { return mMapSize; }
     uint32_t getVisibilityBufferBitsPerChannel() { return mVisibilityPassData.mapBitsPerChannel; }
@@ -92,6 +94,8 @@ public:
     float getVsmLightBleedReduction() { return mCsmData.lightBleedingReduction; }
     float getEvsmPositiveExponent() { return mCsmData.evsmExponents.x; }
     float getEvsmNegativeExponent() { return mCsmData.evsmExponents.y; }
+    bool getStereo() { return mStereo; }
+    bool getCacheStaticCasters() { return mCasterCache.enabled; }
 
 private:
     CSM();
@@ -107,9 +111,11 @@ private:
 
     // Set shadow map generation parameters into a program.
     void setDataIntoVars(ShaderVar const& globalVars, ShaderVar const& csmDataVar);
-    float2 calcDistanceRange(RenderContext* pRenderCtx, const Camera* pCamera, const Texture::SharedPtr& pDepthBuffer);
-    void partitionCascades(const Camera* pCamera, const float2& distanceRange);
+    float2 calcDistanceRange(RenderContext* pRenderCtx, const Camera* pCamera, const Texture::SharedPtr& pDepthBuffer, const Texture::SharedPtr& pDepthBufferRight);
+    void partitionCascades(const Camera* pCamera, const float2& distanceRange, bool stereo);
     void renderScene(RenderContext* pCtx);
+    void renderCachedCasters(RenderContext* pCtx);
+    void renderCasters(RenderContext* pCtx, const Fbo::SharedPtr& pFbo, const Scene::DrawList& drawList);
 
     // Shadow-pass
     struct
@@ -125,6 +131,19 @@ private:
         float2 mapSize;
     } mShadowPass;
 
+    // Static shadow casters are kept in a cached map while the shadow transforms don't change. Only used with depth-only filters.
+    struct
+    {
+        ShadowCasterCache casters;
+        Fbo::SharedPtr pStaticFbo;          // Static casters. Only used while there are dynamic casters, otherwise the shadow map itself is the cache.
+        Scene::DrawList dynamicDrawList;
+        std::vector<BoundingBox> bounds;    // Per mesh instance
+        std::vector<bool> alwaysDynamic;    // Skinned mesh instances
+        CsmData csmData;                    // Shadow transforms the cached map was rendered with
+        bool hadDynamic = false;
+        bool enabled = true;
+    } mCasterCache;
+
     // SDSM
     struct SdsmData
     {
@@ -137,7 +156,7 @@ private:
     };
     SdsmData mSdsmData;
     void createSdsmData(Texture::SharedPtr pTexture);
-    void reduceDepthSdsmMinMax(RenderContext* pRenderCtx, const Camera* pCamera, const Texture::SharedPtr pDepthBuffer);
+    void reduceDepthSdsmMinMax(RenderContext* pRenderCtx, const Camera* pCamera, Texture::SharedPtr pDepthBuffer, const Texture::SharedPtr& pDepthBufferRight);
     void createVsmSampleState(uint32_t maxAnisotropy);
 
     RenderGraph::SharedPtr mpBlurGraph;
@@ -157,8 +176,10 @@ private:
     {
         FullScreenPass::SharedPtr pPass;
         Fbo::SharedPtr pFbo;
+        Fbo::SharedPtr pFboRight;
         UniformShaderVarOffset mPassDataOffset;
     } mVisibilityPass;
+    void executeVisibilityPass(RenderContext* pContext, const Fbo::SharedPtr& pFbo, const Texture::SharedPtr& pDepth, const glm::mat4& camInvViewProj);
 
     struct
     {
@@ -183,6 +204,7 @@ private:
     int32_t renderCascade = 0;
     CsmData mCsmData;
     bool mCullMeshes = true;
+    bool mStereo = false;       // Fit the cascades to both eyes of the scene camera and output a visibility map per eye from a single shadow map.
 
     /** Resize
     */
@@ -108,9 +108,13 @@ void DepthPass::execute(RenderContext* pContext, const RenderData& renderData)
     mpFbo->attachDepthStencilTarget(pDepth);
 
     mpState->setFbo(mpFbo);
-    pContext->clearDsv(pDepth->getDSV().get(), 1, 0);
+    if (mClearDepth) pContext->clearDsv(pDepth->getDSV().get(), 1, 0);
 
-    if (mpScene) mpScene->render(pContext, mpState.get(), mpVars.get());
+    if (mpScene)
+    {
+        if (mDrawList) mpScene->render(pContext, mpState.get(), mpVars.get(), *mDrawList);
+        else mpScene->render(pContext, mpState.get(), mpVars.get());
+    }
 }
 
 DepthPass& DepthPass::setDepthBufferFormat(ResourceFormat format)
@@ -133,6 +137,18 @@ DepthPass& DepthPass::setDepthStencilState(const DepthStencilState::SharedPtr& p
     return *this;
 }
 
+DepthPass& DepthPass::setDrawList(const Scene::DrawList& drawList)
+{
+    mDrawList = drawList;
+    return *this;
+}
+
+DepthPass& DepthPass::resetDrawList()
+{
+    mDrawList.reset();
+    return *this;
+}
+
 static const Gui::DropdownList kDepthFormats =
 {
     { (uint32_t)ResourceFormat::D16Unorm, "D16Unorm"},
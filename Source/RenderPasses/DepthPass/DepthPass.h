@@ -58,6 +58,16 @@ public:
     DepthPass& setDepthBufferFormat(ResourceFormat format);
     DepthPass& setDepthStencilState(const DepthStencilState::SharedPtr& pDsState);
 
+    /** Render a subset of the scene instead of all of it, e.g. the output of a culling pass.
+        The draw list is used until resetDrawList() is called.
+    */
+    DepthPass& setDrawList(const Scene::DrawList& drawList);
+    DepthPass& resetDrawList();
+
+    /** Set whether the depth buffer is cleared before rendering. Disable it to add geometry to an existing depth buffer.
+    */
+    DepthPass& setClearDepth(bool clear) { mClearDepth = clear; return *this; }
+
 private:
     DepthPass(const Dictionary& dict);
     void parseDictionary(const Dictionary& dict);
@@ -67,4 +77,6 @@ private:
     GraphicsVars::SharedPtr mpVars;
     ResourceFormat mDepthFormat = ResourceFormat::D32Float;
     Scene::SharedPtr mpScene;
+    std::optional<Scene::DrawList> mDrawList;
+    bool mClearDepth = true;
 };
@@ -50,6 +50,9 @@ namespace
     const char kReportRunningError[] = "ReportRunningError";
     const char kRunningErrorSigma[] = "RunningErrorSigma";
     const char kSelectedOutputId[] = "SelectedOutputId";
+    const char kReadbackLatency[] = "ReadbackLatency";
+
+    const uint32_t kMaxReadbackLatency = 16;
 }
 
 // Don't remove this. it's required for hot-reload to function properly
@@ -91,6 +94,7 @@ ErrorMeasurePass::ErrorMeasurePass(const Dictionary& dict)
         else if (v.key() == kReportRunningError) mReportRunningError = v.val();
         else if (v.key() == kRunningErrorSigma) mRunningErrorSigma = v.val();
         else if (v.key() == kSelectedOutputId) mSelectedOutputId = v.val();
+        else if (v.key() == kReadbackLatency) mReadbackLatency = std::min((uint32_t)v.val(), kMaxReadbackLatency);
         else
         {
             logWarning("Unknown field `" + v.key() + "` in ErrorMeasurePass dictionary");
@@ -103,6 +107,13 @@ ErrorMeasurePass::ErrorMeasurePass(const Dictionary& dict)
 
     mpParallelReduction = ComputeParallelReduction::create();
     mpErrorMeasurerPass = ComputePass::create(kErrorComputationShaderFile);
+    mpReadbackFence = GpuFence::create();
+}
+
+ErrorMeasurePass::~ErrorMeasurePass()
+{
+    // Write the measurements that are still in flight.
+    resolveReadbacks(0);
 }
 
 Dictionary ErrorMeasurePass::getScriptingDictionary()
@@ -116,6 +127,7 @@ Dictionary ErrorMeasurePass::getScriptingDictionary()
     dict[kReportRunningError] = mReportRunningError;
     dict[kRunningErrorSigma] = mRunningErrorSigma;
     dict[kSelectedOutputId] = mSelectedOutputId;
+    dict[kReadbackLatency] = mReadbackLatency;
     return dict;
 }
 
@@ -146,11 +158,11 @@ void ErrorMeasurePass::execute(RenderContext* pRenderContext, const RenderData&
         assert(mpDifferenceTexture);
     }
 
-    mMeasurements.valid = false;
-
     Texture::SharedPtr pReference = getReference(renderData);
     if (!pReference)
     {
+        mMeasurements.valid = false;
+
         // We don't have a reference image, so just copy the source image to the output.
         pRenderContext->blit(pSourceImageTexture->getSRV(), pOutputImageTexture->getRTV());
         return;
@@ -173,8 +185,6 @@ void ErrorMeasurePass::execute(RenderContext* pRenderContext, const RenderData&
     default:
         throw std::exception("Unhandled OutputId case in ErrorMeasurePass");
     }
-
-    saveMeasurementsToFile();
 }
 
 void ErrorMeasurePass::runDifferencePass(RenderContext* pRenderContext, const RenderData& renderData)
@@ -200,13 +210,76 @@ void ErrorMeasurePass::runDifferencePass(RenderContext* pRenderContext, const Re
 
 void ErrorMeasurePass::runReductionPasses(RenderContext* pRenderContext, const RenderData& renderData)
 {
-    float4 error;
-    if (!mpParallelReduction->execute(pRenderContext, mpDifferenceTexture, ComputeParallelReduction::Type::Sum, &error))
+    const uint32_t pixelCount = mpDifferenceTexture->getWidth() * mpDifferenceTexture->getHeight();
+
+    if (mReadbackLatency == 0)
+    {
+        // Frames measured with a latency are written first to keep the measurements in order.
+        resolveReadbacks(0);
+
+        float4 error;
+        if (!mpParallelReduction->execute(pRenderContext, mpDifferenceTexture, ComputeParallelReduction::Type::Sum, &error))
+        {
+            throw std::exception("Error running parallel reduction in ErrorMeasurePass");
+        }
+        updateMeasurements(error, pixelCount);
+    }
+    else
     {
-        throw std::exception("Error running parallel reduction in ErrorMeasurePass");
+        // Read the results that are ready, and wait for the ones that have reached the maximum latency.
+        resolveReadbacks(mReadbackLatency);
+
+        Readback readback;
+        if (mFreeReadbackBuffers.empty())
+        {
+            readback.pBuffer = Buffer::create(sizeof(float4), Resource::BindFlags::None, Buffer::CpuAccess::Read);
+        }
+        else
+        {
+            readback.pBuffer = mFreeReadbackBuffers.back();
+            mFreeReadbackBuffers.pop_back();
+        }
+
+        if (!mpParallelReduction->execute<float4>(pRenderContext, mpDifferenceTexture, ComputeParallelReduction::Type::Sum, nullptr, readback.pBuffer, 0))
+        {
+            throw std::exception("Error running parallel reduction in ErrorMeasurePass");
+        }
+
+        // Submit the work and insert a signal, so the result can be polled later without waiting for the GPU.
+        pRenderContext->flush(false);
+        readback.fenceValue = mpReadbackFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+        readback.frame = mFrameCount;
+        readback.pixelCount = pixelCount;
+        mPendingReadbacks.push_back(readback);
     }
 
-    const float pixelCountf = static_cast<float>(mpDifferenceTexture->getWidth() * mpDifferenceTexture->getHeight());
+    mFrameCount++;
+}
+
+void ErrorMeasurePass::resolveReadbacks(uint32_t latency)
+{
+    while (!mPendingReadbacks.empty())
+    {
+        const Readback& readback = mPendingReadbacks.front();
+        if (readback.fenceValue > mpReadbackFence->getGpuValue())
+        {
+            // Only block on results that are at least `latency` frames old.
+            if (readback.frame + latency > mFrameCount) break;
+            mpReadbackFence->syncCpu(readback.fenceValue);
+        }
+
+        const float4 error = *reinterpret_cast<const float4*>(readback.pBuffer->map(Buffer::MapType::Read));
+        readback.pBuffer->unmap();
+        updateMeasurements(error, readback.pixelCount);
+
+        mFreeReadbackBuffers.push_back(readback.pBuffer);
+        mPendingReadbacks.pop_front();
+    }
+}
+
+void ErrorMeasurePass::updateMeasurements(const float4& error, uint32_t pixelCount)
+{
+    const float pixelCountf = static_cast<float>(pixelCount);
     mMeasurements.error = error / pixelCountf;
     mMeasurements.avgError = (mMeasurements.error.x + mMeasurements.error.y + mMeasurements.error.z) / 3.f;
     mMeasurements.valid = true;
@@ -222,6 +295,8 @@ void ErrorMeasurePass::runReductionPasses(RenderContext* pRenderContext, const R
         mRunningError = mRunningErrorSigma * mRunningError + (1 - mRunningErrorSigma) * mMeasurements.error;
         mRunningAvgError = mRunningErrorSigma * mRunningAvgError + (1 - mRunningErrorSigma) * mMeasurements.avgError;
     }
+
+    saveMeasurementsToFile();
 }
 
 void ErrorMeasurePass::renderUI(Gui::Widgets& widget)
@@ -276,6 +351,9 @@ void ErrorMeasurePass::renderUI(Gui::Widgets& widget)
     widget.tooltip(("Do not include background pixels in the error measurements.\n"
                       "This option requires the optional input '" + std::string(kInputChannelWorldPosition) + "' to be bound").c_str(), true);
     widget.checkbox("Compute L2 error (rather than L1)", mComputeSquaredDifference);
+    widget.var("Readback latency", mReadbackLatency, 0u, kMaxReadbackLatency);
+    widget.tooltip("Number of frames before the error is read back to the CPU.\n\n"
+                     "With 0 the pass waits for the GPU every frame. Larger values avoid the stall, but the displayed error lags behind.", true);
 
     widget.checkbox("Use loaded reference image", mUseLoadedReference);
     widget.tooltip("Take the reference from the loaded image instead or the input channel.\n\n"
@@ -365,8 +443,12 @@ void ErrorMeasurePass::openMeasurementsFile()
 {
     if (mMeasurementsFilePath.empty()) return;
 
-    mMeasurementsFile = std::ofstream(mMeasurementsFilePath, std::ios::trunc);
-    if (!mMeasurementsFile)
+    // Frames in flight belong to the previous file, which is closed once its queued measurements are written.
+    resolveReadbacks(0);
+    mpMeasurementsWriter = nullptr;
+
+    std::ofstream file(mMeasurementsFilePath, std::ios::trunc);
+    if (!file)
     {
         logError("Failed to open file " + mMeasurementsFilePath);
         mMeasurementsFilePath = "";
@@ -375,22 +457,70 @@ void ErrorMeasurePass::openMeasurementsFile()
     {
         if (mComputeSquaredDifference)
         {
-            mMeasurementsFile << "avg_L2_error,red_L2_error,green_L2_error,blue_L2_error" << std::endl;
+            file << "avg_L2_error,red_L2_error,green_L2_error,blue_L2_error" << std::endl;
         }
         else
         {
-            mMeasurementsFile << "avg_L1_error,red_L1_error,green_L1_error,blue_L1_error" << std::endl;
+            file << "avg_L1_error,red_L1_error,green_L1_error,blue_L1_error" << std::endl;
         }
-        mMeasurementsFile << std::scientific;
+        file << std::scientific;
+        mpMeasurementsWriter = std::make_unique<MeasurementsWriter>(std::move(file));
     }
 }
 
 void ErrorMeasurePass::saveMeasurementsToFile()
 {
-    if (!mMeasurementsFile) return;
+    if (!mpMeasurementsWriter) return;
 
     assert(mMeasurements.valid);
-    mMeasurementsFile << mMeasurements.avgError << ",";
-    mMeasurementsFile << mMeasurements.error.r << ',' << mMeasurements.error.g << ',' << mMeasurements.error.b;
-    mMeasurementsFile << std::endl;
+    mpMeasurementsWriter->push(mMeasurements.avgError, mMeasurements.error);
+}
+
+ErrorMeasurePass::MeasurementsWriter::MeasurementsWriter(std::ofstream&& file)
+    : mFile(std::move(file))
+{
+    mThread = std::thread(&MeasurementsWriter::writerThread, this);
+}
+
+ErrorMeasurePass::MeasurementsWriter::~MeasurementsWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTerminate = true;
+    }
+    mQueueChanged.notify_one();
+    mThread.join();
+}
+
+void ErrorMeasurePass::MeasurementsWriter::push(float avgError, const float3& error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.push_back({ avgError, error });
+    }
+    mQueueChanged.notify_one();
+}
+
+void ErrorMeasurePass::MeasurementsWriter::writerThread()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mQueueChanged.wait(lock, [this] { return mTerminate || !mQueue.empty(); });
+        if (mQueue.empty()) break;
+
+        // Write the queued records without holding the lock.
+        std::deque<Record> records;
+        records.swap(mQueue);
+        lock.unlock();
+
+        for (const auto& record : records)
+        {
+            mFile << record.avgError << ",";
+            mFile << record.error.r << ',' << record.error.g << ',' << record.error.b << '\n';
+        }
+        mFile.flush();
+
+        lock.lock();
+    }
 }
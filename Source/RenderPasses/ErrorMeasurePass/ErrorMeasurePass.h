@@ -28,6 +28,10 @@
 #pragma once
 #include "Falcor.h"
 #include "Utils/Algorithm/ComputeParallelReduction.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 using namespace Falcor;
 
@@ -37,6 +41,7 @@ public:
     using SharedPtr = std::shared_ptr<ErrorMeasurePass>;
 
     static SharedPtr create(RenderContext* pRenderContext = nullptr, const Dictionary& dict = {});
+    ~ErrorMeasurePass();
 
     virtual std::string getDesc() override { return "Measures error with respect to a reference image"; }
     virtual Dictionary getScriptingDictionary() override;
@@ -57,6 +62,36 @@ private:
 
     void runDifferencePass(RenderContext* pRenderContext, const RenderData& renderData);
     void runReductionPasses(RenderContext* pRenderContext, const RenderData& renderData);
+    void resolveReadbacks(uint32_t latency);
+    void updateMeasurements(const float4& error, uint32_t pixelCount);
+
+    /** Appends measurements to the CSV file on a background thread, so file I/O doesn't stall the render thread.
+        Records are written in the order they are pushed. The destructor writes all queued records before closing the file.
+    */
+    class MeasurementsWriter
+    {
+    public:
+        MeasurementsWriter(std::ofstream&& file);
+        ~MeasurementsWriter();
+
+        void push(float avgError, const float3& error);
+
+    private:
+        struct Record
+        {
+            float avgError;
+            float3 error;
+        };
+
+        void writerThread();
+
+        std::ofstream           mFile;
+        std::deque<Record>      mQueue;
+        std::mutex              mMutex;
+        std::condition_variable mQueueChanged;
+        bool                    mTerminate = false;
+        std::thread             mThread;
+    };
 
     ComputePass::SharedPtr mpErrorMeasurerPass;
     ComputeParallelReduction::SharedPtr mpParallelReduction;
@@ -68,6 +103,17 @@ private:
         bool   valid = false;
     } mMeasurements;
 
+    /** Reduction result on its way back to the CPU. It is read once the fence passes fenceValue, or
+        blocking once it is mReadbackLatency frames old.
+    */
+    struct Readback
+    {
+        Buffer::SharedPtr pBuffer;
+        uint64_t fenceValue = 0;
+        uint64_t frame = 0;         ///< Index of the measured frame.
+        uint32_t pixelCount = 0;
+    };
+
     // Internal state
     float3                  mRunningError = float3(0.f, 0.f, 0.f);
     float                   mRunningAvgError = -1.f;        ///< A negative value indicates that both running error values are invalid.
@@ -75,7 +121,12 @@ private:
     Texture::SharedPtr      mpReferenceTexture;
     Texture::SharedPtr      mpDifferenceTexture;
 
-    std::ofstream           mMeasurementsFile;
+    std::unique_ptr<MeasurementsWriter> mpMeasurementsWriter;
+
+    std::deque<Readback>            mPendingReadbacks;      ///< Readbacks in flight, oldest first.
+    std::vector<Buffer::SharedPtr>  mFreeReadbackBuffers;
+    GpuFence::SharedPtr             mpReadbackFence;
+    uint64_t                        mFrameCount = 0;        ///< Number of frames measured.
 
     // UI variables
     std::string             mReferenceImagePath;            ///< Path to the reference used in the comparison.
@@ -86,6 +137,7 @@ private:
     bool                    mUseLoadedReference = false;    ///< If true, use loaded reference image instead of input.
     bool                    mReportRunningError = true;
     float                   mRunningErrorSigma = 0.995f;
+    uint32_t                mReadbackLatency = 0;           ///< Number of frames before the error is read back. 0 waits for the GPU every frame.
 
     enum OutputId
     {
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "ForwardLightingPass.h"
+#include "Scene/Culling/HoleTilesData.slang"
 
 // Don't remove this. it's required for hot-reload to function properly
 extern "C" __declspec(dllexport) const char* getProjDir()
@@ -39,7 +40,8 @@ extern "C" __declspec(dllexport) void getPasses(Falcor::RenderPassLibrary& lib)
 }
 
 const char* ForwardLightingPass::kDesc = "The pass computes the lighting results for the current scene. It will compute direct-illumination, indirect illumination from the light-probe and apply shadows (if a visibility map is provided).\n"
-"The pass can output the world-space normals and screen-space motion vectors, both are optional";
+"The pass can output the world-space normals and screen-space motion vectors, both are optional.\n"
+"If a hole mask is connected, only the tiles containing holes are re-rendered and the other pixels keep the input color. The normals and motion vectors are only written in those tiles, and the depth is at the near plane outside of them";
 
 namespace
 {
@@ -48,9 +50,13 @@ namespace
     const std::string kMotionVecs = "motionVecs";
     const std::string kNormals = "normals";
     const std::string kVisBuffer = "visibilityBuffer";
+    const std::string kLinearZ = "linearZ";
+    const std::string kHoleMask = "holeMask";
 
     const std::string kSampleCount = "sampleCount";
     const std::string kSuperSampling = "enableSuperSampling";
+    const std::string kUseLightClusters = "useLightClusters";
+    const std::string kUseShadingRate = "useShadingRate";
 }
 
 ForwardLightingPass::SharedPtr ForwardLightingPass::create(RenderContext* pRenderContext, const Dictionary& dict)
@@ -62,6 +68,8 @@ ForwardLightingPass::SharedPtr ForwardLightingPass::create(RenderContext* pRende
     {
         if (v.key() == kSampleCount) pThis->setSampleCount(v.val());
         else if (v.key() == kSuperSampling) pThis->setSuperSampling(v.val());
+        else if (v.key() == kUseLightClusters) pThis->setUseLightClusters(v.val());
+        else if (v.key() == kUseShadingRate) pThis->setUseShadingRate(v.val());
         else logWarning("Unknown field `" + v.key() + "` in a ForwardLightingPass dictionary");
     }
 
@@ -73,6 +81,8 @@ Dictionary ForwardLightingPass::getScriptingDictionary()
     Dictionary d;
     d[kSampleCount] = mSampleCount;
     d[kSuperSampling] = mEnableSuperSampling;
+    d[kUseLightClusters] = mUseLightClusters;
+    d[kUseShadingRate] = mUseShadingRate;
     return d;
 }
 
@@ -83,6 +93,9 @@ ForwardLightingPass::ForwardLightingPass()
     mpState->setProgram(pProgram);
 
     mpFbo = Fbo::create();
+    mpLightClusters = LightClusters::create();
+    mpShadingRate = ShadingRate::create();
+    mpHoleDepthFbo = Fbo::create();
 
     DepthStencilState::Desc dsDesc;
     dsDesc.setDepthWriteMask(false).setDepthFunc(DepthStencilState::Func::LessEqual);
@@ -94,7 +107,11 @@ RenderPassReflection ForwardLightingPass::reflect(const CompileData& compileData
     RenderPassReflection reflector;
 
     reflector.addInput(kVisBuffer, "Visibility buffer used for shadowing. Range is [0,1] where 0 means the pixel is fully-shadowed and 1 means the pixel is not shadowed at all").flags(RenderPassReflection::Field::Flags::Optional);
-    reflector.addInputOutput(kColor, "Color texture").format(mColorFormat).texture2D(0, 0, mSampleCount);
+    reflector.addInput(kLinearZ, "Linear depth. With variable-rate shading, tiles with depth discontinuities are shaded at full rate").flags(RenderPassReflection::Field::Flags::Optional);
+    reflector.addInput(kHoleMask, "Hole mask, e.g. the disocclusions after reprojecting the previous frame. Pixels where the first channel is non-zero are holes. If connected, only the tiles with holes are rendered").flags(RenderPassReflection::Field::Flags::Optional);
+    auto& colorField = reflector.addInputOutput(kColor, "Color texture").format(mColorFormat).texture2D(0, 0, mSampleCount);
+    // The variable-rate shading resolve writes the color in a compute pass.
+    if (isShadingRateActive()) colorField.bindFlags(ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget | ResourceBindFlags::UnorderedAccess);
 
     auto& depthField = mUsePreGenDepth ? reflector.addInputOutput(kDepth, "Pre-initialized depth-buffer") : reflector.addOutput(kDepth, "Depth buffer");
     depthField.bindFlags(Resource::BindFlags::DepthStencil).texture2D(0, 0, mSampleCount);
@@ -117,6 +134,7 @@ void ForwardLightingPass::setScene(RenderContext* pRenderContext, const Scene::S
     mpScene = pScene;
 
     if (mpScene) mpState->getProgram()->addDefines(mpScene->getSceneDefines());
+    mpHoleTiles = mpScene ? HoleTiles::create(mpScene) : nullptr;
 
     mpVars = GraphicsVars::create(mpState->getProgram()->getReflector());
 
@@ -171,8 +189,46 @@ void ForwardLightingPass::execute(RenderContext* pContext, const RenderData& ren
         mpVars["PerFrameCB"]["gRenderTargetDim"] = float2(mpFbo->getWidth(), mpFbo->getHeight());
         mpVars->setTexture(kVisBuffer, renderData[kVisBuffer]->asTexture());
 
+        if (mUseLightClusters)
+        {
+            mpLightClusters->build(mpScene.get(), mpScene->getCamera().get(), 0, uint2(mpFbo->getWidth(), mpFbo->getHeight()));
+            mpLightClusters->setShaderData(mpVars->getRootVar());
+        }
+
+        // Hole filling restricts the depth buffer to the tiles with holes, so it needs a depth buffer owned by this pass.
+        const auto& pHoleMask = renderData[kHoleMask];
+        const bool fillHoles = pHoleMask && mSampleCount == 1 && !mUsePreGenDepth;
+        if (fillHoles)
+        {
+            mpHoleTiles->classify(pContext, pHoleMask->asTexture());
+            mpHoleDepthFbo->attachDepthStencilTarget(mpFbo->getDepthStencilTexture());
+            mpHoleTiles->restrictDepthToTiles(pContext, mpHoleDepthFbo);
+        }
+
+        if (isShadingRateActive())
+        {
+            const auto& pLinearZ = renderData[kLinearZ];
+            mpShadingRate->build(pContext, uint2(mpFbo->getWidth(), mpFbo->getHeight()), pLinearZ ? pLinearZ->asTexture() : nullptr);
+            mpShadingRate->setShaderData(mpVars->getRootVar());
+        }
+
         mpState->setFbo(mpFbo);
-        mpScene->render(pContext, mpState.get(), mpVars.get());
+        if (fillHoles)
+        {
+            const auto& drawList = mpHoleTiles->cullDraws(pContext, mpScene->getCamera()->getViewProjMatrix());
+            mpScene->render(pContext, mpState.get(), mpVars.get(), drawList);
+        }
+        else
+        {
+            mpScene->render(pContext, mpState.get(), mpVars.get());
+        }
+
+        if (isShadingRateActive())
+        {
+            // The tile counts of the hole tiles mask the resolve to the re-rendered tiles.
+            static_assert(kHoleTileSize == kShadingRateTileSize, "Hole tiles and shading rate tiles must match");
+            mpShadingRate->resolve(pContext, renderData[kColor]->asTexture(), fillHoles ? mpHoleTiles->getTileCountTexture() : nullptr);
+        }
     }
 }
 
@@ -188,6 +244,34 @@ void ForwardLightingPass::renderUI(Gui::Widgets& widget)
 
     if (widget.dropdown("Sample Count", kSampleCountList, mSampleCount))              setSampleCount(mSampleCount);
     if (mSampleCount > 1 && widget.checkbox("Super Sampling", mEnableSuperSampling))  setSuperSampling(mEnableSuperSampling);
+    if (widget.checkbox("Light Clusters", mUseLightClusters))                          setUseLightClusters(mUseLightClusters);
+    widget.tooltip("Only evaluate the lights of each pixel's cluster instead of all lights. Point and spot lights are culled where their intensity falls below the cut-off.", true);
+
+    if (mUseLightClusters)
+    {
+        auto group = Gui::Group(widget, "Light Clusters");
+        if (group.open())
+        {
+            mpLightClusters->renderUI(group);
+            group.release();
+        }
+    }
+
+    if (mSampleCount == 1)
+    {
+        if (widget.checkbox("Variable-Rate Shading", mUseShadingRate)) setUseShadingRate(mUseShadingRate);
+        widget.tooltip("Only evaluate the lighting in one pixel per block of a per-tile shading rate and interpolate the other pixels. The rate is selected by the distance to the fovea and refined at depth discontinuities if linear depth is connected. Requires a sample count of 1.", true);
+
+        if (mUseShadingRate)
+        {
+            auto group = Gui::Group(widget, "Variable-Rate Shading");
+            if (group.open())
+            {
+                mpShadingRate->renderUI(group);
+                group.release();
+            }
+        }
+    }
 }
 
 ForwardLightingPass& ForwardLightingPass::setColorFormat(ResourceFormat format)
@@ -222,6 +306,7 @@ ForwardLightingPass& ForwardLightingPass::setMotionVecFormat(ResourceFormat form
 ForwardLightingPass& ForwardLightingPass::setSampleCount(uint32_t samples)
 {
     mSampleCount = samples;
+    updateShadingRateDefine();
     mPassChangedCB();
     return *this;
 }
@@ -241,6 +326,41 @@ ForwardLightingPass& ForwardLightingPass::setSuperSampling(bool enable)
     return *this;
 }
 
+ForwardLightingPass& ForwardLightingPass::setUseLightClusters(bool enable)
+{
+    mUseLightClusters = enable;
+    if (mUseLightClusters)
+    {
+        mpState->getProgram()->addDefine("_USE_LIGHT_CLUSTERS");
+    }
+    else
+    {
+        mpState->getProgram()->removeDefine("_USE_LIGHT_CLUSTERS");
+    }
+
+    return *this;
+}
+
+ForwardLightingPass& ForwardLightingPass::setUseShadingRate(bool enable)
+{
+    mUseShadingRate = enable;
+    updateShadingRateDefine();
+    mPassChangedCB();
+    return *this;
+}
+
+void ForwardLightingPass::updateShadingRateDefine()
+{
+    if (isShadingRateActive())
+    {
+        mpState->getProgram()->addDefine("_USE_SHADING_RATE");
+    }
+    else
+    {
+        mpState->getProgram()->removeDefine("_USE_SHADING_RATE");
+    }
+}
+
 ForwardLightingPass& ForwardLightingPass::usePreGeneratedDepthBuffer(bool enable)
 {
     mUsePreGenDepth = enable;
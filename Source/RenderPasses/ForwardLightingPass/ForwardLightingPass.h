@@ -73,6 +73,15 @@ public:
     */
     ForwardLightingPass& usePreGeneratedDepthBuffer(bool enable);
 
+    /** Only evaluate the lights of each pixel's light cluster instead of all scene lights. See LightClusters
+    */
+    ForwardLightingPass& setUseLightClusters(bool enable);
+
+    /** Evaluate the lighting at a reduced rate selected per screen tile, and interpolate the pixels in between. See ShadingRate.
+        Only the lighting is evaluated at the reduced rate, the normal and motion vector outputs are written at full rate. Ignored with multisampling.
+    */
+    ForwardLightingPass& setUseShadingRate(bool enable);
+
     /** Set a sampler-state to be used during rendering. The default is tri-linear
     */
     ForwardLightingPass& setSampler(const Sampler::SharedPtr& pSampler);
@@ -85,12 +94,18 @@ private:
     ForwardLightingPass();
     void initDepth(const RenderData& renderData);
     void initFbo(RenderContext* pContext, const RenderData& renderData);
+    bool isShadingRateActive() const { return mUseShadingRate && mSampleCount == 1; }
+    void updateShadingRateDefine();
 
     Fbo::SharedPtr mpFbo;
     GraphicsState::SharedPtr mpState;
     DepthStencilState::SharedPtr mpDsNoDepthWrite;
     Scene::SharedPtr mpScene;
     GraphicsVars::SharedPtr mpVars;
+    LightClusters::SharedPtr mpLightClusters;
+    ShadingRate::SharedPtr mpShadingRate;
+    HoleTiles::SharedPtr mpHoleTiles;
+    Fbo::SharedPtr mpHoleDepthFbo;          ///< Depth-only FBO to restrict the depth buffer to the hole tiles.
 
     ResourceFormat mColorFormat = ResourceFormat::Unknown;
     ResourceFormat mNormalMapFormat = ResourceFormat::Unknown;
@@ -98,4 +113,6 @@ private:
     uint32_t mSampleCount = 0;
     bool mEnableSuperSampling = false;
     bool mUsePreGenDepth = false;
+    bool mUseLightClusters = false;
+    bool mUseShadingRate = false;
 };
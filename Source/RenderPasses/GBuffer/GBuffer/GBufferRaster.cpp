@@ -28,7 +28,6 @@
 #include "Falcor.h"
 #include "RenderGraph/RenderPassStandardFlags.h"
 #include "GBufferRaster.h"
-#include "../RenderPasses/DepthPass/DepthPass.h"
 
 const char* GBufferRaster::kDesc = "Rasterized G-buffer generation pass";
 
@@ -53,6 +52,10 @@ namespace
     };
 
     const std::string kDepthName = "depth";
+    const std::string kDepthPrePassOutput = "DepthPrePass.depth";
+
+    // Scripting options.
+    const char kUseOcclusionCulling[] = "useOcclusionCulling";
 }
 
 RenderPassReflection GBufferRaster::reflect(const CompileData& compileData)
@@ -103,15 +106,46 @@ GBufferRaster::GBufferRaster(const Dictionary& dict)
     mpFbo = Fbo::create();
 }
 
+void GBufferRaster::parseDictionary(const Dictionary& dict)
+{
+    GBuffer::parseDictionary(dict);
+
+    for (const auto& v : dict)
+    {
+        if (v.key() == kUseOcclusionCulling) mUseOcclusionCulling = v.val();
+    }
+}
+
+Dictionary GBufferRaster::getScriptingDictionary()
+{
+    Dictionary dict = GBuffer::getScriptingDictionary();
+    dict[kUseOcclusionCulling] = mUseOcclusionCulling;
+    return dict;
+}
+
+void GBufferRaster::renderUI(Gui::Widgets& widget)
+{
+    GBuffer::renderUI(widget);
+
+    widget.checkbox("Occlusion culling", mUseOcclusionCulling);
+    widget.tooltip("Cull mesh instances hidden behind the depth of the previous frame. Instances rejected by mistake are re-tested against the current frame's depth and drawn in a second phase.", true);
+
+    if (mUseOcclusionCulling && mpOcclusionCulling)
+    {
+        auto group = Gui::Group(widget, "Occlusion culling stats");
+        if (group.open()) mpOcclusionCulling->renderUI(group);
+    }
+}
+
 void GBufferRaster::compile(RenderContext* pContext, const CompileData& compileData)
 {
     GBuffer::compile(pContext, compileData);
 
     mpDepthPrePassGraph = RenderGraph::create("Depth Pre-Pass");
-    DepthPass::SharedPtr pDepthPass = DepthPass::create(pContext);
-    pDepthPass->setDepthBufferFormat(ResourceFormat::D32Float);
-    mpDepthPrePassGraph->addPass(pDepthPass, "DepthPrePass");
-    mpDepthPrePassGraph->markOutput("DepthPrePass.depth");
+    mpDepthPass = DepthPass::create(pContext);
+    mpDepthPass->setDepthBufferFormat(ResourceFormat::D32Float);
+    mpDepthPrePassGraph->addPass(mpDepthPass, "DepthPrePass");
+    mpDepthPrePassGraph->markOutput(kDepthPrePassOutput);
     mpDepthPrePassGraph->setScene(mpScene);
 }
 
@@ -120,6 +154,7 @@ void GBufferRaster::setScene(RenderContext* pRenderContext, const Scene::SharedP
     GBuffer::setScene(pRenderContext, pScene);
 
     mRaster.pVars = nullptr;
+    mpOcclusionCulling = nullptr;
 
     if (pScene)
     {
@@ -143,6 +178,35 @@ void GBufferRaster::setCullMode(RasterizerState::CullMode mode)
     mRaster.pState->setRasterizerState(RasterizerState::create(rsDesc));
 }
 
+void GBufferRaster::executeDepthPrePass(RenderContext* pRenderContext)
+{
+    if (!mUseOcclusionCulling || mpScene->getMeshInstanceCount() == 0)
+    {
+        mpDepthPass->resetDrawList().setClearDepth(true);
+        mpDepthPrePassGraph->execute(pRenderContext);
+        return;
+    }
+
+    if (!mpOcclusionCulling) mpOcclusionCulling = OcclusionCulling::create(mpScene);
+    const glm::mat4& viewProj = mpScene->getCamera()->getViewProjMatrix();
+
+    // Render the instances that are visible in the previous frame's Hi-Z pyramid.
+    mpOcclusionCulling->cullPhase1(pRenderContext, viewProj);
+    mpDepthPass->setDrawList(mpOcclusionCulling->getPhase1DrawList()).setClearDepth(true);
+    mpDepthPrePassGraph->execute(pRenderContext);
+
+    // Re-test the rejected instances against the depth rendered so far and add the ones that are visible.
+    const Texture::SharedPtr& pDepth = mpDepthPrePassGraph->getOutput(kDepthPrePassOutput)->asTexture();
+    mpOcclusionCulling->buildHiZ(pRenderContext, pDepth, viewProj);
+    mpOcclusionCulling->cullPhase2(pRenderContext);
+    mpDepthPass->setDrawList(mpOcclusionCulling->getPhase2DrawList()).setClearDepth(false);
+    mpDepthPrePassGraph->execute(pRenderContext);
+
+    // Rebuild the pyramid from the complete depth for the next frame's phase 1. The phase 1 depth lacks the occluders
+    // rendered in phase 2, so a pyramid built from it alone culls less.
+    mpOcclusionCulling->buildHiZ(pRenderContext, pDepth, viewProj);
+}
+
 void GBufferRaster::execute(RenderContext* pRenderContext, const RenderData& renderData)
 {
     // Update refresh flag if options that affect the output have changed.
@@ -191,9 +255,9 @@ void GBufferRaster::execute(RenderContext* pRenderContext, const RenderData& ren
     }
 
     // Copy depth buffer.
-    mpDepthPrePassGraph->execute(pRenderContext);
-    mpFbo->attachDepthStencilTarget(mpDepthPrePassGraph->getOutput("DepthPrePass.depth")->asTexture());
-    pRenderContext->copyResource(renderData[kDepthName].get(), mpDepthPrePassGraph->getOutput("DepthPrePass.depth").get());
+    executeDepthPrePass(pRenderContext);
+    mpFbo->attachDepthStencilTarget(mpDepthPrePassGraph->getOutput(kDepthPrePassOutput)->asTexture());
+    pRenderContext->copyResource(renderData[kDepthName].get(), mpDepthPrePassGraph->getOutput(kDepthPrePassOutput).get());
 
     // Bind extra channels as UAV buffers.
     for (const auto& channel : kGBufferExtraChannels)
@@ -207,7 +271,15 @@ void GBufferRaster::execute(RenderContext* pRenderContext, const RenderData& ren
     mRaster.pState->setFbo(mpFbo); // Sets the viewport
 
     Scene::RenderFlags flags = mForceCullMode ? Scene::RenderFlags::UserRasterizerState : Scene::RenderFlags::None;
-    mpScene->render(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), flags);
+    if (mpOcclusionCulling && mUseOcclusionCulling)
+    {
+        mpScene->render(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), mpOcclusionCulling->getPhase1DrawList(), flags);
+        mpScene->render(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), mpOcclusionCulling->getPhase2DrawList(), flags);
+    }
+    else
+    {
+        mpScene->render(pRenderContext, mRaster.pState.get(), mRaster.pVars.get(), flags);
+    }
 
     mGBufferParams.frameCount++;
 }
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "GBuffer.h"
+#include "../RenderPasses/DepthPass/DepthPass.h"
 
 using namespace Falcor;
 
@@ -43,17 +44,26 @@ public:
     RenderPassReflection reflect(const CompileData& compileData) override;
     void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
     void setScene(RenderContext* pRenderContext, const Scene::SharedPtr& pScene) override;
+    void renderUI(Gui::Widgets& widget) override;
+    Dictionary getScriptingDictionary() override;
     std::string getDesc(void) override { return kDesc; }
     virtual void compile(RenderContext* pContext, const CompileData& compileData) override;
 
 private:
     GBufferRaster(const Dictionary& dict);
+    void parseDictionary(const Dictionary& dict) override;
     void setCullMode(RasterizerState::CullMode mode) override;
+    void executeDepthPrePass(RenderContext* pRenderContext);
 
     // Internal state
     RenderGraph::SharedPtr          mpDepthPrePassGraph;
+    DepthPass::SharedPtr            mpDepthPass;
+    OcclusionCulling::SharedPtr     mpOcclusionCulling;
     Fbo::SharedPtr                  mpFbo;
 
+    // UI variables
+    bool                            mUseOcclusionCulling = false;   ///< Cull occluded mesh instances using a Hi-Z pyramid.
+
     // Rasterization resources
     struct
     {
@@ -41,6 +41,7 @@ namespace
     const char kPackLinearZAndNormalShader[] = "RenderPasses/SVGFPass/SVGFPackLinearZAndNormal.ps.slang";
     const char kReprojectShader[]            = "RenderPasses/SVGFPass/SVGFReproject.ps.slang";
     const char kAtrousShader[]               = "RenderPasses/SVGFPass/SVGFAtrous.ps.slang";
+    const char kAtrousComputeShader[]        = "RenderPasses/SVGFPass/SVGFAtrous.cs.slang";
     const char kFilterMomentShader[]         = "RenderPasses/SVGFPass/SVGFFilterMoments.ps.slang";
     const char kFinalModulateShader[]        = "RenderPasses/SVGFPass/SVGFFinalModulate.ps.slang";
 
@@ -53,6 +54,7 @@ namespace
     const char kPhiNormal[] = "PhiNormal";
     const char kAlpha[] = "Alpha";
     const char kMomentsAlpha[] = "MomentsAlpha";
+    const char kComputeAtrous[] = "ComputeAtrous";
 
     // Input buffer names
     const char kInputBufferAlbedo[] = "Albedo";
@@ -101,6 +103,7 @@ SVGFPass::SVGFPass(const Dictionary& dict)
         else if (v.key() == kPhiNormal) mPhiNormal = v.val();
         else if (v.key() == kAlpha) mAlpha = v.val();
         else if (v.key() == kMomentsAlpha) mMomentsAlpha = v.val();
+        else if (v.key() == kComputeAtrous) mComputeAtrous = v.val();
         else
         {
             logWarning("Unknown field `" + v.key() + "` in SVGFPass dictionary");
@@ -112,7 +115,9 @@ SVGFPass::SVGFPass(const Dictionary& dict)
     mpAtrous = FullScreenPass::create(kAtrousShader);
     mpFilterMoments = FullScreenPass::create(kFilterMomentShader);
     mpFinalModulate = FullScreenPass::create(kFinalModulateShader);
-    assert(mpPackLinearZAndNormal && mpReprojection && mpAtrous && mpFilterMoments && mpFinalModulate);
+    mpAtrousFused = ComputePass::create(kAtrousComputeShader, "atrousFused");
+    mpAtrousSingle = ComputePass::create(kAtrousComputeShader, "atrousSingle");
+    assert(mpPackLinearZAndNormal && mpReprojection && mpAtrous && mpFilterMoments && mpFinalModulate && mpAtrousFused && mpAtrousSingle);
 }
 
 Dictionary SVGFPass::getScriptingDictionary()
@@ -126,6 +131,7 @@ Dictionary SVGFPass::getScriptingDictionary()
     dict[kPhiNormal] = mPhiNormal;
     dict[kAlpha] = mAlpha;
     dict[kMomentsAlpha] = mMomentsAlpha;
+    dict[kComputeAtrous] = mComputeAtrous;
     return dict;
 }
 
@@ -226,7 +232,8 @@ void SVGFPass::execute(RenderContext* pRenderContext, const RenderData& renderDa
         // in mpPingPongFbo[0].  Along the way (or at the end, depending on
         // the value of mFeedbackTap), save the filtered illumination for
         // next time into mpFilteredPastFbo.
-        computeAtrousDecomposition(pRenderContext, pAlbedoTexture);
+        if (mComputeAtrous) computeAtrousDecompositionCompute(pRenderContext);
+        else computeAtrousDecomposition(pRenderContext, pAlbedoTexture);
 
         // Compute albedo * filtered illumination and add emission back in.
         auto perImageCB = mpFinalModulate["PerImageCB"];
@@ -264,16 +271,18 @@ void SVGFPass::allocateFbos(uint2 dim, RenderContext* pRenderContext)
     }
 
     {
-        // Screen-size RGBA32F buffer for linear Z, derivative, and packed normal
+        // Screen-size RGBA32F buffer for linear Z, derivative, and packed normal,
+        // and RG32UI guide buffer with linear Z and a 16-bit packed normal for the compute a-trous filter
         Fbo::Desc desc;
         desc.setColorTarget(0, Falcor::ResourceFormat::RGBA32Float);
+        desc.setColorTarget(1, Falcor::ResourceFormat::RG32Uint);
         mpLinearZAndNormalFbo = Fbo::create2D(dim.x, dim.y, desc);
     }
 
     {
-        // Screen-size FBOs with 1 RGBA32F buffer
+        // Screen-size FBOs with 1 RGBA32F buffer, also written as UAV by the compute a-trous filter
         Fbo::Desc desc;
-        desc.setColorTarget(0, Falcor::ResourceFormat::RGBA32Float);
+        desc.setColorTarget(0, Falcor::ResourceFormat::RGBA32Float, true);
         mpPingPongFbo[0]  = Fbo::create2D(dim.x, dim.y, desc);
         mpPingPongFbo[1]  = Fbo::create2D(dim.x, dim.y, desc);
         mpFilteredPastFbo = Fbo::create2D(dim.x, dim.y, desc);
@@ -391,6 +400,66 @@ void SVGFPass::computeAtrousDecomposition(RenderContext* pRenderContext, Texture
     }
 }
 
+// Same filter as computeAtrousDecomposition(), but the first two iterations run in a single compute
+// dispatch that keeps the intermediate result in groupshared memory.
+void SVGFPass::computeAtrousDecompositionCompute(RenderContext* pRenderContext)
+{
+    const uint2 dim = uint2(mpLinearZAndNormalFbo->getWidth(), mpLinearZAndNormalFbo->getHeight());
+    const int feedbackTap = std::min(mFeedbackTap, mFilterIterations - 1);
+
+    for (auto pPass : { mpAtrousFused, mpAtrousSingle })
+    {
+        auto perImageCB = pPass["PerImageCB"];
+        perImageCB["gLinearZAndNormal"] = mpLinearZAndNormalFbo->getColorTexture(0);
+        perImageCB["gGuide"]            = mpLinearZAndNormalFbo->getColorTexture(1);
+        perImageCB["gFeedback"]         = mpFilteredPastFbo->getColorTexture(0);
+        perImageCB["gScreenSize"]       = int2(dim);
+        perImageCB["gPhiColor"]         = mPhiColor;
+        perImageCB["gPhiNormal"]        = mPhiNormal;
+    }
+
+    int i = 0;
+    if (mFilterIterations >= 2)
+    {
+        // Iterations 0 and 1. Iteration 0 is only written out if it feeds into future frames.
+        auto perImageCB = mpAtrousFused["PerImageCB"];
+        perImageCB["gIllumination"]  = mpPingPongFbo[0]->getColorTexture(0);
+        perImageCB["gOutput"]        = mpPingPongFbo[1]->getColorTexture(0);
+        perImageCB["gWriteFeedback"] = feedbackTap == 0;
+        mpAtrousFused->execute(pRenderContext, dim.x, dim.y);
+
+        if (feedbackTap == 1)
+        {
+            pRenderContext->copyResource(mpFilteredPastFbo->getColorTexture(0).get(), mpPingPongFbo[1]->getColorTexture(0).get());
+        }
+
+        std::swap(mpPingPongFbo[0], mpPingPongFbo[1]);
+        i = 2;
+    }
+
+    for (; i < mFilterIterations; i++)
+    {
+        auto perImageCB = mpAtrousSingle["PerImageCB"];
+        perImageCB["gIllumination"] = mpPingPongFbo[0]->getColorTexture(0);
+        perImageCB["gOutput"]       = mpPingPongFbo[1]->getColorTexture(0);
+        perImageCB["gStepSize"]     = 1 << i;
+        mpAtrousSingle->execute(pRenderContext, dim.x, dim.y);
+
+        // store the filtered color for the feedback path
+        if (i == feedbackTap)
+        {
+            pRenderContext->copyResource(mpFilteredPastFbo->getColorTexture(0).get(), mpPingPongFbo[1]->getColorTexture(0).get());
+        }
+
+        std::swap(mpPingPongFbo[0], mpPingPongFbo[1]);
+    }
+
+    if (mFeedbackTap < 0)
+    {
+        pRenderContext->blit(mpCurReprojFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0));
+    }
+}
+
 void SVGFPass::renderUI(Gui::Widgets& widget)
 {
     int dirty = 0;
@@ -401,6 +470,9 @@ void SVGFPass::renderUI(Gui::Widgets& widget)
     widget.text("    iteration feeds into future frames?");
     dirty |= (int)widget.var("Iterations", mFilterIterations, 2, 10, 1);
     dirty |= (int)widget.var("Feedback", mFeedbackTap, -1, mFilterIterations - 2, 1);
+    dirty |= (int)widget.checkbox("Compute a-trous", mComputeAtrous);
+    widget.tooltip("Run the a-trous filter in compute shaders, with the first two iterations fused into one dispatch.\n"
+                   "The normals used for edge stopping are quantized to 16 bits per component.", true);
 
     widget.text("");
     widget.text("Contol edge stopping on bilateral fitler");
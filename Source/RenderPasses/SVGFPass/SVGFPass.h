@@ -61,6 +61,7 @@ private:
                              Texture::SharedPtr pPrevLinearZAndNormalTexture);
     void computeFilteredMoments(RenderContext* pRenderContext);
     void computeAtrousDecomposition(RenderContext* pRenderContext, Texture::SharedPtr pAlbedoTexture);
+    void computeAtrousDecompositionCompute(RenderContext* pRenderContext);
 
     bool mBuffersNeedClear = false;
 
@@ -73,6 +74,7 @@ private:
     float   mPhiNormal           = 128.0f;
     float   mAlpha               = 0.05f;
     float   mMomentsAlpha        = 0.2f;
+    bool    mComputeAtrous       = false;   ///< Run the a-trous filter in compute, with the first two iterations fused. Its 16-bit normals change the results slightly.
 
     // SVGF passes
     FullScreenPass::SharedPtr mpPackLinearZAndNormal;
@@ -80,6 +82,8 @@ private:
     FullScreenPass::SharedPtr mpFilterMoments;
     FullScreenPass::SharedPtr mpAtrous;
     FullScreenPass::SharedPtr mpFinalModulate;
+    ComputePass::SharedPtr    mpAtrousFused;
+    ComputePass::SharedPtr    mpAtrousSingle;
 
     // Intermediate framebuffers
     Fbo::SharedPtr mpPingPongFbo[2];
@@ -49,6 +49,13 @@ namespace
     const char kAutoExposure[] = "autoExposure";
     const char kExposureValue[] = "exposureValue";
     const char kFilmSpeed[] = "filmSpeed";
+    const char kHistogramExposure[] = "histogramExposure";
+    const char kExposureGroup[] = "exposureGroup";
+    const char kExposureTimeStep[] = "exposureTimeStep";
+    const char kExposureLowPercentile[] = "exposureLowPercentile";
+    const char kExposureHighPercentile[] = "exposureHighPercentile";
+    const char kExposureSpeedUp[] = "exposureSpeedUp";
+    const char kExposureSpeedDown[] = "exposureSpeedDown";
 
     const char kWhiteBalance[] = "whiteBalance";
     const char kWhitePoint[] = "whitePoint";
@@ -73,6 +80,8 @@ namespace
     // Note: Color temperatures < ~1905K are out-of-gamut in Rec.709.
     const float kWhitePointMin = 1905.f;
     const float kWhitePointMax = 25000.f;
+
+    const float kDefaultFrameTime = 1.f / 60.f;     // Used for exposure adaptation when there is no global clock.
 }
 
 // Don't remove this. it's required for hot-reload to function properly
@@ -94,6 +103,9 @@ static void regToneMapper(ScriptBindings::Module& m)
     c.property(kClamp, &ToneMapper::getClamp, &ToneMapper::setClamp);
     c.property(kWhiteMaxLuminance, &ToneMapper::getWhiteMaxLuminance, &ToneMapper::setWhiteMaxLuminance);
     c.property(kWhiteScale, &ToneMapper::getWhiteScale, &ToneMapper::setWhiteScale);
+    c.property(kHistogramExposure, &ToneMapper::getHistogramExposure, &ToneMapper::setHistogramExposure);
+    c.property(kExposureGroup, &ToneMapper::getExposureGroup, &ToneMapper::setExposureGroup);
+    c.property(kExposureTimeStep, &ToneMapper::getExposureTimeStep, &ToneMapper::setExposureTimeStep);
 
     auto op = m.enum_<ToneMapper::Operator>("ToneMapOp");
     op.regEnumVal(ToneMapper::Operator::Linear);
@@ -126,6 +138,11 @@ ToneMapper::ToneMapper(ToneMapper::Operator op, ResourceFormat outputFormat) : m
     mpLinearSampler = Sampler::create(samplerDesc);
 }
 
+ToneMapper::~ToneMapper()
+{
+    if (mpSharedExposure) mpSharedExposure->accumulated.erase(this);
+}
+
 ToneMapper::SharedPtr ToneMapper::create(RenderContext* pRenderContext, const Dictionary& dict)
 {
     // outputFormat can only be set on construction
@@ -148,6 +165,13 @@ ToneMapper::SharedPtr ToneMapper::create(RenderContext* pRenderContext, const Di
             else if (v.key() == kClamp) pTM->setClamp(v.val());
             else if (v.key() == kWhiteMaxLuminance) pTM->setWhiteMaxLuminance(v.val());
             else if (v.key() == kWhiteScale) pTM->setWhiteScale(v.val());
+            else if (v.key() == kHistogramExposure) pTM->setHistogramExposure(v.val());
+            else if (v.key() == kExposureGroup) pTM->setExposureGroup(v.val());
+            else if (v.key() == kExposureTimeStep) pTM->setExposureTimeStep(v.val());
+            else if (v.key() == kExposureLowPercentile) pTM->mHistogramParams.lowPercentile = v.val();
+            else if (v.key() == kExposureHighPercentile) pTM->mHistogramParams.highPercentile = v.val();
+            else if (v.key() == kExposureSpeedUp) pTM->mHistogramParams.speedUp = v.val();
+            else if (v.key() == kExposureSpeedDown) pTM->mHistogramParams.speedDown = v.val();
             else logWarning("Unknown field `" + v.key() + "` in a ToneMapping dictionary");
         }
     }
@@ -167,6 +191,13 @@ Dictionary ToneMapper::getScriptingDictionary()
     d[kAutoExposure] = mAutoExposure;
     d[kExposureValue] = mExposureValue;
     d[kFilmSpeed] = mFilmSpeed;
+    d[kHistogramExposure] = mHistogramExposure;
+    if (!mExposureGroup.empty()) d[kExposureGroup] = mExposureGroup;
+    d[kExposureTimeStep] = mExposureTimeStep;
+    d[kExposureLowPercentile] = mHistogramParams.lowPercentile;
+    d[kExposureHighPercentile] = mHistogramParams.highPercentile;
+    d[kExposureSpeedUp] = mHistogramParams.speedUp;
+    d[kExposureSpeedDown] = mHistogramParams.speedDown;
     d[kWhiteBalance] = mWhiteBalance;
     d[kWhitePoint] = mWhitePoint;
     d[kOperator] = mOperator;
@@ -197,7 +228,11 @@ void ToneMapper::execute(RenderContext* pRenderContext, const RenderData& render
     pFbo->attachColorTarget(pDst, 0);
 
     // Run luminance pass if auto exposure is enabled
-    if (mAutoExposure)
+    if (mAutoExposure && mHistogramExposure)
+    {
+        updateHistogramExposure(pRenderContext, pSrc);
+    }
+    else if (mAutoExposure)
     {
         createLuminanceFbo(pSrc);
 
@@ -232,7 +267,11 @@ void ToneMapper::execute(RenderContext* pRenderContext, const RenderData& render
     mpToneMapPass["gColorTex"] = pSrc;
     mpToneMapPass["gColorSampler"] = mpPointSampler;
 
-    if (mAutoExposure)
+    if (mAutoExposure && mHistogramExposure)
+    {
+        mpToneMapPass["gExposure"] = mpSharedExposure->pHistogram->getExposureBuffer();
+    }
+    else if (mAutoExposure)
     {
         mpToneMapPass["gLuminanceTexSampler"] = mpLinearSampler;
         mpToneMapPass["gLuminanceTex"] = mpLuminanceFbo->getColorTexture(0);
@@ -267,6 +306,47 @@ void ToneMapper::createLuminanceFbo(const Texture::SharedPtr& pSrc)
     }
 }
 
+void ToneMapper::updateHistogramExposure(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc)
+{
+    if (!mpSharedExposure)
+    {
+        // The registry only holds weak references, so the histogram of a group is released with its last member.
+        static std::unordered_map<std::string, std::weak_ptr<SharedExposure>> sExposureGroups;
+        if (!mExposureGroup.empty()) mpSharedExposure = sExposureGroups[mExposureGroup].lock();
+        if (!mpSharedExposure)
+        {
+            mpSharedExposure = std::make_shared<SharedExposure>();
+            mpSharedExposure->pHistogram = LuminanceHistogram::create();
+            if (!mExposureGroup.empty()) sExposureGroups[mExposureGroup] = mpSharedExposure;
+        }
+    }
+
+    SharedExposure& shared = *mpSharedExposure;
+    shared.pHistogram->setParams(mHistogramParams);
+
+    // The global clock follows the simulated framerate and pauses, so captures and image tests adapt deterministically.
+    // A negative time step after resetting the clock is ignored.
+    float deltaTime = mExposureTimeStep;
+    if (deltaTime <= 0.f) deltaTime = gpFramework ? std::max((float)gpFramework->getGlobalClock().getDelta(), 0.f) : kDefaultFrameTime;
+
+    if (mExposureGroup.empty())
+    {
+        shared.pHistogram->accumulate(pRenderContext, pSrc);
+        shared.pHistogram->updateExposure(pRenderContext, deltaTime);
+        return;
+    }
+
+    // A member executing again starts a new frame. The exposure is then computed from the inputs of all members in the
+    // previous frame, so that all of them are tone mapped with the same exposure at the cost of one frame of latency.
+    if (shared.accumulated.count(this) > 0)
+    {
+        shared.pHistogram->updateExposure(pRenderContext, deltaTime);
+        shared.accumulated.clear();
+    }
+    shared.pHistogram->accumulate(pRenderContext, pSrc);
+    shared.accumulated.insert(this);
+}
+
 void ToneMapper::renderUI(Gui::Widgets& widget)
 {
     auto exposureGroup = Gui::Group(widget, "Exposure", true);
@@ -276,6 +356,30 @@ void ToneMapper::renderUI(Gui::Widgets& widget)
 
         mRecreateToneMapPass |= exposureGroup.checkbox("Auto Exposure", mAutoExposure);
 
+        if (mAutoExposure)
+        {
+            mRecreateToneMapPass |= exposureGroup.checkbox("Histogram Exposure", mHistogramExposure);
+            exposureGroup.tooltip("Compute the exposure from a luminance histogram, ignoring the darkest and brightest pixels, and adapt it over time.\n"
+                "Otherwise the exposure is the average luminance of the whole image without adaptation.", true);
+
+            if (mHistogramExposure)
+            {
+                if (!mExposureGroup.empty()) exposureGroup.text("Exposure group: " + mExposureGroup);
+
+                LuminanceHistogramParams& params = mHistogramParams;
+                exposureGroup.var("Low Percentile", params.lowPercentile, 0.f, params.highPercentile, 0.01f);
+                exposureGroup.tooltip("Fraction of the darkest pixels that is ignored.", true);
+                exposureGroup.var("High Percentile", params.highPercentile, params.lowPercentile, 1.f, 0.01f);
+                exposureGroup.tooltip("Fraction of the pixels up to which the average is taken. The brightest pixels above it are ignored.", true);
+                exposureGroup.var("Adaptation Speed Up", params.speedUp, 0.f, 100.f, 0.1f);
+                exposureGroup.tooltip("Adaptation speed when the image gets brighter, in 1/s.", true);
+                exposureGroup.var("Adaptation Speed Down", params.speedDown, 0.f, 100.f, 0.1f);
+                exposureGroup.tooltip("Adaptation speed when the image gets darker, in 1/s.", true);
+                if (exposureGroup.var("Adaptation Time Step", mExposureTimeStep, 0.f, 1.f, 0.001f)) setExposureTimeStep(mExposureTimeStep);
+                exposureGroup.tooltip("Fixed time step of the adaptation in seconds. Zero uses the time step of the global clock.", true);
+            }
+        }
+
         if (!mAutoExposure)
         {
             mUpdateToneMapPass |= exposureGroup.var("Exposure Value (EV)", mExposureValue, kExposureValueMin, kExposureValueMax, 0.1f, false, "%.1f");
@@ -344,6 +448,27 @@ void ToneMapper::setAutoExposure(bool autoExposure)
     mRecreateToneMapPass = true;
 }
 
+void ToneMapper::setHistogramExposure(bool histogramExposure)
+{
+    mHistogramExposure = histogramExposure;
+    mRecreateToneMapPass = true;
+}
+
+void ToneMapper::setExposureGroup(const std::string& exposureGroup)
+{
+    if (exposureGroup != mExposureGroup)
+    {
+        if (mpSharedExposure) mpSharedExposure->accumulated.erase(this);
+        mpSharedExposure = nullptr;
+        mExposureGroup = exposureGroup;
+    }
+}
+
+void ToneMapper::setExposureTimeStep(float timeStep)
+{
+    mExposureTimeStep = std::max(timeStep, 0.f);
+}
+
 void ToneMapper::setExposureValue(float exposureValue)
 {
     mExposureValue = glm::clamp(exposureValue, kExposureValueMin, kExposureValueMax);
@@ -408,6 +533,7 @@ void ToneMapper::createToneMapPass()
     Program::DefineList defines;
     defines.add("_TONE_MAPPER_OPERATOR", std::to_string(static_cast<uint32_t>(mOperator)));
     if (mAutoExposure) defines.add("_TONE_MAPPER_AUTO_EXPOSURE");
+    if (mAutoExposure && mHistogramExposure) defines.add("_TONE_MAPPER_HISTOGRAM_EXPOSURE");
     if (mClamp) defines.add("_TONE_MAPPER_CLAMP");
 
     mpToneMapPass = FullScreenPass::create(kToneMappingFile, defines);
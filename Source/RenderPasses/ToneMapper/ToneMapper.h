@@ -29,6 +29,7 @@
 #include "Falcor.h"
 #include "FalcorExperimental.h"
 #include "ToneMapperParams.slang"
+#include <unordered_set>
 
 using namespace Falcor;
 
@@ -45,6 +46,8 @@ public:
     */
     static SharedPtr create(RenderContext* pRenderContext, const Dictionary& dict);
 
+    virtual ~ToneMapper();
+
     std::string getDesc() override { return kDesc; }
     virtual Dictionary getScriptingDictionary() override;
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
@@ -62,6 +65,9 @@ public:
     void setClamp(bool clamp);
     void setWhiteMaxLuminance(float maxLuminance);
     void setWhiteScale(float whiteScale);
+    void setHistogramExposure(bool histogramExposure);
+    void setExposureGroup(const std::string& exposureGroup);
+    void setExposureTimeStep(float timeStep);
 
     float getExposureCompensation() const { return mExposureCompensation; }
     bool getAutoExposure() const { return mAutoExposure; }
@@ -73,6 +79,9 @@ public:
     bool getClamp() const { return mClamp; }
     float getWhiteMaxLuminance() const { return mWhiteMaxLuminance; }
     float getWhiteScale() const { return mWhiteScale; }
+    bool getHistogramExposure() const { return mHistogramExposure; }
+    const std::string& getExposureGroup() const { return mExposureGroup; }
+    float getExposureTimeStep() const { return mExposureTimeStep; }
 
 private:
     ToneMapper(Operator op, ResourceFormat outputFormat);
@@ -80,6 +89,7 @@ private:
     void createToneMapPass();
     void createLuminancePass();
     void createLuminanceFbo(const Texture::SharedPtr& pSrc);
+    void updateHistogramExposure(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc);
 
     void updateWhiteBalanceTransform();
     void updateColorTransform();
@@ -90,12 +100,25 @@ private:
     Sampler::SharedPtr mpPointSampler;
     Sampler::SharedPtr mpLinearSampler;
 
+    /** Luminance histogram shared by all tone mappers of an exposure group.
+    */
+    struct SharedExposure
+    {
+        LuminanceHistogram::SharedPtr pHistogram;
+        std::unordered_set<const ToneMapper*> accumulated;  // Members that added their input since the last exposure update.
+    };
+    std::shared_ptr<SharedExposure> mpSharedExposure;       // Created on first use with histogram exposure.
+
     ResourceFormat mOutputFormat;       // Output format (uses default when set to ResourceFormat::Unknown).
 
     float mExposureCompensation = 0.f;  // Exposure compensation (in F-stops).
     bool mAutoExposure = false;         // Enable auto exposure.
     float mExposureValue = 0.0f;        // Exposure value (EV), only used when auto exposure is disabled.
     float mFilmSpeed = 100.f;           // Film speed (ISO), only used when auto exposure is disabled.
+    bool mHistogramExposure = false;    // Compute the auto exposure from a luminance histogram instead of the mip chain of the luminance.
+    std::string mExposureGroup;         // Tone mappers with the same non-empty group share a single exposure, e.g. both eyes in stereo.
+    LuminanceHistogramParams mHistogramParams;  // Histogram and adaptation parameters, only used with histogram exposure.
+    float mExposureTimeStep = 0.f;      // Fixed time step of the exposure adaptation in seconds. Zero uses the time step of the global clock.
 
     bool mWhiteBalance = false;         // Enable white balance.
     float mWhitePoint = 6500.0f;        // White point (K).
@@ -38,8 +38,69 @@ namespace
 
     const char kKernelWidth[] = "kernelWidth";
     const char kSigma[] = "sigma";
+    const char kCompute[] = "compute";
+    const char kBoxPasses[] = "boxPasses";
+    const char kHalfResolution[] = "halfResolution";
 
     const char kShaderFilename[] = "RenderPasses/Utils/GaussianBlur/GaussianBlur.ps.slang";
+    const char kComputeShaderFilename[] = "RenderPasses/Utils/GaussianBlur/GaussianBlur.cs.slang";
+
+    const uint32_t kMaxApron = 128;     // Largest kernel radius of the compute path. Must match GaussianBlur.cs.slang.
+    const uint32_t kMaxBoxPasses = 4;
+
+    float getCoefficient(float sigma, float kernelWidth, float x)
+    {
+        float sigmaSquared = sigma * sigma;
+        float p = -(x*x) / (2 * sigmaSquared);
+        float e = exp(p);
+
+        float a = 2 * (float)M_PI * sigmaSquared;
+        return e / a;
+    }
+
+    std::vector<float> getKernelWeights(uint32_t kernelWidth, float sigma)
+    {
+        uint32_t center = kernelWidth / 2;
+        float sum = 0;
+        std::vector<float> weights(center + 1);
+        for (uint32_t i = 0; i <= center; i++)
+        {
+            weights[i] = getCoefficient(sigma, (float)kernelWidth, (float)i);
+            sum += (i == 0) ? weights[i] : 2 * weights[i];
+        }
+
+        std::vector<float> kernel(kernelWidth);
+        for (uint32_t i = 0; i <= center; i++)
+        {
+            float w = weights[i] / sum;
+            kernel[center + i] = w;
+            kernel[center - i] = w;
+        }
+        return kernel;
+    }
+
+    /** Get the radii of box filters whose successive application has the variance of a Gaussian.
+        See Kovesi, "Fast Almost-Gaussian Filtering", 2010.
+    */
+    std::vector<uint32_t> getBoxRadii(float sigma, uint32_t boxPasses)
+    {
+        const float n = (float)boxPasses;
+        const float variance = sigma * sigma;
+        int lowerWidth = (int)std::floor(std::sqrt(12.f * variance / n + 1.f));
+        if (lowerWidth % 2 == 0) lowerWidth--;
+        lowerWidth = std::max(lowerWidth, 1);
+
+        // Number of boxes of the lower width. The others are two pixels wider.
+        float m = std::round((12.f * variance - n * lowerWidth * lowerWidth - 4.f * n * lowerWidth - 3.f * n) / (-4.f * lowerWidth - 4.f));
+        uint32_t lowerCount = (uint32_t)glm::clamp(m, 0.f, n);
+
+        std::vector<uint32_t> radii(boxPasses);
+        for (uint32_t i = 0; i < boxPasses; i++)
+        {
+            radii[i] = (uint32_t)(i < lowerCount ? lowerWidth - 1 : lowerWidth + 1) / 2;
+        }
+        return radii;
+    }
 }
 
 void GaussianBlur::registerBindings(ScriptBindings::Module& m)
@@ -47,6 +108,9 @@ void GaussianBlur::registerBindings(ScriptBindings::Module& m)
     auto c = m.regClass(GaussianBlur);
     c.property(kKernelWidth, &GaussianBlur::getKernelWidth, &GaussianBlur::setKernelWidth);
     c.property(kSigma, &GaussianBlur::getSigma, &GaussianBlur::setSigma);
+    c.property(kCompute, &GaussianBlur::getCompute, &GaussianBlur::setCompute);
+    c.property(kBoxPasses, &GaussianBlur::getBoxPasses, &GaussianBlur::setBoxPasses);
+    c.property(kHalfResolution, &GaussianBlur::getHalfResolution, &GaussianBlur::setHalfResolution);
 }
 
 GaussianBlur::GaussianBlur()
@@ -64,6 +128,9 @@ GaussianBlur::SharedPtr GaussianBlur::create(RenderContext* pRenderContext, cons
     {
         if (v.key() == kKernelWidth) pBlur->mKernelWidth = v.val();
         else if (v.key() == kSigma) pBlur->mSigma = v.val();
+        else if (v.key() == kCompute) pBlur->mCompute = v.val();
+        else if (v.key() == kBoxPasses) pBlur->mBoxPasses = std::min((uint32_t)v.val(), kMaxBoxPasses);
+        else if (v.key() == kHalfResolution) pBlur->mHalfResolution = v.val();
         else logWarning("Unknown field '" + v.key() + "' in a GaussianBlur dictionary");
     }
     return pBlur;
@@ -74,6 +141,9 @@ Dictionary GaussianBlur::getScriptingDictionary()
     Dictionary dict;
     dict[kKernelWidth] = mKernelWidth;
     dict[kSigma] = mSigma;
+    dict[kCompute] = mCompute;
+    dict[kBoxPasses] = mBoxPasses;
+    dict[kHalfResolution] = mHalfResolution;
     return dict;
 }
 
@@ -98,7 +168,9 @@ RenderPassReflection GaussianBlur::reflect(const CompileData& compileData)
         };
 
         formatField(reflector.addInput(kSrc, "input image to be blurred"));
-        formatField(reflector.addOutput(kDst, "output blurred image"));
+        auto& output = reflector.addOutput(kDst, "output blurred image");
+        formatField(output);
+        if (mCompute && !isSrgbFormat(srcFormat)) output.bindFlags(ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget | ResourceBindFlags::UnorderedAccess);
         mReady = true;
     }
     else
@@ -113,7 +185,67 @@ void GaussianBlur::compile(RenderContext* pContext, const CompileData& compileDa
 {
     if (!mReady) throw std::runtime_error("GaussianBlur::compile - missing incoming reflection information");
 
-    uint32_t arraySize = compileData.connectedResources.getField(kSrc)->getArraySize();
+    const RenderPassReflection::Field* pSrcField = compileData.connectedResources.getField(kSrc);
+    uint32_t arraySize = pSrcField->getArraySize();
+    mUseCompute = mCompute && !isSrgbFormat(pSrcField->getFormat());
+
+    // At half resolution, the kernel is scaled to keep the blur radius in full resolution pixels.
+    const uint32_t kernelWidth = mHalfResolution ? (mKernelWidth / 2) | 1 : mKernelWidth;
+    const float sigma = mHalfResolution ? mSigma / 2.f : mSigma;
+    std::vector<uint32_t> radii;
+    uint32_t apron = kernelWidth / 2;
+    if (mUseCompute && mBoxPasses > 0)
+    {
+        radii = getBoxRadii(sigma, mBoxPasses);
+        apron = 0;
+        for (uint32_t r : radii) apron += r;
+    }
+
+    // The compute path caches the apron in groupshared memory. Wider kernels use the pixel shaders instead of being truncated.
+    if (mUseCompute && apron > kMaxApron)
+    {
+        logWarning("GaussianBlur: the kernel radius " + std::to_string(apron) + " exceeds the maximum of " + std::to_string(kMaxApron) + " of the compute path. Falling back to pixel shaders.");
+        mUseCompute = false;
+    }
+
+    if (mUseCompute)
+    {
+        Program::DefineList defines;
+        if (arraySize > 1) defines.add("_USE_TEX2D_ARRAY");
+        if (mBoxPasses > 0)
+        {
+            std::string radiiList;
+            for (uint32_t r : radii) radiiList += (radiiList.empty() ? "" : ",") + std::to_string(r);
+            defines.add("_BOX_COUNT", std::to_string(mBoxPasses));
+            defines.add("_BOX_RADII", radiiList);
+            defines.add("_APRON", std::to_string(apron));
+            defines.add("_KERNEL_WIDTH", "1");
+        }
+        else
+        {
+            defines.add("_BOX_COUNT", "0");
+            defines.add("_APRON", std::to_string(apron));
+            defines.add("_KERNEL_WIDTH", std::to_string(kernelWidth));
+        }
+
+        defines.add("_HORIZONTAL_BLUR");
+        if (mHalfResolution) defines.add("_DOWNSAMPLE");
+        mpHorizontalBlurCS = ComputePass::create(kComputeShaderFilename, "main", defines);
+        defines.remove("_HORIZONTAL_BLUR");
+        defines.remove("_DOWNSAMPLE");
+        defines.add("_VERTICAL_BLUR");
+        mpVerticalBlurCS = ComputePass::create(kComputeShaderFilename, "main", defines);
+
+        if (mBoxPasses == 0)
+        {
+            std::vector<float> weights = getKernelWeights(kernelWidth, sigma);
+            Buffer::SharedPtr pBuf = Buffer::createTyped<float>(kernelWidth, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data());
+            mpHorizontalBlurCS["weights"] = pBuf;
+            mpVerticalBlurCS["weights"] = pBuf;
+        }
+        return;
+    }
+
     Program::DefineList defines;
     defines.add("_KERNEL_WIDTH", std::to_string(mKernelWidth));
     if (arraySize > 1) defines.add("_USE_TEX2D_ARRAY");
@@ -134,6 +266,12 @@ void GaussianBlur::compile(RenderContext* pContext, const CompileData& compileDa
 void GaussianBlur::execute(RenderContext* pRenderContext, const RenderData& renderData)
 {
     auto pSrc = renderData[kSrc]->asTexture();
+    if (mUseCompute)
+    {
+        executeCompute(pRenderContext, pSrc, renderData[kDst]->asTexture());
+        return;
+    }
+
     mpFbo->attachColorTarget(renderData[kDst]->asTexture(), 0);
     createTmpFbo(pSrc.get());
 
@@ -147,6 +285,53 @@ void GaussianBlur::execute(RenderContext* pRenderContext, const RenderData& rend
     mpVerticalBlur->execute(pRenderContext, mpFbo);
 }
 
+void GaussianBlur::executeCompute(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc, const Texture::SharedPtr& pDst)
+{
+    const uint32_t arraySize = pSrc->getArraySize();
+    const uint2 srcDim(pSrc->getWidth(), pSrc->getHeight());
+    const uint2 blurDim = mHalfResolution ? (srcDim + 1u) / 2u : srcDim;
+    createTmpTextures(pSrc.get(), blurDim);
+    const Texture::SharedPtr& pVerticalDst = mHalfResolution ? mpHalfResTex : pDst;
+
+    // Horizontal pass. One thread group per tile of a row.
+    auto horizontalVars = mpHorizontalBlurCS->getRootVar();
+    horizontalVars["BlurCB"]["gDstDim"] = blurDim;
+    horizontalVars["gSampler"] = mpSampler;
+    horizontalVars["gSrcTex"] = pSrc;
+    horizontalVars["gDstTex"] = mpTmpTex;
+    mpHorizontalBlurCS->execute(pRenderContext, blurDim.x, blurDim.y, arraySize);
+
+    // Vertical pass. One thread group per tile of a column.
+    auto verticalVars = mpVerticalBlurCS->getRootVar();
+    verticalVars["BlurCB"]["gDstDim"] = blurDim;
+    verticalVars["gSrcTex"] = mpTmpTex;
+    verticalVars["gDstTex"] = pVerticalDst;
+    mpVerticalBlurCS->execute(pRenderContext, blurDim.y, blurDim.x, arraySize);
+
+    if (mHalfResolution)
+    {
+        for (uint32_t slice = 0; slice < arraySize; slice++)
+        {
+            pRenderContext->blit(mpHalfResTex->getSRV(0, 1, slice, 1), pDst->getRTV(0, slice, 1));
+        }
+    }
+}
+
+void GaussianBlur::createTmpTextures(const Texture* pSrc, uint2 blurDim)
+{
+    const ResourceFormat format = pSrc->getFormat();
+    const uint32_t arraySize = pSrc->getArraySize();
+    auto matches = [&](const Texture::SharedPtr& pTex)
+    {
+        return pTex && pTex->getWidth() == blurDim.x && pTex->getHeight() == blurDim.y && pTex->getFormat() == format && pTex->getArraySize() == arraySize;
+    };
+    const ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+
+    if (!matches(mpTmpTex)) mpTmpTex = Texture::create2D(blurDim.x, blurDim.y, format, arraySize, 1, nullptr, bindFlags);
+    if (!mHalfResolution) mpHalfResTex = nullptr;
+    else if (!matches(mpHalfResTex)) mpHalfResTex = Texture::create2D(blurDim.x, blurDim.y, format, arraySize, 1, nullptr, bindFlags);
+}
+
 void GaussianBlur::createTmpFbo(const Texture* pSrc)
 {
     bool createFbo = mpTmpFbo == nullptr;
@@ -170,8 +355,27 @@ void GaussianBlur::createTmpFbo(const Texture* pSrc)
 
 void GaussianBlur::renderUI(Gui::Widgets& widget)
 {
-    if (widget.var("Kernel Width", (int&)mKernelWidth, 1, 15, 2)) setKernelWidth(mKernelWidth);
-    if (widget.slider("Sigma", mSigma, 0.001f, mKernelWidth / 2.f)) setSigma(mSigma);
+    if (widget.checkbox("Compute", mCompute)) setCompute(mCompute);
+    widget.tooltip("Blur in compute shaders with the taps cached in groupshared memory.", true);
+
+    if (mCompute)
+    {
+        if (widget.var("Box Passes", (int&)mBoxPasses, 0, (int)kMaxBoxPasses)) setBoxPasses(mBoxPasses);
+        widget.tooltip("Approximate the Gaussian by this many box filters. The cost does not depend on the radius, which pays off for large radii.\n"
+            "Zero uses the exact kernel.", true);
+        if (widget.checkbox("Half Resolution", mHalfResolution)) setHalfResolution(mHalfResolution);
+        widget.tooltip("Blur at half resolution and upsample bilinearly.", true);
+    }
+
+    if (mCompute && mBoxPasses > 0)
+    {
+        if (widget.slider("Sigma", mSigma, 0.001f, 64.f)) setSigma(mSigma);
+    }
+    else
+    {
+        if (widget.var("Kernel Width", (int&)mKernelWidth, 1, mCompute ? 63 : 15, 2)) setKernelWidth(mKernelWidth);
+        if (widget.slider("Sigma", mSigma, 0.001f, mKernelWidth / 2.f)) setSigma(mSigma);
+    }
 }
 
 void GaussianBlur::setKernelWidth(uint32_t kernelWidth)
@@ -186,35 +390,27 @@ void GaussianBlur::setSigma(float sigma)
     mPassChangedCB();
 }
 
-float getCoefficient(float sigma, float kernelWidth, float x)
+void GaussianBlur::setCompute(bool compute)
 {
-    float sigmaSquared = sigma * sigma;
-    float p = -(x*x) / (2 * sigmaSquared);
-    float e = exp(p);
-
-    float a = 2 * (float)M_PI * sigmaSquared;
-    return e / a;
+    mCompute = compute;
+    mPassChangedCB();
 }
 
-void GaussianBlur::updateKernel()
+void GaussianBlur::setBoxPasses(uint32_t boxPasses)
 {
-    uint32_t center = mKernelWidth / 2;
-    float sum = 0;
-    std::vector<float> weights(center + 1);
-    for (uint32_t i = 0; i <= center; i++)
-    {
-        weights[i] = getCoefficient(mSigma, (float)mKernelWidth, (float)i);
-        sum += (i == 0) ? weights[i] : 2 * weights[i];
-    }
-
-    Buffer::SharedPtr pBuf = Buffer::createTyped<float>(mKernelWidth, Resource::BindFlags::ShaderResource);
+    mBoxPasses = std::min(boxPasses, kMaxBoxPasses);
+    mPassChangedCB();
+}
 
-    for (uint32_t i = 0; i <= center; i++)
-    {
-        float w = weights[i] / sum;
-        pBuf->setElement(center + i, w);
-        pBuf->setElement(center - i, w);
-    }
+void GaussianBlur::setHalfResolution(bool halfResolution)
+{
+    mHalfResolution = halfResolution;
+    mPassChangedCB();
+}
 
+void GaussianBlur::updateKernel()
+{
+    std::vector<float> weights = getKernelWeights(mKernelWidth, mSigma);
+    Buffer::SharedPtr pBuf = Buffer::createTyped<float>(mKernelWidth, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data());
     mpHorizontalBlur["weights"] = pBuf;
 }
@@ -56,19 +56,35 @@ public:
 
     void setKernelWidth(uint32_t kernelWidth);
     void setSigma(float sigma);
+    void setCompute(bool compute);
+    void setBoxPasses(uint32_t boxPasses);
+    void setHalfResolution(bool halfResolution);
     uint32_t getKernelWidth() { return mKernelWidth; }
     float getSigma() { return mSigma; }
+    bool getCompute() { return mCompute; }
+    uint32_t getBoxPasses() { return mBoxPasses; }
+    bool getHalfResolution() { return mHalfResolution; }
 
 private:
     GaussianBlur();
     uint32_t mKernelWidth = 5;
     float mSigma = 2.0f;
+    bool mCompute = false;          // Blur in compute shaders. Falls back to pixel shaders for sRGB formats, which can't be written as UAV, and for radii above the compute apron.
+    uint32_t mBoxPasses = 0;        // Approximate the Gaussian by this many box filters (compute only). Zero uses the exact kernel.
+    bool mHalfResolution = false;   // Blur at half resolution and upsample bilinearly (compute only).
     bool mReady = false;
+    bool mUseCompute = false;       // Set on compile if the compute path is used.
     void createTmpFbo(const Texture* pSrc);
+    void createTmpTextures(const Texture* pSrc, uint2 blurDim);
     void updateKernel();
+    void executeCompute(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc, const Texture::SharedPtr& pDst);
 
     FullScreenPass::SharedPtr mpHorizontalBlur;
     FullScreenPass::SharedPtr mpVerticalBlur;
+    ComputePass::SharedPtr mpHorizontalBlurCS;
+    ComputePass::SharedPtr mpVerticalBlurCS;
+    Texture::SharedPtr mpTmpTex;        // Output of the horizontal compute pass.
+    Texture::SharedPtr mpHalfResTex;    // Output of the vertical compute pass at half resolution.
     Fbo::SharedPtr mpFbo;
     Fbo::SharedPtr mpTmpFbo;
     Sampler::SharedPtr mpSampler;
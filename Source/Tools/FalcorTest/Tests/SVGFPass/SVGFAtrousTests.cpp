@@ -0,0 +1,226 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "RenderPasses/SVGFPass/SVGFAtrous.cs.slang";
+
+        // Not a multiple of the 16x16 tile size, so the partial tiles at the right and bottom are tested.
+        const int kWidth = 45;
+        const int kHeight = 37;
+        const float kPhiColor = 10.f;
+        const float kPhiNormal = 128.f;
+
+        struct Frame
+        {
+            std::vector<float4> illumination;
+            std::vector<float4> linearZAndNormal;   ///< Only the linear Z derivative in y is used.
+            std::vector<uint2> guide;               ///< Linear Z as fp32 bits and octahedral normal as 2x 16-bit snorm.
+        };
+
+        uint32_t packSnorm2x16(float2 v)
+        {
+            auto snorm = [](float x) { return (uint32_t)(int32_t)std::round(glm::clamp(x, -1.f, 1.f) * 32767.f) & 0xffff; };
+            return snorm(v.x) | (snorm(v.y) << 16);
+        }
+
+        float3 decodeNormal2x16(uint32_t packed)
+        {
+            float2 p(std::max((int16_t)(packed & 0xffff) / 32767.f, -1.f), std::max((int16_t)(packed >> 16) / 32767.f, -1.f));
+            float3 n(p.x, p.y, 1.f - std::abs(p.x) - std::abs(p.y));
+            if (n.z < 0.f)
+            {
+                float2 w = (1.f - glm::abs(float2(n.y, n.x))) * float2(n.x >= 0.f ? 1.f : -1.f, n.y >= 0.f ? 1.f : -1.f);
+                n.x = w.x;
+                n.y = w.y;
+            }
+            return glm::normalize(n);
+        }
+
+        Frame createFrame(uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+
+            Frame frame;
+            for (int i = 0; i < kWidth * kHeight; i++)
+            {
+                frame.illumination.push_back(float4(2.f * u(rng), 2.f * u(rng), 2.f * u(rng), 0.5f * u(rng)));
+
+                // A few background pixels with negative depth, which are not filtered.
+                float z = u(rng) < 0.05f ? -1.f : 1.f + 2.f * u(rng);
+                float dz = 0.01f + 0.04f * u(rng);
+                frame.linearZAndNormal.push_back(float4(z, dz, 0.f, 0.f));
+
+                // Normals around +z, so the octahedral map is not wrapped.
+                float2 oct = 0.3f * float2(u(rng) - 0.5f, u(rng) - 0.5f);
+                uint32_t zBits;
+                std::memcpy(&zBits, &z, sizeof(z));
+                frame.guide.push_back(uint2(zBits, packSnorm2x16(oct)));
+            }
+            return frame;
+        }
+
+        float luminance(float3 rgb) { return glm::dot(rgb, float3(0.2126f, 0.7152f, 0.0722f)); }
+
+        /** CPU reference of one a-trous iteration, as in SVGFAtrous.ps.slang.
+        */
+        std::vector<float4> filterReference(const Frame& frame, const std::vector<float4>& illumination, int stepSize)
+        {
+            const float kernelWeights[3] = { 1.f, 2.f / 3.f, 1.f / 6.f };
+            const float varianceKernel[2][2] = { { 1.f / 4.f, 1.f / 8.f }, { 1.f / 8.f, 1.f / 16.f } };
+
+            auto inside = [](int x, int y) { return x >= 0 && y >= 0 && x < kWidth && y < kHeight; };
+            auto getZ = [&](int i) { float z; std::memcpy(&z, &frame.guide[i].x, sizeof(z)); return z; };
+
+            std::vector<float4> result(illumination.size());
+            for (int y = 0; y < kHeight; y++)
+            {
+                for (int x = 0; x < kWidth; x++)
+                {
+                    const int center = y * kWidth + x;
+                    const float4 illuminationCenter = illumination[center];
+                    const float zCenter = getZ(center);
+                    if (zCenter < 0.f)
+                    {
+                        result[center] = illuminationCenter;
+                        continue;
+                    }
+                    const float3 nCenter = decodeNormal2x16(frame.guide[center].y);
+                    const float lCenter = luminance(float3(illuminationCenter));
+
+                    float var = 0.f;
+                    for (int yy = -1; yy <= 1; yy++)
+                    {
+                        for (int xx = -1; xx <= 1; xx++)
+                        {
+                            if (inside(x + xx, y + yy)) var += illumination[(y + yy) * kWidth + x + xx].a * varianceKernel[std::abs(xx)][std::abs(yy)];
+                        }
+                    }
+
+                    const float phiL = kPhiColor * std::sqrt(std::max(0.f, 1e-10f + var));
+                    const float phiDepth = std::max(frame.linearZAndNormal[center].y, 1e-8f) * stepSize;
+
+                    float sumW = 1.f;
+                    float4 sum = illuminationCenter;
+                    for (int yy = -2; yy <= 2; yy++)
+                    {
+                        for (int xx = -2; xx <= 2; xx++)
+                        {
+                            const int px = x + xx * stepSize, py = y + yy * stepSize;
+                            if (!inside(px, py) || (xx == 0 && yy == 0)) continue;
+
+                            const int p = py * kWidth + px;
+                            const float phiZ = phiDepth * std::sqrt(float(xx * xx + yy * yy));
+                            const float weightNormal = std::pow(glm::clamp(glm::dot(nCenter, decodeNormal2x16(frame.guide[p].y)), 0.f, 1.f), kPhiNormal);
+                            const float weightZ = phiZ == 0.f ? 0.f : std::abs(zCenter - getZ(p)) / phiZ;
+                            const float weightL = std::abs(lCenter - luminance(float3(illumination[p]))) / phiL;
+                            const float w = std::exp(-std::max(weightL, 0.f) - std::max(weightZ, 0.f)) * weightNormal * kernelWeights[std::abs(xx)] * kernelWeights[std::abs(yy)];
+
+                            sumW += w;
+                            sum += float4(w, w, w, w * w) * illumination[p];
+                        }
+                    }
+                    result[center] = sum / float4(sumW, sumW, sumW, sumW * sumW);
+                }
+            }
+            return result;
+        }
+
+        Texture::SharedPtr createOutput()
+        {
+            return Texture::create2D(kWidth, kHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+        }
+
+        void expectNear(GPUUnitTestContext& ctx, Texture* pTexture, const std::vector<float4>& expected, const char* name)
+        {
+            std::vector<uint8_t> data = ctx.getRenderContext()->readTextureSubresource(pTexture, 0);
+            const float4* result = reinterpret_cast<const float4*>(data.data());
+            for (int i = 0; i < kWidth * kHeight; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    // GPU exp/pow are approximate, so compare with a relative tolerance.
+                    const float tolerance = 1e-3f * std::max(1.f, std::abs(expected[i][c]));
+                    EXPECT_LE(std::abs(result[i][c] - expected[i][c]), tolerance) << name << " pixel=(" << i % kWidth << "," << i / kWidth << ") channel=" << c;
+                }
+            }
+        }
+    }
+
+    GPU_TEST(SVGFAtrousCompute)
+    {
+        RenderPassLibrary::instance().loadLibrary("SVGFPass.dll");
+        RenderContext* pRenderContext = ctx.getRenderContext();
+
+        const Frame frame = createFrame(1);
+        Texture::SharedPtr pIllumination = Texture::create2D(kWidth, kHeight, ResourceFormat::RGBA32Float, 1, 1, frame.illumination.data());
+        Texture::SharedPtr pLinearZAndNormal = Texture::create2D(kWidth, kHeight, ResourceFormat::RGBA32Float, 1, 1, frame.linearZAndNormal.data());
+        Texture::SharedPtr pGuide = Texture::create2D(kWidth, kHeight, ResourceFormat::RG32Uint, 1, 1, frame.guide.data());
+        Texture::SharedPtr pFeedback = createOutput();
+        Texture::SharedPtr pFused = createOutput();
+        Texture::SharedPtr pSingle = createOutput();
+
+        auto bind = [&](ComputePass::SharedPtr pPass, Texture::SharedPtr pInput, Texture::SharedPtr pOutput)
+        {
+            auto perImageCB = pPass["PerImageCB"];
+            perImageCB["gIllumination"] = pInput;
+            perImageCB["gLinearZAndNormal"] = pLinearZAndNormal;
+            perImageCB["gGuide"] = pGuide;
+            perImageCB["gOutput"] = pOutput;
+            perImageCB["gFeedback"] = pFeedback;
+            perImageCB["gScreenSize"] = int2(kWidth, kHeight);
+            perImageCB["gPhiColor"] = kPhiColor;
+            perImageCB["gPhiNormal"] = kPhiNormal;
+        };
+
+        // Iterations 0 and 1 fused, with the output of iteration 0 written to the feedback texture.
+        ComputePass::SharedPtr pFusedPass = ComputePass::create(kShaderFile, "atrousFused");
+        bind(pFusedPass, pIllumination, pFused);
+        pFusedPass["PerImageCB"]["gWriteFeedback"] = true;
+        pFusedPass->execute(pRenderContext, kWidth, kHeight);
+
+        // Iteration 2 on the fused output.
+        ComputePass::SharedPtr pSinglePass = ComputePass::create(kShaderFile, "atrousSingle");
+        bind(pSinglePass, pFused, pSingle);
+        pSinglePass["PerImageCB"]["gStepSize"] = 4;
+        pSinglePass->execute(pRenderContext, kWidth, kHeight);
+
+        std::vector<float4> expected1 = filterReference(frame, frame.illumination, 1);
+        std::vector<float4> expected2 = filterReference(frame, expected1, 2);
+        std::vector<float4> expected3 = filterReference(frame, expected2, 4);
+
+        expectNear(ctx, pFeedback.get(), expected1, "iteration 0");
+        expectNear(ctx, pFused.get(), expected2, "iteration 1");
+        expectNear(ctx, pSingle.get(), expected3, "iteration 2");
+    }
+}
@@ -0,0 +1,246 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneTypes.slang"
+#include "Scene/SceneBuilder.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        float3 randomDirection(std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> u(-1.f, 1.f);
+            while (true)
+            {
+                float3 d(u(rng), u(rng), u(rng));
+                float l = glm::length(d);
+                if (l > 1e-3f && l <= 1.f) return d / l;
+            }
+        }
+
+        // Create a bumpy grid facing +z. The large depth range makes the position quantization step clearly visible.
+        Scene::SharedPtr createCompactGridScene()
+        {
+            const uint32_t gridSize = 32;
+            std::mt19937 rng;
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+
+            std::vector<float3> positions;
+            std::vector<float3> normals;
+            std::vector<float2> texCrds;
+            for (uint32_t y = 0; y < gridSize; y++)
+            {
+                for (uint32_t x = 0; x < gridSize; x++)
+                {
+                    float2 uv = float2(x, y) / float(gridSize - 1);
+                    positions.push_back(float3(uv * 100.f - 50.f, -200.f * u(rng)));
+                    normals.push_back(float3(0.f, 0.f, 1.f));
+                    texCrds.push_back(uv);
+                }
+            }
+            std::vector<uint32_t> indices;
+            for (uint32_t y = 0; y + 1 < gridSize; y++)
+            {
+                for (uint32_t x = 0; x + 1 < gridSize; x++)
+                {
+                    uint32_t i = y * gridSize + x;
+                    for (uint32_t j : { i, i + 1, i + gridSize, i + 1, i + gridSize + 1, i + gridSize }) indices.push_back(j);
+                }
+            }
+
+            SceneBuilder::Mesh mesh;
+            mesh.name = "Grid";
+            mesh.vertexCount = (uint32_t)positions.size();
+            mesh.indexCount = (uint32_t)indices.size();
+            mesh.pIndices = indices.data();
+            mesh.pPositions = positions.data();
+            mesh.pNormals = normals.data();
+            mesh.pTexCrd = texCrds.data();
+            mesh.topology = Vao::Topology::TriangleList;
+            mesh.pMaterial = Material::create("Grid");
+
+            auto pBuilder = SceneBuilder::create(SceneBuilder::Flags::UseCompactVertices);
+            SceneBuilder::Node node;
+            node.name = "Root";
+            node.transform = glm::translate(float3(1.f, 2.f, -3.f));
+            pBuilder->addMeshInstance(pBuilder->addNode(node), pBuilder->addMesh(mesh));
+            return pBuilder->getScene();
+        }
+    }
+
+    CPU_TEST(CompactVertexSize)
+    {
+        EXPECT_EQ(sizeof(CompactVertexData), 16);
+        EXPECT_EQ(sizeof(PackedStaticVertexData), 32);
+    }
+
+    CPU_TEST(CompactVertexRoundTrip)
+    {
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        const float3 minPos(-12.5f, 0.f, 3.f);
+        const float3 maxPos(40.f, 2.5f, 3.25f);
+        const float3 offset = minPos;
+        const float3 scale = (maxPos - minPos) / 65535.f;
+
+        float maxPosError = 0.f;
+        float minNormalDot = 1.f;
+        float minBitangentDot = 1.f;
+        float maxTexCrdError = 0.f;
+
+        for (uint32_t i = 0; i < 10000; i++)
+        {
+            StaticVertexData v;
+            v.position = minPos + float3(u(rng), u(rng), u(rng)) * (maxPos - minPos);
+            v.normal = randomDirection(rng);
+            v.bitangent = randomDirection(rng);
+            v.texCrd = float2(u(rng) * 4.f - 2.f, u(rng));
+
+            CompactVertexData c;
+            c.pack(v, offset, scale);
+            StaticVertexData d = c.unpack(offset, scale);
+
+            for (int j = 0; j < 3; j++)
+            {
+                maxPosError = std::max(maxPosError, std::abs(d.position[j] - v.position[j]) / scale[j]);
+            }
+            minNormalDot = std::min(minNormalDot, glm::dot(d.normal, v.normal));
+            minBitangentDot = std::min(minBitangentDot, glm::dot(d.bitangent, v.bitangent));
+            maxTexCrdError = std::max(maxTexCrdError, std::max(std::abs(d.texCrd.x - v.texCrd.x), std::abs(d.texCrd.y - v.texCrd.y)));
+        }
+
+        // Positions are within half a quantization step (plus float rounding) of the input.
+        EXPECT_LE(maxPosError, 0.51f);
+        // 16-bit octahedral normals are accurate to roughly 0.01 degrees, 8-bit bitangents to roughly 1 degree.
+        EXPECT_GE(minNormalDot, 0.99999f);
+        EXPECT_GE(minBitangentDot, 0.999f);
+        // fp16 has 11 bits of mantissa, so the error in [-2,2] is at most 2^-10.
+        EXPECT_LE(maxTexCrdError, 1.f / 1024.f);
+    }
+
+    CPU_TEST(CompactVertexDegenerateBounds)
+    {
+        // A mesh that is flat along one axis has zero scale on that axis, which must decode to the offset.
+        const float3 offset(1.f, 2.f, 3.f);
+        const float3 scale(1.f / 65535.f, 0.f, 1.f / 65535.f);
+
+        StaticVertexData v;
+        v.position = float3(1.5f, 2.f, 4.f);
+        v.normal = float3(0.f, 1.f, 0.f);
+        v.bitangent = float3(0.f, 0.f, -1.f);
+        v.texCrd = float2(0.25f, 0.75f);
+
+        CompactVertexData c;
+        c.pack(v, offset, scale);
+        StaticVertexData d = c.unpack(offset, scale);
+
+        EXPECT_EQ(d.position.y, 2.f);
+        EXPECT_LE(std::abs(d.position.x - 1.5f), 1e-4f);
+        EXPECT_LE(std::abs(d.position.z - 4.f), 1e-4f);
+        EXPECT_GE(glm::dot(d.normal, v.normal), 0.99999f);
+        EXPECT_GE(glm::dot(d.bitangent, v.bitangent), 0.999f);
+        EXPECT_EQ(d.texCrd.x, 0.25f);
+        EXPECT_EQ(d.texCrd.y, 0.75f);
+    }
+
+    CPU_TEST(CompactVertexZeroNormal)
+    {
+        // Meshes without normals or tangents have zero vectors, which must not be encoded as NaN.
+        StaticVertexData v;
+        v.position = float3(0.f);
+        v.normal = float3(0.f);
+        v.bitangent = float3(0.f);
+        v.texCrd = float2(0.f);
+
+        CompactVertexData c;
+        c.pack(v, float3(0.f), float3(1.f / 65535.f));
+        StaticVertexData d = c.unpack(float3(0.f), float3(1.f / 65535.f));
+        for (int j = 0; j < 3; j++)
+        {
+            EXPECT(!std::isnan(d.normal[j]));
+            EXPECT(!std::isnan(d.bitangent[j]));
+        }
+
+        PackedStaticVertexData p(v);
+        StaticVertexData e = p.unpack();
+        for (int j = 0; j < 3; j++)
+        {
+            EXPECT_EQ(e.normal[j], 0.f);
+            EXPECT_EQ(e.bitangent[j], 0.f);
+        }
+    }
+
+    GPU_TEST(CompactVertexStaticMotion)
+    {
+        // A static mesh rendered from compact vertices must not produce motion, even though its positions are quantized.
+        const uint32_t width = 128, height = 128;
+        RenderContext* pRenderContext = ctx.getRenderContext();
+
+        Scene::SharedPtr pScene = createCompactGridScene();
+        EXPECT(pScene->getCompactVao() != nullptr);
+
+        auto pCamera = pScene->getCamera();
+        pCamera->setPosition(float3(0.f, 0.f, 150.f));
+        pCamera->setTarget(float3(0.f, 0.f, 0.f));
+        pCamera->setUpVector(float3(0.f, 1.f, 0.f));
+        pScene->setCameraAspectRatio(1.f);
+        // Update twice so the previous frame's transforms are valid.
+        pScene->update(pRenderContext, 0.0);
+        pScene->update(pRenderContext, 0.0);
+
+        auto pProgram = GraphicsProgram::createFromFile("Tests/Scene/CompactVertexTests.3d.slang", "vsMain", "psMain", pScene->getSceneDefines());
+        auto pVars = GraphicsVars::create(pProgram.get());
+        auto pState = GraphicsState::create();
+        pState->setProgram(pProgram);
+        RasterizerState::Desc rsDesc;
+        rsDesc.setCullMode(RasterizerState::CullMode::None);
+        pState->setRasterizerState(RasterizerState::create(rsDesc));
+
+        // Pixels that are not covered keep the sentinel value.
+        const float kSentinel = 1e30f;
+        auto pFbo = Fbo::create2D(width, height, ResourceFormat::RG32Float, ResourceFormat::D32Float);
+        pRenderContext->clearFbo(pFbo.get(), float4(kSentinel), 1.f, 0, FboAttachmentType::All);
+        pState->setFbo(pFbo);
+        pScene->render(pRenderContext, pState.get(), pVars.get(), Scene::RenderFlags::UserRasterizerState);
+
+        std::vector<uint8_t> data = pRenderContext->readTextureSubresource(pFbo->getColorTexture(0).get(), 0);
+        const float2* pMotion = reinterpret_cast<const float2*>(data.data());
+        uint32_t coveredCount = 0;
+        for (uint32_t i = 0; i < width * height; i++)
+        {
+            if (pMotion[i].x == kSentinel) continue;
+            coveredCount++;
+            EXPECT_LE(std::abs(pMotion[i].x), 1e-6f) << "pixel " << i;
+            EXPECT_LE(std::abs(pMotion[i].y), 1e-6f) << "pixel " << i;
+        }
+        EXPECT_GT(coveredCount, 0u);
+    }
+}
@@ -0,0 +1,161 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Culling/HiZReference.h"
+#include "Scene/Culling/HoleTilesData.slang"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kWidth = 150;
+        const uint32_t kHeight = 70;
+
+        uint2 getTileDim() { return (uint2(kWidth, kHeight) + kHoleTileSize - 1u) / kHoleTileSize; }
+
+        /** Count the holes per tile, like HoleTilesClassify.cs.slang.
+        */
+        std::vector<float> classify(const std::vector<bool>& holes)
+        {
+            const uint2 tileDim = getTileDim();
+            std::vector<float> counts(tileDim.x * tileDim.y, 0.f);
+            for (uint32_t y = 0; y < kHeight; y++)
+            {
+                for (uint32_t x = 0; x < kWidth; x++)
+                {
+                    if (holes[y * kWidth + x]) counts[(y / kHoleTileSize) * tileDim.x + x / kHoleTileSize] += 1.f;
+                }
+            }
+            return counts;
+        }
+
+        std::vector<bool> createHoleMask(uint32_t seed)
+        {
+            // A few rectangular disocclusions.
+            std::vector<bool> holes(kWidth * kHeight, false);
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<uint32_t> size(0, 7);
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                uint32_t x0 = std::uniform_int_distribution<uint32_t>(0, kWidth - 1)(rng);
+                uint32_t y0 = std::uniform_int_distribution<uint32_t>(0, kHeight - 1)(rng);
+                uint32_t x1 = std::min(x0 + size(rng), kWidth - 1), y1 = std::min(y0 + size(rng), kHeight - 1);
+                for (uint32_t y = y0; y <= y1; y++)
+                {
+                    for (uint32_t x = x0; x <= x1; x++) holes[y * kWidth + x] = true;
+                }
+            }
+            return holes;
+        }
+    }
+
+    CPU_TEST(HoleTilesClassify)
+    {
+        std::vector<bool> holes(kWidth * kHeight, false);
+        holes[0] = true;
+        holes[20 * kWidth + 17] = true;
+        holes[20 * kWidth + 18] = true;
+        holes[(kHeight - 1) * kWidth + kWidth - 1] = true;
+
+        const uint2 tileDim = getTileDim();
+        EXPECT(tileDim == uint2(10, 5));
+
+        std::vector<float> counts = classify(holes);
+        EXPECT_EQ(counts[0], 1.f);
+        EXPECT_EQ(counts[1 * tileDim.x + 1], 2.f);
+        EXPECT_EQ(counts[(tileDim.y - 1) * tileDim.x + tileDim.x - 1], 1.f);
+        EXPECT_EQ(std::count_if(counts.begin(), counts.end(), [](float c) { return c > 0.f; }), 3);
+    }
+
+    CPU_TEST(HoleTilesOverlap)
+    {
+        // The tile lookup must never miss a hole tile inside the rectangle, and single tiles must be exact.
+        const uint2 tileDim = getTileDim();
+        std::mt19937 rng;
+        std::uniform_int_distribution<uint32_t> size(0, 3);
+        for (uint32_t seed = 0; seed < 8; seed++)
+        {
+            std::vector<float> counts = classify(createHoleMask(seed));
+            HiZReference tiles(counts, tileDim.x, tileDim.y);
+
+            for (uint32_t i = 0; i < 200; i++)
+            {
+                int2 tileMin(std::uniform_int_distribution<uint32_t>(0, tileDim.x - 1)(rng), std::uniform_int_distribution<uint32_t>(0, tileDim.y - 1)(rng));
+                int2 tileMax = glm::min(tileMin + int2(size(rng), size(rng)), int2(tileDim) - 1);
+
+                bool expected = false;
+                for (int y = tileMin.y; y <= tileMax.y; y++)
+                {
+                    for (int x = tileMin.x; x <= tileMax.x; x++) expected |= counts[y * tileDim.x + x] > 0.f;
+                }
+
+                bool overlaps = tiles.getMaxInRect(tileMin, tileMax) > 0.f;
+                if (expected) EXPECT(overlaps) << "seed=" << seed << " rect=(" << tileMin.x << "," << tileMin.y << ")-(" << tileMax.x << "," << tileMax.y << ")";
+                if (tileMin == tileMax) EXPECT_EQ(overlaps, expected) << "seed=" << seed << " tile=(" << tileMin.x << "," << tileMin.y << ")";
+            }
+        }
+    }
+
+    CPU_TEST(HoleTilesDrawSelection)
+    {
+        // Camera at the origin looking down -z.
+        glm::mat4 proj = glm::perspective(glm::radians(60.f), float(kWidth) / kHeight, 0.1f, 100.f);
+        glm::mat4 view = glm::lookAt(float3(0.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f));
+        const glm::mat4 viewProj = proj * view;
+
+        // A single hole in the center of the screen.
+        std::vector<bool> holes(kWidth * kHeight, false);
+        holes[(kHeight / 2) * kWidth + kWidth / 2] = true;
+        const uint2 tileDim = getTileDim();
+        HiZReference tiles(classify(holes), tileDim.x, tileDim.y);
+
+        // Mirrors HoleTilesCull.cs.slang.
+        auto overlapsHoles = [&](float3 center, float3 extent)
+        {
+            BoundingBox box;
+            box.center = center;
+            box.extent = extent;
+            if (!HiZReference::isInFrustum(box, viewProj)) return false;
+
+            int2 pixelMin, pixelMax;
+            float minZ;
+            if (!HiZReference::getScreenRect(box, viewProj, uint2(kWidth, kHeight), pixelMin, pixelMax, minZ)) return true;
+            return tiles.getMaxInRect(pixelMin / int(kHoleTileSize), pixelMax / int(kHoleTileSize)) > 0.f;
+        };
+
+        EXPECT(overlapsHoles(float3(0, 0, -10), float3(0.1f)));
+        EXPECT(overlapsHoles(float3(0, 0, -50), float3(20.f)));
+        EXPECT(!overlapsHoles(float3(-4, 2, -10), float3(0.1f)));
+        EXPECT(!overlapsHoles(float3(4, -2, -10), float3(0.1f)));
+        EXPECT(!overlapsHoles(float3(0, 0, 10), float3(1.f)));
+
+        // Boxes crossing the near plane are always kept.
+        EXPECT(overlapsHoles(float3(0.2f, -0.1f, 0), float3(0.5f)));
+    }
+}
@@ -0,0 +1,199 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Experimental/Scene/Lights/LightBVHBuilder.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kTriangleCount = 1000;
+        const uint32_t kParallelBuildTriangleCount = 50000; // Large enough for the builder to bin triangles and build subtrees in parallel.
+
+        struct NodeBounds
+        {
+            uint32_t byteOffset;
+            float3 aabbMin;
+            float3 aabbMax;
+            float3 coneDirection;
+            float cosConeAngle;
+        };
+
+        // Create a scene with randomly placed and oriented emissive triangles.
+        Scene::SharedPtr createEmissiveScene(uint32_t triangleCount)
+        {
+            std::mt19937 rng;
+            std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+            std::vector<float3> positions(3 * triangleCount);
+            std::vector<float3> normals(3 * triangleCount);
+            std::vector<float2> texCrds(3 * triangleCount, float2(0.f));
+            std::vector<uint32_t> indices(3 * triangleCount);
+            for (uint32_t i = 0; i < triangleCount; i++)
+            {
+                const float3 center(dist(rng), dist(rng), dist(rng));
+                for (uint32_t j = 0; j < 3; j++) positions[3 * i + j] = center + 0.1f * float3(dist(rng), dist(rng), dist(rng));
+                const float3 n = glm::normalize(glm::cross(positions[3 * i + 1] - positions[3 * i], positions[3 * i + 2] - positions[3 * i]));
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    normals[3 * i + j] = n;
+                    indices[3 * i + j] = 3 * i + j;
+                }
+            }
+
+            auto pMaterial = Material::create("Emissive");
+            pMaterial->setEmissiveColor(float3(1.f));
+
+            SceneBuilder::Mesh mesh;
+            mesh.name = "Triangles";
+            mesh.vertexCount = (uint32_t)positions.size();
+            mesh.indexCount = (uint32_t)indices.size();
+            mesh.pIndices = indices.data();
+            mesh.pPositions = positions.data();
+            mesh.pNormals = normals.data();
+            mesh.pTexCrd = texCrds.data();
+            mesh.topology = Vao::Topology::TriangleList;
+            mesh.pMaterial = pMaterial;
+
+            auto pBuilder = SceneBuilder::create();
+            SceneBuilder::Node node;
+            node.name = "Root";
+            node.transform = glm::mat4(1.f);
+            pBuilder->addMeshInstance(pBuilder->addNode(node), pBuilder->addMesh(mesh));
+            return pBuilder->getScene();
+        }
+
+        std::vector<NodeBounds> getNodeBounds(LightBVH& bvh)
+        {
+            std::vector<NodeBounds> nodes;
+            bvh.traverseBVH([&nodes](const LightBVH::NodeLocation& location, const LightBVH::InternalNode* pInternalNode, const LightBVH::LeafNode* pLeafNode)
+            {
+                if (pInternalNode) nodes.push_back({ location.byteOffset, pInternalNode->aabbMin, pInternalNode->aabbMax, pInternalNode->coneDirection, pInternalNode->cosConeAngle });
+                else nodes.push_back({ location.byteOffset, pLeafNode->aabbMin, pLeafNode->aabbMax, pLeafNode->coneDirection, pLeafNode->cosConeAngle });
+                return true;
+            });
+            return nodes;
+        }
+    }
+
+    GPU_TEST(LightBVHRefitCPUMatchesGPU)
+    {
+        Scene::SharedPtr pScene = createEmissiveScene(kTriangleCount);
+        EXPECT(pScene != nullptr);
+        if (!pScene) return;
+
+        auto pLightCollection = pScene->getLightCollection(ctx.getRenderContext());
+        EXPECT_EQ(pLightCollection->getTotalLightCount(), kTriangleCount);
+
+        // Build two identical BVHs and refit one on the GPU and the other on the CPU.
+        auto pBuilder = LightBVHBuilder::create(LightBVHBuilder::Options());
+        auto pGPUBVH = LightBVH::create(pLightCollection);
+        auto pCPUBVH = LightBVH::create(pLightCollection);
+        pBuilder->build(*pGPUBVH);
+        pBuilder->build(*pCPUBVH);
+
+        pGPUBVH->refit(ctx.getRenderContext());
+        pCPUBVH->refitCPU({ { 0, pLightCollection->getTotalLightCount() } });
+
+        const auto gpuNodes = getNodeBounds(*pGPUBVH);
+        const auto cpuNodes = getNodeBounds(*pCPUBVH);
+        EXPECT_EQ(gpuNodes.size(), cpuNodes.size());
+        if (gpuNodes.size() != cpuNodes.size()) return;
+
+        // The bounding boxes are computed with min/max only and must match exactly.
+        // The cones involve a few arithmetic operations whose rounding may differ between the CPU and the GPU.
+        for (size_t i = 0; i < gpuNodes.size(); i++)
+        {
+            const auto& g = gpuNodes[i];
+            const auto& c = cpuNodes[i];
+            EXPECT_EQ(g.byteOffset, c.byteOffset);
+            for (int k = 0; k < 3; k++)
+            {
+                EXPECT_EQ(g.aabbMin[k], c.aabbMin[k]) << "node " << i;
+                EXPECT_EQ(g.aabbMax[k], c.aabbMax[k]) << "node " << i;
+                EXPECT_LE(std::abs(g.coneDirection[k] - c.coneDirection[k]), 1e-5f) << "node " << i;
+            }
+            EXPECT_LE(std::abs(g.cosConeAngle - c.cosConeAngle), 1e-5f) << "node " << i;
+        }
+
+        // Check that the leaves were actually refit by comparing against the triangle bounds.
+        const auto& triangles = pLightCollection->getMeshLightTriangles();
+        pCPUBVH->traverseBVH([&](const LightBVH::NodeLocation& location, const LightBVH::InternalNode* pInternalNode, const LightBVH::LeafNode* pLeafNode)
+        {
+            if (!pLeafNode) return true;
+            BBox bounds;
+            for (uint32_t i = 0; i < pLeafNode->triangleCount; i++)
+            {
+                for (uint32_t j = 0; j < 3; j++) bounds |= triangles[pLeafNode->triangleIndices[i]].vtx[j].pos;
+            }
+            for (int k = 0; k < 3; k++)
+            {
+                EXPECT_EQ(pLeafNode->aabbMin[k], bounds.minPoint[k]);
+                EXPECT_EQ(pLeafNode->aabbMax[k], bounds.maxPoint[k]);
+            }
+            return true;
+        });
+    }
+
+    GPU_TEST(LightBVHParallelBuildMatchesSerial)
+    {
+        Scene::SharedPtr pScene = createEmissiveScene(kParallelBuildTriangleCount);
+        EXPECT(pScene != nullptr);
+        if (!pScene) return;
+
+        auto pLightCollection = pScene->getLightCollection(ctx.getRenderContext());
+
+        LightBVHBuilder::Options options;
+        options.useParallelBuild = false;
+        auto pSerialBVH = LightBVH::create(pLightCollection);
+        LightBVHBuilder::create(options)->build(*pSerialBVH);
+
+        options.useParallelBuild = true;
+        auto pParallelBVH = LightBVH::create(pLightCollection);
+        LightBVHBuilder::create(options)->build(*pParallelBVH);
+
+        EXPECT_EQ(pSerialBVH->getStats().byteSize, pParallelBVH->getStats().byteSize);
+        EXPECT_EQ(pSerialBVH->getStats().internalNodeCount, pParallelBVH->getStats().internalNodeCount);
+        EXPECT_EQ(pSerialBVH->getStats().leafNodeCount, pParallelBVH->getStats().leafNodeCount);
+        EXPECT(pSerialBVH->getTriangleBitmasks() == pParallelBVH->getTriangleBitmasks());
+
+        // Both builds must produce the same nodes at the same byte offsets.
+        uint32_t mismatchCount = 0;
+        pSerialBVH->traverseBVH([&](const LightBVH::NodeLocation& location, const LightBVH::InternalNode* pInternalNode, const LightBVH::LeafNode* pLeafNode)
+        {
+            const void* pSerialNode = pInternalNode ? (const void*)pInternalNode : (const void*)pLeafNode;
+            const void* pParallelNode = pInternalNode ? (const void*)pParallelBVH->getInternalNode(location.byteOffset) : (const void*)pParallelBVH->getLeafNode(location.byteOffset);
+            const size_t nodeSize = pInternalNode ? sizeof(LightBVH::InternalNode) : sizeof(LightBVH::LeafNode) + (pLeafNode->triangleCount - 1) * sizeof(uint32_t);
+            if (!pParallelNode || std::memcmp(pSerialNode, pParallelNode, nodeSize) != 0) mismatchCount++;
+            return true;
+        });
+        EXPECT_EQ(mismatchCount, 0);
+    }
+}
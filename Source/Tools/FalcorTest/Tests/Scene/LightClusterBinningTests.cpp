@@ -0,0 +1,257 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Lights/LightClusterBinning.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint2 kScreenDim = uint2(1280, 720);
+        const float kNearZ = 0.1f;
+        const float kFarZ = 100.f;
+        const uint32_t kLightCount = 300;
+
+        float4x4 createView(float3 eye)
+        {
+            return glm::lookAt(eye, eye + float3(0.2f, -0.1f, -1.f), float3(0.f, 1.f, 0.f));
+        }
+
+        LightData createPointLight(float3 posW, float intensity)
+        {
+            LightData light;
+            light.type = (uint32_t)LightType::Point;
+            light.posW = posW;
+            light.intensity = float3(intensity);
+            return light;
+        }
+
+        /** Create point and spot lights scattered in front of the camera, with ranges of 1 to 10 at the default cut-off.
+        */
+        std::vector<LightData> createLights(uint32_t count)
+        {
+            std::mt19937 r;
+            std::uniform_real_distribution<float> u;
+            std::vector<LightData> lights(count);
+            for (auto& light : lights)
+            {
+                light = createPointLight(float3(40.f * u(r) - 20.f, 20.f * u(r) - 10.f, 5.f - 105.f * u(r)), 0.01f + 0.99f * u(r));
+                if (u(r) < 0.3f)
+                {
+                    light.openingAngle = 0.1f + 1.4f * u(r);
+                    light.cosOpeningAngle = std::cos(light.openingAngle);
+                    light.dirW = glm::normalize(float3(u(r), u(r), u(r)) * 2.f - float3(1.f));
+                }
+            }
+            return lights;
+        }
+
+        bool clusterHasLight(const LightClusterBinning& binning, uint3 cluster, uint32_t lightIndex)
+        {
+            const uint2 range = binning.getClusterRanges()[getLightClusterIndex(cluster, binning.getGrid())];
+            const auto& indices = binning.getLightIndices();
+            return std::find(indices.begin() + range.x, indices.begin() + range.x + range.y, lightIndex) != indices.begin() + range.x + range.y;
+        }
+
+        /** Check that every visible point inside a light's bounding sphere falls into a cluster listing the light.
+            The cluster of a point is looked up the same way as in the shader.
+        */
+        void testCoverage(CPUUnitTestContext& ctx, const float4x4& viewMat, const float4x4& projMat)
+        {
+            const auto lights = createLights(kLightCount);
+            LightClusterBinning binning;
+            binning.setView(viewMat, projMat, kScreenDim, 1.f, kFarZ);
+            binning.bin(lights);
+            const LightClusterGrid& grid = binning.getGrid();
+
+            std::mt19937 r;
+            std::uniform_real_distribution<float> u;
+            uint32_t testedCount = 0;
+            for (uint32_t i = 0; i < kLightCount; i++)
+            {
+                float3 centerW;
+                float radius;
+                EXPECT(LightClusterBinning::getLightBoundingSphere(lights[i], LightClusterBinning::kDefaultMinIntensity, centerW, radius));
+
+                for (uint32_t j = 0; j < 64; j++)
+                {
+                    float3 d = float3(u(r), u(r), u(r)) * 2.f - float3(1.f);
+                    if (glm::dot(d, d) > 1.f) continue;
+                    const float3 posW = centerW + d * (0.999f * radius);
+
+                    const float depth = -(viewMat * float4(posW, 1.f)).z;
+                    const float4 clip = projMat * viewMat * float4(posW, 1.f);
+                    const float2 ndc = float2(clip.x, clip.y) / clip.w;
+                    if (depth <= kNearZ || depth >= kFarZ || std::abs(ndc.x) >= 1.f || std::abs(ndc.y) >= 1.f) continue;
+
+                    const float2 pixel = float2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f) * float2(kScreenDim);
+                    const uint3 cluster = getLightCluster(pixel, getLightClusterViewDepth(posW, grid), grid);
+                    EXPECT(clusterHasLight(binning, cluster, i)) << "light " << i << ", cluster (" << cluster.x << ", " << cluster.y << ", " << cluster.z << ")";
+                    testedCount++;
+                }
+            }
+            EXPECT_GE(testedCount, 1000u);
+        }
+    }
+
+    CPU_TEST(LightClusterBinningCoverage)
+    {
+        testCoverage(ctx, createView(float3(0.f)), glm::perspective(glm::radians(60.f), float(kScreenDim.x) / kScreenDim.y, kNearZ, kFarZ));
+    }
+
+    CPU_TEST(LightClusterBinningCoverageOffCenter)
+    {
+        // Off-center projection of the right eye of a stereo camera.
+        const float t = kNearZ * std::tan(glm::radians(30.f));
+        const float aspect = float(kScreenDim.x) / kScreenDim.y;
+        testCoverage(ctx, createView(float3(0.065f, 0.f, 0.f)), glm::frustum(-1.2f * t * aspect, 0.8f * t * aspect, -t, t, kNearZ, kFarZ));
+    }
+
+    CPU_TEST(LightClusterBinningLists)
+    {
+        const auto lights = createLights(kLightCount);
+        const float4x4 viewMat = createView(float3(0.f));
+        LightClusterBinning binning(uint3(8, 6, 12));
+        binning.setView(viewMat, glm::perspective(glm::radians(60.f), 4.f / 3.f, kNearZ, kFarZ), uint2(640, 480), 1.f, kFarZ);
+        binning.bin(lights);
+
+        const auto& ranges = binning.getClusterRanges();
+        const auto& indices = binning.getLightIndices();
+        EXPECT_EQ(binning.getGrid().globalLightCount, 0u);
+        EXPECT_EQ(ranges.size(), (size_t)8 * 6 * 12);
+        EXPECT(!indices.empty());
+
+        // The lists are compact and the lights of each cluster overlap its bounds.
+        uint32_t offset = 0;
+        for (uint32_t z = 0; z < 12; z++)
+        {
+            for (uint32_t y = 0; y < 6; y++)
+            {
+                for (uint32_t x = 0; x < 8; x++)
+                {
+                    const uint3 cluster(x, y, z);
+                    const uint2 range = ranges[getLightClusterIndex(cluster, binning.getGrid())];
+                    EXPECT_EQ(range.x, offset);
+                    offset += range.y;
+
+                    const BoundingBox& bounds = binning.getClusterBounds(cluster);
+                    for (uint32_t i = range.x; i < range.x + range.y; i++)
+                    {
+                        if (i > range.x) EXPECT_LT(indices[i - 1], indices[i]);
+
+                        float3 centerW;
+                        float radius;
+                        LightClusterBinning::getLightBoundingSphere(lights[indices[i]], LightClusterBinning::kDefaultMinIntensity, centerW, radius);
+                        const float3 centerV = float3(viewMat * float4(centerW, 1.f));
+                        const float3 d = centerV - glm::clamp(centerV, bounds.getMinPos(), bounds.getMaxPos());
+                        EXPECT_LE(glm::dot(d, d), radius * radius * 1.0001f) << "light " << indices[i];
+                    }
+                }
+            }
+        }
+        EXPECT_EQ(offset, (uint32_t)indices.size());
+    }
+
+    CPU_TEST(LightClusterBinningGlobalLights)
+    {
+        std::vector<LightData> lights(4);
+        lights[0] = createPointLight(float3(0.f, 0.f, -10.f), 1.f);
+        lights[1].type = (uint32_t)LightType::Directional;
+        lights[2] = createPointLight(float3(0.f, 0.f, -10.f), 0.f);
+        lights[3].type = (uint32_t)LightType::Rect;
+
+        LightClusterBinning binning;
+        binning.setView(createView(float3(0.f)), glm::perspective(glm::radians(60.f), 16.f / 9.f, kNearZ, kFarZ), kScreenDim, 1.f, kFarZ);
+        binning.bin(lights);
+
+        // Lights without a finite range come first. Lights without intensity are culled.
+        const auto& indices = binning.getLightIndices();
+        EXPECT_EQ(binning.getGrid().globalLightCount, 2u);
+        EXPECT_EQ(indices[0], 1u);
+        EXPECT_EQ(indices[1], 3u);
+        EXPECT(std::count(indices.begin(), indices.end(), 0u) > 0);
+        EXPECT_EQ(std::count(indices.begin(), indices.end(), 2u), 0);
+
+        // Without a cut-off, all lights are global.
+        binning.bin(lights, 0.f);
+        EXPECT_EQ(binning.getGrid().globalLightCount, 4u);
+        EXPECT_EQ(binning.getLightIndices().size(), (size_t)4);
+    }
+
+    CPU_TEST(LightClusterBinningSpotLightBounds)
+    {
+        std::mt19937 r;
+        std::uniform_real_distribution<float> u;
+        const float angles[] = { 0.1f, 0.5f, 0.78f, 0.8f, 1.2f, 1.55f, float(M_PI) };
+        for (float angle : angles)
+        {
+            LightData light = createPointLight(float3(1.f, 2.f, 3.f), 1.f);
+            light.openingAngle = angle;
+            light.cosOpeningAngle = std::cos(angle);
+            light.dirW = glm::normalize(float3(1.f, -1.f, 0.5f));
+
+            float3 centerW;
+            float radius;
+            EXPECT(LightClusterBinning::getLightBoundingSphere(light, 0.01f, centerW, radius));
+            const float range = 10.f;
+            EXPECT_LE(radius, range * 1.0001f) << "angle " << angle;
+
+            // Points inside the cone and the range are inside the sphere.
+            const float3 t = glm::normalize(float3(light.dirW.y, -light.dirW.x, 0.f));
+            const float3 b = float3(light.dirW.y * t.z - light.dirW.z * t.y, light.dirW.z * t.x - light.dirW.x * t.z, light.dirW.x * t.y - light.dirW.y * t.x);
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                const float theta = angle * (i < 16 ? 1.f : u(r));
+                const float phi = 2.f * float(M_PI) * u(r);
+                const float dist = range * (i < 32 ? 1.f : u(r));
+                const float3 dir = light.dirW * std::cos(theta) + (t * std::cos(phi) + b * std::sin(phi)) * std::sin(theta);
+                const float3 d = light.posW + dir * dist - centerW;
+                EXPECT_LE(glm::length(d), radius * 1.0001f) << "angle " << angle << ", theta " << theta << ", distance " << dist;
+            }
+        }
+    }
+
+    CPU_TEST(LightClusterBinningViewChange)
+    {
+        // Moving the camera reuses the cluster bounds and gives the same result as binning from scratch.
+        const auto lights = createLights(kLightCount);
+        const float4x4 projMat = glm::perspective(glm::radians(60.f), 16.f / 9.f, kNearZ, kFarZ);
+        LightClusterBinning binning;
+        binning.setView(createView(float3(0.f)), projMat, kScreenDim, 1.f, kFarZ);
+        binning.bin(lights);
+        binning.setView(createView(float3(2.f, 1.f, -5.f)), projMat, kScreenDim, 1.f, kFarZ);
+        binning.bin(lights);
+
+        LightClusterBinning reference;
+        reference.setView(createView(float3(2.f, 1.f, -5.f)), projMat, kScreenDim, 1.f, kFarZ);
+        reference.bin(lights);
+        EXPECT(binning.getClusterRanges() == reference.getClusterRanges());
+        EXPECT(binning.getLightIndices() == reference.getLightIndices());
+    }
+}
@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshOptimizer.h"
+#include <array>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Create a planar grid of n x n quads with the triangles in random order.
+        void createShuffledGrid(uint32_t n, std::vector<float3>& positions, std::vector<uint32_t>& indices)
+        {
+            positions.clear();
+            for (uint32_t y = 0; y <= n; y++)
+            {
+                for (uint32_t x = 0; x <= n; x++) positions.push_back(float3(x, y, 0));
+            }
+
+            std::vector<uint3> triangles;
+            for (uint32_t y = 0; y < n; y++)
+            {
+                for (uint32_t x = 0; x < n; x++)
+                {
+                    uint32_t i = y * (n + 1) + x;
+                    triangles.push_back(uint3(i, i + 1, i + n + 2));
+                    triangles.push_back(uint3(i, i + n + 2, i + n + 1));
+                }
+            }
+
+            std::mt19937 r;
+            std::shuffle(triangles.begin(), triangles.end(), r);
+            indices.clear();
+            for (const auto& t : triangles) indices.insert(indices.end(), { t.x, t.y, t.z });
+        }
+
+        std::vector<std::array<float3, 3>> getSortedTriangles(const std::vector<float3>& positions, const std::vector<uint32_t>& indices)
+        {
+            auto less = [](const float3& a, const float3& b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+            std::vector<std::array<float3, 3>> triangles;
+            for (size_t i = 0; i < indices.size(); i += 3) triangles.push_back({ positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]] });
+            std::sort(triangles.begin(), triangles.end(), [&less](const auto& a, const auto& b)
+            {
+                return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), less);
+            });
+            return triangles;
+        }
+    }
+
+    CPU_TEST(MeshOptimizerStats)
+    {
+        // Two triangles sharing an edge: 4 transformed vertices.
+        const uint32_t indices[] = { 0, 1, 2, 2, 1, 3 };
+        auto stats = MeshOptimizer::computeStats(indices, 6, 4);
+        EXPECT_EQ(stats.transformedVertexCount, 4);
+        EXPECT_EQ(stats.getACMR(), 2.f);
+        EXPECT_EQ(stats.getATVR(), 1.f);
+
+        // With a cache of 3 entries, vertex 0 is evicted before it's used again.
+        const uint32_t indices2[] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+        stats = MeshOptimizer::computeStats(indices2, 9, 6, 3);
+        EXPECT_EQ(stats.transformedVertexCount, 9);
+        stats = MeshOptimizer::computeStats(indices2, 9, 6, 6);
+        EXPECT_EQ(stats.transformedVertexCount, 6);
+    }
+
+    CPU_TEST(MeshOptimizerVertexCache)
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createShuffledGrid(64, positions, indices);
+        const uint32_t vertexCount = (uint32_t)positions.size();
+        const auto referenceTriangles = getSortedTriangles(positions, indices);
+
+        auto before = MeshOptimizer::computeStats(indices.data(), indices.size(), vertexCount);
+        MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+        auto after = MeshOptimizer::computeStats(indices.data(), indices.size(), vertexCount);
+
+        // A regular grid has ~2 triangles per vertex, so the ideal ACMR is ~0.5.
+        EXPECT_GT(before.getACMR(), 2.5f);
+        EXPECT_LT(after.getACMR(), 0.8f);
+        EXPECT_LT(after.getATVR(), 1.6f);
+
+        // Vertex fetch optimization must not change the stats and must number vertices in order of first use.
+        std::vector<uint32_t> remap;
+        uint32_t referencedCount = MeshOptimizer::optimizeVertexFetch(indices.data(), indices.size(), vertexCount, remap);
+        EXPECT_EQ(referencedCount, vertexCount);
+        MeshOptimizer::remapIndices(indices.data(), indices.size(), remap);
+        positions = MeshOptimizer::remapVertices(positions, remap, referencedCount);
+        EXPECT_EQ(MeshOptimizer::computeStats(indices.data(), indices.size(), vertexCount).transformedVertexCount, after.transformedVertexCount);
+
+        uint32_t maxIndex = 0;
+        bool inOrder = true;
+        for (uint32_t i : indices)
+        {
+            inOrder = inOrder && i <= maxIndex + 1;
+            maxIndex = std::max(maxIndex, i);
+        }
+        EXPECT(inOrder);
+
+        // The optimized mesh must contain the same triangles with the same winding.
+        EXPECT(getSortedTriangles(positions, indices) == referenceTriangles);
+    }
+
+    CPU_TEST(MeshOptimizerWeld)
+    {
+        // Unindexed grid with three vertices per triangle.
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createShuffledGrid(16, positions, indices);
+
+        std::vector<float3> unindexed;
+        for (uint32_t i : indices) unindexed.push_back(positions[i]);
+
+        std::vector<uint32_t> remap;
+        uint32_t weldedCount = MeshOptimizer::weldVertices(unindexed.data(), (uint32_t)unindexed.size(), sizeof(float3), remap);
+        EXPECT_EQ(weldedCount, positions.size());
+
+        auto welded = MeshOptimizer::remapVertices(unindexed, remap, weldedCount);
+        for (size_t i = 0; i < unindexed.size(); i++)
+        {
+            EXPECT(welded[remap[i]] == unindexed[i]) << "i = " << i;
+        }
+    }
+
+    CPU_TEST(MeshOptimizerMeshlets)
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+        createShuffledGrid(64, positions, indices);
+        MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), (uint32_t)positions.size());
+
+        const uint32_t maxVertices = 64;
+        const uint32_t maxTriangles = 124;
+        auto meshlets = MeshOptimizer::buildMeshlets(indices.data(), indices.size(), positions.data(), maxVertices, maxTriangles);
+        EXPECT_GT(meshlets.size(), 0);
+
+        uint32_t indexOffset = 0;
+        for (const auto& m : meshlets)
+        {
+            // Meshlets cover the index buffer contiguously and respect the limits.
+            EXPECT_EQ(m.indexOffset, indexOffset);
+            EXPECT_LE(m.vertexCount, maxVertices);
+            EXPECT_LE(m.triangleCount, maxTriangles);
+            indexOffset += m.triangleCount * 3;
+
+            // The bounding sphere contains all vertices.
+            for (uint32_t i = 0; i < m.triangleCount * 3; i++)
+            {
+                EXPECT_LE(length(positions[indices[m.indexOffset + i]] - m.center), m.radius * 1.0001f);
+            }
+
+            // All triangles of the grid face +z, so the cone is tight around the z-axis.
+            EXPECT_EQ(m.coneAxis.z, 1.f);
+            EXPECT_LT(m.coneCutoff, 1e-3f);
+        }
+        EXPECT_EQ(indexOffset, indices.size());
+    }
+}
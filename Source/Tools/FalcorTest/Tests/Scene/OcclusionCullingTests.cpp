@@ -0,0 +1,176 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Culling/HiZReference.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kWidth = 160;
+        const uint32_t kHeight = 90;
+
+        // Camera at the origin looking down -z.
+        glm::mat4 getViewProj()
+        {
+            glm::mat4 proj = glm::perspective(glm::radians(60.f), float(kWidth) / kHeight, 0.1f, 100.f);
+            glm::mat4 view = glm::lookAt(float3(0.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f));
+            return proj * view;
+        }
+
+        float getDepth(const glm::mat4& viewProj, float distance)
+        {
+            float4 p = viewProj * float4(0.f, 0.f, -distance, 1.f);
+            return p.z / p.w;
+        }
+    }
+
+    CPU_TEST(HiZPyramid)
+    {
+        // Use an odd size to exercise the padding to a power of two.
+        const uint32_t width = 13, height = 5;
+        std::vector<float> depth(width * height);
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+        for (auto& d : depth) d = dist(rng);
+
+        HiZReference hiZ(depth, width, height);
+        EXPECT_EQ(hiZ.getMipCount(), 5u);
+        EXPECT(hiZ.getMipDim(0) == uint2(16, 8));
+        EXPECT(hiZ.getMipDim(4) == uint2(1, 1));
+
+        // Each texel holds the max depth of the pixels it covers, or zero if it only covers padding.
+        for (uint32_t level = 0; level < hiZ.getMipCount(); level++)
+        {
+            uint2 dim = hiZ.getMipDim(level);
+            for (uint32_t y = 0; y < dim.y; y++)
+            {
+                for (uint32_t x = 0; x < dim.x; x++)
+                {
+                    float expected = 0.f;
+                    for (uint32_t py = y << level; py < std::min((y + 1) << level, height); py++)
+                    {
+                        for (uint32_t px = x << level; px < std::min((x + 1) << level, width); px++)
+                        {
+                            expected = std::max(expected, depth[py * width + px]);
+                        }
+                    }
+                    EXPECT_EQ(hiZ.getTexel(level, x, y), expected) << "level=" << level << " x=" << x << " y=" << y;
+                }
+            }
+        }
+    }
+
+    CPU_TEST(HiZOcclusion)
+    {
+        const glm::mat4 viewProj = getViewProj();
+
+        // A wall at distance 10 covering the whole screen.
+        std::vector<float> depth(kWidth * kHeight, getDepth(viewProj, 10.f));
+        HiZReference hiZ(depth, kWidth, kHeight);
+
+        auto box = [](float3 center, float3 extent) { BoundingBox b; b.center = center; b.extent = extent; return b; };
+
+        EXPECT(hiZ.isOccluded(box(float3(0, 0, -20), float3(1)), viewProj));
+        EXPECT(hiZ.isOccluded(box(float3(3, -2, -50), float3(5)), viewProj));
+        EXPECT(!hiZ.isOccluded(box(float3(0, 0, -5), float3(1)), viewProj));
+
+        // Boxes reaching in front of the wall or crossing the near plane are visible.
+        EXPECT(!hiZ.isOccluded(box(float3(0, 0, -12), float3(3)), viewProj));
+        EXPECT(!hiZ.isOccluded(box(float3(0, 0, 0), float3(1)), viewProj));
+
+        // Cut a hole into the wall. A box behind the wall that is visible through the hole is not occluded.
+        for (uint32_t y = 40; y < 50; y++)
+        {
+            for (uint32_t x = 75; x < 85; x++) depth[y * kWidth + x] = 1.f;
+        }
+        HiZReference hiZWithHole(depth, kWidth, kHeight);
+        EXPECT(!hiZWithHole.isOccluded(box(float3(0, 0, -20), float3(1)), viewProj));
+        EXPECT(!hiZWithHole.isOccluded(box(float3(0, 0, -50), float3(10)), viewProj));
+
+        // A box that only projects onto the intact part of the wall is still occluded.
+        EXPECT(hiZWithHole.isOccluded(box(float3(-15, 0, -20), float3(1)), viewProj));
+    }
+
+    CPU_TEST(HiZOcclusionMatchesBruteForce)
+    {
+        // The Hi-Z test is conservative: an occluded box must be behind the depth at every pixel it covers.
+        const glm::mat4 viewProj = getViewProj();
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        std::vector<float> depth(kWidth * kHeight);
+        for (uint32_t y = 0; y < kHeight; y++)
+        {
+            for (uint32_t x = 0; x < kWidth; x++) depth[y * kWidth + x] = getDepth(viewProj, 5.f + 20.f * float((x / 16 + y / 16) % 3));
+        }
+        HiZReference hiZ(depth, kWidth, kHeight);
+
+        uint32_t occludedCount = 0;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            BoundingBox b;
+            b.center = float3(u(rng) * 40.f - 20.f, u(rng) * 24.f - 12.f, -1.f - u(rng) * 60.f);
+            b.extent = float3(0.1f + u(rng) * 2.f);
+            if (!hiZ.isOccluded(b, viewProj)) continue;
+            occludedCount++;
+
+            // Find the box's nearest depth and screen rectangle.
+            float minZ = 1.f;
+            float2 ndcMin(1.f), ndcMax(-1.f);
+            for (uint32_t c = 0; c < 8; c++)
+            {
+                float3 s((c & 1) ? 1.f : -1.f, (c & 2) ? 1.f : -1.f, (c & 4) ? 1.f : -1.f);
+                float4 p = viewProj * float4(b.center + s * b.extent, 1.f);
+                minZ = std::min(minZ, p.z / p.w);
+                ndcMin = glm::min(ndcMin, float2(p) / p.w);
+                ndcMax = glm::max(ndcMax, float2(p) / p.w);
+            }
+            int2 pMin = glm::clamp(int2(glm::floor(float2(ndcMin.x * 0.5f + 0.5f, 0.5f - ndcMax.y * 0.5f) * float2(kWidth, kHeight))), int2(0), int2(kWidth - 1, kHeight - 1));
+            int2 pMax = glm::clamp(int2(glm::floor(float2(ndcMax.x * 0.5f + 0.5f, 0.5f - ndcMin.y * 0.5f) * float2(kWidth, kHeight))), int2(0), int2(kWidth - 1, kHeight - 1));
+            for (int y = pMin.y; y <= pMax.y; y++)
+            {
+                for (int x = pMin.x; x <= pMax.x; x++) EXPECT_GT(minZ, depth[y * kWidth + x]);
+            }
+        }
+        EXPECT_GT(occludedCount, 0u);
+    }
+
+    CPU_TEST(HiZFrustum)
+    {
+        const glm::mat4 viewProj = getViewProj();
+        auto box = [](float3 center, float3 extent) { BoundingBox b; b.center = center; b.extent = extent; return b; };
+
+        EXPECT(HiZReference::isInFrustum(box(float3(0, 0, -10), float3(1)), viewProj));
+        EXPECT(HiZReference::isInFrustum(box(float3(0, 0, 0), float3(1)), viewProj));    // Contains the camera.
+        EXPECT(!HiZReference::isInFrustum(box(float3(0, 0, 10), float3(1)), viewProj));  // Behind the camera.
+        EXPECT(!HiZReference::isInFrustum(box(float3(50, 0, -10), float3(1)), viewProj)); // Right of the frustum.
+        EXPECT(!HiZReference::isInFrustum(box(float3(0, 0, -200), float3(1)), viewProj)); // Beyond the far plane.
+    }
+}
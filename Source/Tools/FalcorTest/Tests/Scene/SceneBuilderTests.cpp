@@ -0,0 +1,108 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBenchmarkMaterialCount = 50000;
+
+        // Create a material with properties that are unique for each value of 'i'.
+        Material::SharedPtr createMaterial(const std::string& name, uint32_t i)
+        {
+            auto pMaterial = Material::create(name);
+            pMaterial->setBaseColor(float4((i & 0xff) / 255.f, ((i >> 8) & 0xff) / 255.f, ((i >> 16) & 0xff) / 255.f, 1.f));
+            pMaterial->setIndexOfRefraction(1.f + (i % 7) * 0.1f);
+            return pMaterial;
+        }
+    }
+
+    CPU_TEST(SceneBuilderMaterialDedup)
+    {
+        auto pBuilder = SceneBuilder::create(SceneBuilder::Flags::RemoveDuplicateMaterials);
+
+        auto pA = createMaterial("A", 1);
+        auto pB = createMaterial("B", 2);
+        EXPECT_EQ(pBuilder->addMaterial(pA), 0);
+        EXPECT_EQ(pBuilder->addMaterial(pB), 1);
+
+        // Same object.
+        EXPECT_EQ(pBuilder->addMaterial(pA), 0);
+
+        // Equal properties, different name.
+        EXPECT_EQ(pBuilder->addMaterial(createMaterial("C", 2)), 1);
+
+        // -0 and +0 compare equal, so they must hash equal.
+        // The setter ignores values equal to the current one, so go through a different value to actually store -0.
+        auto pZero = createMaterial("Zero", 3);
+        pZero->setSpecularTransmission(0.f);
+        auto pNegZero = createMaterial("NegZero", 3);
+        pNegZero->setSpecularTransmission(1.f);
+        pNegZero->setSpecularTransmission(-0.f);
+        EXPECT(std::signbit(pNegZero->getSpecularTransmission()));
+        EXPECT(!std::signbit(pZero->getSpecularTransmission()));
+        EXPECT_EQ(pZero->getHash(), pNegZero->getHash());
+        EXPECT_EQ(pBuilder->addMaterial(pZero), 2);
+        EXPECT_EQ(pBuilder->addMaterial(pNegZero), 2);
+
+        EXPECT_EQ(pBuilder->getMaterialCount(), 3);
+    }
+
+    CPU_TEST(SceneBuilderMaterialNoDedup)
+    {
+        // Without RemoveDuplicateMaterials only materials with equal name and properties are merged.
+        auto pBuilder = SceneBuilder::create(SceneBuilder::Flags::None);
+        EXPECT_EQ(pBuilder->addMaterial(createMaterial("A", 1)), 0);
+        EXPECT_EQ(pBuilder->addMaterial(createMaterial("B", 1)), 1);
+        EXPECT_EQ(pBuilder->addMaterial(createMaterial("A", 1)), 0);
+        EXPECT_EQ(pBuilder->addMaterial(createMaterial("B", 1)), 1);
+        EXPECT_EQ(pBuilder->getMaterialCount(), 2);
+    }
+
+    CPU_TEST(SceneBuilderMaterialDedupBenchmark)
+    {
+        // Adds 50k unique materials followed by 50k duplicates. With a linear search this takes minutes.
+        auto pBuilder = SceneBuilder::create(SceneBuilder::Flags::RemoveDuplicateMaterials);
+
+        std::vector<Material::SharedPtr> materials(kBenchmarkMaterialCount);
+        for (uint32_t i = 0; i < kBenchmarkMaterialCount; i++) materials[i] = createMaterial("Material" + std::to_string(i), i);
+
+        for (uint32_t i = 0; i < kBenchmarkMaterialCount; i++)
+        {
+            EXPECT_EQ(pBuilder->addMaterial(materials[i]), i);
+        }
+        for (uint32_t i = 0; i < kBenchmarkMaterialCount; i++)
+        {
+            EXPECT_EQ(pBuilder->addMaterial(materials[i]), i);
+            EXPECT_EQ(pBuilder->addMaterial(createMaterial("Duplicate", i)), i);
+        }
+        EXPECT_EQ(pBuilder->getMaterialCount(), kBenchmarkMaterialCount);
+    }
+}
@@ -0,0 +1,142 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Lights/ShadowCasterCache.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        using Update = ShadowCasterCache::Update;
+
+        const float3 kLightDir = float3(0.f, -1.f, 0.f);
+        const uint32_t kStaticFrameCount = 4;
+
+        std::vector<BoundingBox> createCasters(uint32_t count)
+        {
+            std::vector<BoundingBox> bounds(count);
+            for (uint32_t i = 0; i < count; i++) bounds[i] = BoundingBox::fromMinMax(float3(float(i), 0.f, 0.f), float3(float(i) + 0.5f, 1.f, 0.5f));
+            return bounds;
+        }
+
+        void move(BoundingBox& box)
+        {
+            box.center += float3(0.f, 0.f, 0.1f);
+        }
+    }
+
+    CPU_TEST(ShadowCasterCacheInvalidation)
+    {
+        ShadowCasterCache cache(kStaticFrameCount);
+        std::vector<BoundingBox> bounds = createCasters(4);
+
+        // The first update builds the cache with all casters static.
+        EXPECT(cache.update(kLightDir, bounds) == Update::Rebuild);
+        EXPECT_EQ(cache.getStaticCasters().size(), 4u);
+        EXPECT(cache.getDynamicCasters().empty());
+        EXPECT(cache.update(kLightDir, bounds) == Update::None);
+
+        // A static caster that moves invalidates the cache and becomes dynamic.
+        move(bounds[1]);
+        EXPECT(cache.update(kLightDir, bounds) == Update::Rebuild);
+        EXPECT(!cache.isStatic(1));
+        EXPECT(cache.getStaticCasters() == std::vector<uint32_t>({ 0, 2, 3 }));
+        EXPECT(cache.getDynamicCasters() == std::vector<uint32_t>({ 1 }));
+
+        // Dynamic casters can keep moving without touching the cache.
+        for (uint32_t i = 0; i < 2 * kStaticFrameCount; i++)
+        {
+            move(bounds[1]);
+            EXPECT(cache.update(kLightDir, bounds) == Update::None) << "frame " << i;
+        }
+
+        // Once it stops, it is appended to the cache after kStaticFrameCount frames.
+        for (uint32_t i = 1; i < kStaticFrameCount; i++)
+        {
+            EXPECT(cache.update(kLightDir, bounds) == Update::None) << "frame " << i;
+        }
+        EXPECT(cache.update(kLightDir, bounds) == Update::Append);
+        EXPECT(cache.getAppendedCasters() == std::vector<uint32_t>({ 1 }));
+        EXPECT(cache.isStatic(1));
+        EXPECT_EQ(cache.getStaticCasters().size(), 4u);
+        EXPECT(cache.getDynamicCasters().empty());
+        EXPECT(cache.update(kLightDir, bounds) == Update::None);
+        EXPECT(cache.getAppendedCasters().empty());
+
+        // Explicit invalidation and a change in the number of casters rebuild the cache.
+        cache.invalidate();
+        EXPECT(cache.update(kLightDir, bounds) == Update::Rebuild);
+        bounds = createCasters(5);
+        EXPECT(cache.update(kLightDir, bounds) == Update::Rebuild);
+        EXPECT_EQ(cache.getStaticCasters().size(), 5u);
+        EXPECT(cache.update(kLightDir, bounds) == Update::None);
+    }
+
+    CPU_TEST(ShadowCasterCacheLightDirection)
+    {
+        ShadowCasterCache cache(kStaticFrameCount, 0.9999f);
+        std::vector<BoundingBox> bounds = createCasters(3);
+        EXPECT(cache.update(kLightDir, bounds) == Update::Rebuild);
+
+        // The length of the direction doesn't matter, and changes below the threshold are ignored.
+        EXPECT(cache.update(kLightDir * 2.f, bounds) == Update::None);
+        EXPECT(cache.update(glm::normalize(kLightDir + float3(0.005f, 0.f, 0.f)), bounds) == Update::None);
+
+        // Larger changes rebuild the cache. The classification is kept.
+        move(bounds[2]);
+        EXPECT(cache.update(kLightDir, bounds) == Update::Rebuild);
+        EXPECT(cache.update(glm::normalize(kLightDir + float3(0.1f, 0.f, 0.f)), bounds) == Update::Rebuild);
+        EXPECT(cache.getDynamicCasters() == std::vector<uint32_t>({ 2 }));
+
+        // Small changes accumulate against the cached direction instead of the previous frame's.
+        const float3 cachedDir = glm::normalize(kLightDir + float3(0.1f, 0.f, 0.f));
+        Update update = Update::None;
+        for (uint32_t i = 1; i <= 10 && update == Update::None; i++)
+        {
+            update = cache.update(glm::normalize(cachedDir + float3(0.f, 0.f, 0.005f * i)), bounds);
+        }
+        EXPECT(update == Update::Rebuild);
+    }
+
+    CPU_TEST(ShadowCasterCacheAlwaysDynamic)
+    {
+        ShadowCasterCache cache(kStaticFrameCount);
+        std::vector<BoundingBox> bounds = createCasters(3);
+        std::vector<bool> alwaysDynamic = { false, true, false };
+
+        EXPECT(cache.update(kLightDir, bounds, alwaysDynamic) == Update::Rebuild);
+        EXPECT(cache.getDynamicCasters() == std::vector<uint32_t>({ 1 }));
+
+        // Casters flagged as always dynamic are never cached, even if their bounds don't change.
+        for (uint32_t i = 0; i < 2 * kStaticFrameCount; i++)
+        {
+            EXPECT(cache.update(kLightDir, bounds, alwaysDynamic) == Update::None) << "frame " << i;
+        }
+        EXPECT(!cache.isStatic(1));
+    }
+}
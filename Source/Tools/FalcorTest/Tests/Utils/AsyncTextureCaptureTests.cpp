@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kWidth = 37;
+        const uint32_t kHeight = 19;
+        const uint32_t kFrameCount = 6;
+
+        std::string getCaptureFilename(const std::string& name, uint32_t frame, const std::string& ext)
+        {
+            return getExecutableDirectory() + "/AsyncTextureCaptureTest_" + name + std::to_string(frame) + "." + ext;
+        }
+    }
+
+    GPU_TEST(AsyncTextureCapture)
+    {
+        RenderContext* pContext = ctx.getRenderContext();
+
+        // Use fewer readback slots than frames to exercise the forced waits and staging buffer reuse
+        AsyncTextureCapture::SharedPtr pCapture = AsyncTextureCapture::create(2, 2, 2);
+
+        std::vector<std::vector<uint8_t>> colors(kFrameCount);
+        for (uint32_t f = 0; f < kFrameCount; f++)
+        {
+            colors[f].resize(kWidth * kHeight * 4);
+            for (uint32_t i = 0; i < kWidth * kHeight; i++)
+            {
+                colors[f][i * 4 + 0] = uint8_t(i + f);
+                colors[f][i * 4 + 1] = uint8_t(i * 7);
+                colors[f][i * 4 + 2] = uint8_t(f * 40);
+                colors[f][i * 4 + 3] = 255;
+            }
+
+            // The source textures are released right away. The service must not depend on them staying alive.
+            Texture::SharedPtr pColor = Texture::create2D(kWidth, kHeight, ResourceFormat::RGBA8Unorm, 1, 1, colors[f].data(), ResourceBindFlags::ShaderResource);
+            pCapture->capture(pContext, pColor.get(), 0, 0, getCaptureFilename("color", f, "png"), Bitmap::FileFormat::PngFile);
+
+            // Single channel float formats are converted to RGBA32Float
+            std::vector<float> depth(kWidth * kHeight, float(f));
+            Texture::SharedPtr pDepth = Texture::create2D(kWidth, kHeight, ResourceFormat::R32Float, 1, 1, depth.data(), ResourceBindFlags::ShaderResource);
+            pCapture->capture(pContext, pDepth.get(), 0, 0, getCaptureFilename("depth", f, "pfm"), Bitmap::FileFormat::PfmFile);
+
+            pCapture->poll();
+        }
+
+        pCapture->flush();
+        auto stats = pCapture->getStats();
+        EXPECT_EQ(stats.capturedCount, 2 * kFrameCount);
+        EXPECT_EQ(stats.writtenCount, 2 * kFrameCount);
+        EXPECT_EQ(stats.pendingReadbacks, 0u);
+        EXPECT_EQ(stats.queuedImages, 0u);
+
+        for (uint32_t f = 0; f < kFrameCount; f++)
+        {
+            std::string colorFile = getCaptureFilename("color", f, "png");
+            std::string depthFile = getCaptureFilename("depth", f, "pfm");
+            EXPECT(doesFileExist(colorFile)) << colorFile;
+            EXPECT(doesFileExist(depthFile)) << depthFile;
+
+            // PNGs load as BGRA8
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(colorFile, true);
+            EXPECT(pBitmap != nullptr);
+            if (pBitmap)
+            {
+                EXPECT_EQ(pBitmap->getWidth(), kWidth);
+                EXPECT_EQ(pBitmap->getHeight(), kHeight);
+                const uint8_t* pData = pBitmap->getData();
+                for (uint32_t i = 0; i < kWidth * kHeight; i++)
+                {
+                    EXPECT_EQ(pData[i * 4 + 0], colors[f][i * 4 + 2]) << "frame " << f << " pixel " << i;
+                    EXPECT_EQ(pData[i * 4 + 1], colors[f][i * 4 + 1]) << "frame " << f << " pixel " << i;
+                    EXPECT_EQ(pData[i * 4 + 2], colors[f][i * 4 + 0]) << "frame " << f << " pixel " << i;
+                }
+            }
+
+            std::remove(colorFile.c_str());
+            std::remove(depthFile.c_str());
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/FrameTimeStatistics.h"
+#include <sstream>
+
+namespace Falcor
+{
+    CPU_TEST(FrameTimeStatisticsJitterAndStutter)
+    {
+        FrameTimeStatistics::Options options;
+        options.stutterFactor = 2.0;
+        FrameTimeStatistics stats(options);
+
+        // Alternating 16/17 ms frames with two 50 ms hitches.
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            double t = (i == 100 || i == 500) ? 50.0 : (i % 2 ? 17.0 : 16.0);
+            stats.addFrame(t);
+        }
+        EXPECT_EQ(stats.getFrameCount(), 1000);
+
+        auto summary = stats.getSummary();
+        EXPECT_EQ(summary.frameTime.count, 1000);
+        EXPECT_LE(std::abs(summary.frameTime.minMS - 16.0), 0.02);
+        EXPECT_LE(std::abs(summary.frameTime.maxMS - 50.0), 0.05);
+        EXPECT_LE(std::abs(summary.frameTime.p50MS - 17.0), 0.02);
+        EXPECT_LE(std::abs(summary.frameTime.p99MS - 17.0), 0.02);
+
+        // Consecutive frames differ by 1 ms, except around the hitches.
+        EXPECT_EQ(summary.jitter.count, 999);
+        EXPECT_LE(std::abs(summary.jitter.p50MS - 1.0), 0.002);
+        EXPECT_GE(summary.jitter.maxMS, 33.0);
+
+        // The median is 17 ms (the hitches tip the balance), so the threshold is 34 ms.
+        EXPECT_LE(std::abs(summary.stutterThresholdMS - 34.0), 0.05);
+        EXPECT_EQ(summary.stutterCount, 2);
+        auto stutterFrames = stats.getStutterFrames();
+        EXPECT_EQ(stutterFrames.size(), 2);
+        if (stutterFrames.size() == 2)
+        {
+            EXPECT_EQ(stutterFrames[0], 100);
+            EXPECT_EQ(stutterFrames[1], 500);
+        }
+
+        stats.reset();
+        EXPECT_EQ(stats.getFrameCount(), 0);
+        EXPECT_EQ(stats.getSummary().stutterCount, 0);
+    }
+
+    CPU_TEST(FrameTimeStatisticsAppend)
+    {
+        FrameTimeStatistics stats;
+        std::stringstream batched(std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t writtenCount = 0;
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            stats.addFrame(10.0 + i);
+            if (i % 30 == 0)
+            {
+                EXPECT(stats.appendFrameTimes(batched, writtenCount));
+                writtenCount = stats.getFrameCount();
+            }
+        }
+        EXPECT(stats.appendFrameTimes(batched, writtenCount));
+
+        // Appending in batches gives the same file as writing all frames at once.
+        std::stringstream single(std::ios::in | std::ios::out | std::ios::binary);
+        EXPECT(stats.appendFrameTimes(single, 0));
+        EXPECT(batched.str() == single.str());
+
+        // Header: magic, version, frame count, followed by the float32 frame times.
+        const std::string data = single.str();
+        EXPECT_EQ(data.size(), 20 + 100 * sizeof(float));
+        if (data.size() != 20 + 100 * sizeof(float)) return;
+        EXPECT(data.compare(0, 8, "FALCORFT") == 0);
+        uint64_t frameCount = 0;
+        std::memcpy(&frameCount, data.data() + 12, sizeof(frameCount));
+        EXPECT_EQ(frameCount, 100);
+        float lastFrameTime = 0.f;
+        std::memcpy(&lastFrameTime, data.data() + 20 + 99 * sizeof(float), sizeof(float));
+        EXPECT_EQ(lastFrameTime, 109.f);
+    }
+}
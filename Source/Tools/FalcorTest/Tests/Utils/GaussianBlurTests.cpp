@@ -0,0 +1,264 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "RenderPasses/Utils/GaussianBlur/GaussianBlur.cs.slang";
+
+        // Wider than one 256 pixel tile and not a multiple of it, with odd sizes for the half resolution path.
+        const uint2 kDim(301, 75);
+
+        /** Blur settings. Box filters are used if radii is not empty, otherwise the kernel weights.
+        */
+        struct Blur
+        {
+            std::vector<float> weights;
+            std::vector<uint32_t> radii;
+            bool downsample = false;
+
+            uint32_t getApron() const
+            {
+                if (radii.empty()) return (uint32_t)weights.size() / 2;
+                uint32_t apron = 0;
+                for (uint32_t r : radii) apron += r;
+                return apron;
+            }
+        };
+
+        std::vector<float> getGaussianWeights(uint32_t kernelWidth, float sigma)
+        {
+            std::vector<float> weights(kernelWidth);
+            float sum = 0.f;
+            for (uint32_t i = 0; i < kernelWidth; i++)
+            {
+                float x = (float)i - (float)(kernelWidth / 2);
+                weights[i] = std::exp(-x * x / (2.f * sigma * sigma));
+                sum += weights[i];
+            }
+            for (float& w : weights) w /= sum;
+            return weights;
+        }
+
+        /** CPU reference of the blur of one line in GaussianBlur.cs.slang.
+            The line is extended by the apron with the edge pixels. Box filters are applied successively to the part of
+            the extended line that is valid after the previous filters.
+        */
+        std::vector<float4> blurLine(const std::vector<float4>& line, const Blur& blur)
+        {
+            const int n = (int)line.size();
+            const int apron = (int)blur.getApron();
+            std::vector<float4> extended(n + 2 * apron);
+            for (int i = 0; i < n + 2 * apron; i++) extended[i] = line[glm::clamp(i - apron, 0, n - 1)];
+
+            std::vector<float4> result(n);
+            if (blur.radii.empty())
+            {
+                for (int x = 0; x < n; x++)
+                {
+                    float4 sum(0.f);
+                    for (size_t k = 0; k < blur.weights.size(); k++) sum += blur.weights[k] * extended[x + k];
+                    result[x] = sum;
+                }
+                return result;
+            }
+
+            int lo = 0, hi = n + 2 * apron;
+            for (uint32_t r : blur.radii)
+            {
+                const int radius = (int)r;
+                std::vector<float4> filtered = extended;
+                for (int i = lo + radius; i + radius < hi; i++)
+                {
+                    float4 sum(0.f);
+                    for (int k = -radius; k <= radius; k++) sum += extended[i + k];
+                    filtered[i] = sum / float(2 * radius + 1);
+                }
+                extended = filtered;
+                lo += radius;
+                hi -= radius;
+            }
+            for (int x = 0; x < n; x++) result[x] = extended[apron + x];
+            return result;
+        }
+
+        /** CPU reference of the horizontal and vertical pass. Returns the blurred image at the blur resolution.
+        */
+        std::vector<float4> blurReference(const std::vector<float4>& image, uint2 dim, const Blur& blur, uint2& blurDim)
+        {
+            std::vector<float4> src = image;
+            blurDim = dim;
+            if (blur.downsample)
+            {
+                // Average of 2x2 pixels, clamped to the edge.
+                blurDim = (dim + 1u) / 2u;
+                src.resize((size_t)blurDim.x * blurDim.y);
+                for (uint32_t y = 0; y < blurDim.y; y++)
+                {
+                    for (uint32_t x = 0; x < blurDim.x; x++)
+                    {
+                        float4 sum(0.f);
+                        for (uint32_t i = 0; i < 4; i++)
+                        {
+                            uint32_t sx = std::min(2 * x + (i & 1), dim.x - 1), sy = std::min(2 * y + (i >> 1), dim.y - 1);
+                            sum += image[sy * dim.x + sx];
+                        }
+                        src[y * blurDim.x + x] = sum * 0.25f;
+                    }
+                }
+            }
+
+            std::vector<float4> tmp(src.size()), result(src.size());
+            for (uint32_t y = 0; y < blurDim.y; y++)
+            {
+                std::vector<float4> row(src.begin() + y * blurDim.x, src.begin() + (y + 1) * blurDim.x);
+                row = blurLine(row, blur);
+                std::copy(row.begin(), row.end(), tmp.begin() + y * blurDim.x);
+            }
+            for (uint32_t x = 0; x < blurDim.x; x++)
+            {
+                std::vector<float4> column(blurDim.y);
+                for (uint32_t y = 0; y < blurDim.y; y++) column[y] = tmp[y * blurDim.x + x];
+                column = blurLine(column, blur);
+                for (uint32_t y = 0; y < blurDim.y; y++) result[y * blurDim.x + x] = column[y];
+            }
+            return result;
+        }
+
+        void testBlur(GPUUnitTestContext& ctx, const Blur& blur, const char* name)
+        {
+            std::mt19937 rng(17);
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+            std::vector<float4> image((size_t)kDim.x * kDim.y);
+            for (auto& c : image) c = float4(u(rng), u(rng), 4.f * u(rng), 1.f);
+            Texture::SharedPtr pSrc = Texture::create2D(kDim.x, kDim.y, ResourceFormat::RGBA32Float, 1, 1, image.data());
+
+            uint2 blurDim;
+            std::vector<float4> expected = blurReference(image, kDim, blur, blurDim);
+
+            std::string radii;
+            for (uint32_t r : blur.radii) radii += (radii.empty() ? "" : ",") + std::to_string(r);
+
+            Program::DefineList defines;
+            defines.add("_BOX_COUNT", std::to_string(blur.radii.size()));
+            if (!blur.radii.empty()) defines.add("_BOX_RADII", radii);
+            defines.add("_APRON", std::to_string(blur.getApron()));
+            defines.add("_KERNEL_WIDTH", std::to_string(std::max<size_t>(blur.weights.size(), 1)));
+
+            Sampler::Desc samplerDesc;
+            samplerDesc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Point).setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp);
+            Buffer::SharedPtr pWeights = blur.weights.empty() ? nullptr : Buffer::createTyped<float>((uint32_t)blur.weights.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, blur.weights.data());
+            const ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+            Texture::SharedPtr pTmp = Texture::create2D(blurDim.x, blurDim.y, ResourceFormat::RGBA32Float, 1, 1, nullptr, bindFlags);
+            Texture::SharedPtr pDst = Texture::create2D(blurDim.x, blurDim.y, ResourceFormat::RGBA32Float, 1, 1, nullptr, bindFlags);
+
+            Program::DefineList horizontalDefines = defines;
+            horizontalDefines.add("_HORIZONTAL_BLUR");
+            if (blur.downsample) horizontalDefines.add("_DOWNSAMPLE");
+            ComputePass::SharedPtr pHorizontal = ComputePass::create(kShaderFile, "main", horizontalDefines);
+            pHorizontal["BlurCB"]["gDstDim"] = blurDim;
+            pHorizontal["gSampler"] = Sampler::create(samplerDesc);
+            pHorizontal["gSrcTex"] = pSrc;
+            pHorizontal["gDstTex"] = pTmp;
+            if (pWeights) pHorizontal["weights"] = pWeights;
+            pHorizontal->execute(ctx.getRenderContext(), blurDim.x, blurDim.y);
+
+            Program::DefineList verticalDefines = defines;
+            verticalDefines.add("_VERTICAL_BLUR");
+            ComputePass::SharedPtr pVertical = ComputePass::create(kShaderFile, "main", verticalDefines);
+            pVertical["BlurCB"]["gDstDim"] = blurDim;
+            pVertical["gSrcTex"] = pTmp;
+            pVertical["gDstTex"] = pDst;
+            if (pWeights) pVertical["weights"] = pWeights;
+            pVertical->execute(ctx.getRenderContext(), blurDim.y, blurDim.x);
+
+            std::vector<uint8_t> data = ctx.getRenderContext()->readTextureSubresource(pDst.get(), 0);
+            const float4* result = reinterpret_cast<const float4*>(data.data());
+            for (uint32_t i = 0; i < blurDim.x * blurDim.y; i++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    // Box filters take differences of prefix sums over the line, which loses a few bits.
+                    EXPECT_LE(std::abs(result[i][c] - expected[i][c]), 1e-4f * std::max(1.f, std::abs(expected[i][c])))
+                        << name << " pixel=(" << i % blurDim.x << "," << i / blurDim.x << ") channel=" << c;
+                }
+            }
+        }
+    }
+
+    CPU_TEST(GaussianBlurBoxApproximation)
+    {
+        // The impulse response of three box filters is close to the Gaussian with the same variance.
+        Blur blur;
+        blur.radii = { 4, 4, 5 };
+        float variance = 0.f;
+        for (uint32_t r : blur.radii) variance += r * (r + 1) / 3.f;
+
+        const uint32_t n = 81;
+        std::vector<float4> impulse(n, float4(0.f));
+        impulse[n / 2] = float4(1.f);
+        std::vector<float4> response = blurLine(impulse, blur);
+        std::vector<float> gaussian = getGaussianWeights(n, std::sqrt(variance));
+
+        float sum = 0.f;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            sum += response[i].x;
+            EXPECT_LE(std::abs(response[i].x - gaussian[i]), 0.1f * gaussian[n / 2]) << "i=" << i;
+        }
+        EXPECT_LE(std::abs(sum - 1.f), 1e-5f);
+
+        // A constant line, including its edges, is preserved by both kinds of filters.
+        std::vector<float4> constant(20, float4(0.5f));
+        for (const float4& c : blurLine(constant, blur)) EXPECT_LE(std::abs(c.x - 0.5f), 1e-6f);
+        Blur exact;
+        exact.weights = getGaussianWeights(9, 2.f);
+        for (const float4& c : blurLine(constant, exact)) EXPECT_LE(std::abs(c.x - 0.5f), 1e-6f);
+    }
+
+    GPU_TEST(GaussianBlurCompute)
+    {
+        RenderPassLibrary::instance().loadLibrary("Utils.dll");
+
+        Blur exact;
+        exact.weights = getGaussianWeights(9, 2.f);
+        testBlur(ctx, exact, "exact");
+
+        Blur box;
+        box.radii = { 20, 21, 21 };
+        testBlur(ctx, box, "box");
+
+        Blur halfRes;
+        halfRes.radii = { 2, 2, 3 };
+        halfRes.downsample = true;
+        testBlur(ctx, halfRes, "half resolution");
+    }
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/HdrHistogram.h"
+#include <random>
+
+namespace Falcor
+{
+    CPU_TEST(HdrHistogramBasics)
+    {
+        HdrHistogram h(1000000, 3);
+        EXPECT_EQ(h.getTotalCount(), 0);
+        EXPECT_EQ(h.getValueAtPercentile(50.0), 0);
+
+        // Values below the sub-bucket count are tracked exactly.
+        for (uint64_t i = 1; i <= 1000; i++) h.record(i);
+        EXPECT_EQ(h.getTotalCount(), 1000);
+        EXPECT_EQ(h.getMin(), 1);
+        EXPECT_EQ(h.getMax(), 1000);
+        EXPECT_EQ(h.getValueAtPercentile(50.0), 500);
+        EXPECT_EQ(h.getValueAtPercentile(99.0), 990);
+        EXPECT_EQ(h.getValueAtPercentile(100.0), 1000);
+        EXPECT_EQ(h.getValueAtPercentile(0.0), 1);
+        EXPECT_LE(std::abs(h.getMean() - 500.5), 1e-9);
+        EXPECT_EQ(h.getCountAbove(900), 100);
+
+        // Values above the range are clamped.
+        h.record(5000000);
+        EXPECT_EQ(h.getMax(), 1000000);
+
+        h.reset();
+        EXPECT_EQ(h.getTotalCount(), 0);
+        EXPECT_EQ(h.getMax(), 0);
+    }
+
+    CPU_TEST(HdrHistogramPrecision)
+    {
+        // Percentiles of a wide distribution must be within the requested number of significant digits of the exact values.
+        const uint32_t kDigits = 3;
+        HdrHistogram h(3600ull * 1000 * 1000, kDigits);
+
+        std::mt19937 rng(1234);
+        std::lognormal_distribution<double> dist(9.0, 1.5);
+        std::vector<uint64_t> values(100000);
+        for (auto& v : values)
+        {
+            v = std::max<uint64_t>(1, (uint64_t)dist(rng));
+            h.record(v);
+        }
+        std::sort(values.begin(), values.end());
+
+        for (double p : { 1.0, 25.0, 50.0, 90.0, 99.0, 99.9 })
+        {
+            size_t rank = (size_t)std::ceil(p / 100.0 * values.size()) - 1;
+            double exact = (double)values[rank];
+            double estimate = (double)h.getValueAtPercentile(p);
+            EXPECT_LE(std::abs(estimate - exact) / exact, 1e-3) << "percentile " << p;
+        }
+
+        HdrHistogram h2(3600ull * 1000 * 1000, kDigits);
+        h2.add(h);
+        EXPECT_EQ(h2.getTotalCount(), h.getTotalCount());
+        EXPECT_EQ(h2.getValueAtPercentile(50.0), h.getValueAtPercentile(50.0));
+    }
+}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Color/LuminanceHistogram.h"
+#include "Utils/Color/LuminanceHistogramReference.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint2 kFrameDim(253, 117);
+
+        /** Random HDR image spanning the luminance range of the histogram, with a few pixels outside it.
+        */
+        std::vector<float3> createImage(uint32_t seed, float logScale)
+        {
+            std::mt19937 r(seed);
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+            std::vector<float3> color((size_t)kFrameDim.x * kFrameDim.y);
+            for (auto& c : color)
+            {
+                float luminance = std::exp2(logScale + 24.f * u(r) - 12.f);
+                if (u(r) < 0.01f) luminance = u(r) < 0.5f ? 0.f : 1e6f;
+                c = luminance * float3(u(r), u(r), u(r));
+            }
+            return color;
+        }
+
+        void readBack(const LuminanceHistogram::SharedPtr& pHistogram, std::vector<uint32_t>& bins, LuminanceHistogramExposure& exposure)
+        {
+            const uint32_t* pBins = (const uint32_t*)pHistogram->getHistogramBuffer()->map(Buffer::MapType::Read);
+            bins.assign(pBins, pBins + kLuminanceHistogramBinCount);
+            pHistogram->getHistogramBuffer()->unmap();
+
+            exposure = *(const LuminanceHistogramExposure*)pHistogram->getExposureBuffer()->map(Buffer::MapType::Read);
+            pHistogram->getExposureBuffer()->unmap();
+        }
+    }
+
+    CPU_TEST(LuminanceHistogramBins)
+    {
+        LuminanceHistogramParams params;
+        EXPECT_EQ(getLuminanceHistogramBin(0.f, params), 0u);
+        EXPECT_EQ(getLuminanceHistogramBin(-1.f, params), 0u);
+        EXPECT_EQ(getLuminanceHistogramBin(std::exp2(params.minLogLuminance - 1.f), params), 0u);
+        EXPECT_EQ(getLuminanceHistogramBin(std::exp2(params.maxLogLuminance + 1.f), params), kLuminanceHistogramBinCount - 1);
+
+        // Bin centers map back to their bin.
+        for (uint32_t i = 0; i < kLuminanceHistogramBinCount; i++)
+        {
+            EXPECT_EQ(getLuminanceHistogramBin(std::exp2(getLuminanceHistogramBinCenter(i, params)), params), i) << "i=" << i;
+        }
+
+        // The bin weights sum to the number of pixels between the percentiles.
+        const uint32_t counts[] = { 10, 0, 30, 40, 20 };
+        float weightSum = 0.f;
+        uint32_t firstPixel = 0;
+        for (uint32_t count : counts)
+        {
+            weightSum += getLuminanceHistogramBinWeight(firstPixel, count, 100, params);
+            firstPixel += count;
+        }
+        EXPECT_LT(std::abs(weightSum - 100.f * (params.highPercentile - params.lowPercentile)), 1e-4f);
+    }
+
+    CPU_TEST(LuminanceHistogramAdaptation)
+    {
+        LuminanceHistogramParams params;
+        params.lowPercentile = 0.f;
+        params.highPercentile = 0.9f;
+        LuminanceHistogramReference histogram(params);
+
+        // 90% of the pixels at luminance 0.5 and 10% very bright ones. The bright pixels are ignored.
+        std::vector<float3> color(1000, float3(0.5f));
+        for (size_t i = 0; i < 100; i++) color[i] = float3(1000.f);
+        histogram.accumulate(color);
+        EXPECT_EQ(histogram.getBins()[getLuminanceHistogramBin(0.5f, params)], 900u);
+
+        histogram.updateExposure(0.1f);
+        const float expected = getLuminanceHistogramBinCenter(getLuminanceHistogramBin(0.5f, params), params);
+        EXPECT_EQ(histogram.getExposure().valid, 1u);
+        EXPECT_LT(std::abs(histogram.getExposure().targetLogLuminance - expected), 1e-5f);
+        EXPECT_EQ(histogram.getExposure().adaptedLogLuminance, histogram.getExposure().targetLogLuminance) << "The first update must not adapt";
+        EXPECT_EQ(histogram.getBins()[getLuminanceHistogramBin(0.5f, params)], 0u);
+
+        // An empty histogram keeps the exposure.
+        histogram.updateExposure(0.1f);
+        EXPECT_LT(std::abs(histogram.getExposure().adaptedLogLuminance - expected), 1e-5f);
+
+        // Adaptation moves towards a brighter target monotonically without overshooting, faster than towards a darker one.
+        std::fill(color.begin(), color.end(), float3(8.f));
+        float previous = histogram.getExposure().adaptedLogLuminance;
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            histogram.accumulate(color);
+            histogram.updateExposure(0.1f);
+            const float adapted = histogram.getExposure().adaptedLogLuminance;
+            EXPECT_GT(adapted, previous) << "i=" << i;
+            EXPECT_LE(adapted, histogram.getExposure().targetLogLuminance) << "i=" << i;
+            previous = adapted;
+        }
+
+        const float brightStep = adaptLogLuminance(0.f, 1.f, 0.1f, params);
+        const float darkStep = -adaptLogLuminance(0.f, -1.f, 0.1f, params);
+        EXPECT_GT(brightStep, darkStep);
+        EXPECT_LT(std::abs(adaptLogLuminance(0.f, 1.f, 1000.f, params) - 1.f), 1e-6f);
+    }
+
+    GPU_TEST(LuminanceHistogram)
+    {
+        LuminanceHistogramParams params;
+        LuminanceHistogram::SharedPtr pHistogram = LuminanceHistogram::create();
+        pHistogram->setParams(params);
+        LuminanceHistogramReference reference(params);
+
+        // Two images accumulated into one histogram, as for the two eyes in stereo, followed by an adaptation step.
+        for (uint32_t frame = 0; frame < 2; frame++)
+        {
+            for (uint32_t eye = 0; eye < 2; eye++)
+            {
+                std::vector<float3> color = createImage(2 * frame + eye, frame * 3.f + eye);
+                std::vector<float4> texels(color.size());
+                for (size_t i = 0; i < color.size(); i++) texels[i] = float4(color[i], 1.f);
+                Texture::SharedPtr pColor = Texture::create2D(kFrameDim.x, kFrameDim.y, ResourceFormat::RGBA32Float, 1, 1, texels.data());
+
+                pHistogram->accumulate(ctx.getRenderContext(), pColor);
+                reference.accumulate(color);
+            }
+
+            std::vector<uint32_t> bins;
+            LuminanceHistogramExposure exposure;
+            readBack(pHistogram, bins, exposure);
+            for (uint32_t i = 0; i < kLuminanceHistogramBinCount; i++)
+            {
+                // Pixels on a bin edge may fall on either side due to differences in log2() precision.
+                EXPECT_LE(std::abs((int)bins[i] - (int)reference.getBins()[i]), 2) << "frame=" << frame << " bin=" << i;
+            }
+
+            pHistogram->updateExposure(ctx.getRenderContext(), 0.25f);
+            reference.updateExposure(0.25f);
+
+            readBack(pHistogram, bins, exposure);
+            for (uint32_t i = 0; i < kLuminanceHistogramBinCount; i++) EXPECT_EQ(bins[i], 0u) << "frame=" << frame << " bin=" << i;
+
+            EXPECT_EQ(exposure.valid, 1u);
+            EXPECT_LT(std::abs(exposure.targetLogLuminance - reference.getExposure().targetLogLuminance), 1e-3f) << "frame=" << frame;
+            EXPECT_LT(std::abs(exposure.adaptedLogLuminance - reference.getExposure().adaptedLogLuminance), 1e-3f) << "frame=" << frame;
+        }
+    }
+}
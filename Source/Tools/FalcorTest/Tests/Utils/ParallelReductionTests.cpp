@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Algorithm/ComputeParallelReduction.h"
+#include "Utils/Algorithm/ParallelReduction.h"
 #include "glm/detail/type_half.hpp"
 #include <random>
 
@@ -247,4 +248,56 @@ namespace Falcor
         testReduction(ctx, pReduction, ResourceFormat::R16Int, 64, 33);
         testReduction(ctx, pReduction, ResourceFormat::RG8Int, 403, 57);
     }
+
+    GPU_TEST(ParallelReductionMinMaxPair)
+    {
+        // The pixel shader reduction works in tiles of 16x16 pixels. Use a size that is not a multiple of it.
+        const uint32_t width = 201, height = 117;
+
+        // Random depths with a quarter of the pixels at the far plane, which the reduction ignores.
+        std::mt19937 rng;
+        auto dist = std::uniform_real_distribution<float>(0.1f, 0.9f);
+        std::vector<float> depth[2];
+        for (auto& d : depth)
+        {
+            d.resize(width * height);
+            for (auto& v : d) v = rng() % 4 == 0 ? 1.f : dist(rng);
+        }
+
+        // Put the minimum and maximum into different inputs, so that the result is only correct if both are read.
+        depth[0][37 * width + 150] = 0.95f;
+        depth[1][100 * width + 3] = 0.05f;
+
+        auto reduceCpu = [](float2 range, const std::vector<float>& d)
+        {
+            for (float v : d)
+            {
+                if (v == 1.f) continue;
+                range.x = std::min(range.x, v);
+                range.y = std::max(range.y, v);
+            }
+            return range;
+        };
+
+        Texture::SharedPtr pTex[2];
+        for (uint32_t i = 0; i < 2; i++) pTex[i] = Texture::create2D(width, height, ResourceFormat::R32Float, 1, 1, depth[i].data());
+
+        // No readback latency, so each call returns its own result.
+        ParallelReduction::UniquePtr pReduction = ParallelReduction::create(ParallelReduction::Type::MinMax, 0, width, height);
+
+        const float2 ref0 = reduceCpu(float2(1.f, 0.f), depth[0]);
+        float4 result = pReduction->reduce(ctx.getRenderContext(), pTex[0]);
+        EXPECT_EQ(result.x, ref0.x);
+        EXPECT_EQ(result.y, ref0.y);
+
+        const float2 ref = reduceCpu(ref0, depth[1]);
+        EXPECT_EQ(ref.x, 0.05f);
+        EXPECT_EQ(ref.y, 0.95f);
+        for (uint32_t first = 0; first < 2; first++)
+        {
+            result = pReduction->reduce(ctx.getRenderContext(), pTex[first], pTex[1 - first]);
+            EXPECT_EQ(result.x, ref.x) << "first = " << first;
+            EXPECT_EQ(result.y, ref.y) << "first = " << first;
+        }
+    }
 }
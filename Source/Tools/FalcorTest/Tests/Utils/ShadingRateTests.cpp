@@ -0,0 +1,199 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/ShadingRate/ShadingRateReference.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint2 kScreenDim(200, 120);
+
+        ShadingRateParams getParams()
+        {
+            ShadingRateParams params;
+            params.screenDim = kScreenDim;
+            return params;
+        }
+
+        float4 gradient(uint2 pixel) { return float4(0.5f * pixel.x, 0.25f * pixel.y, 1.f + 0.1f * pixel.x - 0.2f * pixel.y, 1.f); }
+    }
+
+    CPU_TEST(ShadingRateEncoding)
+    {
+        EXPECT(getShadingRateBlockSize(kShadingRate1x1) == uint2(1, 1));
+        EXPECT(getShadingRateBlockSize(kShadingRate2x4) == uint2(2, 4));
+        EXPECT(getShadingRateBlockSize(kShadingRate4x2) == uint2(4, 2));
+        EXPECT(getShadingRateBlockSize(kShadingRate4x4) == uint2(4, 4));
+
+        EXPECT_EQ(combineShadingRates(kShadingRate2x4, kShadingRate4x2), kShadingRate2x2);
+        EXPECT_EQ(combineShadingRates(kShadingRate4x4, kShadingRate1x1), kShadingRate1x1);
+
+        EXPECT(getShadingRateAnchor(uint2(7, 6), kShadingRate4x4) == uint2(4, 4));
+        EXPECT(getShadingRateAnchor(uint2(7, 6), kShadingRate2x4) == uint2(6, 4));
+    }
+
+    CPU_TEST(ShadingRateFoveation)
+    {
+        ShadingRateParams params = getParams();
+        params.foveaCenter = float2(0.25f, 0.5f);
+        ShadingRateReference rates(params);
+
+        const uint2 tileDim = rates.getTileDim();
+        EXPECT(tileDim == uint2(13, 8));
+
+        // The tile containing the fovea is shaded at full rate, the corners at the coarsest rate.
+        EXPECT_EQ(rates.getRate(uint2(50, 60)), kShadingRate1x1);
+        EXPECT_EQ(rates.getTileRate(tileDim.x - 1, 0), kShadingRate4x4);
+        EXPECT_EQ(rates.getTileRate(tileDim.x - 1, tileDim.y - 1), kShadingRate4x4);
+
+        // The rate never gets finer with increasing distance from the fovea.
+        for (uint32_t x = 4; x + 1 < tileDim.x; x++)
+        {
+            uint32_t inner = rates.getTileRate(x, 3), outer = rates.getTileRate(x + 1, 3);
+            EXPECT_EQ(combineShadingRates(inner, outer), inner) << "x=" << x;
+        }
+
+        EXPECT_LT(rates.getAnchorCount(), kScreenDim.x * kScreenDim.y / 2);
+
+        // The coarsest rate limits all tiles.
+        params.coarsestRate = kShadingRate2x1;
+        ShadingRateReference limited(params);
+        for (uint32_t y = 0; y < tileDim.y; y++)
+        {
+            for (uint32_t x = 0; x < tileDim.x; x++)
+            {
+                uint32_t rate = limited.getTileRate(x, y);
+                EXPECT_EQ(combineShadingRates(rate, kShadingRate2x1), rate) << "x=" << x << " y=" << y;
+            }
+        }
+    }
+
+    CPU_TEST(ShadingRateDiscontinuity)
+    {
+        ShadingRateParams params = getParams();
+        params.useFoveation = false;
+
+        // A depth edge at x = 100 between depth 10 and 20. The tiles next to it must be shaded at full rate.
+        std::vector<float> linearZ(kScreenDim.x * kScreenDim.y);
+        for (uint32_t y = 0; y < kScreenDim.y; y++)
+        {
+            for (uint32_t x = 0; x < kScreenDim.x; x++) linearZ[y * kScreenDim.x + x] = x < 100 ? 10.f : 20.f;
+        }
+
+        ShadingRateReference rates(params, linearZ);
+        for (uint32_t y = 0; y < rates.getTileDim().y; y++)
+        {
+            EXPECT_EQ(rates.getTileRate(99 / kShadingRateTileSize, y), kShadingRate1x1) << "y=" << y;
+            EXPECT_EQ(rates.getTileRate(0, y), kShadingRate4x4) << "y=" << y;
+            EXPECT_EQ(rates.getTileRate(rates.getTileDim().x - 1, y), kShadingRate4x4) << "y=" << y;
+        }
+
+        // Without depth, the coarsest rate is used everywhere.
+        ShadingRateReference noDepth(params);
+        EXPECT_EQ(noDepth.getTileRate(99 / kShadingRateTileSize, 0), kShadingRate4x4);
+    }
+
+    CPU_TEST(ShadingRateResolve)
+    {
+        ShadingRateParams params = getParams();
+        params.foveaCenter = float2(0.3f, 0.6f);
+        ShadingRateReference rates(params);
+
+        // Shade only the anchors of a linear gradient.
+        std::vector<float4> color(kScreenDim.x * kScreenDim.y, float4(-1.f));
+        for (uint32_t y = 0; y < kScreenDim.y; y++)
+        {
+            for (uint32_t x = 0; x < kScreenDim.x; x++)
+            {
+                if (rates.isAnchor(uint2(x, y))) color[y * kScreenDim.x + x] = gradient(uint2(x, y));
+            }
+        }
+        rates.resolve(color);
+
+        // Bilinear interpolation reproduces the gradient wherever all surrounding anchors are shaded.
+        // Elsewhere the result is a convex combination of nearby anchors.
+        for (uint32_t y = 0; y < kScreenDim.y; y++)
+        {
+            for (uint32_t x = 0; x < kScreenDim.x; x++)
+            {
+                const uint2 pixel(x, y);
+                const float4 c = color[y * kScreenDim.x + x];
+                const uint2 blockSize = getShadingRateBlockSize(rates.getRate(pixel));
+                const uint2 anchor = getShadingRateAnchor(pixel, rates.getRate(pixel));
+                const uint2 far = anchor + blockSize;
+
+                bool complete = far.x < kScreenDim.x && far.y < kScreenDim.y && rates.isAnchor(uint2(far.x, anchor.y)) && rates.isAnchor(uint2(anchor.x, far.y)) && rates.isAnchor(far);
+                if (complete)
+                {
+                    float4 expected = gradient(pixel);
+                    EXPECT(glm::all(glm::lessThan(glm::abs(c - expected), float4(1e-4f)))) << "x=" << x << " y=" << y;
+                }
+                else
+                {
+                    EXPECT_GE(c.x, 0.f) << "x=" << x << " y=" << y;
+                    EXPECT_LT(std::abs(c.w - 1.f), 1e-5f) << "x=" << x << " y=" << y;
+                }
+            }
+        }
+    }
+
+    CPU_TEST(ShadingRateResolveTileMask)
+    {
+        ShadingRateParams params = getParams();
+        params.useFoveation = false;
+        ShadingRateReference rates(params);
+
+        // Only resolve every other tile column.
+        const uint2 tileDim = rates.getTileDim();
+        std::vector<float> tileMask(tileDim.x * tileDim.y);
+        for (uint32_t i = 0; i < tileMask.size(); i++) tileMask[i] = (i % tileDim.x) % 2 == 0 ? 1.f : 0.f;
+
+        std::vector<float4> color(kScreenDim.x * kScreenDim.y, float4(-1.f));
+        for (uint32_t y = 0; y < kScreenDim.y; y++)
+        {
+            for (uint32_t x = 0; x < kScreenDim.x; x++)
+            {
+                if (rates.isAnchor(uint2(x, y))) color[y * kScreenDim.x + x] = gradient(uint2(x, y));
+            }
+        }
+        rates.resolve(color, tileMask);
+
+        // The pixels outside the mask keep their color, the ones inside are interpolated from the anchors, including the anchors outside the mask.
+        for (uint32_t y = 0; y < kScreenDim.y; y++)
+        {
+            for (uint32_t x = 0; x < kScreenDim.x; x++)
+            {
+                const float4 c = color[y * kScreenDim.x + x];
+                const bool masked = (x / kShadingRateTileSize) % 2 == 0;
+                if (masked || rates.isAnchor(uint2(x, y))) EXPECT_GE(c.x, 0.f) << "x=" << x << " y=" << y;
+                else EXPECT_EQ(c.x, -1.f) << "x=" << x << " y=" << y;
+            }
+        }
+    }
+}
@@ -26,15 +26,27 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "args.h"
+#include "ImageMetrics.h"
+#include "ImageReader.h"
 #include "FreeImage.h"
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <memory>
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <map>
 #include <functional>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <immintrin.h>
 
 template<typename T>
 T sqr(T x) { return x * x; }
@@ -59,29 +71,9 @@ public:
 
     static SharedPtr loadFromFile(const std::string& filename)
     {
-        FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
-
-        // Determine file format.
-        fifFormat = FreeImage_GetFileType(filename.c_str(), 0);
-        if (fifFormat == FIF_UNKNOWN) fifFormat = FreeImage_GetFIFFromFilename(filename.c_str());
-        if (fifFormat == FIF_UNKNOWN) throw std::runtime_error("Unknown image format");
-        if (!FreeImage_FIFSupportsReading(fifFormat)) throw std::runtime_error("Unsupported image format");
-
-        // Read image.
-        FIBITMAP* srcBitmap = FreeImage_Load(fifFormat, filename.c_str());
-        if (!srcBitmap) throw std::runtime_error("Cannot read image");
-
-        // Convert to RGBA32F.
-        FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
-        FreeImage_Unload(srcBitmap);
-        if (!floatBitmap) throw std::runtime_error("Cannot convert to RGBA float format");
-
-        // Create image.
-        auto image = create(FreeImage_GetWidth(floatBitmap), FreeImage_GetHeight(floatBitmap));
-        int bytesPerPixel = 4 * sizeof(float);
-        FreeImage_ConvertToRawBits(reinterpret_cast<BYTE*>(image->getData()), floatBitmap, bytesPerPixel * image->getWidth(), bytesPerPixel * 8, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true);
-        FreeImage_Unload(floatBitmap);
-
+        auto reader = ImageReader::open(filename);
+        auto image = create(reader->getWidth(), reader->getHeight());
+        reader->readRows(0, image->getHeight(), image->getData());
         return image;
     }
 
@@ -159,78 +151,144 @@ private:
     {}
 };
 
+// Images are compared in blocks of this many rows. The block sums are reduced pairwise, so the block size determines the summation order.
+static const uint32_t kRowsPerBlock = 16;
+
+// Error metrics. Each computes the per-channel error of one RGBA pixel held in an SSE register.
+// The channels are averaged and multiplied by kScale to get the per-pixel error.
+
 struct MSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += sqr(a[i] - b[i]); }
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_mul_ps(d, d);
     }
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3); }
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_div_ps(_mm_mul_ps(d, d), _mm_add_ps(_mm_mul_ps(a, a), _mm_set1_ps(1e-3f)));
     }
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 1.f;
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += std::fabs(sqr(a[i] - b[i])); }
-        return error / count;
+        return abs(_mm_sub_ps(a, b));
     }
+    static __m128 abs(__m128 x) { return _mm_andnot_ps(_mm_set1_ps(-0.f), x); }
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr float kScale = 100.f;
+    static __m128 error(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i) { error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3)); }
-        return 100.0 * error / count;
+        return MAE::abs(_mm_div_ps(_mm_sub_ps(a, b), _mm_add_ps(a, _mm_set1_ps(1e-3f))));
     }
 };
 
+/** Compares the pixels in [begin, end) and returns the sum of the per-pixel errors.
+*/
 template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+double compareRange(const float* a, const float* b, size_t begin, size_t end, bool alpha, float* errorMap)
 {
-    Metric metric;
+    // Masked lanes are cleared after the metric, so NaNs/infs from an ignored alpha channel don't leak into the sum.
+    const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(alpha ? -1 : 0, -1, -1, -1));
+    const float scale = Metric::kScale / (alpha ? 4.f : 3.f);
+
     double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
+    for (size_t i = begin; i < end; ++i)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
-        if (errorMap) *errorMap++ = float(error);
+        __m128 e = _mm_and_ps(Metric::error(_mm_loadu_ps(a + 4 * i), _mm_loadu_ps(b + 4 * i)), mask);
+        e = _mm_add_ps(e, _mm_movehl_ps(e, e));
+        e = _mm_add_ss(e, _mm_shuffle_ps(e, e, 1));
+        float error = _mm_cvtss_f32(e) * scale;
+        if (errorMap) errorMap[i] = error;
         sum += error;
-        a += 4;
-        b += 4;
     }
-    return sum / count;
+    return sum;
+}
+
+/** Compares two images of the same size and returns the average per-pixel error.
+    The images are split into blocks of rows that are compared in parallel. The block sums are reduced pairwise in a fixed order,
+    so the result is the same for any thread count.
+*/
+template<typename Metric>
+double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap, uint32_t threadCount)
+{
+    const size_t width = imageA.getWidth();
+    const size_t height = imageA.getHeight();
+    const size_t count = width * height;
+    if (count == 0) return 0.0;
+
+    const size_t blockCount = (height + kRowsPerBlock - 1) / kRowsPerBlock;
+    std::vector<double> blockSums(blockCount);
+    ImageMetrics::parallelFor(blockCount, threadCount, [&] (size_t block)
+    {
+        size_t begin = block * kRowsPerBlock * width;
+        size_t end = std::min(begin + kRowsPerBlock * width, count);
+        blockSums[block] = compareRange<Metric>(imageA.getData(), imageB.getData(), begin, end, alpha, errorMap);
+    });
+
+    return ImageMetrics::pairwiseSum(blockSums.data(), blockCount) / count;
+}
+
+static ImageMetrics::ImageView getView(const Image& image)
+{
+    ImageMetrics::ImageView view;
+    view.pData = image.getData();
+    view.width = image.getWidth();
+    view.height = image.getHeight();
+    return view;
+}
+
+/** Compares with a similarity metric, using 1 - similarity as the error. The alpha channel is ignored.
+*/
+template<double(*Similarity)(const ImageMetrics::ImageView&, const ImageMetrics::ImageView&, float*, uint32_t)>
+double compareSimilarity(const Image& imageA, const Image& imageB, bool alpha, float* errorMap, uint32_t threadCount)
+{
+    double similarity = Similarity(getView(imageA), getView(imageB), errorMap, threadCount);
+    if (errorMap)
+    {
+        size_t count = size_t(imageA.getWidth()) * imageA.getHeight();
+        for (size_t i = 0; i < count; ++i) errorMap[i] = 1.f - errorMap[i];
+    }
+    return 1.0 - similarity;
+}
+
+/** Compares with FLIP for a 24" 4K monitor viewed from 0.7 m. The alpha channel is ignored.
+*/
+static double compareFLIP(const Image& imageA, const Image& imageB, bool alpha, float* errorMap, uint32_t threadCount)
+{
+    return ImageMetrics::computeFLIP(getView(imageA), getView(imageB), 67.f, errorMap, threadCount);
 }
 
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap, uint32_t threadCount)> compare;
+    std::function<double(const float* a, const float* b, size_t begin, size_t end, bool alpha, float* errorMap)> compareRange;   ///< Set for per-pixel metrics, which can compare images while streaming them.
 };
 
 static const std::vector<ErrorMetric> errorMetrics =
 {
-    { "mse", "Mean Squared Error", compare<MSE> },
-    { "rmse", "Relative Mean Squared Error", compare<RMSE> },
-    { "mae", "Mean Absolute Error", compare<MAE> },
-    { "mape", "Mean Absolute Percentage Error", compare<MAPE> },
+    { "mse", "Mean Squared Error", compare<MSE>, compareRange<MSE> },
+    { "rmse", "Relative Mean Squared Error", compare<RMSE>, compareRange<RMSE> },
+    { "mae", "Mean Absolute Error", compare<MAE>, compareRange<MAE> },
+    { "mape", "Mean Absolute Percentage Error", compare<MAPE>, compareRange<MAPE> },
+    { "ssim", "Structural Dissimilarity (1 - SSIM)", compareSimilarity<ImageMetrics::computeSSIM> },
+    { "msssim", "Multi-Scale Structural Dissimilarity (1 - MS-SSIM)", compareSimilarity<ImageMetrics::computeMSSSIM> },
+    { "flip", "FLIP Perceptual Difference", compareFLIP },
 };
 
 static Image::SharedPtr generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
@@ -264,66 +322,298 @@ static Image::SharedPtr generateHeatMap(uint32_t width, uint32_t height, const f
     return image;
 }
 
-static bool compareImages(const std::string& filenameA, const std::string& filenameB, ErrorMetric metric, float threshold, bool alpha, const std::string& heatMapFilename)
+struct CompareResult
+{
+    std::string filenameA;
+    std::string filenameB;
+    std::string heatMapFilename;    ///< Heat map to write, or empty.
+    double error = 0.0;
+    bool success = false;
+    bool earlyOut = false;          ///< Comparison stopped once the error exceeded the threshold, error is a lower bound.
+    std::string message;            ///< Reason the images could not be compared, or empty.
+};
+
+static void saveHeatMap(uint32_t width, uint32_t height, const float* errorMap, const std::string& filename)
+{
+    try
+    {
+        generateHeatMap(width, height, errorMap)->saveToFile(filename);
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << "Cannot save image to '" << filename << "' (Error: " << e.what() << ")." << std::endl;
+    }
+}
+
+/** Compares two images with a per-pixel metric while streaming them in blocks of rows.
+    Only the rows being compared are held in memory, plus the error map if a heat map is written. The block sums are reduced the same
+    way as in compare(), so the result is identical to comparing the images in memory.
+    With earlyOut, the comparison stops as soon as the error exceeds the threshold. Per-pixel errors are non-negative, so the error
+    can only grow as more rows are compared.
+*/
+static void compareStreaming(CompareResult& result, const ErrorMetric& metric, float threshold, bool alpha, bool earlyOut, uint32_t threadCount)
 {
-    auto loadImage = [] (const std::string& filename)
+    auto openImage = [&result] (const std::string& filename)
     {
         try
         {
-            return Image::loadFromFile(filename);
+            return ImageReader::open(filename);
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot load image from '" << filename << "' (Error: " << e.what() << ")." << std::endl;
-            return Image::SharedPtr();
+            result.message = "Cannot load image from '" + filename + "' (Error: " + e.what() + ").";
+            return std::unique_ptr<ImageReader>();
         }
     };
 
-    auto saveImage = [] (const Image& image, const std::string& filename)
+    // Open images.
+    auto readerA = openImage(result.filenameA);
+    if (!readerA) return;
+    auto readerB = openImage(result.filenameB);
+    if (!readerB) return;
+
+    // Check resolution.
+    if (readerA->getWidth() != readerB->getWidth() || readerA->getHeight() != readerB->getHeight())
+    {
+        result.message = "Cannot compare images with different resolutions.";
+        return;
+    }
+
+    const uint32_t width = readerA->getWidth();
+    const uint32_t height = readerA->getHeight();
+    const size_t count = size_t(width) * height;
+    if (count == 0) return;
+
+    // Read enough rows at a time to keep all threads busy.
+    const uint32_t rowsPerChunk = kRowsPerBlock * std::max(threadCount, 4u);
+    std::vector<float> chunkA(size_t(rowsPerChunk) * width * 4);
+    std::vector<float> chunkB(size_t(rowsPerChunk) * width * 4);
+    std::vector<double> blockSums((height + kRowsPerBlock - 1) / kRowsPerBlock);
+    std::unique_ptr<float[]> errorMap = result.heatMapFilename.empty() ? nullptr : std::make_unique<float[]>(count);
+
+    for (uint32_t y = 0; y < height; y += rowsPerChunk)
     {
+        const uint32_t rowCount = std::min(rowsPerChunk, height - y);
         try
         {
-            image.saveToFile(filename);
+            readerA->readRows(y, rowCount, chunkA.data());
+            readerB->readRows(y, rowCount, chunkB.data());
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot save image to '" << filename << "' (Error: " << e.what() << ")." << std::endl;
+            result.message = "Cannot read image rows (Error: " + std::string(e.what()) + ").";
+            return;
+        }
+
+        const size_t firstBlock = y / kRowsPerBlock;
+        const size_t chunkBlockCount = (rowCount + kRowsPerBlock - 1) / kRowsPerBlock;
+        float* chunkErrorMap = errorMap ? errorMap.get() + size_t(y) * width : nullptr;
+        ImageMetrics::parallelFor(chunkBlockCount, threadCount, [&] (size_t block)
+        {
+            size_t begin = block * kRowsPerBlock * width;
+            size_t end = std::min(begin + size_t(kRowsPerBlock) * width, size_t(rowCount) * width);
+            blockSums[firstBlock + block] = metric.compareRange(chunkA.data(), chunkB.data(), begin, end, alpha, chunkErrorMap);
+        });
+
+        if (earlyOut && y + rowCount < height)
+        {
+            double error = ImageMetrics::pairwiseSum(blockSums.data(), firstBlock + chunkBlockCount) / count;
+            if (!(error <= threshold))
+            {
+                result.error = error;
+                result.earlyOut = true;
+                return;
+            }
+        }
+    }
+
+    result.error = ImageMetrics::pairwiseSum(blockSums.data(), blockSums.size()) / count;
+    if (errorMap) saveHeatMap(width, height, errorMap.get(), result.heatMapFilename);
+
+    // Treat nans and infs as errors.
+    result.success = !std::isnan(result.error) && !std::isinf(result.error) && result.error <= threshold;
+}
+
+static void compareImages(CompareResult& result, const ErrorMetric& metric, float threshold, bool alpha, bool earlyOut, uint32_t threadCount)
+{
+    if (metric.compareRange) return compareStreaming(result, metric, threshold, alpha, earlyOut, threadCount);
+
+    auto loadImage = [&result] (const std::string& filename)
+    {
+        try
+        {
+            return Image::loadFromFile(filename);
+        }
+        catch (const std::runtime_error& e)
+        {
+            result.message = "Cannot load image from '" + filename + "' (Error: " + e.what() + ").";
+            return Image::SharedPtr();
         }
     };
 
     // Load images.
-    auto imageA = loadImage(filenameA);
-    if (!imageA) return false;
-    auto imageB = loadImage(filenameB);
-    if (!imageB) return false;
+    auto imageA = loadImage(result.filenameA);
+    if (!imageA) return;
+    auto imageB = loadImage(result.filenameB);
+    if (!imageB) return;
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.message = "Cannot compare images with different resolutions.";
+        return;
     }
 
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapFilename.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap = result.heatMapFilename.empty() ? nullptr : std::make_unique<float[]>(width * height);
+    result.error = metric.compare(*imageA, *imageB, alpha, errorMap.get(), threadCount);
 
     // Generate heat map.
-    if (errorMap)
+    if (errorMap) saveHeatMap(width, height, errorMap.get(), result.heatMapFilename);
+
+    // Treat nans and infs as errors.
+    result.success = !std::isnan(result.error) && !std::isinf(result.error) && result.error <= threshold;
+}
+
+/** Compares all pairs that could be resolved. Pairs are compared concurrently, which overlaps decoding one pair with comparing another.
+    Threads left over when there are fewer pairs than threads are used to compare the pairs in parallel.
+*/
+static void compareBatch(std::vector<CompareResult>& results, const ErrorMetric& metric, float threshold, bool alpha, bool earlyOut, uint32_t threadCount)
+{
+    uint32_t pairThreadCount = std::max(1u, threadCount / uint32_t(std::max<size_t>(results.size(), 1)));
+    ImageMetrics::parallelFor(results.size(), threadCount, [&] (size_t i)
+    {
+        if (results[i].message.empty()) compareImages(results[i], metric, threshold, alpha, earlyOut, pairThreadCount);
+    });
+}
+
+/** Reads a manifest listing the image pairs to compare.
+    Each line holds two tab-separated filenames and optionally the filename of the heat map to write. Empty lines and lines starting with '#' are skipped.
+*/
+static std::vector<CompareResult> readManifest(const std::string& filename)
+{
+    std::ifstream stream(filename);
+    if (!stream) throw std::runtime_error("Cannot open manifest '" + filename + "'.");
+
+    std::vector<CompareResult> results;
+    std::string line;
+    while (std::getline(stream, line))
     {
-        auto heatMap = generateHeatMap(width, height, errorMap.get());
-        saveImage(*heatMap, heatMapFilename);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> columns;
+        std::stringstream ss(line);
+        for (std::string column; std::getline(ss, column, '\t');) columns.push_back(column);
+        if (columns.size() < 2 || columns.size() > 3) throw std::runtime_error("Invalid manifest line '" + line + "'.");
+
+        CompareResult result;
+        result.filenameA = columns[0];
+        result.filenameB = columns[1];
+        if (columns.size() == 3) result.heatMapFilename = columns[2];
+        results.push_back(result);
     }
+    return results;
+}
 
-    std::cout << error << std::endl;
+/** Pairs up the images with the same relative path in two directory trees.
+    Images found in only one of the trees are reported as failed pairs. Files ending in heatMapSuffix are skipped, they are output from a previous run.
+*/
+static std::vector<CompareResult> collectDirectoryPairs(const std::string& dirA, const std::string& dirB, const std::string& heatMapSuffix)
+{
+    namespace fs = std::filesystem;
 
-    // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error)) return false;
+    auto collectImages = [&heatMapSuffix] (const fs::path& dir)
+    {
+        if (!fs::is_directory(dir)) throw std::runtime_error("'" + dir.string() + "' is not a directory.");
+        std::vector<fs::path> images;
+        for (const auto& entry : fs::recursive_directory_iterator(dir))
+        {
+            if (!entry.is_regular_file()) continue;
+            std::string filename = entry.path().string();
+            if (!heatMapSuffix.empty() && filename.size() >= heatMapSuffix.size() && filename.compare(filename.size() - heatMapSuffix.size(), heatMapSuffix.size(), heatMapSuffix) == 0) continue;
+            if (FreeImage_GetFIFFromFilename(filename.c_str()) == FIF_UNKNOWN) continue;
+            images.push_back(fs::relative(entry.path(), dir));
+        }
+        std::sort(images.begin(), images.end());
+        return images;
+    };
+
+    auto imagesA = collectImages(dirA);
+    auto imagesB = collectImages(dirB);
+    std::vector<fs::path> images;
+    std::set_union(imagesA.begin(), imagesA.end(), imagesB.begin(), imagesB.end(), std::back_inserter(images));
+
+    std::vector<CompareResult> results;
+    for (const auto& image : images)
+    {
+        CompareResult result;
+        result.filenameA = (fs::path(dirA) / image).string();
+        result.filenameB = (fs::path(dirB) / image).string();
+        if (!std::binary_search(imagesA.begin(), imagesA.end(), image)) result.message = "Image '" + image.string() + "' is missing in '" + dirA + "'.";
+        else if (!std::binary_search(imagesB.begin(), imagesB.end(), image)) result.message = "Image '" + image.string() + "' is missing in '" + dirB + "'.";
+        else if (!heatMapSuffix.empty()) result.heatMapFilename = result.filenameB + heatMapSuffix;
+        results.push_back(result);
+    }
+    return results;
+}
+
+static std::string toJsonString(const std::string& str)
+{
+    std::ostringstream ss;
+    ss << '"';
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"': ss << "\\\""; break;
+        case '\\': ss << "\\\\"; break;
+        case '\n': ss << "\\n"; break;
+        case '\r': ss << "\\r"; break;
+        case '\t': ss << "\\t"; break;
+        default:
+            if (uint8_t(c) < 0x20) ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+            else ss << c;
+        }
+    }
+    ss << '"';
+    return ss.str();
+}
 
-    return error <= threshold;
+/** Writes the results of a batch as JSON. Errors that are nan or inf are written as null.
+*/
+static void writeReport(const std::string& filename, const ErrorMetric& metric, float threshold, const std::vector<CompareResult>& results)
+{
+    std::ofstream stream(filename);
+    if (!stream) throw std::runtime_error("Cannot write report to '" + filename + "'.");
+    bool success = std::all_of(results.begin(), results.end(), [] (const CompareResult& result) { return result.success; });
+
+    stream << "{" << std::endl;
+    stream << "    \"metric\": " << toJsonString(metric.name) << "," << std::endl;
+    stream << "    \"threshold\": " << threshold << "," << std::endl;
+    stream << "    \"success\": " << (success ? "true" : "false") << "," << std::endl;
+    stream << "    \"images\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        bool validError = result.message.empty() && !std::isnan(result.error) && !std::isinf(result.error);
+        stream << "        {" << std::endl;
+        stream << "            \"imageA\": " << toJsonString(result.filenameA) << "," << std::endl;
+        stream << "            \"imageB\": " << toJsonString(result.filenameB) << "," << std::endl;
+        stream << "            \"error\": ";
+        if (validError) stream << std::setprecision(std::numeric_limits<double>::max_digits10) << result.error;
+        else stream << "null";
+        stream << "," << std::endl;
+        stream << "            \"success\": " << (result.success ? "true" : "false") << "," << std::endl;
+        stream << "            \"earlyOut\": " << (result.earlyOut ? "true" : "false") << "," << std::endl;
+        stream << "            \"message\": " << toJsonString(result.message) << std::endl;
+        stream << "        }" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    stream << "    ]" << std::endl;
+    stream << "}" << std::endl;
 }
 
 static void printMetrics(std::ostream &stream = std::cout)
@@ -337,7 +627,7 @@ static void printMetrics(std::ostream &stream = std::cout)
 
 int main(int argc, char** argv)
 {
-    args::ArgumentParser parser("Utility to compare images.");
+    args::ArgumentParser parser("Utility to compare images.", "Batch mode: with -d or --manifest, all pairs are compared in one run and -e gives the suffix appended to the second image of each pair to name its heat map.");
     parser.helpParams.programName = "ImageCompare";
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
     args::Flag listMetricsFlag(parser, "", "List available error metrics.", {'l'});
@@ -345,8 +635,13 @@ int main(int argc, char** argv)
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
     args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::Flag directoriesFlag(parser, "", "Compare all images in two directory trees.", {'d', "dirs"});
+    args::ValueFlag<std::string> manifestFlag(parser, "filename", "Compare the image pairs listed in a manifest file (tab-separated: image1, image2 and optionally the heat map filename).", {"manifest"});
+    args::ValueFlag<std::string> reportFlag(parser, "filename", "Write a JSON report of all compared pairs.", {'r', "report"});
+    args::Flag earlyOutFlag(parser, "", "Stop comparing once the error exceeds the threshold. The reported error is then a lower bound. Only per-pixel metrics stop early.", {'x', "early-out"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "count", "Number of worker threads (default: all logical cores).", {'j', "threads"});
+    args::Positional<std::string> image1(parser, "image1", "The first image (or directory).");
+    args::Positional<std::string> image2(parser, "image2", "The second image (or directory).");
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -396,12 +691,76 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
-    return compareImages(
-        args::get(image1),
-        args::get(image2),
-        metric,
-        thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false,
-        heatMapFlag ? args::get(heatMapFlag) : ""
-    ) ? 0 : 1;
+    float threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    bool alpha = alphaFlag ? args::get(alphaFlag) : false;
+    std::string heatMap = heatMapFlag ? args::get(heatMapFlag) : "";
+    uint32_t threadCount = threadsFlag ? std::max(args::get(threadsFlag), 1u) : std::max(std::thread::hardware_concurrency(), 1u);
+
+    if (!manifestFlag && (!image1 || !image2))
+    {
+        std::cerr << "Two images or directories are required." << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::vector<CompareResult> results;
+    try
+    {
+        if (manifestFlag)
+        {
+            results = readManifest(args::get(manifestFlag));
+            for (auto& result : results)
+            {
+                if (result.heatMapFilename.empty() && !heatMap.empty()) result.heatMapFilename = result.filenameB + heatMap;
+            }
+        }
+        else if (directoriesFlag) results = collectDirectoryPairs(args::get(image1), args::get(image2), heatMap);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // Single image pair.
+    if (!manifestFlag && !directoriesFlag)
+    {
+        CompareResult result;
+        result.filenameA = args::get(image1);
+        result.filenameB = args::get(image2);
+        result.heatMapFilename = heatMap;
+        compareImages(result, metric, threshold, alpha, earlyOutFlag, threadCount);
+
+        if (!result.message.empty()) std::cerr << result.message << std::endl;
+        else std::cout << result.error << std::endl;
+
+        if (reportFlag) results.push_back(result);
+        else return result.success ? 0 : 1;
+    }
+    else
+    {
+        compareBatch(results, metric, threshold, alpha, earlyOutFlag, threadCount);
+
+        for (const auto& result : results)
+        {
+            if (!result.message.empty()) std::cerr << result.message << std::endl;
+            else std::cout << result.error << "\t" << result.filenameB << std::endl;
+        }
+    }
+
+    if (reportFlag)
+    {
+        try
+        {
+            writeReport(args::get(reportFlag), metric, threshold, results);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    bool success = std::all_of(results.begin(), results.end(), [] (const CompareResult& result) { return result.success; });
+    return success ? 0 : 1;
 }
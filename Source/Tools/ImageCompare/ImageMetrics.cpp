@@ -0,0 +1,555 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ImageMetrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace ImageMetrics
+{
+    namespace
+    {
+        using Plane = std::vector<float>;
+
+        const uint32_t kRowsPerBlock = 32;
+        const float kPi = 3.14159265358979f;
+
+        // SSIM constants (Wang et al. 2004) for a dynamic range of 1.
+        const int kSSIMRadius = 5;
+        const float kSSIMSigma = 1.5f;
+        const float kSSIMC1 = 0.01f * 0.01f;
+        const float kSSIMC2 = 0.03f * 0.03f;
+        const float kMSSSIMWeights[] = { 0.0448f, 0.2856f, 0.3001f, 0.2363f, 0.1333f };
+
+        // FLIP constants (Andersson et al. 2020).
+        struct CSFParams { float a1, b1, a2, b2; };
+        const CSFParams kFlipCSF[3] =
+        {
+            { 1.f, 0.0047f, 0.f, 1e-5f },       // Achromatic
+            { 1.f, 0.0053f, 0.f, 1e-5f },       // Red-green
+            { 34.1f, 0.04f, 13.5f, 0.025f },    // Blue-yellow
+        };
+        const float kFlipMaxB = 0.04f;
+        const float kFlipQc = 0.7f;
+        const float kFlipPc = 0.4f;
+        const float kFlipPt = 0.95f;
+        const float kFlipQf = 0.5f;
+        const float kFlipFeatureWidth = 0.082f;
+
+        uint32_t getBlockCount(uint32_t height) { return (height + kRowsPerBlock - 1) / kRowsPerBlock; }
+
+        /** Convolves a row with a 1D kernel, clamping to the edge.
+        */
+        void convolveRow(const float* pSrc, float* pDst, int width, const std::vector<float>& kernel)
+        {
+            const int radius = int(kernel.size() / 2);
+            for (int x = 0; x < width; ++x)
+            {
+                float sum = 0.f;
+                if (x >= radius && x + radius < width)
+                {
+                    const float* p = pSrc + x - radius;
+                    for (size_t k = 0; k < kernel.size(); ++k) sum += kernel[k] * p[k];
+                }
+                else
+                {
+                    for (int k = 0; k < int(kernel.size()); ++k) sum += kernel[k] * pSrc[std::clamp(x - radius + k, 0, width - 1)];
+                }
+                pDst[x] = sum;
+            }
+        }
+
+        /** Convolves a plane with a separable kernel, clamping to the edge.
+            Each block of rows runs the horizontal pass over the rows it needs into a buffer that stays in cache, followed by the vertical pass.
+        */
+        void convolve(const float* pSrc, float* pDst, uint32_t width, uint32_t height, const std::vector<float>& kernelX, const std::vector<float>& kernelY, uint32_t threadCount)
+        {
+            const int radius = int(kernelY.size() / 2);
+            parallelFor(getBlockCount(height), threadCount, [&] (size_t block)
+            {
+                const int y0 = int(block * kRowsPerBlock);
+                const int y1 = std::min(y0 + int(kRowsPerBlock), int(height));
+                const int rows = y1 - y0 + 2 * radius;
+
+                Plane rowBuffer(size_t(rows) * width);
+                for (int r = 0; r < rows; ++r)
+                {
+                    int y = std::clamp(y0 - radius + r, 0, int(height) - 1);
+                    convolveRow(pSrc + size_t(y) * width, rowBuffer.data() + size_t(r) * width, int(width), kernelX);
+                }
+
+                for (int y = y0; y < y1; ++y)
+                {
+                    float* pOut = pDst + size_t(y) * width;
+                    std::fill(pOut, pOut + width, 0.f);
+                    for (size_t k = 0; k < kernelY.size(); ++k)
+                    {
+                        const float w = kernelY[k];
+                        const float* pRow = rowBuffer.data() + size_t(y - y0 + k) * width;
+                        for (uint32_t x = 0; x < width; ++x) pOut[x] += w * pRow[x];
+                    }
+                }
+            });
+        }
+
+        std::vector<float> createGaussianKernel(int radius, float sigma)
+        {
+            std::vector<float> kernel(2 * radius + 1);
+            float sum = 0.f;
+            for (int i = -radius; i <= radius; ++i) sum += kernel[i + radius] = std::exp(-float(i * i) / (2.f * sigma * sigma));
+            for (auto& w : kernel) w /= sum;
+            return kernel;
+        }
+
+        /** Scales the positive weights of a derivative kernel to sum to 1 and the negative weights to sum to -1.
+        */
+        void normalizeDerivativeKernel(std::vector<float>& kernel)
+        {
+            float positiveSum = 0.f, negativeSum = 0.f;
+            for (float w : kernel) (w > 0.f ? positiveSum : negativeSum) += w;
+            for (auto& w : kernel) w /= (w > 0.f ? positiveSum : -negativeSum);
+        }
+
+        Plane computeLuma(const ImageView& image)
+        {
+            const size_t count = size_t(image.width) * image.height;
+            Plane luma(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float* p = image.pData + 4 * i;
+                luma[i] = 0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2];
+            }
+            return luma;
+        }
+
+        Plane downsample(const Plane& src, uint32_t width, uint32_t height)
+        {
+            const uint32_t w = width / 2, h = height / 2;
+            Plane dst(size_t(w) * h);
+            for (uint32_t y = 0; y < h; ++y)
+            {
+                const float* p0 = src.data() + size_t(2 * y) * width;
+                const float* p1 = p0 + width;
+                for (uint32_t x = 0; x < w; ++x) dst[size_t(y) * w + x] = 0.25f * (p0[2 * x] + p0[2 * x + 1] + p1[2 * x] + p1[2 * x + 1]);
+            }
+            return dst;
+        }
+
+        struct SSIMResult
+        {
+            double ssim = 0.0;      ///< Mean SSIM.
+            double cs = 0.0;        ///< Mean contrast-structure term.
+        };
+
+        /** Computes SSIM of two luma planes at one scale.
+            The Gaussian-weighted moments are computed per block of rows in a fused horizontal/vertical pass, without full-size intermediate planes.
+        */
+        SSIMResult computeSSIMScale(const float* pA, const float* pB, uint32_t width, uint32_t height, float* pSSIMMap, float* pCSMap, uint32_t threadCount)
+        {
+            static const std::vector<float> kernel = createGaussianKernel(kSSIMRadius, kSSIMSigma);
+            const int radius = kSSIMRadius;
+            const uint32_t blockCount = getBlockCount(height);
+            std::vector<double> ssimSums(blockCount), csSums(blockCount);
+
+            parallelFor(blockCount, threadCount, [&] (size_t block)
+            {
+                const int y0 = int(block * kRowsPerBlock);
+                const int y1 = std::min(y0 + int(kRowsPerBlock), int(height));
+                const int rows = y1 - y0 + 2 * radius;
+
+                // Horizontal pass of the moments a, b, a^2, b^2 and ab.
+                Plane moments[5];
+                for (auto& m : moments) m.resize(size_t(rows) * width);
+                Plane products[3];
+                for (auto& p : products) p.resize(width);
+                for (int r = 0; r < rows; ++r)
+                {
+                    const int y = std::clamp(y0 - radius + r, 0, int(height) - 1);
+                    const float* a = pA + size_t(y) * width;
+                    const float* b = pB + size_t(y) * width;
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        products[0][x] = a[x] * a[x];
+                        products[1][x] = b[x] * b[x];
+                        products[2][x] = a[x] * b[x];
+                    }
+                    const size_t offset = size_t(r) * width;
+                    convolveRow(a, moments[0].data() + offset, int(width), kernel);
+                    convolveRow(b, moments[1].data() + offset, int(width), kernel);
+                    for (int i = 0; i < 3; ++i) convolveRow(products[i].data(), moments[2 + i].data() + offset, int(width), kernel);
+                }
+
+                // Vertical pass and per-pixel SSIM.
+                Plane mean[5];
+                for (auto& m : mean) m.resize(width);
+                double ssimSum = 0.0, csSum = 0.0;
+                for (int y = y0; y < y1; ++y)
+                {
+                    for (int i = 0; i < 5; ++i)
+                    {
+                        std::fill(mean[i].begin(), mean[i].end(), 0.f);
+                        for (size_t k = 0; k < kernel.size(); ++k)
+                        {
+                            const float w = kernel[k];
+                            const float* pRow = moments[i].data() + size_t(y - y0 + k) * width;
+                            for (uint32_t x = 0; x < width; ++x) mean[i][x] += w * pRow[x];
+                        }
+                    }
+
+                    double ssimRowSum = 0.0, csRowSum = 0.0;
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        const float muA = mean[0][x], muB = mean[1][x];
+                        const float varA = mean[2][x] - muA * muA;
+                        const float varB = mean[3][x] - muB * muB;
+                        const float covAB = mean[4][x] - muA * muB;
+                        const float l = (2.f * muA * muB + kSSIMC1) / (muA * muA + muB * muB + kSSIMC1);
+                        const float cs = (2.f * covAB + kSSIMC2) / (varA + varB + kSSIMC2);
+                        const size_t i = size_t(y) * width + x;
+                        if (pSSIMMap) pSSIMMap[i] = l * cs;
+                        if (pCSMap) pCSMap[i] = cs;
+                        ssimRowSum += l * cs;
+                        csRowSum += cs;
+                    }
+                    ssimSum += ssimRowSum;
+                    csSum += csRowSum;
+                }
+                ssimSums[block] = ssimSum;
+                csSums[block] = csSum;
+            });
+
+            const double count = double(width) * height;
+            SSIMResult result;
+            result.ssim = pairwiseSum(ssimSums.data(), blockCount) / count;
+            result.cs = pairwiseSum(csSums.data(), blockCount) / count;
+            return result;
+        }
+
+        // Color conversions for FLIP. Linear sRGB primaries with a D65 white point.
+
+        float sRGBToLinear(float c)
+        {
+            return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        void linearRGBToXYZ(const float rgb[3], float xyz[3])
+        {
+            xyz[0] = 0.4124564f * rgb[0] + 0.3575761f * rgb[1] + 0.1804375f * rgb[2];
+            xyz[1] = 0.2126729f * rgb[0] + 0.7151522f * rgb[1] + 0.0721750f * rgb[2];
+            xyz[2] = 0.0193339f * rgb[0] + 0.1191920f * rgb[1] + 0.9503041f * rgb[2];
+        }
+
+        void XYZToLinearRGB(const float xyz[3], float rgb[3])
+        {
+            rgb[0] = 3.2404542f * xyz[0] - 1.5371385f * xyz[1] - 0.4985314f * xyz[2];
+            rgb[1] = -0.9692660f * xyz[0] + 1.8760108f * xyz[1] + 0.0415560f * xyz[2];
+            rgb[2] = 0.0556434f * xyz[0] - 0.2040259f * xyz[1] + 1.0572252f * xyz[2];
+        }
+
+        const float kWhiteXYZ[3] = { 0.4124564f + 0.3575761f + 0.1804375f, 1.f, 0.0193339f + 0.1191920f + 0.9503041f };
+
+        /** Converts linear RGB in [0, 1] to Hunt-adjusted CIELAB.
+        */
+        void linearRGBToHuntLab(const float rgb[3], float lab[3])
+        {
+            auto f = [] (float t)
+            {
+                const float delta = 6.f / 29.f;
+                return t > delta * delta * delta ? std::cbrt(t) : t / (3.f * delta * delta) + 4.f / 29.f;
+            };
+
+            float xyz[3];
+            linearRGBToXYZ(rgb, xyz);
+            const float fx = f(xyz[0] / kWhiteXYZ[0]), fy = f(xyz[1] / kWhiteXYZ[1]), fz = f(xyz[2] / kWhiteXYZ[2]);
+            lab[0] = 116.f * fy - 16.f;
+            lab[1] = 0.01f * lab[0] * 500.f * (fx - fy);
+            lab[2] = 0.01f * lab[0] * 200.f * (fy - fz);
+        }
+
+        float computeHyAB(const float labA[3], const float labB[3])
+        {
+            const float da = labA[1] - labB[1], db = labA[2] - labB[2];
+            return std::fabs(labA[0] - labB[0]) + std::sqrt(da * da + db * db);
+        }
+
+        struct FlipPlanes
+        {
+            Plane opponent[3];      ///< CSF-filtered Y, Cx, Cz.
+            Plane luminance;        ///< Unfiltered relative luminance, used for feature detection.
+        };
+
+        FlipPlanes computeFlipPlanes(const ImageView& image, float pixelsPerDegree, uint32_t threadCount)
+        {
+            const size_t count = size_t(image.width) * image.height;
+            FlipPlanes planes;
+            Plane opponent[3];
+            for (auto& p : opponent) p.resize(count);
+            planes.luminance.resize(count);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                float rgb[3], xyz[3];
+                for (int c = 0; c < 3; ++c) rgb[c] = sRGBToLinear(std::clamp(image.pData[4 * i + c], 0.f, 1.f));
+                linearRGBToXYZ(rgb, xyz);
+                const float x = xyz[0] / kWhiteXYZ[0], y = xyz[1] / kWhiteXYZ[1], z = xyz[2] / kWhiteXYZ[2];
+                opponent[0][i] = 116.f * y - 16.f;
+                opponent[1][i] = 500.f * (x - y);
+                opponent[2][i] = 200.f * (y - z);
+                planes.luminance[i] = y;
+            }
+
+            // Each CSF is a sum of up to two Gaussians. Each Gaussian is separable, so the channels are filtered once per term and the results blended.
+            const int radius = int(std::ceil(3.f * std::sqrt(kFlipMaxB / (2.f * kPi * kPi)) * pixelsPerDegree));
+            Plane filtered(count);
+            for (int c = 0; c < 3; ++c)
+            {
+                const float a[2] = { kFlipCSF[c].a1, kFlipCSF[c].a2 };
+                const float b[2] = { kFlipCSF[c].b1, kFlipCSF[c].b2 };
+                std::vector<float> kernels[2];
+                float weights[2] = {};
+                float weightSum = 0.f;
+                for (int t = 0; t < 2; ++t)
+                {
+                    if (a[t] == 0.f) continue;
+                    kernels[t].resize(2 * radius + 1);
+                    float sum = 0.f;
+                    for (int i = -radius; i <= radius; ++i)
+                    {
+                        const float d = float(i) / pixelsPerDegree;
+                        sum += kernels[t][i + radius] = std::exp(-kPi * kPi * d * d / b[t]);
+                    }
+                    for (auto& w : kernels[t]) w /= sum;
+                    weights[t] = a[t] * std::sqrt(kPi / b[t]) * sum * sum;
+                    weightSum += weights[t];
+                }
+
+                planes.opponent[c].assign(count, 0.f);
+                for (int t = 0; t < 2; ++t)
+                {
+                    if (kernels[t].empty()) continue;
+                    convolve(opponent[c].data(), filtered.data(), image.width, image.height, kernels[t], kernels[t], threadCount);
+                    const float w = weights[t] / weightSum;
+                    for (size_t i = 0; i < count; ++i) planes.opponent[c][i] += w * filtered[i];
+                }
+            }
+            return planes;
+        }
+
+        /** Computes the edge and point feature magnitudes of a luminance plane.
+        */
+        void computeFeatures(const Plane& luminance, uint32_t width, uint32_t height, float pixelsPerDegree, Plane& edges, Plane& points, uint32_t threadCount)
+        {
+            const float sigma = 0.5f * kFlipFeatureWidth * pixelsPerDegree;
+            const int radius = int(std::ceil(3.f * sigma));
+            std::vector<float> gaussian = createGaussianKernel(radius, sigma);
+            std::vector<float> edgeKernel(2 * radius + 1), pointKernel(2 * radius + 1);
+            for (int i = -radius; i <= radius; ++i)
+            {
+                const float g = std::exp(-float(i * i) / (2.f * sigma * sigma));
+                edgeKernel[i + radius] = -float(i) * g;
+                pointKernel[i + radius] = (float(i * i) / (sigma * sigma) - 1.f) * g;
+            }
+            normalizeDerivativeKernel(edgeKernel);
+            normalizeDerivativeKernel(pointKernel);
+
+            const size_t count = luminance.size();
+            Plane dx(count), dy(count);
+            edges.resize(count);
+            points.resize(count);
+
+            convolve(luminance.data(), dx.data(), width, height, edgeKernel, gaussian, threadCount);
+            convolve(luminance.data(), dy.data(), width, height, gaussian, edgeKernel, threadCount);
+            for (size_t i = 0; i < count; ++i) edges[i] = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+
+            convolve(luminance.data(), dx.data(), width, height, pointKernel, gaussian, threadCount);
+            convolve(luminance.data(), dy.data(), width, height, gaussian, pointKernel, threadCount);
+            for (size_t i = 0; i < count; ++i) points[i] = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+        }
+    }
+
+    void parallelFor(size_t count, uint32_t threadCount, const std::function<void(size_t)>& func)
+    {
+        threadCount = uint32_t(std::min<size_t>(threadCount, count));
+        if (threadCount <= 1)
+        {
+            for (size_t i = 0; i < count; ++i) func(i);
+            return;
+        }
+
+        std::atomic<size_t> next = 0;
+        auto worker = [&] () { for (size_t i = next++; i < count; i = next++) func(i); };
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < threadCount; ++i) threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads) thread.join();
+    }
+
+    double pairwiseSum(const double* values, size_t count)
+    {
+        if (count == 0) return 0.0;
+        if (count == 1) return values[0];
+        size_t half = count / 2;
+        return pairwiseSum(values, half) + pairwiseSum(values + half, count - half);
+    }
+
+    double computeSSIM(const ImageView& a, const ImageView& b, float* pSSIMMap, uint32_t threadCount)
+    {
+        if (a.width == 0 || a.height == 0) return 1.0;
+        Plane lumaA = computeLuma(a);
+        Plane lumaB = computeLuma(b);
+        return computeSSIMScale(lumaA.data(), lumaB.data(), a.width, a.height, pSSIMMap, nullptr, threadCount).ssim;
+    }
+
+    double computeMSSSIM(const ImageView& a, const ImageView& b, float* pSSIMMap, uint32_t threadCount)
+    {
+        if (a.width == 0 || a.height == 0) return 1.0;
+
+        // Use as many scales as leave the coarsest one at least as large as the SSIM window.
+        const uint32_t maxScaleCount = uint32_t(std::size(kMSSSIMWeights));
+        uint32_t scaleCount = 1;
+        while (scaleCount < maxScaleCount && std::min(a.width >> scaleCount, a.height >> scaleCount) >= 2 * kSSIMRadius + 1) scaleCount++;
+
+        float weightSum = 0.f;
+        for (uint32_t s = 0; s < scaleCount; ++s) weightSum += kMSSSIMWeights[s];
+
+        // The coarser scales use the contrast-structure term only, the coarsest one the full SSIM.
+        Plane lumaA = computeLuma(a);
+        Plane lumaB = computeLuma(b);
+        uint32_t width = a.width, height = a.height;
+        std::vector<Plane> maps(pSSIMMap ? scaleCount : 0);
+        double result = 1.0;
+        for (uint32_t s = 0; s < scaleCount; ++s)
+        {
+            const bool coarsest = s + 1 == scaleCount;
+            float* pMap = nullptr;
+            if (pSSIMMap)
+            {
+                maps[s].resize(size_t(width) * height);
+                pMap = maps[s].data();
+            }
+
+            SSIMResult scale = computeSSIMScale(lumaA.data(), lumaB.data(), width, height, coarsest ? pMap : nullptr, coarsest ? nullptr : pMap, threadCount);
+            result *= std::pow(std::max(coarsest ? scale.ssim : scale.cs, 0.0), double(kMSSSIMWeights[s] / weightSum));
+
+            if (!coarsest)
+            {
+                lumaA = downsample(lumaA, width, height);
+                lumaB = downsample(lumaB, width, height);
+                width /= 2;
+                height /= 2;
+            }
+        }
+
+        if (pSSIMMap)
+        {
+            parallelFor(getBlockCount(a.height), threadCount, [&] (size_t block)
+            {
+                const uint32_t y0 = uint32_t(block) * kRowsPerBlock;
+                const uint32_t y1 = std::min(y0 + kRowsPerBlock, a.height);
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    for (uint32_t x = 0; x < a.width; ++x)
+                    {
+                        float value = 1.f;
+                        for (uint32_t s = 0; s < scaleCount; ++s)
+                        {
+                            const uint32_t w = a.width >> s, h = a.height >> s;
+                            const float m = maps[s][size_t(std::min(y >> s, h - 1)) * w + std::min(x >> s, w - 1)];
+                            value *= std::pow(std::max(m, 0.f), kMSSSIMWeights[s] / weightSum);
+                        }
+                        pSSIMMap[size_t(y) * a.width + x] = value;
+                    }
+                }
+            });
+        }
+
+        return result;
+    }
+
+    double computeFLIP(const ImageView& a, const ImageView& b, float pixelsPerDegree, float* pErrorMap, uint32_t threadCount)
+    {
+        if (a.width == 0 || a.height == 0) return 0.0;
+
+        const FlipPlanes planesA = computeFlipPlanes(a, pixelsPerDegree, threadCount);
+        const FlipPlanes planesB = computeFlipPlanes(b, pixelsPerDegree, threadCount);
+        Plane edgesA, pointsA, edgesB, pointsB;
+        computeFeatures(planesA.luminance, a.width, a.height, pixelsPerDegree, edgesA, pointsA, threadCount);
+        computeFeatures(planesB.luminance, b.width, b.height, pixelsPerDegree, edgesB, pointsB, threadCount);
+
+        // The largest color difference is between green and blue.
+        const float green[3] = { 0.f, 1.f, 0.f }, blue[3] = { 0.f, 0.f, 1.f };
+        float greenLab[3], blueLab[3];
+        linearRGBToHuntLab(green, greenLab);
+        linearRGBToHuntLab(blue, blueLab);
+        const float cmax = std::pow(computeHyAB(greenLab, blueLab), kFlipQc);
+
+        const uint32_t blockCount = getBlockCount(a.height);
+        std::vector<double> blockSums(blockCount);
+        parallelFor(blockCount, threadCount, [&] (size_t block)
+        {
+            const size_t begin = block * kRowsPerBlock * a.width;
+            const size_t end = std::min(begin + size_t(kRowsPerBlock) * a.width, size_t(a.width) * a.height);
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                // Back to linear RGB after filtering, clamped to the displayable range.
+                float labA[3], labB[3];
+                const FlipPlanes* planes[2] = { &planesA, &planesB };
+                float* labs[2] = { labA, labB };
+                for (int j = 0; j < 2; ++j)
+                {
+                    const float yr = (planes[j]->opponent[0][i] + 16.f) / 116.f;
+                    const float xyz[3] = { (planes[j]->opponent[1][i] / 500.f + yr) * kWhiteXYZ[0], yr * kWhiteXYZ[1], (yr - planes[j]->opponent[2][i] / 200.f) * kWhiteXYZ[2] };
+                    float rgb[3];
+                    XYZToLinearRGB(xyz, rgb);
+                    for (auto& c : rgb) c = std::clamp(c, 0.f, 1.f);
+                    linearRGBToHuntLab(rgb, labs[j]);
+                }
+
+                // Map the color difference so that differences up to pc * cmax cover most of the error range.
+                float colorError = std::pow(computeHyAB(labA, labB), kFlipQc);
+                if (colorError < kFlipPc * cmax) colorError *= kFlipPt / (kFlipPc * cmax);
+                else colorError = kFlipPt + (colorError - kFlipPc * cmax) / (cmax - kFlipPc * cmax) * (1.f - kFlipPt);
+
+                const float featureDiff = std::max(std::fabs(edgesA[i] - edgesB[i]), std::fabs(pointsA[i] - pointsB[i]));
+                const float featureError = std::pow(featureDiff / std::sqrt(2.f), kFlipQf);
+
+                const float error = std::pow(std::min(colorError, 1.f), 1.f - featureError);
+                if (pErrorMap) pErrorMap[i] = error;
+                sum += error;
+            }
+            blockSums[block] = sum;
+        });
+
+        return pairwiseSum(blockSums.data(), blockCount) / (double(a.width) * a.height);
+    }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <cstdint>
+#include <functional>
+
+/** Image quality metrics for RGBA32F images in memory.
+    Only depends on the standard library, so other tools can build it in alongside ImageCompare.
+    The filters are separable and process the image in blocks of rows on multiple threads. Block results are reduced in a fixed
+    order, so the results don't change with the thread count.
+*/
+namespace ImageMetrics
+{
+    /** An RGBA32F image. Rows are stored top to bottom without padding.
+    */
+    struct ImageView
+    {
+        const float* pData = nullptr;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    /** Runs func(index) for all indices in [0, count) on up to threadCount threads.
+        Indices are handed out dynamically, func must not depend on the order they are processed in.
+    */
+    void parallelFor(size_t count, uint32_t threadCount, const std::function<void(size_t)>& func);
+
+    /** Sums values with a pairwise reduction.
+        The result only depends on the values and their order, so it doesn't change with the number of threads that produced them.
+    */
+    double pairwiseSum(const double* values, size_t count);
+
+    /** Computes the mean structural similarity (SSIM) of the luma of two images, using an 11x11 Gaussian window with sigma 1.5.
+        The images must have the same size. Inputs are expected to be display-encoded values in [0, 1].
+        \param[out] pSSIMMap Optional per-pixel SSIM, width * height floats.
+        \return Mean SSIM in [-1, 1], 1 for identical images.
+    */
+    double computeSSIM(const ImageView& a, const ImageView& b, float* pSSIMMap = nullptr, uint32_t threadCount = 1);
+
+    /** Computes the multi-scale SSIM (Wang et al. 2003) over up to 5 scales.
+        Images too small for 5 scales use fewer, with the weights renormalized.
+        \param[out] pSSIMMap Optional per-pixel similarity. Each scale's map is sampled at the pixel and combined with the scale weights.
+        \return MS-SSIM in [0, 1], 1 for identical images.
+    */
+    double computeMSSSIM(const ImageView& a, const ImageView& b, float* pSSIMMap = nullptr, uint32_t threadCount = 1);
+
+    /** Computes a perceptual difference following the LDR FLIP pipeline (Andersson et al. 2020).
+        The images are filtered with contrast sensitivity functions in YCxCz opponent space and compared with the Hunt-adjusted HyAB
+        color difference. The color difference is then amplified where edges and points differ.
+        Inputs are expected to be sRGB-encoded values in [0, 1]. HDR images should be tone mapped first.
+        \param[in] pixelsPerDegree Pixels per degree of visual angle. 67 is a 24" 4K monitor viewed from 0.7 m.
+        \param[out] pErrorMap Optional per-pixel error in [0, 1], width * height floats.
+        \return Mean error in [0, 1], 0 for identical images.
+    */
+    double computeFLIP(const ImageView& a, const ImageView& b, float pixelsPerDegree = 67.f, float* pErrorMap = nullptr, uint32_t threadCount = 1);
+}
@@ -0,0 +1,207 @@
+/***************************************************************************
+ # Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ImageReader.h"
+#include "FreeImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    /** Streams rows from a PFM file. Rows are stored bottom to top, so a block of rows is contiguous in the file.
+    */
+    class PfmReader : public ImageReader
+    {
+    public:
+        PfmReader(const std::string& filename)
+            : mStream(filename, std::ios::binary)
+        {
+            if (!mStream) throw std::runtime_error("Cannot open file");
+
+            std::string magic;
+            float scale = 0.f;
+            mStream >> magic >> mWidth >> mHeight >> scale;
+            if (!mStream || (magic != "PF" && magic != "Pf") || mWidth == 0 || mHeight == 0 || scale == 0.f) throw std::runtime_error("Invalid PFM header");
+            mStream.get(); // Single whitespace character before the data
+
+            mChannels = magic == "PF" ? 3 : 1;
+            mSwapBytes = scale > 0.f; // Positive scale means big-endian data
+            mDataOffset = mStream.tellg();
+
+            mStream.seekg(0, std::ios::end);
+            if (std::streamoff(mStream.tellg() - mDataOffset) < std::streamoff(getRowSize()) * mHeight) throw std::runtime_error("Truncated PFM file");
+        }
+
+        void readRows(uint32_t y, uint32_t rowCount, float* pDst) override
+        {
+            if (y + rowCount > mHeight) throw std::runtime_error("Row range out of bounds");
+
+            const size_t rowSize = getRowSize();
+            mBuffer.resize(rowSize * rowCount / sizeof(float));
+            mStream.seekg(mDataOffset + std::streamoff(rowSize) * (mHeight - y - rowCount));
+            mStream.read(reinterpret_cast<char*>(mBuffer.data()), rowSize * rowCount);
+            if (!mStream) throw std::runtime_error("Cannot read PFM data");
+
+            if (mSwapBytes)
+            {
+                for (auto& value : mBuffer)
+                {
+                    uint8_t* p = reinterpret_cast<uint8_t*>(&value);
+                    std::swap(p[0], p[3]);
+                    std::swap(p[1], p[2]);
+                }
+            }
+
+            for (uint32_t r = 0; r < rowCount; ++r)
+            {
+                const float* src = mBuffer.data() + size_t(rowCount - r - 1) * mWidth * mChannels;
+                float* dst = pDst + size_t(r) * mWidth * 4;
+                for (uint32_t x = 0; x < mWidth; ++x)
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[mChannels == 3 ? 1 : 0];
+                    dst[2] = src[mChannels == 3 ? 2 : 0];
+                    dst[3] = 1.f;
+                    src += mChannels;
+                    dst += 4;
+                }
+            }
+        }
+
+    private:
+        size_t getRowSize() const { return size_t(mWidth) * mChannels * sizeof(float); }
+
+        std::ifstream mStream;
+        std::streampos mDataOffset;
+        uint32_t mChannels = 0;
+        bool mSwapBytes = false;
+        std::vector<float> mBuffer;
+    };
+
+    /** Keeps the FreeImage bitmap in its native format and converts rows to float when they're read.
+        Formats without a direct conversion are converted to RGBA32F up front.
+    */
+    class FreeImageReader : public ImageReader
+    {
+    public:
+        FreeImageReader(const std::string& filename, FREE_IMAGE_FORMAT fifFormat)
+        {
+            if (!FreeImage_FIFSupportsReading(fifFormat)) throw std::runtime_error("Unsupported image format");
+
+            mpBitmap = FreeImage_Load(fifFormat, filename.c_str());
+            if (!mpBitmap) throw std::runtime_error("Cannot read image");
+
+            mType = FreeImage_GetImageType(mpBitmap);
+            unsigned bpp = FreeImage_GetBPP(mpBitmap);
+            bool native = mType == FIT_RGBF || mType == FIT_RGBAF || mType == FIT_FLOAT || mType == FIT_RGB16 || mType == FIT_RGBA16 || mType == FIT_UINT16 || (mType == FIT_BITMAP && (bpp == 24 || bpp == 32));
+            if (!native)
+            {
+                FIBITMAP* pFloatBitmap = FreeImage_ConvertToRGBAF(mpBitmap);
+                FreeImage_Unload(mpBitmap);
+                mpBitmap = pFloatBitmap;
+                if (!mpBitmap) throw std::runtime_error("Cannot convert to RGBA float format");
+                mType = FIT_RGBAF;
+            }
+            mBytesPerPixel = FreeImage_GetBPP(mpBitmap) / 8;
+            mWidth = FreeImage_GetWidth(mpBitmap);
+            mHeight = FreeImage_GetHeight(mpBitmap);
+        }
+
+        ~FreeImageReader()
+        {
+            if (mpBitmap) FreeImage_Unload(mpBitmap);
+        }
+
+        void readRows(uint32_t y, uint32_t rowCount, float* pDst) override
+        {
+            if (y + rowCount > mHeight) throw std::runtime_error("Row range out of bounds");
+
+            // Same conversions as FreeImage_ConvertToRGBAF. FreeImage stores rows bottom to top.
+            for (uint32_t r = 0; r < rowCount; ++r)
+            {
+                const BYTE* src = FreeImage_GetScanLine(mpBitmap, mHeight - (y + r) - 1);
+                float* dst = pDst + size_t(r) * mWidth * 4;
+                for (uint32_t x = 0; x < mWidth; ++x, src += mBytesPerPixel, dst += 4)
+                {
+                    switch (mType)
+                    {
+                    case FIT_BITMAP:
+                        dst[0] = src[FI_RGBA_RED] / 255.f;
+                        dst[1] = src[FI_RGBA_GREEN] / 255.f;
+                        dst[2] = src[FI_RGBA_BLUE] / 255.f;
+                        dst[3] = mBytesPerPixel == 4 ? src[FI_RGBA_ALPHA] / 255.f : 1.f;
+                        break;
+                    case FIT_UINT16:
+                        dst[0] = dst[1] = dst[2] = reinterpret_cast<const uint16_t*>(src)[0] / 65535.f;
+                        dst[3] = 1.f;
+                        break;
+                    case FIT_RGB16:
+                    case FIT_RGBA16:
+                        for (int c = 0; c < 3; ++c) dst[c] = reinterpret_cast<const uint16_t*>(src)[c] / 65535.f;
+                        dst[3] = mType == FIT_RGBA16 ? reinterpret_cast<const uint16_t*>(src)[3] / 65535.f : 1.f;
+                        break;
+                    case FIT_FLOAT:
+                        dst[0] = dst[1] = dst[2] = reinterpret_cast<const float*>(src)[0];
+                        dst[3] = 1.f;
+                        break;
+                    case FIT_RGBF:
+                        std::memcpy(dst, src, 3 * sizeof(float));
+                        dst[3] = 1.f;
+                        break;
+                    case FIT_RGBAF:
+                        std::memcpy(dst, src, 4 * sizeof(float));
+                        break;
+                    default:
+                        throw std::runtime_error("Unsupported pixel format");
+                    }
+                }
+            }
+        }
+
+    private:
+        FIBITMAP* mpBitmap = nullptr;
+        FREE_IMAGE_TYPE mType = FIT_UNKNOWN;
+        uint32_t mBytesPerPixel = 0;
+    };
+}
+
+std::unique_ptr<ImageReader> ImageReader::open(const std::string& filename)
+{
+    FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+
+    // Determine file format.
+    fifFormat = FreeImage_GetFileType(filename.c_str(), 0);
+    if (fifFormat == FIF_UNKNOWN) fifFormat = FreeImage_GetFIFFromFilename(filename.c_str());
+    if (fifFormat == FIF_UNKNOWN) throw std::runtime_error("Unknown image format");
+
+    if (fifFormat == FIF_PFM) return std::make_unique<PfmReader>(filename);
+    return std::make_unique<FreeImageReader>(filename, fifFormat);
+}
@@ -157,18 +157,30 @@ class Test:
 
         return Test.Result.PASSED, []
 
-    def compare_image(self, ref_file, result_file, error_file, tolerance, image_compare_exe):
+    def compare_image_pairs(self, pairs, tolerance, work_dir, image_compare_exe):
         '''
-        Compare two images using ImageCompare.
-        Returns a tuple containing the a boolean to indicate success and the measured error.
+        Compare a list of (ref_file, result_file, error_file) tuples using a single ImageCompare run.
+        Returns a list of tuples containing a boolean to indicate success and the measured error (None if the images could not be compared).
         '''
-        args = [str(image_compare_exe), '-m', 'mse', '-t', str(tolerance), str(ref_file), str(result_file)]
-        if error_file:
-            args += ['-e', str(error_file)]
+        manifest_file = work_dir / 'compare_manifest.txt'
+        report_file = work_dir / 'compare_report.json'
+        with open(manifest_file, 'w') as f:
+            for ref_file, result_file, error_file in pairs:
+                f.write(f'{ref_file}\t{result_file}\t{error_file}\n')
+
+        args = [str(image_compare_exe), '-m', 'mse', '-t', str(tolerance), '--manifest', str(manifest_file), '-r', str(report_file)]
         process = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
-        output = process.communicate()[0]
-        error = float(output.strip())
-        return process.returncode == 0, error
+        process.communicate()
+
+        try:
+            with open(report_file) as f:
+                images = json.load(f)['images']
+        except Exception:
+            images = []
+        if len(images) != len(pairs):
+            return [(False, None)] * len(pairs)
+
+        return [(image['success'], image['error']) for image in images]
 
     def compare_images(self, ref_dir, result_dir, image_compare_exe):
         '''
@@ -203,16 +215,19 @@ class Test:
         image_reports = []
 
         # Compare every result image with the corresponding reference image and report missing references.
+        compared_images = []
         for image in result_images:
             if not image in ref_images:
                 result = Test.Result.FAILED
                 messages.append(f'Test has generated image "{image}" with no corresponding reference image.')
                 continue
+            compared_images.append(image)
+
+        # All images of the test are compared in one ImageCompare run.
+        pairs = [(ref_dir / image, result_dir / image, result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)) for image in compared_images]
+        compare_results = self.compare_image_pairs(pairs, self.tolerance, result_dir, image_compare_exe) if pairs else []
 
-            ref_file = ref_dir / image
-            result_file = result_dir / image
-            error_file = result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)
-            compare_success, compare_error = self.compare_image(ref_file, result_file, error_file, self.tolerance, image_compare_exe)
+        for image, (compare_success, compare_error) in zip(compared_images, compare_results):
             if not compare_success:
                 result = Test.Result.FAILED
                 messages.append(f'Test image "{image}" failed with error {compare_error}.')